@@ -0,0 +1,348 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for heap allocation accounting, including the replacement global
+// operator new and delete
+//----------------------------------------------------------------------------------------
+
+#include "AllocTrackerType.h"
+
+#ifdef ALLOC_TRACKING_ENABLED
+
+#include <windows.h>
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	// Every tracked block has this header in front of the memory handed back to the caller.
+	// Live blocks are kept in a doubly linked list so leaks can be listed at shutdown.
+	struct BlockHeader
+	{
+		BlockHeader* prev;
+		BlockHeader* next;
+		size_t size;
+		unsigned int frame; // Frame the block was allocated in
+		unsigned short tag;
+		unsigned short magic;
+	};
+
+	const unsigned short BLOCK_MAGIC = 0x4B4A; // "KJ"
+	const size_t HEADER_SIZE = (sizeof(BlockHeader) + 15) & ~size_t(15); // Keeps the caller's memory 16 byte aligned
+
+	// Everything below is only touched while holding the lock. It is a spin lock on an
+	// atomic_flag so it works before any constructors have run.
+	std::atomic_flag trackerLock = ATOMIC_FLAG_INIT;
+
+	BlockHeader* liveBlocks = NULL;
+	AllocTrackerType::Stats tagStats[AllocTrackerType::TAG_COUNT];
+	long long totalLiveBytes = 0;
+	long long totalPeakBytes = 0;
+	unsigned int currentFrame = 0;
+
+	thread_local AllocTrackerType::Tag currentTag = AllocTrackerType::General;
+
+	std::atomic<bool> expectNoAllocations(false);
+	bool assertOnUnexpected = true;
+	DWORD steadyStateThread = 0;
+	thread_local bool steadyStateJoined = false; // A worker counted along with steadyStateThread
+	std::atomic<long long> unexpectedAllocations(0);
+
+	bool overlayVisible = false;
+
+	class LockGuard
+	{
+		public:
+			LockGuard() { while (trackerLock.test_and_set(std::memory_order_acquire)) {} }
+			~LockGuard() { trackerLock.clear(std::memory_order_release); }
+	};
+
+	// -------------------------------------------------------------------------
+	// Allocate a block with a header and add it to the live list
+	void* TrackedAlloc(size_t size)
+	{
+		BlockHeader* header = (BlockHeader*)malloc(HEADER_SIZE + size);
+		if (header == NULL)
+			return NULL;
+
+		AllocTrackerType::Tag tag = currentTag;
+
+		header->size = size;
+		header->tag = (unsigned short)tag;
+		header->magic = BLOCK_MAGIC;
+		header->prev = NULL;
+
+		{
+			LockGuard lock;
+
+			header->frame = currentFrame;
+			header->next = liveBlocks;
+			if (liveBlocks != NULL)
+				liveBlocks->prev = header;
+			liveBlocks = header;
+
+			AllocTrackerType::Stats& stats = tagStats[tag];
+			stats.count++;
+			stats.bytes += size;
+			stats.liveCount++;
+			stats.liveBytes += size;
+			stats.frameCount++;
+			stats.frameBytes += size;
+			if (stats.liveBytes > stats.peakBytes)
+				stats.peakBytes = stats.liveBytes;
+
+			totalLiveBytes += size;
+			if (totalLiveBytes > totalPeakBytes)
+				totalPeakBytes = totalLiveBytes;
+		}
+
+		// checked outside the lock, the assert dialog allocates
+		if (expectNoAllocations.load(std::memory_order_relaxed) && (GetCurrentThreadId() == steadyStateThread || steadyStateJoined))
+		{
+			unexpectedAllocations++;
+			assert(!assertOnUnexpected && "Heap allocation during a steady-state section");
+		}
+
+		return (char*)header + HEADER_SIZE;
+	}
+
+	// -------------------------------------------------------------------------
+	// Remove a block from the live list and free it
+	void TrackedFree(void* memory)
+	{
+		if (memory == NULL)
+			return;
+
+		BlockHeader* header = (BlockHeader*)((char*)memory - HEADER_SIZE);
+		assert(header->magic == BLOCK_MAGIC && "Freeing memory that was not allocated by operator new");
+
+		{
+			LockGuard lock;
+
+			if (header->prev != NULL)
+				header->prev->next = header->next;
+			else
+				liveBlocks = header->next;
+
+			if (header->next != NULL)
+				header->next->prev = header->prev;
+
+			AllocTrackerType::Stats& stats = tagStats[header->tag];
+			stats.liveCount--;
+			stats.liveBytes -= header->size;
+			totalLiveBytes -= header->size;
+		}
+
+		header->magic = 0;
+		free(header);
+	}
+
+	// -------------------------------------------------------------------------
+	// Writes the leak report when the program exits
+	class LeakReportAtExit
+	{
+		public:
+			~LeakReportAtExit() { AllocTrackerType::ReportLeaks("alloc_leaks.txt"); }
+	};
+
+	LeakReportAtExit leakReportAtExit;
+}
+
+// -----------------------------------------------------------------------------
+// Replacement global operators
+void* operator new(size_t size)
+{
+	void* memory = TrackedAlloc(size);
+	if (memory == NULL)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void* operator new[](size_t size)
+{
+	void* memory = TrackedAlloc(size);
+	if (memory == NULL)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return TrackedAlloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return TrackedAlloc(size); }
+
+void operator delete(void* memory) noexcept { TrackedFree(memory); }
+void operator delete[](void* memory) noexcept { TrackedFree(memory); }
+void operator delete(void* memory, size_t) noexcept { TrackedFree(memory); }
+void operator delete[](void* memory, size_t) noexcept { TrackedFree(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { TrackedFree(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { TrackedFree(memory); }
+
+// -----------------------------------------------------------------------------
+// Start a new frame, resets the per-frame counts
+void AllocTrackerType::BeginFrame()
+{
+	LockGuard lock;
+
+	currentFrame++;
+
+	for (int i = 0; i < TAG_COUNT; i++)
+	{
+		tagStats[i].frameCount = 0;
+		tagStats[i].frameBytes = 0;
+	}
+}
+
+unsigned int AllocTrackerType::GetFrame()
+{
+	LockGuard lock;
+	return currentFrame;
+}
+
+// -----------------------------------------------------------------------------
+// Get the statistics for a tag
+AllocTrackerType::Stats AllocTrackerType::GetStats(Tag tag)
+{
+	LockGuard lock;
+	return tagStats[tag];
+}
+
+// -----------------------------------------------------------------------------
+// Get the statistics for all tags added together
+AllocTrackerType::Stats AllocTrackerType::GetTotal()
+{
+	LockGuard lock;
+
+	Stats total = { 0, 0, 0, 0, 0, 0, 0 };
+	for (int i = 0; i < TAG_COUNT; i++)
+	{
+		total.count += tagStats[i].count;
+		total.bytes += tagStats[i].bytes;
+		total.liveCount += tagStats[i].liveCount;
+		total.liveBytes += tagStats[i].liveBytes;
+		total.frameCount += tagStats[i].frameCount;
+		total.frameBytes += tagStats[i].frameBytes;
+	}
+	total.peakBytes = totalPeakBytes;
+
+	return total;
+}
+
+AllocTrackerType::Tag AllocTrackerType::GetCurrentTag() { return currentTag; }
+void AllocTrackerType::SetCurrentTag(Tag tag) { currentTag = tag; }
+
+// -----------------------------------------------------------------------------
+// Turn steady-state mode on or off for the calling thread
+void AllocTrackerType::ExpectNoAllocations(bool expect, bool assertOnAllocation)
+{
+	if (expect)
+	{
+		unexpectedAllocations = 0;
+		assertOnUnexpected = assertOnAllocation;
+		steadyStateThread = GetCurrentThreadId();
+	}
+
+	expectNoAllocations = expect;
+}
+
+long long AllocTrackerType::GetUnexpectedAllocations() { return unexpectedAllocations; }
+void AllocTrackerType::JoinSteadyState() { steadyStateJoined = true; }
+
+// -----------------------------------------------------------------------------
+// List everything that is still allocated. The list is copied while holding the
+// lock and printed afterwards, as printing can allocate.
+int AllocTrackerType::ReportLeaks(const char* fileName)
+{
+	static const int MAX_LISTED = 256;
+
+	struct Leak
+	{
+		size_t size;
+		unsigned int frame;
+		unsigned short tag;
+	};
+
+	static Leak leaks[MAX_LISTED];
+	static Stats stats[TAG_COUNT];
+	int leakCount = 0;
+
+	{
+		LockGuard lock;
+
+		for (BlockHeader* header = liveBlocks; header != NULL; header = header->next)
+		{
+			if (leakCount < MAX_LISTED)
+			{
+				leaks[leakCount].size = header->size;
+				leaks[leakCount].frame = header->frame;
+				leaks[leakCount].tag = header->tag;
+			}
+			leakCount++;
+		}
+
+		for (int i = 0; i < TAG_COUNT; i++)
+			stats[i] = tagStats[i];
+	}
+
+	FILE* file = fopen(fileName, "w");
+	char line[160];
+
+	snprintf(line, sizeof(line), "Allocation report: %d allocations still live\n", leakCount);
+	OutputDebugStringA(line);
+	if (file)
+		fputs(line, file);
+
+	for (int i = 0; i < TAG_COUNT; i++)
+	{
+		snprintf(line, sizeof(line), "  %-12s %8lld live (%10lld bytes)  peak %10lld bytes  %10lld allocations total\n",
+			GetTagName(Tag(i)), stats[i].liveCount, stats[i].liveBytes, stats[i].peakBytes, stats[i].count);
+		OutputDebugStringA(line);
+		if (file)
+			fputs(line, file);
+	}
+
+	int listed = leakCount < MAX_LISTED ? leakCount : MAX_LISTED;
+	for (int i = 0; i < listed; i++)
+	{
+		snprintf(line, sizeof(line), "  leak: %8u bytes, tag %s, allocated in frame %u\n", (unsigned int)leaks[i].size, GetTagName(Tag(leaks[i].tag)), leaks[i].frame);
+		OutputDebugStringA(line);
+		if (file)
+			fputs(line, file);
+	}
+
+	if (file)
+		fclose(file);
+
+	return leakCount;
+}
+
+bool AllocTrackerType::IsOverlayVisible() { return overlayVisible; }
+void AllocTrackerType::ToggleOverlay() { overlayVisible = !overlayVisible; }
+
+// -----------------------------------------------------------------------------
+// Draw one line per tag with this frame's traffic and the live/peak bytes
+void AllocTrackerType::DrawOverlay(FontType& font, int posX, int posY)
+{
+	wchar_t line[128];
+
+	swprintf(line, 128, L"%-12ls %6ls %9ls %10ls %10ls", L"Heap", L"frame", L"bytes", L"live", L"peak");
+	font.PrintMessage(posX, posY, line, FC_BLACK);
+
+	for (int i = 0; i < TAG_COUNT; i++)
+	{
+		Stats stats = GetStats(Tag(i));
+
+		swprintf(line, 128, L"%-12hs %6lld %9lld %10lld %10lld", GetTagName(Tag(i)), stats.frameCount, stats.frameBytes, stats.liveBytes, stats.peakBytes);
+		font.PrintMessage(posX, posY + (i + 1) * 18, line, FC_BLACK);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Name used in the overlay and leak report for each tag
+const char* AllocTrackerType::GetTagName(Tag tag)
+{
+	static const char* names[TAG_COUNT] = { "General", "Sprites", "UI", "Rendering", "Textures", "Diagnostics" };
+
+	return (tag >= 0 && tag < TAG_COUNT) ? names[tag] : "";
+}
+
+#endif
@@ -0,0 +1,96 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Heap allocation accounting. Replaces the global operator new/delete so every allocation
+// is counted against the subsystem tag that is active on the allocating thread and the
+// frame it happened in. Tracks count, bytes, live bytes and peak live bytes per tag, can
+// assert when anything allocates during a steady-state section, and writes a leak report
+// for everything still allocated at shutdown.
+//
+// Only compiled in debug builds (_DEBUG). In release builds ALLOC_TAG expands to nothing
+// and the default operator new/delete are used.
+//----------------------------------------------------------------------------------------
+
+#ifdef _DEBUG
+#define ALLOC_TRACKING_ENABLED
+#endif
+
+#ifdef ALLOC_TRACKING_ENABLED
+
+#include <cstddef>
+#include "Font.h"
+
+class AllocTrackerType
+{
+	public:
+
+		// subsystems that allocations are counted against
+		enum Tag { General, Sprites, UI, Rendering, Textures, Diagnostics, TAG_COUNT };
+
+		// allocation statistics for a tag
+		struct Stats
+		{
+			long long count; // Allocations since startup
+			long long bytes; // Bytes allocated since startup
+			long long liveCount; // Allocations not yet freed
+			long long liveBytes; // Bytes not yet freed
+			long long peakBytes; // Highest liveBytes has been
+			long long frameCount; // Allocations during the current frame
+			long long frameBytes; // Bytes allocated during the current frame
+		};
+
+		// start a new frame, resets the per-frame counts
+		static void BeginFrame();
+		static unsigned int GetFrame();
+
+		// get the statistics for a tag, or all tags together
+		static Stats GetStats(Tag tag);
+		static Stats GetTotal();
+
+		// get and set the tag new allocations on this thread are counted against
+		static Tag GetCurrentTag();
+		static void SetCurrentTag(Tag tag);
+
+		// steady-state mode. While on, any allocation made by the thread that turned it on, or
+		// by a thread that joined, is counted as unexpected and fails an assert unless
+		// assertOnAllocation is false
+		static void ExpectNoAllocations(bool expect, bool assertOnAllocation = true);
+
+		// count the calling thread's allocations in every steady-state section, for the job
+		// workers that run the frame's tasks
+		static void JoinSteadyState();
+		static long long GetUnexpectedAllocations();
+
+		// write every live allocation to a file and the debugger output, returns the number of leaks
+		static int ReportLeaks(const char* fileName);
+
+		// get and set whether the overlay is drawn
+		static bool IsOverlayVisible();
+		static void ToggleOverlay();
+
+		// draw the per-tag breakdown
+		static void DrawOverlay(FontType& font, int posX, int posY);
+
+		static const char* GetTagName(Tag tag);
+};
+
+//----------------------------------------------------------------------------------------
+// Counts allocations made in the enclosing scope against a tag
+class AllocTagScope
+{
+	public:
+		AllocTagScope(AllocTrackerType::Tag tag) : previous(AllocTrackerType::GetCurrentTag()) { AllocTrackerType::SetCurrentTag(tag); }
+		~AllocTagScope() { AllocTrackerType::SetCurrentTag(previous); }
+
+	private:
+		AllocTrackerType::Tag previous;
+};
+
+#define ALLOC_CONCAT_INNER(a, b) a##b
+#define ALLOC_CONCAT(a, b) ALLOC_CONCAT_INNER(a, b)
+#define ALLOC_TAG(tag) AllocTagScope ALLOC_CONCAT(allocTagScope, __LINE__)(AllocTrackerType::tag)
+
+#else
+
+#define ALLOC_TAG(tag)
+
+#endif
@@ -0,0 +1,144 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for the sprite-sheet animator
+//----------------------------------------------------------------------------------------
+
+#include "AnimatorType.h"
+#include "AllocTrackerType.h"
+
+#include <cfloat>
+#include <cmath>
+
+// -----------------------------------------------------------------------------
+// No clips to start with
+AnimatorType::AnimatorType()
+{
+	frameChanges = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Cut the frames from the sheet, wrapping to the next row at the sheet's right edge. A frame
+// time of zero or less would never count down, so the clip is made still instead
+int AnimatorType::AddClip(TextureType* sheet, int frameWidth, int frameHeight, int frameCount, float secondsPerFrame, Vector2 origin, bool loop)
+{
+	ALLOC_TAG(Sprites);
+
+	int columns = sheet->GetWidth() / frameWidth;
+	if (columns < 1)
+		columns = 1;
+
+	AnimationClip clip;
+	clip.sheet = sheet;
+	clip.firstFrame = int(frames.size());
+	clip.frameCount = frameCount > 1 ? frameCount : 1;
+	clip.secondsPerFrame = secondsPerFrame > 0 ? secondsPerFrame : FLT_MAX;
+	clip.loop = loop;
+
+	for (int i = 0; i < clip.frameCount; i++)
+	{
+		AnimationFrame frame;
+		frame.regionLeft = (i % columns) * frameWidth;
+		frame.regionTop = (i / columns) * frameHeight;
+		frame.regionRight = frame.regionLeft + frameWidth;
+		frame.regionBottom = frame.regionTop + frameHeight;
+		frame.originX = origin.x;
+		frame.originY = origin.y;
+
+		frames.push_back(frame);
+	}
+
+	clips.push_back(clip);
+	return int(clips.size()) - 1;
+}
+
+// -----------------------------------------------------------------------------
+// First frame, shown for the clip's full frame time
+void AnimatorType::Start(AnimationComponent& animation, int clip) const
+{
+	animation.clip = clip;
+	animation.frame = 0;
+	animation.timeLeft = clips[clip].secondsPerFrame;
+}
+
+// -----------------------------------------------------------------------------
+// Start the animation and show its first frame on the sprite
+void AnimatorType::Start(SpriteType& sprite, AnimationComponent& animation, int clip) const
+{
+	Start(animation, clip);
+
+	const AnimationFrame& frame = GetFrame(clip, 0);
+	RECT region = { frame.regionLeft, frame.regionTop, frame.regionRight, frame.regionBottom };
+	sprite.SetFrame(region, Vector2(frame.originX, frame.originY));
+}
+
+// -----------------------------------------------------------------------------
+// Count the time down, moving on as many frames as have passed: the one that ran out, and one
+// more for each whole frame time past it. A clip that doesn't loop holds its last frame from then on
+bool AnimatorType::Step(AnimationComponent& animation, float deltaTime) const
+{
+	animation.timeLeft -= deltaTime;
+	if (animation.timeLeft > 0)
+		return false;
+
+	const AnimationClip& clip = clips[animation.clip];
+
+	float passed = 1 + floorf(-animation.timeLeft / clip.secondsPerFrame);
+	animation.timeLeft += passed * clip.secondsPerFrame;
+
+	float next = float(animation.frame) + passed; // In float, a long stall can pass more frames than an int holds
+	int frame;
+	if (next < float(clip.frameCount))
+		frame = int(next);
+	else if (clip.loop)
+		frame = int(fmodf(next, float(clip.frameCount)));
+	else
+	{
+		frame = clip.frameCount - 1;
+		animation.timeLeft = FLT_MAX; // Never moves on again
+	}
+
+	if (frame == animation.frame)
+		return false;
+
+	animation.frame = frame;
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// One pass over every chunk with an animation and something to draw
+void AnimatorType::Advance(EntityWorldType& world, float deltaTime)
+{
+	frameChanges = 0;
+
+	world.ForEachChunk(ComponentBit<AnimationComponent>() | ComponentBit<RenderComponent>(), [&](ArchetypeType& archetype, int chunk, int count)
+	{
+		AnimationComponent* animations = archetype.GetArray<AnimationComponent>(chunk);
+		RenderComponent* renders = archetype.GetArray<RenderComponent>(chunk);
+
+		for (int i = 0; i < count; i++)
+		{
+			if (animations[i].clip < 0 || !Step(animations[i], deltaTime))
+				continue;
+
+			const AnimationFrame& frame = frames[clips[animations[i].clip].firstFrame + animations[i].frame];
+			renders[i].regionLeft = frame.regionLeft;
+			renders[i].regionTop = frame.regionTop;
+			renders[i].regionRight = frame.regionRight;
+			renders[i].regionBottom = frame.regionBottom;
+			renders[i].originX = frame.originX;
+			renders[i].originY = frame.originY;
+			frameChanges++;
+		}
+	});
+}
+
+// -----------------------------------------------------------------------------
+// The sprite only gets a new region when the frame changes
+void AnimatorType::Advance(SpriteType& sprite, AnimationComponent& animation, float deltaTime)
+{
+	if (animation.clip < 0 || !Step(animation, deltaTime))
+		return;
+
+	const AnimationFrame& frame = GetFrame(animation.clip, animation.frame);
+	RECT region = { frame.regionLeft, frame.regionTop, frame.regionRight, frame.regionBottom };
+	sprite.SetFrame(region, Vector2(frame.originX, frame.originY));
+}
@@ -0,0 +1,71 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Sprite-sheet animation. A clip is a run of frames cut from one sheet texture, shown for
+// the clip's secondsPerFrame each. Every frame's region and origin are worked out when the
+// clip is added, so changing frame is a copy and the pivot never has to be worked out
+// again.
+//
+// Entities animate with an AnimationComponent next to their RenderComponent. Advance
+// steps every one of them in a single pass over the chunks, and only writes the render
+// region and origin of those that moved on to a new frame. Sprites outside the world,
+// such as the koala, keep their own AnimationComponent and are stepped one at a time.
+//
+// Animation is in seconds and purely for looks, collision boxes don't follow the frames.
+//----------------------------------------------------------------------------------------
+
+#include <vector>
+#include "SpriteType.h"
+#include "EntityWorldType.h"
+
+// one frame of a clip
+struct AnimationFrame
+{
+	int regionLeft, regionTop, regionRight, regionBottom;
+	float originX, originY; // Relative to the region, as the sprite batch takes it
+};
+
+// frames in a row of the animator's frame list, and how they play
+struct AnimationClip
+{
+	TextureType* sheet;
+	int firstFrame;
+	int frameCount;
+	float secondsPerFrame;
+	bool loop; // Otherwise it stops on the last frame
+};
+
+class AnimatorType
+{
+	public:
+		// constructor
+		AnimatorType();
+
+		// add a clip of frameCount frames of the same size, taken left to right and then row by row from
+		// the sheet. origin is in texels from each frame's top left. A clip with no frame time holds its
+		// first frame. Returns the clip's index
+		int AddClip(TextureType* sheet, int frameWidth, int frameHeight, int frameCount, float secondsPerFrame, Vector2 origin, bool loop = true);
+
+		const AnimationClip& GetClip(int clip) const { return clips[clip]; }
+		const AnimationFrame& GetFrame(int clip, int frame) const { return frames[clips[clip].firstFrame + frame]; }
+
+		// put an animation at the start of a clip, with a sprite on its first frame
+		void Start(AnimationComponent& animation, int clip) const;
+		void Start(SpriteType& sprite, AnimationComponent& animation, int clip) const;
+
+		// step every animated entity in the world
+		void Advance(EntityWorldType& world, float deltaTime);
+
+		// step one sprite's animation
+		void Advance(SpriteType& sprite, AnimationComponent& animation, float deltaTime);
+
+		// frames changed by the last Advance of the world
+		int GetFrameChanges() const { return frameChanges; }
+
+	private:
+		std::vector<AnimationClip> clips;
+		std::vector<AnimationFrame> frames; // Every clip's frames, each clip's together
+		int frameChanges;
+
+		// move an animation on, true if it changed frame
+		bool Step(AnimationComponent& animation, float deltaTime) const;
+};
@@ -0,0 +1,121 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for archetype chunk storage
+//----------------------------------------------------------------------------------------
+
+#include "ArchetypeType.h"
+#include "AllocTrackerType.h"
+
+#include <cassert>
+#include <cstring>
+
+static const size_t ARRAY_ALIGNMENT = 16; // Each array in a chunk starts on this boundary
+
+// size of each component, indexed by component ID
+static const size_t componentSizes[COMPONENT_COUNT] =
+{
+	sizeof(TransformComponent),
+	sizeof(MotionComponent),
+	sizeof(PatrolComponent),
+	sizeof(RenderComponent),
+	sizeof(ColliderComponent),
+	sizeof(DamageComponent),
+	sizeof(PickupComponent),
+	sizeof(LifetimeComponent),
+	sizeof(AnimationComponent)
+};
+
+static size_t AlignUp(size_t value) { return (value + ARRAY_ALIGNMENT - 1) & ~(ARRAY_ALIGNMENT - 1); }
+
+// -----------------------------------------------------------------------------
+// Work out how many entities fit in a chunk and where each array goes
+ArchetypeType::ArchetypeType(ComponentMask inMask, EntityKind::Kind inKind)
+{
+	mask = inMask;
+	kind = inKind;
+	count = 0;
+
+	size_t rowSize = sizeof(Entity);
+	for (int id = 0; id < COMPONENT_COUNT; id++)
+	{
+		sizes[id] = (mask & (ComponentMask(1) << id)) ? componentSizes[id] : 0;
+		rowSize += sizes[id];
+	}
+
+	// Every array can lose up to ARRAY_ALIGNMENT bytes to padding
+	chunkCapacity = int((CHUNK_SIZE - (COMPONENT_COUNT + 1) * ARRAY_ALIGNMENT) / rowSize);
+
+	size_t offset = AlignUp(chunkCapacity * sizeof(Entity));
+	for (int id = 0; id < COMPONENT_COUNT; id++)
+	{
+		offsets[id] = offset;
+		offset = AlignUp(offset + chunkCapacity * sizes[id]);
+	}
+
+	assert(offset <= CHUNK_SIZE);
+}
+
+// -----------------------------------------------------------------------------
+// Free the chunks
+ArchetypeType::~ArchetypeType()
+{
+	for (size_t i = 0; i < chunks.size(); i++)
+		::operator delete(chunks[i]);
+}
+
+// -----------------------------------------------------------------------------
+// Add an entity to the end, allocating a chunk if every chunk is full
+int ArchetypeType::Add(Entity entity)
+{
+	if (count == GetCapacity())
+	{
+		ALLOC_TAG(Sprites);
+		chunks.push_back((char*)::operator new(CHUNK_SIZE));
+	}
+
+	int row = count++;
+	GetEntities(row / chunkCapacity)[row % chunkCapacity] = entity;
+
+	return row;
+}
+
+// -----------------------------------------------------------------------------
+// Allocate every chunk the extra entities need in one go
+void ArchetypeType::Reserve(int extra)
+{
+	int needed = count + extra;
+	if (needed <= GetCapacity())
+		return;
+
+	ALLOC_TAG(Sprites);
+
+	chunks.reserve((needed + chunkCapacity - 1) / chunkCapacity);
+	while (GetCapacity() < needed)
+		chunks.push_back((char*)::operator new(CHUNK_SIZE));
+}
+
+// -----------------------------------------------------------------------------
+// Remove the entity at a row, the last entity moves into its place to keep the rows packed
+bool ArchetypeType::Remove(int row, Entity& moved)
+{
+	assert(row >= 0 && row < count);
+
+	int last = --count;
+	if (row == last)
+		return false;
+
+	char* to = chunks[row / chunkCapacity];
+	char* from = chunks[last / chunkCapacity];
+	int toIndex = row % chunkCapacity;
+	int fromIndex = last % chunkCapacity;
+
+	((Entity*)to)[toIndex] = ((Entity*)from)[fromIndex];
+
+	for (int id = 0; id < COMPONENT_COUNT; id++)
+	{
+		if (sizes[id] != 0)
+			memcpy(to + offsets[id] + toIndex * sizes[id], from + offsets[id] + fromIndex * sizes[id], sizes[id]);
+	}
+
+	moved = ((Entity*)to)[toIndex];
+	return true;
+}
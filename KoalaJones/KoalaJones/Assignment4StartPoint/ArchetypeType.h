@@ -0,0 +1,82 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Storage for every entity with the same components and kind. Entities are kept packed in
+// fixed size chunks. Each chunk holds one array per component, so a system walking a
+// chunk reads each component it uses as one contiguous run. Removing an entity moves the
+// last entity into its place, so the rows stay packed and only the last chunk is partly
+// filled. Chunks are kept when entities are removed, ready for the next ones.
+//----------------------------------------------------------------------------------------
+
+#include <cstddef>
+#include <vector>
+#include "ComponentTypes.h"
+
+// handle to an entity, the generation changes when the slot is reused so stale handles can be detected
+struct Entity
+{
+	uint32_t index;
+	uint32_t generation;
+};
+
+class ArchetypeType
+{
+	public:
+		static const size_t CHUNK_SIZE = 16 * 1024;
+
+		// constructor and destructor
+		ArchetypeType(ComponentMask mask, EntityKind::Kind kind);
+		~ArchetypeType();
+
+		ComponentMask GetMask() const { return mask; }
+		EntityKind::Kind GetKind() const { return kind; }
+
+		// does this archetype have all the components in the mask
+		bool Has(ComponentMask components) const { return (mask & components) == components; }
+
+		// get the number of entities, and how many fit in the chunks already allocated
+		int GetCount() const { return count; }
+		int GetCapacity() const { return int(chunks.size()) * chunkCapacity; }
+
+		// get the bytes held by the chunks
+		size_t GetMemoryBytes() const { return chunks.size() * CHUNK_SIZE; }
+
+		// get the number of chunks with entities in them, and the number of entities in one
+		int GetChunkCount() const { return (count + chunkCapacity - 1) / chunkCapacity; }
+		int GetCountInChunk(int chunk) const { return (chunk + 1) * chunkCapacity <= count ? chunkCapacity : count - chunk * chunkCapacity; }
+
+		// get a component array, or the entity array, of a chunk
+		template <class T>
+		T* GetArray(int chunk) { return (T*)(chunks[chunk] + offsets[T::ID]); }
+		Entity* GetEntities(int chunk) { return (Entity*)chunks[chunk]; }
+
+		// get a component of the entity at a row
+		template <class T>
+		T& Get(int row) { return GetArray<T>(row / chunkCapacity)[row % chunkCapacity]; }
+
+		// add an entity to the end, its components are left uninitialized. Returns its row
+		int Add(Entity entity);
+
+		// allocate chunks up front so the next extra entities can be added without allocating
+		void Reserve(int extra);
+
+		// remove the entity at a row by moving the last entity into it. Returns true and the moved entity if one moved
+		bool Remove(int row, Entity& moved);
+
+		// remove every entity, the chunks are kept
+		void Clear() { count = 0; }
+
+	private:
+		ComponentMask mask;
+		EntityKind::Kind kind;
+
+		size_t offsets[COMPONENT_COUNT]; // Where each component's array starts in a chunk
+		size_t sizes[COMPONENT_COUNT]; // Size of each component, 0 if the archetype doesn't have it
+		int chunkCapacity; // Entities per chunk
+
+		std::vector<char*> chunks;
+		int count;
+
+		// archetypes own their chunks and can't be copied
+		ArchetypeType(const ArchetypeType&);
+		ArchetypeType& operator=(const ArchetypeType&);
+};
@@ -0,0 +1,174 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for the beam search autoplayer
+//----------------------------------------------------------------------------------------
+
+#include "AutoplayerType.h"
+
+#include <algorithm>
+
+static const float DEAD = -1000000; // Added to the value of a game that is over, below any game still going
+
+// -----------------------------------------------------------------------------
+// A budget that leaves half a 60 fps frame for the game
+AutoplayerType::AutoplayerType() : pools{ { POOL_BYTES }, { POOL_BYTES } }
+{
+	HeadlessGameType::SetDefaults(config);
+
+	budget = 8 * ClockType::NANOSECONDS_PER_MILLISECOND;
+
+	lastNodes = 0;
+	lastDepth = 0;
+	lastValue = 0;
+	lastTime = 0;
+
+	totalNodes = 0;
+	totalTicks = 0;
+	totalTime = 0;
+	decisions = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Grow the beam a layer at a time, keeping the best of each, until it is MAX_DEPTH deep or
+// the time runs out. A layer the time ran out in is thrown away unless it is the first
+HeadlessGameType::Action AutoplayerType::Decide(const HeadlessGameType& game, ClockType& clock)
+{
+	int64_t start = clock.Now();
+
+	pools[0].Reset();
+	pools[1].Reset();
+
+	// Clones don't spawn, so none is bigger than the game they start from. A layer is at most a
+	// node and a clone for each action of each node kept, with room to align each one
+	size_t cloneBytes = game.GetCloneBytes() + alignof(HeadlessGameType);
+	size_t layerBytes = BEAM_WIDTH * HeadlessGameType::ACTION_COUNT * (sizeof(Node) + cloneBytes) + alignof(Node);
+	pools[0].Reserve(layerBytes);
+	pools[1].Reserve(layerBytes);
+
+	// The clones can't know what will spawn, so they play on without spawning
+	config = *game.GetConfig();
+	config.spawning = false;
+
+	int read = 0;
+	Node* layer = (Node*)pools[read].Allocate(sizeof(Node), alignof(Node));
+	layer[0].game = game.CloneInto(pools[read]);
+	layer[0].game->SetConfig(&config);
+	layer[0].value = Evaluate(game);
+	layer[0].key = 0;
+	layer[0].firstAction = HeadlessGameType::Wait;
+	int count = 1;
+
+	int action = HeadlessGameType::Wait;
+	lastNodes = 0;
+	lastDepth = 0;
+	lastValue = layer[0].value;
+
+	bool outOfTime = false;
+
+	for (int depth = 0; depth < MAX_DEPTH && !outOfTime; depth++)
+	{
+		int build = 1 - read;
+		Node* next = (Node*)pools[build].Allocate(sizeof(Node) * count * HeadlessGameType::ACTION_COUNT, alignof(Node));
+		int nextCount = 0;
+
+		for (int i = 0; i < count && !outOfTime; i++)
+		{
+			const Node& node = layer[i];
+
+			if (node.game->IsOver())
+			{
+				next[nextCount++] = node;
+				next[nextCount - 1].game = node.game->CloneInto(pools[build]); // Carried on so a line that dies later beats one that dies sooner
+				continue;
+			}
+
+			for (int a = 0; a < HeadlessGameType::ACTION_COUNT; a++)
+			{
+				HeadlessGameType::Action nodeAction = HeadlessGameType::Action(a);
+				if (!node.game->CanTake(nodeAction))
+					continue; // The same as waiting
+
+				HeadlessGameType* clone = node.game->CloneInto(pools[build]);
+				clone->Step(nodeAction);
+				for (int t = 1; t < SEGMENT_TICKS; t++)
+					clone->Step(HeadlessGameType::Wait);
+
+				Node& child = next[nextCount++];
+				child.game = clone;
+				child.value = Evaluate(*clone);
+				child.key = ((clone->GetLives() * 8 + clone->GetVine()) * 2 + (clone->GetGraceTicks() > 0)) * 4096 + (int(clone->GetKoalaY()) & 4095);
+				child.firstAction = depth == 0 ? a : node.firstAction;
+				lastNodes++;
+			}
+
+			outOfTime = clock.Now() - start > budget;
+		}
+
+		if (outOfTime && depth > 0)
+			break; // Part of a layer would favour the lines that happened to come first
+
+		count = Prune(next, nextCount);
+
+		pools[read].Reset();
+		read = build;
+		layer = next;
+
+		action = layer[0].firstAction;
+		lastValue = layer[0].value;
+		lastDepth = depth + 1;
+	}
+
+	lastTime = clock.Now() - start;
+
+	totalNodes += lastNodes;
+	totalTicks += (long long)lastNodes * SEGMENT_TICKS;
+	totalTime += lastTime;
+	decisions++;
+
+	return HeadlessGameType::Action(action);
+}
+
+// -----------------------------------------------------------------------------
+// Average nodes over all the time spent deciding
+double AutoplayerType::GetNodesPerSecond() const
+{
+	return totalTime > 0 ? double(totalNodes) * double(ClockType::NANOSECONDS_PER_SECOND) / double(totalTime) : 0;
+}
+
+// -----------------------------------------------------------------------------
+// Every node steps SEGMENT_TICKS ticks
+double AutoplayerType::GetTicksPerSecond() const
+{
+	return totalTime > 0 ? double(totalTicks) * double(ClockType::NANOSECONDS_PER_SECOND) / double(totalTime) : 0;
+}
+
+// -----------------------------------------------------------------------------
+// Lives first, then score. A game that is over is worth the ticks it lasted
+float AutoplayerType::Evaluate(const HeadlessGameType& game)
+{
+	if (game.IsOver())
+		return DEAD + float(game.GetTick());
+
+	return float(game.GetLives()) * 100000 + float(game.GetScore());
+}
+
+// -----------------------------------------------------------------------------
+// Keep the best node for each key, then the best BEAM_WIDTH of those. Ties go to the lower
+// first action, so with nothing to gain the bot waits
+int AutoplayerType::Prune(Node* nodes, int count)
+{
+	auto better = [](const Node& a, const Node& b) { return a.value != b.value ? a.value > b.value : a.firstAction < b.firstAction; };
+
+	std::sort(nodes, nodes + count, [&](const Node& a, const Node& b) { return a.key != b.key ? a.key < b.key : better(a, b); });
+
+	int kept = 0;
+	for (int i = 0; i < count; i++)
+	{
+		if (kept == 0 || nodes[i].key != nodes[kept - 1].key)
+			nodes[kept++] = nodes[i];
+	}
+
+	int width = kept < BEAM_WIDTH ? kept : BEAM_WIDTH;
+	std::partial_sort(nodes, nodes + width, nodes + kept, better);
+
+	return width;
+}
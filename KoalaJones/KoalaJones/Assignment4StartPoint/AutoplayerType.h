@@ -0,0 +1,89 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Built-in bot that plays by beam search over the five actions. The search starts from a
+// HeadlessGameType copied from the running game. Each node is a clone of its parent
+// stepped forward SEGMENT_TICKS ticks, taking one action and then waiting. After each layer
+// only the BEAM_WIDTH best nodes are kept, so MAX_DEPTH layers look a few hundred ticks
+// ahead. The bot takes the first action of the best line it found.
+//
+// Nodes and their game clones are bump allocated from two FrameArenaTypes, one for the
+// layer being read and one for the layer being built. A layer's arena is reset once the
+// next layer has been built, so a decision never frees anything one node at a time. A
+// clone's size grows with the obstacles on screen, so each decision first grows the
+// arenas to hold a full layer of clones of the game it starts from.
+//
+// The search stops early when the time budget runs out, and then goes with the deepest
+// layer it finished. The nodes, ticks and time of each decision are kept, so the bot also
+// measures how fast the headless game clones and steps.
+//
+// Clones can't see future spawns, so they only dodge what is already on screen.
+//----------------------------------------------------------------------------------------
+
+#include "HeadlessGameType.h"
+#include "FrameArenaType.h"
+#include "ClockType.h"
+
+class AutoplayerType
+{
+	public:
+		static const int BEAM_WIDTH = 128; // Nodes kept after each layer
+		static const int SEGMENT_TICKS = 12; // Ticks each node steps, the bot decides this often
+		static const int MAX_DEPTH = 24; // Layers, SEGMENT_TICKS * MAX_DEPTH ticks ahead
+		static const size_t POOL_BYTES = 1024 * 1024; // Each arena to start with, Decide grows them for bigger games
+
+		// constructor
+		AutoplayerType();
+
+		// set how long a decision can take
+		void SetBudget(int64_t nanoseconds) { budget = nanoseconds; }
+
+		// search ahead from the game and return the action to take now
+		HeadlessGameType::Action Decide(const HeadlessGameType& game, ClockType& clock);
+
+		// the last decision's nodes, layers finished, the score of its best line and its time in milliseconds
+		int GetNodeCount() const { return lastNodes; }
+		int GetDepth() const { return lastDepth; }
+		float GetBestValue() const { return lastValue; }
+		double GetDecisionMs() const { return double(lastTime) / double(ClockType::NANOSECONDS_PER_MILLISECOND); }
+
+		// the bytes each arena has, after growing to the biggest game decided on so far
+		size_t GetPoolBytes() const { return pools[0].GetCapacity(); }
+
+		// clone and step throughput over every decision so far
+		double GetNodesPerSecond() const;
+		double GetTicksPerSecond() const;
+		int GetDecisionCount() const { return decisions; }
+
+	private:
+		// one game in the beam, and the action its line started with
+		struct Node
+		{
+			HeadlessGameType* game;
+			float value;
+			int key; // Where the koala is and how it's doing, nodes with the same key are the same to the search
+			int firstAction;
+		};
+
+		HeadlessConfig config; // The game's config with spawning off, the clones play with this
+		int64_t budget;
+
+		FrameArenaType pools[2]; // Layer being read, layer being built
+
+		// last decision
+		int lastNodes;
+		int lastDepth;
+		float lastValue;
+		int64_t lastTime;
+
+		// every decision
+		long long totalNodes;
+		long long totalTicks;
+		int64_t totalTime;
+		int decisions;
+
+		// score a game at the end of a segment, losing lives costs far more than any score
+		static float Evaluate(const HeadlessGameType& game);
+
+		// keep the best nodes with different keys, at most BEAM_WIDTH of them, returns how many
+		static int Prune(Node* nodes, int count);
+};
@@ -0,0 +1,722 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for the batched environment
+//----------------------------------------------------------------------------------------
+
+#include "BatchEnvironmentType.h"
+#include "AllocTrackerType.h"
+
+#include <emmintrin.h>
+#include <cfloat>
+#include <cmath>
+
+static const float PARKED_X = -1.0e9f; // Where empty slots sit, no koala box reaches this far
+static const float MOVE_STEP = 50; // As HeadlessGameType
+static const float REVERSE_DISTANCE = 5;
+
+// -----------------------------------------------------------------------------
+// Nothing to step until Initialize
+BatchEnvironmentType::BatchEnvironmentType()
+{
+	config = NULL;
+	gameCount = 0;
+	groupCount = 0;
+	nextSeed = 1;
+
+	results = NULL;
+	paramSet = 0;
+
+	episodes = 0;
+	episodeTicks = 0;
+	episodeScore = 0;
+	totalTicks = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Size every array for whole groups and start each game
+void BatchEnvironmentType::Initialize(const HeadlessConfig* inConfig, int inGameCount, uint32_t firstSeed)
+{
+	ALLOC_TAG(General);
+
+	config = inConfig;
+	gameCount = inGameCount;
+	groupCount = (inGameCount + LANES - 1) / LANES;
+
+	int games = groupCount * LANES;
+
+	seed.assign(games, 0);
+	random.assign(games, 1);
+	tick.assign(games, 0);
+	vine.assign(games, 0);
+	koalaX.assign(games, 0);
+	koalaY.assign(games, 0);
+	lives.assign(games, 0);
+	score.assign(games, 0);
+	graceTicks.assign(games, 0);
+	scoreForExtraLife.assign(games, 0);
+	deathCause.assign(games, -1);
+	itemCombo.assign(games, 0);
+	maxItemCombo.assign(games, 0);
+	itemLevel.assign(games, 0);
+	obstacleLevel.assign(games, 0);
+	obstacleSpeed.assign(games, 0);
+	nextSpawnTick.assign(games, 0);
+	nextLevelTick.assign(games, 0);
+	obstacleCount.assign(games, 0);
+	done.assign(games, 0);
+	reward.assign(games, 0);
+
+	itemX.assign(games * MAX_ITEMS, 0);
+	itemY.assign(games * MAX_ITEMS, 0);
+	itemHalfWidth.assign(games * MAX_ITEMS, 0);
+	itemHalfHeight.assign(games * MAX_ITEMS, 0);
+	itemExpiry.assign(games * MAX_ITEMS, 0);
+	itemCount.assign(games, 0);
+
+	int slots = games * SLOTS;
+	x.assign(slots, 0);
+	y.assign(slots, 0);
+	stepX.assign(slots, 0);
+	stepY.assign(slots, 0);
+	halfWidth.assign(slots, 0);
+	halfHeight.assign(slots, 0);
+	startY.assign(slots, 0);
+	endY.assign(slots, 0);
+	minX.assign(slots, 0);
+	maxX.assign(slots, 0);
+	minY.assign(slots, 0);
+	maxY.assign(slots, 0);
+	reversed.assign(slots, 0);
+	kind.assign(slots, 0);
+
+	for (int game = 0; game < games; game++)
+		Start(game, firstSeed + game);
+	nextSeed = firstSeed + games;
+
+	episodes = 0;
+	episodeTicks = 0;
+	episodeScore = 0;
+	totalTicks = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Every group runs the parts of the tick in HeadlessGameType's order. Games that ended are
+// counted and started again once their group is done
+void BatchEnvironmentType::Step(const uint8_t* actions)
+{
+	for (int group = 0; group < groupCount; group++)
+	{
+		int base = group * LANES;
+
+		for (int lane = 0; lane < LANES; lane++)
+			reward[base + lane] = float(score[base + lane]); // The score before, the change is worked out after
+
+		ApplyActions(group, actions);
+		int ended = CheckForCollisions(group);
+		UpdateTimers(group, ended);
+		MoveObstacles(group);
+
+		for (int lane = 0; lane < LANES; lane++)
+		{
+			int game = base + lane;
+			reward[game] = float(score[game]) - reward[game];
+			done[game] = 0;
+
+			if ((ended & (1 << lane)) == 0)
+			{
+				tick[game]++;
+				continue;
+			}
+
+			if (game < gameCount)
+			{
+				episodes++;
+				episodeTicks += tick[game];
+				episodeScore += score[game];
+
+				if (results != NULL)
+					AddResult(game);
+			}
+
+			done[game] = 1;
+			int cause = deathCause[game];
+			Start(game, nextSeed++);
+			deathCause[game] = cause; // Kept for the caller until the next Step
+		}
+	}
+
+	totalTicks += gameCount;
+}
+
+// -----------------------------------------------------------------------------
+// Clicks are one game at a time, most ticks most games wait
+void BatchEnvironmentType::ApplyActions(int group, const uint8_t* actions)
+{
+	int base = group * LANES;
+
+	for (int lane = 0; lane < LANES; lane++)
+	{
+		int game = base + lane;
+		if (game < gameCount && actions[game] != HeadlessGameType::Wait)
+			ApplyAction(game, actions[game]);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// HeadlessGameType::CanTake and ApplyAction together
+void BatchEnvironmentType::ApplyAction(int game, int action)
+{
+	switch (action)
+	{
+	case HeadlessGameType::Up:
+		if (koalaY[game] - MOVE_STEP >= 0)
+			koalaY[game] -= MOVE_STEP;
+		break;
+	case HeadlessGameType::Down:
+		if (koalaY[game] + MOVE_STEP < config->lavaTop - 20)
+			koalaY[game] += MOVE_STEP;
+		break;
+	case HeadlessGameType::Left:
+		if (vine[game] > 0)
+		{
+			vine[game]--;
+			koalaX[game] = float(config->vineX[vine[game]]);
+			score[game] += 20;
+		}
+		break;
+	case HeadlessGameType::Right:
+		if (vine[game] < config->vineCount - 1)
+		{
+			vine[game]++;
+			koalaX[game] = float(config->vineX[vine[game]]);
+			score[game] += 20;
+		}
+		break;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Test one slot of the group's games at a time against their koalas' boxes. A game stops
+// looking at its first hit, the lowest slot, which is the one HeadlessGameType would find.
+// The hits are then taken one game at a time
+int BatchEnvironmentType::CheckForCollisions(int group)
+{
+	int base = group * LANES;
+
+	// The koalas' boxes, worked out the same way as HeadlessGameType's
+	alignas(16) float left[LANES], right[LANES], top[LANES], bottom[LANES];
+	int looking = 0; // A bit for each game that can be hit
+	for (int lane = 0; lane < LANES; lane++)
+	{
+		int game = base + lane;
+		int boxLeft = int(koalaX[game] - (config->koalaWidth >> 1));
+		int boxTop = int(koalaY[game] - (config->koalaHeight >> 1));
+
+		left[lane] = float(boxLeft);
+		right[lane] = float(boxLeft + config->koalaWidth);
+		top[lane] = float(boxTop);
+		bottom[lane] = float(boxTop + config->koalaHeight);
+
+		if (graceTicks[game] == 0)
+			looking |= 1 << lane;
+	}
+
+	int hitSlot[LANES] = { -1, -1, -1, -1 };
+
+	__m128 boxLeft = _mm_load_ps(left);
+	__m128 boxRight = _mm_load_ps(right);
+	__m128 boxTop = _mm_load_ps(top);
+	__m128 boxBottom = _mm_load_ps(bottom);
+
+	int count = GetGroupCount(group);
+	for (int slot = 0; slot < count && looking != 0; slot++)
+	{
+		int index = (group * SLOTS + slot) * LANES;
+
+		__m128 px = _mm_loadu_ps(&x[index]);
+		__m128 py = _mm_loadu_ps(&y[index]);
+		__m128 hw = _mm_loadu_ps(&halfWidth[index]);
+		__m128 hh = _mm_loadu_ps(&halfHeight[index]);
+
+		// A corner inside the box is an edge inside it on each axis
+		__m128 x0 = _mm_sub_ps(px, hw), x1 = _mm_add_ps(px, hw);
+		__m128 y0 = _mm_sub_ps(py, hh), y1 = _mm_add_ps(py, hh);
+
+		__m128 inX = _mm_or_ps(_mm_and_ps(_mm_cmpge_ps(x0, boxLeft), _mm_cmple_ps(x0, boxRight)),
+			_mm_and_ps(_mm_cmpge_ps(x1, boxLeft), _mm_cmple_ps(x1, boxRight)));
+		__m128 inY = _mm_or_ps(_mm_and_ps(_mm_cmpge_ps(y0, boxTop), _mm_cmple_ps(y0, boxBottom)),
+			_mm_and_ps(_mm_cmpge_ps(y1, boxTop), _mm_cmple_ps(y1, boxBottom)));
+
+		int hits = _mm_movemask_ps(_mm_and_ps(inX, inY)) & looking;
+		if (hits == 0)
+			continue;
+
+		for (int lane = 0; lane < LANES; lane++)
+		{
+			if (hits & (1 << lane))
+				hitSlot[lane] = slot;
+		}
+		looking &= ~hits;
+	}
+
+	int ended = 0;
+	for (int lane = 0; lane < LANES; lane++)
+	{
+		int game = base + lane;
+
+		if (hitSlot[lane] >= 0)
+		{
+			Hit(game, hitSlot[lane]);
+			if (lives[game] < 0)
+			{
+				ended |= 1 << lane;
+				continue; // Game over on the hit, no items
+			}
+		}
+
+		if (itemCount[game] > 0)
+			CollectItems(game);
+	}
+
+	return ended;
+}
+
+// -----------------------------------------------------------------------------
+// Grace counts down and extra lives are checked for the whole group at once. The games
+// with an item, a level change or a spawn due then go one at a time
+void BatchEnvironmentType::UpdateTimers(int group, int ended)
+{
+	int base = group * LANES;
+
+	__m128i playing = _mm_set_epi32(ended & 8 ? 0 : -1, ended & 4 ? 0 : -1, ended & 2 ? 0 : -1, ended & 1 ? 0 : -1);
+	__m128i zero = _mm_setzero_si128();
+
+	__m128i groupScore = _mm_loadu_si128((const __m128i*)&score[base]);
+	__m128i extraLife = _mm_loadu_si128((const __m128i*)&scoreForExtraLife[base]);
+	int extraLives = _mm_movemask_ps(_mm_castsi128_ps(_mm_andnot_si128(_mm_cmplt_epi32(groupScore, extraLife), playing)));
+
+	for (int lane = 0; lane < LANES; lane++)
+	{
+		if (extraLives & (1 << lane))
+		{
+			lives[base + lane] += 1;
+			scoreForExtraLife[base + lane] = int(scoreForExtraLife[base + lane] * 2.5);
+		}
+	}
+
+	// grace - 1 where it is above 0, the compare is -1 where true
+	__m128i grace = _mm_loadu_si128((const __m128i*)&graceTicks[base]);
+	grace = _mm_add_epi32(grace, _mm_and_si128(_mm_cmpgt_epi32(grace, zero), playing));
+	_mm_storeu_si128((__m128i*)&graceTicks[base], grace);
+
+	// Items to expire, or a level change or spawn due
+	__m128i now = _mm_loadu_si128((const __m128i*)&tick[base]);
+	__m128i due = _mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)&itemCount[base]), zero);
+	if (config->spawning)
+	{
+		__m128i level = _mm_loadu_si128((const __m128i*)&nextLevelTick[base]);
+		__m128i spawn = _mm_loadu_si128((const __m128i*)&nextSpawnTick[base]);
+		due = _mm_or_si128(due, _mm_or_si128(_mm_cmplt_epi32(level, _mm_add_epi32(now, _mm_set1_epi32(1))), _mm_cmplt_epi32(spawn, _mm_add_epi32(now, _mm_set1_epi32(1)))));
+	}
+
+	int dueGames = _mm_movemask_ps(_mm_castsi128_ps(_mm_and_si128(due, playing)));
+	for (int lane = 0; lane < LANES; lane++)
+	{
+		if (dueGames & (1 << lane))
+			UpdateGameTimers(base + lane);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Step every slot of the group, turning snakes that have reached their end, and test the
+// new positions against the despawn bounds in the same pass. The obstacles that left are
+// then removed the way HeadlessGameType does after its own pass, the last one moved into
+// the gap and tested again, so the bit for each slot travels with the obstacle
+void BatchEnvironmentType::MoveObstacles(int group)
+{
+	__m128 signBit = _mm_set1_ps(-0.0f);
+	__m128 reverseDistance = _mm_set1_ps(REVERSE_DISTANCE);
+
+	uint64_t leaving[LANES] = {};
+	int anyLeaving = 0;
+
+	int count = GetGroupCount(group);
+	for (int slot = 0; slot < count; slot++)
+	{
+		int index = (group * SLOTS + slot) * LANES;
+
+		__m128 px = _mm_add_ps(_mm_loadu_ps(&x[index]), _mm_loadu_ps(&stepX[index]));
+		__m128 py = _mm_add_ps(_mm_loadu_ps(&y[index]), _mm_loadu_ps(&stepY[index]));
+		_mm_storeu_ps(&x[index], px);
+		_mm_storeu_ps(&y[index], py);
+
+		__m128 outside = _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(px, _mm_loadu_ps(&minX[index])), _mm_cmpgt_ps(px, _mm_loadu_ps(&maxX[index]))),
+			_mm_or_ps(_mm_cmplt_ps(py, _mm_loadu_ps(&minY[index])), _mm_cmpgt_ps(py, _mm_loadu_ps(&maxY[index]))));
+
+		int gone = _mm_movemask_ps(outside);
+		if (gone != 0)
+		{
+			for (int lane = 0; lane < LANES; lane++)
+			{
+				if (gone & (1 << lane))
+					leaving[lane] |= uint64_t(1) << slot;
+			}
+			anyLeaving |= gone;
+		}
+
+		__m128 turned = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)&reversed[index]));
+		if (_mm_movemask_ps(turned) == 0xF)
+			continue; // Nothing here can turn
+
+		__m128 end = _mm_loadu_ps(&endY[index]);
+		__m128 distance = _mm_andnot_ps(signBit, _mm_sub_ps(end, py));
+		__m128 turn = _mm_andnot_ps(turned, _mm_cmplt_ps(distance, reverseDistance));
+		if (_mm_movemask_ps(turn) == 0)
+			continue;
+
+		// Swap start and end, and head back the other way
+		__m128 start = _mm_loadu_ps(&startY[index]);
+		_mm_storeu_ps(&startY[index], _mm_or_ps(_mm_and_ps(turn, end), _mm_andnot_ps(turn, start)));
+		_mm_storeu_ps(&endY[index], _mm_or_ps(_mm_and_ps(turn, start), _mm_andnot_ps(turn, end)));
+		_mm_storeu_ps(&stepY[index], _mm_xor_ps(_mm_loadu_ps(&stepY[index]), _mm_and_ps(turn, signBit)));
+		_mm_storeu_si128((__m128i*)&reversed[index], _mm_castps_si128(_mm_or_ps(turned, turn)));
+	}
+
+	if (anyLeaving == 0)
+		return;
+
+	for (int lane = 0; lane < LANES; lane++)
+	{
+		int game = group * LANES + lane;
+		uint64_t bits = leaving[lane];
+
+		for (int slot = 0; bits != 0 && slot < obstacleCount[game]; )
+		{
+			if ((bits & (uint64_t(1) << slot)) == 0)
+			{
+				slot++;
+				continue;
+			}
+
+			int last = obstacleCount[game] - 1;
+			bits &= ~(uint64_t(1) << slot);
+			if (bits & (uint64_t(1) << last))
+				bits = (bits & ~(uint64_t(1) << last)) | (uint64_t(1) << slot);
+
+			RemoveAt(game, slot);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// HeadlessGameType::Start
+void BatchEnvironmentType::Start(int game, uint32_t gameSeed)
+{
+	seed[game] = gameSeed;
+	random[game] = gameSeed != 0 ? gameSeed : 1;
+	tick[game] = 0;
+	deathCause[game] = -1;
+
+	vine[game] = 2;
+	koalaX[game] = float(config->vineX[2]);
+	koalaY[game] = 768 / 2;
+	lives[game] = 2;
+	score[game] = 0;
+	itemCombo[game] = 100;
+	maxItemCombo[game] = 100;
+	graceTicks[game] = 0;
+
+	itemLevel[game] = 1;
+	obstacleLevel[game] = 1;
+	obstacleSpeed[game] = 1;
+	scoreForExtraLife[game] = 10000;
+
+	nextSpawnTick[game] = 3 * HeadlessGameType::TICKS_PER_SECOND;
+	nextLevelTick[game] = 15 * HeadlessGameType::TICKS_PER_SECOND;
+
+	itemCount[game] = 0;
+	obstacleCount[game] = 0;
+	for (int slot = 0; slot < SLOTS; slot++)
+		Park(game, slot);
+}
+
+// -----------------------------------------------------------------------------
+// Summarise a game that has just ended, with what was on the screen when it did
+void BatchEnvironmentType::AddResult(int game)
+{
+	GameResult result = {};
+	result.seed = seed[game];
+	result.paramSet = paramSet;
+	result.ticks = tick[game];
+	result.score = score[game];
+	result.maxItemCombo = maxItemCombo[game];
+	result.deathCause = deathCause[game];
+
+	for (int slot = 0; slot < obstacleCount[game]; slot++)
+		result.obstacles[kind[Slot(game, slot)]]++;
+
+	results->Append(result);
+}
+
+// -----------------------------------------------------------------------------
+// Take a life for the obstacle in the slot, knock the koala back and remove it
+void BatchEnvironmentType::Hit(int game, int slot)
+{
+	int obstacleKind = kind[Slot(game, slot)];
+
+	lives[game] -= 1;
+	graceTicks[game] = HeadlessGameType::TICKS_PER_SECOND;
+	koalaY[game] += obstacleTraits[obstacleKind].knockbackY;
+	deathCause[game] = obstacleKind;
+
+	RemoveAt(game, slot);
+}
+
+// -----------------------------------------------------------------------------
+// Collect every item the koala's box has a corner of inside it
+void BatchEnvironmentType::CollectItems(int game)
+{
+	int left = int(koalaX[game] - (config->koalaWidth >> 1));
+	int right = left + config->koalaWidth;
+	int top = int(koalaY[game] - (config->koalaHeight >> 1));
+	int bottom = top + config->koalaHeight;
+
+	auto contains = [&](float px, float py) { return px >= left && px <= right && py >= top && py <= bottom; };
+
+	int first = game * MAX_ITEMS;
+	for (int i = 0; i < itemCount[game]; i++)
+	{
+		float ix = itemX[first + i], iy = itemY[first + i];
+		float hw = itemHalfWidth[first + i], hh = itemHalfHeight[first + i];
+
+		if (contains(ix - hw, iy - hh) || contains(ix + hw, iy - hh) || contains(ix - hw, iy + hh) || contains(ix + hw, iy + hh))
+		{
+			score[game] += itemCombo[game];
+			itemCombo[game] *= 2;
+			if (itemCombo[game] > maxItemCombo[game])
+				maxItemCombo[game] = itemCombo[game];
+
+			// The last item into the gap, then look at the gap again
+			int last = first + --itemCount[game];
+			itemX[first + i] = itemX[last];
+			itemY[first + i] = itemY[last];
+			itemHalfWidth[first + i] = itemHalfWidth[last];
+			itemHalfHeight[first + i] = itemHalfHeight[last];
+			itemExpiry[first + i] = itemExpiry[last];
+			i--;
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// The item expiry, level change and spawn parts of HeadlessGameType::UpdateTimers
+void BatchEnvironmentType::UpdateGameTimers(int game)
+{
+	int first = game * MAX_ITEMS;
+	for (int i = 0; i < itemCount[game]; i++)
+	{
+		if (tick[game] >= itemExpiry[first + i])
+		{
+			itemCombo[game] = 100;
+			itemLevel[game] = 1;
+
+			int last = first + --itemCount[game];
+			itemX[first + i] = itemX[last];
+			itemY[first + i] = itemY[last];
+			itemHalfWidth[first + i] = itemHalfWidth[last];
+			itemHalfHeight[first + i] = itemHalfHeight[last];
+			itemExpiry[first + i] = itemExpiry[last];
+			i--;
+		}
+	}
+
+	if (!config->spawning)
+		return;
+
+	if (tick[game] >= nextLevelTick[game])
+	{
+		nextLevelTick[game] += 15 * HeadlessGameType::TICKS_PER_SECOND;
+
+		if (itemLevel[game] > 8)
+		{
+			itemLevel[game] = 1;
+			itemCombo[game] = 100;
+		}
+
+		SpawnItem(game);
+		itemLevel[game]++;
+
+		if (obstacleLevel[game] <= 4)
+			obstacleLevel[game]++;
+		else
+			obstacleSpeed[game] += 0.5f;
+	}
+
+	if (tick[game] >= nextSpawnTick[game])
+	{
+		int toSpawn = Random(game, obstacleLevel[game]);
+		float wait = Random(game, 3) + 0.5f;
+
+		if (toSpawn < OBSTACLE_KIND_COUNT)
+			SpawnObstacle(game, EntityKind::Kind(toSpawn));
+
+		nextSpawnTick[game] = tick[game] + int(ceilf(wait * HeadlessGameType::TICKS_PER_SECOND));
+	}
+}
+
+// -----------------------------------------------------------------------------
+// HeadlessGameType::SpawnObstacle, into the game's next free slot
+void BatchEnvironmentType::SpawnObstacle(int game, EntityKind::Kind obstacleKind)
+{
+	const ObstacleTraits& traits = obstacleTraits[obstacleKind];
+
+	int side = traits.sideCount > 1 ? Random(game, 2) : 0;
+
+	float across;
+	if (traits.spawnEdge == ObstacleRule::LeftOrRight)
+		across = float(Random(game, config->lavaTop - 50) + 50);
+	else
+		across = float(config->vineX[Random(game, config->vineCount)]);
+
+	float speed = traits.speed == ObstacleRule::RandomSpeed ? float(Random(game, int(obstacleSpeed[game])) + 1) : obstacleSpeed[game] + 1;
+
+	float spawnX = across, spawnY = 0, spawnEndY = 768;
+	switch (traits.spawnEdge)
+	{
+	case ObstacleRule::Top:
+		break;
+	case ObstacleRule::Bottom:
+		spawnY = 768;
+		spawnEndY = 0;
+		break;
+	case ObstacleRule::LeftOrRight:
+		spawnX = side == 0 ? 0.0f : 1024.0f;
+		spawnY = across;
+		spawnEndY = across;
+		break;
+	case ObstacleRule::TopOrBottom:
+		spawnY = side == 0 ? 0.0f : 768.0f;
+		spawnEndY = side == 0 ? float(config->lavaTop - 20) : 0.0f;
+		break;
+	}
+
+	if (obstacleCount[game] == SLOTS)
+		return; // Full, the spawn is lost
+
+	int at = Slot(game, obstacleCount[game]++);
+	const ObstacleSide& look = traits.sides[side];
+	bool horizontal = traits.axis == ObstacleRule::Horizontal;
+
+	x[at] = spawnX;
+	y[at] = spawnY;
+	stepX[at] = horizontal ? look.dirX * speed : 0;
+	stepY[at] = horizontal ? 0 : look.dirY * speed;
+	halfWidth[at] = config->obstacleHalfWidth[obstacleKind];
+	halfHeight[at] = config->obstacleHalfHeight[obstacleKind];
+	startY[at] = spawnY;
+	endY[at] = spawnEndY;
+	minX[at] = traits.minX;
+	maxX[at] = traits.maxX;
+	minY[at] = traits.minY;
+	maxY[at] = traits.maxY;
+	reversed[at] = traits.path == ObstacleRule::ReverseOnce ? 0 : -1;
+	kind[at] = obstacleKind;
+}
+
+// -----------------------------------------------------------------------------
+// HeadlessGameType::SpawnItem
+void BatchEnvironmentType::SpawnItem(int game)
+{
+	int itemVine = Random(game, config->vineCount);
+	if (itemVine == vine[game])
+		itemVine = (itemVine + 1 + Random(game, config->vineCount - 1)) % config->vineCount;
+
+	float itemTop = float(Random(game, config->lavaTop - 30) + 30);
+
+	if (itemCount[game] == MAX_ITEMS)
+		return;
+
+	int level = itemLevel[game] >= 1 && itemLevel[game] <= HeadlessConfig::ITEM_LEVELS ? itemLevel[game] - 1 : 0;
+	int at = game * MAX_ITEMS + itemCount[game]++;
+
+	itemX[at] = float(config->vineX[itemVine]);
+	itemY[at] = itemTop;
+	itemHalfWidth[at] = config->itemHalfWidth[level];
+	itemHalfHeight[at] = config->itemHalfHeight[level];
+	itemExpiry[at] = tick[game] + 5 * HeadlessGameType::TICKS_PER_SECOND;
+}
+
+// -----------------------------------------------------------------------------
+// Copy the game's last obstacle over the slot
+void BatchEnvironmentType::RemoveAt(int game, int slot)
+{
+	int to = Slot(game, slot);
+	int from = Slot(game, --obstacleCount[game]);
+
+	x[to] = x[from];
+	y[to] = y[from];
+	stepX[to] = stepX[from];
+	stepY[to] = stepY[from];
+	halfWidth[to] = halfWidth[from];
+	halfHeight[to] = halfHeight[from];
+	startY[to] = startY[from];
+	endY[to] = endY[from];
+	minX[to] = minX[from];
+	maxX[to] = maxX[from];
+	minY[to] = minY[from];
+	maxY[to] = maxY[from];
+	reversed[to] = reversed[from];
+	kind[to] = kind[from];
+
+	Park(game, obstacleCount[game]);
+}
+
+// -----------------------------------------------------------------------------
+// An empty slot can't hit, move, turn or despawn
+void BatchEnvironmentType::Park(int game, int slot)
+{
+	int at = Slot(game, slot);
+
+	x[at] = PARKED_X;
+	y[at] = 0;
+	stepX[at] = 0;
+	stepY[at] = 0;
+	halfWidth[at] = 0;
+	halfHeight[at] = 0;
+	startY[at] = 0;
+	endY[at] = 0;
+	minX[at] = -FLT_MAX;
+	maxX[at] = FLT_MAX;
+	minY[at] = -FLT_MAX;
+	maxY[at] = FLT_MAX;
+	reversed[at] = -1;
+	kind[at] = 0;
+}
+
+// -----------------------------------------------------------------------------
+// HeadlessGameType::Random, on the game's own state
+int BatchEnvironmentType::Random(int game, int range)
+{
+	uint32_t state = random[game];
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	random[game] = state;
+
+	return range > 0 ? int(state % uint32_t(range)) : 0;
+}
+
+// -----------------------------------------------------------------------------
+// Highest obstacle count in the group
+int BatchEnvironmentType::GetGroupCount(int group) const
+{
+	int base = group * LANES;
+	int count = 0;
+
+	for (int lane = 0; lane < LANES; lane++)
+	{
+		if (obstacleCount[base + lane] > count)
+			count = obstacleCount[base + lane];
+	}
+
+	return count;
+}
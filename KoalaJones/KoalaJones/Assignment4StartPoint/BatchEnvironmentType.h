@@ -0,0 +1,136 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Many headless games stepped together, for bot training and mass evaluation. The rules
+// are HeadlessGameType's, tick for tick: a game here and a HeadlessGameType with the same
+// seed, config and actions play out exactly the same.
+//
+// Each per-game value (score, lives, vine, timers, levels, the random state) is an array
+// across the games. Games are grouped LANES at a time to match an SSE register. Each group
+// has a segment of SLOTS obstacle slots in the shared obstacle arrays, stored slot by slot
+// with the group's games side by side. The hot loops (moving with the snake turns and
+// despawn tests, collision tests, grace and extra lives) then work on one slot of LANES games per
+// instruction. The rare events these loops find (a hit, a despawn, a spawn or level
+// change that is due) are handled one game at a time.
+//
+// Empty slots are parked far off to the left with no speed, so the vector loops can run over
+// them without hitting or despawning anything.
+//
+// A game that ends is started again with the next seed within the same Step. GetDone says
+// which games did.
+//----------------------------------------------------------------------------------------
+
+#include <vector>
+#include <cstdint>
+#include "HeadlessGameType.h"
+#include "ResultsStoreType.h"
+
+class BatchEnvironmentType
+{
+	public:
+		static const int LANES = 4; // Games per SSE register
+		static const int SLOTS = HeadlessGameType::MAX_OBSTACLES; // Obstacles each game has room for, as many as a headless game so the two lose the same spawns
+		static const int MAX_ITEMS = HeadlessGameType::MAX_ITEMS;
+
+		// constructor
+		BatchEnvironmentType();
+
+		// make room for the games and start them, game g with seed firstSeed + g. The config must outlive the environment
+		void Initialize(const HeadlessConfig* inConfig, int inGameCount, uint32_t firstSeed);
+
+		// add a row to the store for every game that ends from now on, NULL to stop
+		void SetResults(ResultsStoreType* inResults, int inParamSet) { results = inResults; paramSet = inParamSet; }
+
+		// run one tick of every game, actions holds a HeadlessGameType::Action for each
+		void Step(const uint8_t* actions);
+
+		int GetGameCount() const { return gameCount; }
+
+		// per game, as they are after the last Step. Games that ended have been started again
+		const int* GetScores() const { return &score[0]; }
+		const int* GetLives() const { return &lives[0]; }
+		const int* GetVines() const { return &vine[0]; }
+		const float* GetKoalaY() const { return &koalaY[0]; }
+		const int* GetTicks() const { return &tick[0]; }
+		const int* GetObstacleCounts() const { return &obstacleCount[0]; }
+
+		// per game, set by the last Step
+		const uint8_t* GetDone() const { return &done[0]; } // 1 if the game ended and was started again
+		const float* GetRewards() const { return &reward[0]; } // Score gained, a game that ended gets what it gained before it ended
+		const int* GetDeathCauses() const { return &deathCause[0]; } // Kind that ended it, for games that are done
+
+		// games that have ended, and the ticks they lasted and scored between them
+		long long GetEpisodeCount() const { return episodes; }
+		long long GetEpisodeTicks() const { return episodeTicks; }
+		long long GetEpisodeScore() const { return episodeScore; }
+
+		// ticks stepped over every game
+		long long GetTotalTicks() const { return totalTicks; }
+
+	private:
+		const HeadlessConfig* config;
+		int gameCount;
+		int groupCount; // Groups of LANES games, the last is filled out with games that only ever wait
+		uint32_t nextSeed;
+
+		ResultsStoreType* results;
+		int paramSet;
+
+		// per game
+		std::vector<uint32_t> seed; // What the game started with
+		std::vector<uint32_t> random;
+		std::vector<int> tick;
+		std::vector<int> vine;
+		std::vector<float> koalaX, koalaY;
+		std::vector<int> lives, score;
+		std::vector<int> graceTicks;
+		std::vector<int> scoreForExtraLife;
+		std::vector<int> deathCause;
+		std::vector<int> itemCombo, maxItemCombo, itemLevel;
+		std::vector<int> obstacleLevel;
+		std::vector<float> obstacleSpeed;
+		std::vector<int> nextSpawnTick, nextLevelTick;
+		std::vector<int> obstacleCount;
+		std::vector<uint8_t> done;
+		std::vector<float> reward;
+
+		// items, MAX_ITEMS per game
+		std::vector<float> itemX, itemY, itemHalfWidth, itemHalfHeight;
+		std::vector<int> itemExpiry;
+		std::vector<int> itemCount;
+
+		// obstacles, see Slot for the layout
+		std::vector<float> x, y;
+		std::vector<float> stepX, stepY;
+		std::vector<float> halfWidth, halfHeight;
+		std::vector<float> startY, endY;
+		std::vector<float> minX, maxX, minY, maxY; // Despawn bounds
+		std::vector<int> reversed; // -1 once a snake has turned, and for every kind that doesn't turn. 0 until then
+		std::vector<int> kind;
+
+		long long episodes, episodeTicks, episodeScore, totalTicks;
+
+		// where an obstacle slot of a game is in the obstacle arrays
+		static int Slot(int game, int slot) { return ((game / LANES) * SLOTS + slot) * LANES + game % LANES; }
+
+		// the parts of a tick for one group of games
+		void ApplyActions(int group, const uint8_t* actions);
+		void ApplyAction(int game, int action);
+		int CheckForCollisions(int group); // Returns a bit for each lane whose game ended
+		void UpdateTimers(int group, int ended);
+		void MoveObstacles(int group); // And removes the ones that left
+
+		// one game at a time, as HeadlessGameType does them
+		void Start(int game, uint32_t gameSeed);
+		void AddResult(int game);
+		void Hit(int game, int slot);
+		void CollectItems(int game);
+		void UpdateGameTimers(int game);
+		void SpawnObstacle(int game, EntityKind::Kind obstacleKind);
+		void SpawnItem(int game);
+		void RemoveAt(int game, int slot); // Move the last obstacle into the slot and park the last one
+		void Park(int game, int slot);
+		int Random(int game, int range);
+
+		// the most obstacles any game in a group has, the vector loops run this far
+		int GetGroupCount(int group) const;
+};
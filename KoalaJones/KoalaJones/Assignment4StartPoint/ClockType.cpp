@@ -0,0 +1,95 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for the system clock
+//----------------------------------------------------------------------------------------
+
+#include "ClockType.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <mmsystem.h>
+#pragma comment(lib, "winmm.lib") // timeBeginPeriod
+#else
+#include <time.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// Read the counter frequency once, and ask Windows for 1 ms scheduler ticks so
+// Sleep comes back close to on time
+SystemClockType::SystemClockType()
+{
+#ifdef _WIN32
+	LARGE_INTEGER counterFrequency;
+	QueryPerformanceFrequency(&counterFrequency);
+	frequency = counterFrequency.QuadPart;
+
+	timeBeginPeriod(1);
+#else
+	frequency = NANOSECONDS_PER_SECOND;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Hand the scheduler resolution back
+SystemClockType::~SystemClockType()
+{
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Read the monotonic counter
+int64_t SystemClockType::Now()
+{
+#ifdef _WIN32
+	LARGE_INTEGER ticks;
+	QueryPerformanceCounter(&ticks);
+
+	// Whole seconds and the remainder apart, so the multiply can't overflow however long the machine has been up
+	int64_t seconds = ticks.QuadPart / frequency;
+	int64_t remainder = ticks.QuadPart % frequency;
+	return seconds * NANOSECONDS_PER_SECOND + remainder * NANOSECONDS_PER_SECOND / frequency;
+#else
+	timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return int64_t(time.tv_sec) * NANOSECONDS_PER_SECOND + time.tv_nsec;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Sleep in whole milliseconds on Windows, the finest Sleep takes, and to the nanosecond elsewhere
+void SystemClockType::Sleep(int64_t nanoseconds)
+{
+	if (nanoseconds <= 0)
+		return;
+
+#ifdef _WIN32
+	DWORD milliseconds = DWORD(nanoseconds / NANOSECONDS_PER_MILLISECOND);
+	if (milliseconds > 0)
+		::Sleep(milliseconds);
+#else
+	timespec time;
+	time.tv_sec = time_t(nanoseconds / NANOSECONDS_PER_SECOND);
+	time.tv_nsec = long(nanoseconds % NANOSECONDS_PER_SECOND);
+	nanosleep(&time, NULL);
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Windows wakes threads on its scheduler tick, which can still be a couple of milliseconds late at 1 ms
+int64_t SystemClockType::GetSleepSlack() const
+{
+#ifdef _WIN32
+	return 2 * NANOSECONDS_PER_MILLISECOND;
+#else
+	return NANOSECONDS_PER_MILLISECOND / 5;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Read the counter until it gets there, time moves on by itself
+void SystemClockType::SpinUntil(int64_t time)
+{
+	while (Now() < time)
+		;
+}
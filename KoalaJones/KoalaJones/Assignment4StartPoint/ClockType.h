@@ -0,0 +1,72 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Monotonic clocks in nanoseconds. Code that waits or measures time takes a ClockType, so
+// it can be driven by SystemClockType in the game or by ManualClockType where time has to
+// be under control, such as checking the frame pacer's decisions off Windows.
+//
+// SystemClockType reads QueryPerformanceCounter on Windows and clock_gettime with
+// CLOCK_MONOTONIC everywhere else.
+//----------------------------------------------------------------------------------------
+
+#include <cstdint>
+
+class ClockType
+{
+	public:
+		static const int64_t NANOSECONDS_PER_SECOND = 1000000000;
+		static const int64_t NANOSECONDS_PER_MILLISECOND = 1000000;
+
+		virtual ~ClockType() {}
+
+		// get the time now, only differences between two times mean anything
+		virtual int64_t Now() = 0;
+
+		// give the thread up for about this long, it can come back late but never early
+		virtual void Sleep(int64_t nanoseconds) = 0;
+
+		// how late Sleep can come back, waits closer than this to their end spin instead
+		virtual int64_t GetSleepSlack() const = 0;
+
+		// busy wait until the time, for the last stretch of a wait that a sleep could overshoot
+		virtual void SpinUntil(int64_t time) = 0;
+};
+
+// the real clock, safe to read from any thread
+class SystemClockType : public ClockType
+{
+	public:
+		// constructor and destructor, on Windows they read the counter frequency and raise the scheduler resolution
+		SystemClockType();
+		~SystemClockType();
+
+		int64_t Now();
+		void Sleep(int64_t nanoseconds);
+		int64_t GetSleepSlack() const;
+		void SpinUntil(int64_t time);
+
+	private:
+		int64_t frequency; // Counter ticks a second on Windows
+};
+
+// a clock that only moves when told to, sleeping moves it on by exactly the time asked for and
+// spinning moves it straight to the time, as nothing else would move it while it spins
+class ManualClockType : public ClockType
+{
+	public:
+		ManualClockType() : now(0), slack(0) {}
+
+		int64_t Now() { return now; }
+		void Sleep(int64_t nanoseconds) { if (nanoseconds > 0) now += nanoseconds + slack; }
+		int64_t GetSleepSlack() const { return slack; }
+		void SpinUntil(int64_t time) { if (now < time) now = time; }
+
+		// move time on, as the work being timed would
+		void Advance(int64_t nanoseconds) { now += nanoseconds; }
+
+		// make every sleep this much late, like a real scheduler
+		void SetSleepSlack(int64_t nanoseconds) { slack = nanoseconds; }
+
+	private:
+		int64_t now;
+		int64_t slack;
+};
@@ -0,0 +1,121 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Components stored in the entity world. Components are plain data with no DirectX types,
+// so the simulation doesn't need a device. Each component has a bit in a ComponentMask.
+// An archetype is one combination of component bits plus the kind of entity it holds.
+//----------------------------------------------------------------------------------------
+
+#include <cstdint>
+#include "TimerWheelType.h"
+
+class TextureType;
+
+typedef uint32_t ComponentMask;
+
+class EntityKind
+{
+	public:
+
+		// kinds of entity in the world, each archetype only holds one kind so counting a kind is cheap
+		enum Kind { Rock, FireBall, Dart, Snake, Item, COUNT };
+
+		static const char* GetName(Kind kind)
+		{
+			static const char* names[COUNT] = { "Rock", "FireBall", "Dart", "Snake", "Item" };
+
+			return (kind >= 0 && kind < COUNT) ? names[kind] : "";
+		}
+};
+
+// position, rotation in degrees and scale
+struct TransformComponent
+{
+	static const int ID = 0;
+
+	float x, y;
+	float rotation;
+	float scale;
+};
+
+// moves along direction at speed every tick
+struct MotionComponent
+{
+	static const int ID = 1;
+
+	float dirX, dirY;
+	float speed;
+};
+
+// travels from start to end, then turns round once and heads back
+struct PatrolComponent
+{
+	static const int ID = 2;
+
+	float startX, startY;
+	float endX, endY;
+	int reversed; // Already turned round, don't turn again
+};
+
+// what to draw, the texture region and origin are in texels
+struct RenderComponent
+{
+	static const int ID = 3;
+
+	TextureType* texture;
+	int regionLeft, regionTop, regionRight, regionBottom;
+	float originX, originY;
+	float r, g, b, a;
+	float layer;
+};
+
+// box around the position used to test against the player
+struct ColliderComponent
+{
+	static const int ID = 4;
+
+	float halfWidth, halfHeight;
+	float reach; // Furthest the drawn sprite gets from the position at any rotation, see NarrowPhaseType
+};
+
+// hurts the player on contact
+struct DamageComponent
+{
+	static const int ID = 5;
+
+	int lives; // Lives taken
+};
+
+// collected by the player on contact
+struct PickupComponent
+{
+	static const int ID = 6;
+
+	int level; // Item level when it was spawned
+};
+
+// removed when its timer fires
+struct LifetimeComponent
+{
+	static const int ID = 7;
+
+	TimerHandle timer; // Cancel it if the entity goes early
+};
+
+// steps through a clip's frames, see AnimatorType
+struct AnimationComponent
+{
+	static const int ID = 8;
+
+	int clip; // -1 doesn't animate
+	int frame;
+	float timeLeft; // Seconds until the next frame
+};
+
+static const int COMPONENT_COUNT = 9;
+
+// the mask bit of a component
+template <class T>
+inline ComponentMask ComponentBit()
+{
+	return ComponentMask(1) << T::ID;
+}
@@ -0,0 +1,187 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for the entity world
+//----------------------------------------------------------------------------------------
+
+#include "EntityWorldType.h"
+#include "AllocTrackerType.h"
+
+#include <cassert>
+
+// -----------------------------------------------------------------------------
+// Start with an empty world
+EntityWorldType::EntityWorldType()
+{
+	layoutVersion = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Free the archetypes
+EntityWorldType::~EntityWorldType()
+{
+	for (size_t i = 0; i < archetypes.size(); i++)
+		delete archetypes[i];
+}
+
+// -----------------------------------------------------------------------------
+// Find the archetype for a mask and kind, there are only ever a handful so a scan is fine
+ArchetypeType* EntityWorldType::GetArchetype(ComponentMask mask, EntityKind::Kind kind)
+{
+	for (size_t i = 0; i < archetypes.size(); i++)
+	{
+		if (archetypes[i]->GetMask() == mask && archetypes[i]->GetKind() == kind)
+			return archetypes[i];
+	}
+
+	ALLOC_TAG(Sprites);
+	archetypes.push_back(new ArchetypeType(mask, kind));
+
+	return archetypes.back();
+}
+
+// -----------------------------------------------------------------------------
+// Create an entity, reusing a free record slot if there is one
+Entity EntityWorldType::Create(ComponentMask mask, EntityKind::Kind kind)
+{
+	Entity entity;
+
+	if (!freeRecords.empty())
+	{
+		entity.index = freeRecords.back();
+		freeRecords.pop_back();
+	}
+	else
+	{
+		ALLOC_TAG(Sprites);
+
+		Record record = { NULL, 0, 0 };
+		entity.index = uint32_t(records.size());
+		records.push_back(record);
+	}
+
+	Record& record = records[entity.index];
+	entity.generation = record.generation;
+
+	record.archetype = GetArchetype(mask, kind);
+	record.row = record.archetype->Add(entity);
+	layoutVersion++;
+
+	return entity;
+}
+
+// -----------------------------------------------------------------------------
+// Grow the archetype's chunks and the records once for the whole batch
+void EntityWorldType::Reserve(ComponentMask mask, EntityKind::Kind kind, int count)
+{
+	GetArchetype(mask, kind)->Reserve(count);
+	layoutVersion++; // There may be new chunks
+
+	size_t newRecords = size_t(count) > freeRecords.size() ? count - freeRecords.size() : 0;
+	if (newRecords > 0)
+	{
+		ALLOC_TAG(Sprites);
+		records.reserve(records.size() + newRecords);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Destroy an entity, fixing up the record of whichever entity moved into its row
+void EntityWorldType::Destroy(Entity entity)
+{
+	if (!IsAlive(entity))
+		return;
+
+	Record& record = records[entity.index];
+
+	Entity moved;
+	if (record.archetype->Remove(record.row, moved))
+		records[moved.index].row = record.row;
+
+	record.archetype = NULL;
+	record.generation++;
+	layoutVersion++;
+
+	ALLOC_TAG(Sprites);
+	freeRecords.push_back(entity.index);
+}
+
+// -----------------------------------------------------------------------------
+// Destroy everything queued by DestroyLater
+void EntityWorldType::FlushDestroyed()
+{
+	for (size_t i = 0; i < pendingDestroy.size(); i++)
+		Destroy(pendingDestroy[i]); // Destroy ignores an entity queued twice
+
+	pendingDestroy.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Destroy every entity, keeping the memory
+void EntityWorldType::Clear()
+{
+	ALLOC_TAG(Sprites);
+
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		if (records[i].archetype != NULL)
+		{
+			records[i].archetype = NULL;
+			records[i].generation++;
+			freeRecords.push_back(uint32_t(i));
+		}
+	}
+
+	for (size_t i = 0; i < archetypes.size(); i++)
+		archetypes[i]->Clear();
+
+	pendingDestroy.clear();
+	layoutVersion++;
+}
+
+// -----------------------------------------------------------------------------
+// Check the handle's generation against the record
+bool EntityWorldType::IsAlive(Entity entity) const
+{
+	return entity.index < records.size() && records[entity.index].archetype != NULL && records[entity.index].generation == entity.generation;
+}
+
+// -----------------------------------------------------------------------------
+// Count the entities of a kind across its archetypes
+int EntityWorldType::GetCount(EntityKind::Kind kind) const
+{
+	int count = 0;
+
+	for (size_t i = 0; i < archetypes.size(); i++)
+	{
+		if (archetypes[i]->GetKind() == kind)
+			count += archetypes[i]->GetCount();
+	}
+
+	return count;
+}
+
+// -----------------------------------------------------------------------------
+// Add up the chunk capacity of a kind across its archetypes
+int EntityWorldType::GetCapacity(EntityKind::Kind kind) const
+{
+	int capacity = 0;
+
+	for (size_t i = 0; i < archetypes.size(); i++)
+	{
+		if (archetypes[i]->GetKind() == kind)
+			capacity += archetypes[i]->GetCapacity();
+	}
+
+	return capacity;
+}
+
+// -----------------------------------------------------------------------------
+// Add up the chunks of every archetype and the bookkeeping vectors
+size_t EntityWorldType::GetMemoryBytes() const
+{
+	size_t bytes = records.capacity() * sizeof(Record) + freeRecords.capacity() * sizeof(uint32_t) + pendingDestroy.capacity() * sizeof(Entity);
+
+	for (size_t i = 0; i < archetypes.size(); i++)
+		bytes += sizeof(ArchetypeType) + archetypes[i]->GetMemoryBytes();
+
+	return bytes;
+}
@@ -0,0 +1,101 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Archetype based entity storage. An entity's components live in the archetype for its
+// combination of components and kind. A system asks for a component mask and visits every
+// chunk of every archetype that has those components, see ForEachChunk.
+//
+// Entities can't be created or destroyed while ForEachChunk is running because that
+// moves rows around. Use DestroyLater from inside a system, then FlushDestroyed after it.
+//----------------------------------------------------------------------------------------
+
+#include <vector>
+#include "ArchetypeType.h"
+
+class EntityWorldType
+{
+	public:
+		// constructor and destructor
+		EntityWorldType();
+		~EntityWorldType();
+
+		// create an entity with the components in the mask, the components are left for the caller to fill in
+		Entity Create(ComponentMask mask, EntityKind::Kind kind);
+
+		// make room for count more entities with the components in the mask, so creating them doesn't allocate
+		void Reserve(ComponentMask mask, EntityKind::Kind kind, int count);
+
+		// destroy an entity now, or queue it to be destroyed by FlushDestroyed
+		void Destroy(Entity entity);
+		void DestroyLater(Entity entity) { pendingDestroy.push_back(entity); }
+		void FlushDestroyed();
+
+		// destroy every entity, the archetypes and their chunks are kept for the next game
+		void Clear();
+
+		// is the handle still pointing at a live entity
+		bool IsAlive(Entity entity) const;
+
+		// get the kind of a live entity
+		EntityKind::Kind GetKind(Entity entity) const { return records[entity.index].archetype->GetKind(); }
+
+		// get a component of a live entity
+		template <class T>
+		T& Get(Entity entity)
+		{
+			const Record& record = records[entity.index];
+			return record.archetype->Get<T>(record.row);
+		}
+
+		// get the number of entities of a kind, and how many fit in the chunks already allocated
+		int GetCount(EntityKind::Kind kind) const;
+		int GetCapacity(EntityKind::Kind kind) const;
+
+		// get the bytes held by the chunks and the entity records
+		size_t GetMemoryBytes() const;
+
+		// changes whenever entities are created or destroyed or chunks added, so a system can keep a list of
+		// chunks and their counts until it does
+		unsigned int GetLayoutVersion() const { return layoutVersion; }
+
+		// get the archetypes, for systems that need more than ForEachChunk
+		int GetArchetypeCount() const { return int(archetypes.size()); }
+		ArchetypeType& GetArchetype(int index) { return *archetypes[index]; }
+
+		// call function(archetype, chunk, count) for every chunk that has the components in the mask
+		template <class Function>
+		void ForEachChunk(ComponentMask mask, Function function)
+		{
+			for (size_t a = 0; a < archetypes.size(); a++)
+			{
+				ArchetypeType& archetype = *archetypes[a];
+				if (!archetype.Has(mask))
+					continue;
+
+				int chunkCount = archetype.GetChunkCount();
+				for (int chunk = 0; chunk < chunkCount; chunk++)
+					function(archetype, chunk, archetype.GetCountInChunk(chunk));
+			}
+		}
+
+	private:
+		// where an entity lives, archetype is NULL for a free slot
+		struct Record
+		{
+			ArchetypeType* archetype;
+			int row;
+			uint32_t generation;
+		};
+
+		std::vector<Record> records;
+		std::vector<uint32_t> freeRecords; // Record slots that can be reused
+		std::vector<ArchetypeType*> archetypes;
+		std::vector<Entity> pendingDestroy;
+		unsigned int layoutVersion;
+
+		// find the archetype for a mask and kind, creating it the first time
+		ArchetypeType* GetArchetype(ComponentMask mask, EntityKind::Kind kind);
+
+		// worlds own their archetypes and can't be copied
+		EntityWorldType(const EntityWorldType&);
+		EntityWorldType& operator=(const EntityWorldType&);
+};
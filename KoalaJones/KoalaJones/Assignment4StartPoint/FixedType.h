@@ -0,0 +1,80 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// A 16.16 fixed-point number: a 32-bit integer counting 1/65536ths. Adding, subtracting,
+// comparing and multiplying are integer operations, so they give the same bits on every
+// compiler, platform and build, which floats don't promise.
+//
+// It is written to be a stand in for float in code templated on the number type. Numbers
+// are made with an explicit conversion from int or float, and turned back with an explicit
+// int (truncating towards zero, as a float does) or float. Converting from a float rounds
+// to the nearest 1/65536th and saturates, so FLT_MAX becomes the largest fixed-point
+// number rather than overflowing. Floats only come in at the edges, the arithmetic in
+// between never touches them.
+//
+// The range is -32768 to just under 32768, plenty for a 1024 by 768 screen.
+//----------------------------------------------------------------------------------------
+
+#include <cstdint>
+
+class FixedType
+{
+	public:
+		static const int FRACTION_BITS = 16;
+		static const int32_t ONE = 1 << FRACTION_BITS;
+
+		// zero
+		constexpr FixedType() : raw(0) {}
+
+		// whole numbers are exact
+		constexpr explicit FixedType(int value) : raw(int32_t(value * ONE)) {}
+
+		// nearest 1/65536th, saturated to the range
+		constexpr explicit FixedType(float value) : raw(FromFloat(value)) {}
+
+		// straight from 1/65536ths
+		static constexpr FixedType FromRaw(int32_t value)
+		{
+			FixedType fixed;
+			fixed.raw = value;
+			return fixed;
+		}
+
+		constexpr int32_t GetRaw() const { return raw; }
+
+		// the whole part, truncated towards zero like a float to int
+		constexpr explicit operator int() const { return raw / ONE; }
+
+		// exact in a double, so there is only the one rounding to float
+		constexpr explicit operator float() const { return float(double(raw) * (1.0 / ONE)); }
+
+		constexpr FixedType operator-() const { return FromRaw(-raw); }
+		constexpr FixedType operator+(FixedType other) const { return FromRaw(raw + other.raw); }
+		constexpr FixedType operator-(FixedType other) const { return FromRaw(raw - other.raw); }
+		constexpr FixedType operator*(FixedType other) const { return FromRaw(int32_t((int64_t(raw) * other.raw) >> FRACTION_BITS)); }
+
+		FixedType& operator+=(FixedType other) { raw += other.raw; return *this; }
+		FixedType& operator-=(FixedType other) { raw -= other.raw; return *this; }
+
+		constexpr bool operator==(FixedType other) const { return raw == other.raw; }
+		constexpr bool operator!=(FixedType other) const { return raw != other.raw; }
+		constexpr bool operator<(FixedType other) const { return raw < other.raw; }
+		constexpr bool operator<=(FixedType other) const { return raw <= other.raw; }
+		constexpr bool operator>(FixedType other) const { return raw > other.raw; }
+		constexpr bool operator>=(FixedType other) const { return raw >= other.raw; }
+
+	private:
+		int32_t raw; // 1/65536ths
+
+		// a float times 65536 is exact in a double, so the rounding is the same everywhere
+		static constexpr int32_t FromFloat(float value)
+		{
+			double scaled = double(value) * ONE;
+
+			if (scaled >= 2147483647.0)
+				return INT32_MAX;
+			if (scaled <= -2147483648.0)
+				return INT32_MIN;
+
+			return int32_t(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+		}
+};
@@ -0,0 +1,70 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// On-disk layout of a flight recorder dump. Kept free of Windows/DirectX headers so the
+// offline decoder can be built on its own.
+//
+// A dump is a FlightFileHeader followed by frameCount FlightFrameRecords, oldest first.
+//----------------------------------------------------------------------------------------
+
+#include <cstdint>
+#include "FramePhase.h"
+
+class FlightRecord
+{
+	public:
+
+		static const uint16_t VERSION = 1;
+		static const int MAX_INPUTS = 4; // Input events kept per frame, extra events are counted but not stored
+
+		// the sprite lists that are tracked each frame
+		enum List { Rocks, FireBalls, Darts, Snakes, Items, LIST_COUNT };
+
+		// the kinds of input event that are recorded
+		enum Input { MouseDown, MouseUp, KeyUp };
+
+		static const char* GetListName(List list)
+		{
+			static const char* names[LIST_COUNT] = { "Rocks", "FireBalls", "Darts", "Snakes", "Items" };
+
+			return (list >= 0 && list < LIST_COUNT) ? names[list] : "";
+		}
+};
+
+#pragma pack(push, 1)
+
+struct FlightFileHeader
+{
+	char magic[4]; // "KJFR"
+	uint16_t version;
+	uint16_t phaseCount; // FramePhase::COUNT when the dump was written
+	uint16_t listCount; // FlightRecord::LIST_COUNT when the dump was written
+	uint16_t maxInputs; // FlightRecord::MAX_INPUTS when the dump was written
+	uint32_t frameCount; // Number of records following the header
+	uint32_t hitchFrame; // Frame number that went over budget
+	float budgetMs; // Frame budget that triggered the dump
+};
+
+struct FlightInputEvent
+{
+	uint8_t type; // FlightRecord::Input
+	uint8_t key; // Virtual key for KeyUp events
+	int16_t x; // Mouse position for mouse events
+	int16_t y;
+};
+
+struct FlightFrameRecord
+{
+	uint32_t frame; // Frame number since the game started
+	float deltaMs; // Length of the frame as measured by the frame timer
+	float phaseMs[FramePhase::COUNT]; // Time spent in each phase
+	uint32_t spriteCount[FlightRecord::LIST_COUNT];
+	uint32_t listCapacity[FlightRecord::LIST_COUNT];
+	int32_t score;
+	int16_t lives;
+	uint8_t obstacleLevel;
+	uint8_t gameState; // MyProject::eGameStates
+	uint8_t inputCount; // Input events received this frame, may be more than MAX_INPUTS
+	FlightInputEvent inputs[FlightRecord::MAX_INPUTS];
+};
+
+#pragma pack(pop)
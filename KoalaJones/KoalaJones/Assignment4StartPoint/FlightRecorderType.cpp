@@ -0,0 +1,153 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for the hitch detector and flight recorder
+//----------------------------------------------------------------------------------------
+
+#include "FlightRecorderType.h"
+
+#include <cstdio>
+#include <cstring>
+
+// -----------------------------------------------------------------------------
+// Initialize member variables
+FlightRecorderType::FlightRecorderType()
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	msPerTick = 1000.0 / double(frequency.QuadPart);
+
+	memset(frames, 0, sizeof(frames));
+	current = 0;
+	recorded = 0;
+	frameNumber = 0;
+
+	budgetMs = 50.0f; // Three missed vsyncs at 60 Hz
+	framesUntilNextDump = 0;
+	dumpCount = 0;
+
+	renderEndTicks = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Finish the last frame's record and start a new one
+void FlightRecorderType::BeginFrame(float deltaTime)
+{
+	if (recorded > 0)
+	{
+		FlightFrameRecord& last = frames[current];
+
+		last.deltaMs = deltaTime * 1000.0f;
+
+		if (renderEndTicks != 0) // Present is the gap between Render finishing and now
+		{
+			last.phaseMs[FramePhase::Present] = float((GetTicks() - renderEndTicks) * msPerTick);
+			renderEndTicks = 0;
+		}
+
+		if (framesUntilNextDump > 0)
+			framesUntilNextDump--;
+
+		if (last.deltaMs > budgetMs && framesUntilNextDump == 0)
+		{
+			char fileName[64];
+			snprintf(fileName, sizeof(fileName), "hitch_%u.kjfr", last.frame);
+
+			if (Dump(fileName))
+				framesUntilNextDump = FRAME_COUNT; // Next dump won't overlap with this one
+		}
+
+		current = (current + 1) % FRAME_COUNT;
+	}
+
+	memset(&frames[current], 0, sizeof(FlightFrameRecord));
+	frames[current].frame = frameNumber++;
+
+	if (recorded < FRAME_COUNT)
+		recorded++;
+}
+
+// -----------------------------------------------------------------------------
+// Add time spent in a phase, phases can run more than once a frame
+void FlightRecorderType::AddPhaseTime(FramePhase::Phase phase, __int64 ticks)
+{
+	frames[current].phaseMs[phase] += float(ticks * msPerTick);
+
+	if (phase == FramePhase::Render)
+		renderEndTicks = GetTicks();
+}
+
+// -----------------------------------------------------------------------------
+// Record the size of a sprite list
+void FlightRecorderType::SetList(FlightRecord::List list, int count, int capacity)
+{
+	frames[current].spriteCount[list] = (uint32_t)count;
+	frames[current].listCapacity[list] = (uint32_t)capacity;
+}
+
+// -----------------------------------------------------------------------------
+// Record the game values
+void FlightRecorderType::SetGameState(int score, int lives, int obstacleLevel, int gameState)
+{
+	FlightFrameRecord& frame = frames[current];
+
+	frame.score = score;
+	frame.lives = (int16_t)lives;
+	frame.obstacleLevel = (uint8_t)obstacleLevel;
+	frame.gameState = (uint8_t)gameState;
+}
+
+// -----------------------------------------------------------------------------
+// Record an input event, only the first MAX_INPUTS events of a frame are kept
+void FlightRecorderType::AddInput(FlightRecord::Input type, int key, int x, int y)
+{
+	FlightFrameRecord& frame = frames[current];
+
+	if (frame.inputCount < FlightRecord::MAX_INPUTS)
+	{
+		FlightInputEvent& input = frame.inputs[frame.inputCount];
+		input.type = (uint8_t)type;
+		input.key = (uint8_t)key;
+		input.x = (int16_t)x;
+		input.y = (int16_t)y;
+	}
+
+	if (frame.inputCount < 255)
+		frame.inputCount++;
+}
+
+// -----------------------------------------------------------------------------
+// Write the header followed by the recorded frames, oldest first
+bool FlightRecorderType::Dump(const char* fileName)
+{
+	FILE* file = fopen(fileName, "wb");
+	if (file == NULL)
+		return false;
+
+	int oldest = (recorded < FRAME_COUNT) ? 0 : (current + 1) % FRAME_COUNT;
+
+	FlightFileHeader header;
+	memcpy(header.magic, "KJFR", 4);
+	header.version = FlightRecord::VERSION;
+	header.phaseCount = FramePhase::COUNT;
+	header.listCount = FlightRecord::LIST_COUNT;
+	header.maxInputs = FlightRecord::MAX_INPUTS;
+	header.frameCount = (uint32_t)recorded;
+	header.hitchFrame = frames[current].frame;
+	header.budgetMs = budgetMs;
+
+	fwrite(&header, sizeof(header), 1, file);
+
+	if (oldest + recorded <= FRAME_COUNT)
+	{
+		fwrite(&frames[oldest], sizeof(FlightFrameRecord), recorded, file);
+	}
+	else
+	{
+		fwrite(&frames[oldest], sizeof(FlightFrameRecord), FRAME_COUNT - oldest, file); // Wrapped, write the two halves
+		fwrite(&frames[0], sizeof(FlightFrameRecord), current + 1, file);
+	}
+
+	fclose(file);
+
+	dumpCount++;
+	return true;
+}
@@ -0,0 +1,78 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Hitch detector and flight recorder. Keeps a rolling record of the last FRAME_COUNT frames
+// (phase timings, sprite list sizes and the input received) and writes them to a compact
+// binary file whenever a frame takes longer than the budget. Dumps are read back with the
+// FlightDecoder tool.
+//----------------------------------------------------------------------------------------
+
+#include <windows.h>
+#include "FlightRecordFormat.h"
+
+class FlightRecorderType
+{
+	public:
+		// constructor
+		FlightRecorderType();
+
+		// get and set the frame budget in milliseconds, frames longer than this are dumped
+		float GetBudget() const { return budgetMs; }
+		void SetBudget(float ms) { budgetMs = ms; }
+
+		// called at the top of Update. deltaTime is how long the previous frame took, so this
+		// finishes that frame's record, dumps the recorder if it was over budget and starts a new record
+		void BeginFrame(float deltaTime);
+
+		// add time spent in a phase to the current frame
+		void AddPhaseTime(FramePhase::Phase phase, __int64 ticks);
+
+		// record the size of a sprite list for the current frame
+		void SetList(FlightRecord::List list, int count, int capacity);
+
+		// record the game values for the current frame
+		void SetGameState(int score, int lives, int obstacleLevel, int gameState);
+
+		// record an input event for the current frame
+		void AddInput(FlightRecord::Input type, int key, int x, int y);
+
+		// write the recorded frames, oldest first, to a file
+		bool Dump(const char* fileName);
+
+		int GetDumpCount() const { return dumpCount; }
+
+		// read the high resolution counter
+		static __int64 GetTicks() { LARGE_INTEGER t; QueryPerformanceCounter(&t); return t.QuadPart; }
+
+	private:
+		static const int FRAME_COUNT = 300; // Frames kept, about 5 seconds at 60 fps
+
+		FlightFrameRecord frames[FRAME_COUNT]; // Ring buffer of frame records
+		int current; // Index of the frame being recorded
+		int recorded; // Number of valid records, up to FRAME_COUNT
+		unsigned int frameNumber; // Frames since the recorder was created
+
+		float budgetMs;
+		int framesUntilNextDump; // Stops one long stall from writing a dump every frame
+		int dumpCount; // Number of dumps written
+
+		double msPerTick; // Converts counter ticks to milliseconds
+		__int64 renderEndTicks; // When the last Render finished, used to time Present
+};
+
+//----------------------------------------------------------------------------------------
+// Times the enclosing scope and adds it to the current flight recorder frame
+class FlightPhaseScope
+{
+	public:
+		FlightPhaseScope(FlightRecorderType& inRecorder, FramePhase::Phase inPhase) : recorder(inRecorder), phase(inPhase), startTicks(FlightRecorderType::GetTicks()) {}
+		~FlightPhaseScope() { recorder.AddPhaseTime(phase, FlightRecorderType::GetTicks() - startTicks); }
+
+	private:
+		FlightRecorderType& recorder;
+		FramePhase::Phase phase;
+		__int64 startTicks;
+};
+
+#define FLIGHT_CONCAT_INNER(a, b) a##b
+#define FLIGHT_CONCAT(a, b) FLIGHT_CONCAT_INNER(a, b)
+#define RECORD_PHASE(phase) FlightPhaseScope FLIGHT_CONCAT(flightScope, __LINE__)(flightRecorder, FramePhase::phase)
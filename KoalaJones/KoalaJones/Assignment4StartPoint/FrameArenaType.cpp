@@ -0,0 +1,101 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for the per-frame linear arena
+//----------------------------------------------------------------------------------------
+
+#include "FrameArenaType.h"
+
+#include <cstring>
+
+// -----------------------------------------------------------------------------
+// Allocate the arena's block
+FrameArenaType::FrameArenaType(size_t inCapacity)
+{
+	capacity = inCapacity;
+	block = (char*)::operator new(capacity);
+	used = 0;
+	highWater = 0;
+
+	overflowList = NULL;
+	overflowCount = 0;
+	overflowBytes = 0;
+	frameOverflowBytes = 0;
+
+#ifdef _DEBUG
+	memset(block, POISON, capacity);
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Free the block and anything that overflowed
+FrameArenaType::~FrameArenaType()
+{
+	Reset();
+
+	::operator delete(block);
+}
+
+// -----------------------------------------------------------------------------
+// Bump allocate, or fall back to the heap if the block is full
+void* FrameArenaType::Allocate(size_t size, size_t alignment)
+{
+	size_t start = (used + alignment - 1) & ~(alignment - 1); // Round up to the alignment
+
+	if (start + size <= capacity)
+	{
+		used = start + size;
+		if (used + frameOverflowBytes > highWater)
+			highWater = used + frameOverflowBytes;
+
+		return block + start;
+	}
+
+	// Didn't fit
+	Overflow* overflow = (Overflow*)::operator new(OVERFLOW_HEADER + size);
+	overflow->next = overflowList;
+	overflowList = overflow;
+
+	overflowCount++;
+	overflowBytes += size;
+	frameOverflowBytes += size;
+	if (used + frameOverflowBytes > highWater)
+		highWater = used + frameOverflowBytes;
+
+	return (char*)overflow + OVERFLOW_HEADER;
+}
+
+// -----------------------------------------------------------------------------
+// Swap the block for a bigger one, what was in the old one has already been thrown away
+void FrameArenaType::Reserve(size_t size)
+{
+	if (size <= capacity)
+		return;
+
+	Reset();
+	::operator delete(block);
+
+	capacity = size;
+	block = (char*)::operator new(capacity);
+
+#ifdef _DEBUG
+	memset(block, POISON, capacity);
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Release everything allocated this frame
+void FrameArenaType::Reset()
+{
+#ifdef _DEBUG
+	memset(block, POISON, used); // Anything still pointing into the arena reads garbage
+#endif
+
+	used = 0;
+	frameOverflowBytes = 0;
+
+	while (overflowList != NULL)
+	{
+		Overflow* next = overflowList->next;
+		::operator delete(overflowList);
+		overflowList = next;
+	}
+}
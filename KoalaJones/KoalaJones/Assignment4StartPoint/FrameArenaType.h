@@ -0,0 +1,63 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Per-frame linear arena. Allocations are a pointer bump out of one block that is reset
+// once its owner is done with them, such as after each autoplayer layer, so anything
+// allocated from it must not outlive the reset. Requests that don't fit fall back to the
+// heap and are freed on the next reset.
+//----------------------------------------------------------------------------------------
+
+#include <cstddef>
+
+class FrameArenaType
+{
+	public:
+		static const size_t DEFAULT_CAPACITY = 64 * 1024;
+
+		// constructor and destructor
+		FrameArenaType(size_t capacity = DEFAULT_CAPACITY);
+		~FrameArenaType();
+
+		// allocate memory that stays valid until the next Reset
+		void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+		// throw away everything allocated since the last reset
+		void Reset();
+
+		// make the block at least this big, straight after a Reset so nothing points into the old one
+		void Reserve(size_t size);
+
+		// get the amount of memory used this frame and the most ever used in one frame
+		size_t GetUsed() const { return used; }
+		size_t GetHighWater() const { return highWater; }
+		size_t GetCapacity() const { return capacity; }
+
+		// get the number of allocations that didn't fit and went to the heap
+		int GetOverflowCount() const { return overflowCount; }
+		size_t GetOverflowBytes() const { return overflowBytes; }
+
+	private:
+		// heap allocations that didn't fit, chained together so Reset can free them
+		struct Overflow
+		{
+			Overflow* next;
+		};
+
+		// padded so the memory after an Overflow keeps max_align_t alignment
+		static const size_t OVERFLOW_HEADER = (sizeof(Overflow) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+		static const unsigned char POISON = 0xDD; // Written over released memory in debug builds
+
+		char* block;
+		size_t capacity;
+		size_t used;
+		size_t highWater; // Most memory used in a single frame, including overflow
+
+		Overflow* overflowList;
+		int overflowCount; // Overflow allocations since startup
+		size_t overflowBytes; // Overflow bytes since startup
+		size_t frameOverflowBytes; // Overflow bytes this frame, counted towards the high water mark
+
+		// arenas own a block of memory and can't be copied
+		FrameArenaType(const FrameArenaType&);
+		FrameArenaType& operator=(const FrameArenaType&);
+};
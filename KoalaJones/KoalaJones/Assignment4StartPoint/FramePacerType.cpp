@@ -0,0 +1,208 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for the frame pacer
+//----------------------------------------------------------------------------------------
+
+#include "FramePacerType.h"
+#include <cmath>
+
+// -----------------------------------------------------------------------------
+// Pace to 60 fps until told otherwise, with nothing measured yet
+FramePacerType::FramePacerType(ClockType& inClock) : clock(inClock)
+{
+	pacing = true;
+	period = ClockType::NANOSECONDS_PER_SECOND / 60;
+
+	frameStart = 0;
+	simEnd = 0;
+	renderEnd = 0;
+	rendered = false;
+	deadline = 0;
+	lastFrameEnd = 0;
+	started = false;
+	paced = false;
+
+	frameCount = 0;
+	predictedSim = 0;
+	predictedRender = 0;
+	lastWait = 0;
+	missed = 0;
+
+	inputWaitTotal = 0;
+	inputCount = 0;
+	lastInputToPresent = 0;
+	inputFrames = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Change the time between presents, the next deadline follows on from the last at the new period
+void FramePacerType::SetTargetFps(float fps)
+{
+	if (fps > 0)
+		period = int64_t(double(ClockType::NANOSECONDS_PER_SECOND) / fps);
+}
+
+// -----------------------------------------------------------------------------
+// Measure the frame that just presented, then hold this one back until the latest start
+// that still meets its deadline
+void FramePacerType::BeginFrame()
+{
+	int64_t now = clock.Now();
+
+	if (started)
+	{
+		// Sim ran from the frame's start to EndSim, render from there to EndRender, or to here, just after
+		// Present, if it wasn't called
+		int slot = frameCount % HISTORY;
+		simCosts[slot] = simEnd - frameStart;
+		renderCosts[slot] = (rendered ? renderEnd : now) - simEnd;
+		frameTimes[slot] = now - lastFrameEnd;
+		frameCount++;
+
+		// Present returns just after the flip, a frame that missed it is a whole flip late
+		if (paced && now > deadline + MARGIN)
+			missed++;
+
+		// The inputs the frame applied have been presented now
+		if (inputCount > 0)
+		{
+			lastInputToPresent = now - frameStart + inputWaitTotal / inputCount;
+			inputLatencies[inputFrames % HISTORY] = lastInputToPresent;
+			inputFrames++;
+
+			inputWaitTotal = 0;
+			inputCount = 0;
+		}
+
+		predictedSim = Predict(simCosts);
+		predictedRender = Predict(renderCosts);
+	}
+
+	lastFrameEnd = now;
+	lastWait = 0;
+
+	paced = pacing && started;
+	if (paced)
+	{
+		int64_t work = predictedSim + predictedRender + MARGIN;
+
+		// Present a period after the last deadline, so the rate holds steady. If this frame can't
+		// make that, or the deadline is stale from pacing being off, start again from the flip
+		// after the one the last frame just presented on, or as soon as the frame can be done
+		deadline += period;
+		if (deadline < now + work || deadline > now + work + period)
+			deadline = now + (work > period ? work : period);
+
+		WaitUntil(deadline - work);
+		lastWait = clock.Now() - now;
+	}
+
+	started = true;
+	frameStart = clock.Now();
+	simEnd = frameStart; // In case EndSim isn't called, the whole frame counts as render
+	rendered = false;
+}
+
+// -----------------------------------------------------------------------------
+// Note where the sim ended
+void FramePacerType::EndSim()
+{
+	simEnd = clock.Now();
+}
+
+// -----------------------------------------------------------------------------
+// Note where the drawing ended, the time after it until the next BeginFrame is Present
+void FramePacerType::EndRender()
+{
+	renderEnd = clock.Now();
+	rendered = true;
+}
+
+// -----------------------------------------------------------------------------
+// Keep how long the input had already waited when the frame started, its latency is finished off once the frame presents
+void FramePacerType::AddInput(int64_t arrival)
+{
+	inputWaitTotal += frameStart - arrival;
+	inputCount++;
+}
+
+// -----------------------------------------------------------------------------
+// Sleep for all but the last stretch of the wait, where the sleep could overshoot, then spin out the rest
+void FramePacerType::WaitUntil(int64_t time)
+{
+	int64_t sleep = time - clock.Now() - clock.GetSleepSlack();
+	if (sleep > 0)
+		clock.Sleep(sleep);
+
+	clock.SpinUntil(time);
+}
+
+// -----------------------------------------------------------------------------
+// Take the second highest of the recent costs, so one spike can't make every frame start early
+// but the next frame still comes in under the prediction almost every time
+int64_t FramePacerType::Predict(const int64_t* costs) const
+{
+	int count = GetHistoryCount();
+
+	int64_t highest = 0, second = 0;
+	for (int i = 0; i < count; i++)
+	{
+		if (costs[i] > highest)
+		{
+			second = highest;
+			highest = costs[i];
+		}
+		else if (costs[i] > second)
+			second = costs[i];
+	}
+
+	return count < 2 ? highest : second;
+}
+
+// -----------------------------------------------------------------------------
+// Average the recent frame times
+double FramePacerType::GetMeanFrameMs() const
+{
+	int count = GetHistoryCount();
+	if (count == 0)
+		return 0;
+
+	double total = 0;
+	for (int i = 0; i < count; i++)
+		total += double(frameTimes[i]);
+
+	return total / count / double(ClockType::NANOSECONDS_PER_MILLISECOND);
+}
+
+// -----------------------------------------------------------------------------
+// Standard deviation of the recent frame times
+double FramePacerType::GetJitterMs() const
+{
+	int count = GetHistoryCount();
+	if (count < 2)
+		return 0;
+
+	double mean = GetMeanFrameMs();
+	double total = 0;
+	for (int i = 0; i < count; i++)
+	{
+		double difference = ToMs(frameTimes[i]) - mean;
+		total += difference * difference;
+	}
+
+	return sqrt(total / count);
+}
+
+// -----------------------------------------------------------------------------
+// Average the recent input to present latencies
+double FramePacerType::GetMeanInputToPresentMs() const
+{
+	int count = inputFrames < HISTORY ? inputFrames : HISTORY;
+	if (count == 0)
+		return 0;
+
+	double total = 0;
+	for (int i = 0; i < count; i++)
+		total += double(inputLatencies[i]);
+
+	return total / count / double(ClockType::NANOSECONDS_PER_MILLISECOND);
+}
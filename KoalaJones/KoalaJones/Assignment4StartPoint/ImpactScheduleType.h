@@ -0,0 +1,106 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Predictive collision scheduling. Every obstacle moves along one axis by a fixed step
+// each tick, so the first tick its box can touch the koala's box can be worked out when it
+// spawns. That tick goes into a min-heap of events. Each frame only the events that are
+// due get looked at, so the collision cost is the number of events due rather than the
+// number of obstacles.
+//
+// A due event is checked with a swept test over the tick that just ran. The test asks
+// whether a corner of the obstacle's box crossed the koala's box at any point during the
+// move, not only where it ended up. Fast obstacles can't step over the koala between two
+// frames. If the check misses, the event is worked out again from where the obstacle is
+// now, so rounding in the prediction can only ever make it look early, never late.
+//
+// Snakes reverse once at their end point. Until they have, their event is capped at the
+// earliest tick they could reach it, and the snake is looked at again then.
+//
+// When the koala's box changes (Move, or knockback from a hit) every event is worked out
+// again from scratch, starting with the move that has just happened.
+//
+// When the narrow phase tests the drawn shapes, events are for the obstacle's reach
+// overlapping the koala's box. A due event that overlaps is then handed to the narrow
+// phase at points back along the tick's move, at most SAMPLE_PIXELS apart, so a dart that
+// passed through the koala during the tick still hits. Each point uses the rotation the
+// obstacle has now. One that doesn't touch yet is looked at again next tick.
+//----------------------------------------------------------------------------------------
+
+#include <vector>
+#include "EntityWorldType.h"
+#include "ObstacleSystemsType.h"
+
+class ImpactScheduleType
+{
+	public:
+		static const int SAMPLE_PIXELS = 4; // Furthest apart the narrow phase is asked along a move
+
+		// constructor
+		ImpactScheduleType();
+
+		// drop every event, the next FindHit rebuilds them from the world
+		void Clear();
+
+		// set the koala's box, every event is rebuilt on the next FindHit if it has changed
+		void SetPlayerBox(const PlayerBox& inPlayer);
+
+		// set the narrow phase due events are checked with, NULL for the swept boxes alone. Clear after
+		// changing it or its mode
+		void SetNarrowPhase(NarrowPhaseType* inNarrowPhase) { narrowPhase = inNarrowPhase; }
+
+		// work out when a new obstacle can first touch the koala, call once it is in place
+		void Schedule(EntityWorldType& world, Entity entity);
+
+		// count a tick of obstacle movement, call once after every ObstacleSystemsType::Move
+		void AdvanceTick() { tick++; }
+
+		// look at the events due this tick, returns the first obstacle that touched the koala
+		bool FindHit(EntityWorldType& world, ObstacleHit& hit);
+
+		int GetEventCount() const { return int(events.size()); }
+		int GetEventsChecked() const { return eventsChecked; } // Due events looked at by the last FindHit
+
+	private:
+		struct ImpactEvent
+		{
+			unsigned int tick;
+			Entity entity;
+			float stepX, stepY; // The move the obstacle makes each tick, as it was when scheduled
+		};
+
+		// the heap's order, soonest first with ties in entity order
+		struct Later
+		{
+			bool operator()(const ImpactEvent& a, const ImpactEvent& b) const
+			{
+				return a.tick != b.tick ? a.tick > b.tick : a.entity.index > b.entity.index;
+			}
+		};
+
+		std::vector<ImpactEvent> events; // Min-heap on tick
+		unsigned int tick; // Moves so far
+		PlayerBox player;
+		NarrowPhaseType* narrowPhase;
+		bool playerSet;
+		bool rebuild; // Every event needs working out again
+		int eventsChecked;
+
+		// schedule every obstacle in the world
+		void Rebuild(EntityWorldType& world);
+
+		// work out the event for an obstacle and add it, without fixing the heap. patrol is NULL for kinds that
+		// don't reverse. firstTick is 0 to include the move that has just happened, 1 to start with the next
+		void Add(Entity entity, EntityKind::Kind kind, const TransformComponent& transform, const MotionComponent& motion,
+			const ColliderComponent& collider, const PatrolComponent* patrol, int firstTick);
+
+		// did the obstacle's box touch the koala's box, grown by pad on every side, while it moved by step to get to x, y
+		bool SweptHit(float x, float y, float halfWidth, float halfHeight, float pad, float stepX, float stepY) const;
+
+		// does the drawn shape touch the koala anywhere along the move by step that ended where it is now
+		bool TouchesAlongStep(const TransformComponent& transform, const RenderComponent& render, float stepX, float stepY) const;
+
+		// get the obstacle's box and how far to grow the koala's, a point and the reach for the drawn shapes
+		void GetExtent(const ColliderComponent& collider, float& halfWidth, float& halfHeight, float& pad) const;
+
+		// first tick from now, firstTick or later, that a box at p moving by step along an axis crosses [low, high]. Returns -1 if it never does
+		static double FirstCrossing(float p, float halfSize, float step, float low, float high, int firstTick);
+};
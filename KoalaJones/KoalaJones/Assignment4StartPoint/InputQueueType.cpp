@@ -0,0 +1,84 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for the input queue
+//----------------------------------------------------------------------------------------
+
+#include "InputQueueType.h"
+
+static_assert((InputQueueType::CAPACITY & (InputQueueType::CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+// -----------------------------------------------------------------------------
+// Start empty
+InputQueueType::InputQueueType()
+{
+	writeIndex.store(0, std::memory_order_relaxed);
+	readIndex.store(0, std::memory_order_relaxed);
+	dropped.store(0, std::memory_order_relaxed);
+
+	lastLatencyMs = 0;
+	maxLatencyMs = 0;
+	appliedCount = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Write the event into the slot after the last one, then publish it by moving the write index on
+bool InputQueueType::Push(const InputEvent& event)
+{
+	uint32_t write = writeIndex.load(std::memory_order_relaxed);
+	uint32_t read = readIndex.load(std::memory_order_acquire); // The consumer has finished with every slot before it
+
+	if (write - read == CAPACITY)
+	{
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	events[write & (CAPACITY - 1)] = event;
+	writeIndex.store(write + 1, std::memory_order_release);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Copy the oldest event out, then hand its slot back by moving the read index on
+bool InputQueueType::Pop(InputEvent& event)
+{
+	uint32_t read = readIndex.load(std::memory_order_relaxed);
+	uint32_t write = writeIndex.load(std::memory_order_acquire); // Every event before it has been written
+
+	if (read == write)
+		return false;
+
+	event = events[read & (CAPACITY - 1)];
+	readIndex.store(read + 1, std::memory_order_release);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Work out how long the event waited and keep it with the recent ones
+void InputQueueType::MarkApplied(const InputEvent& event, int64_t appliedTime)
+{
+	double latency = double(appliedTime - event.timestamp) / 1000000.0;
+
+	lastLatencyMs = latency;
+	if (latency > maxLatencyMs)
+		maxLatencyMs = latency;
+
+	latencySamples[appliedCount % LATENCY_SAMPLES] = float(latency);
+	appliedCount++;
+}
+
+// -----------------------------------------------------------------------------
+// Average the recent latencies
+double InputQueueType::GetMeanLatencyMs() const
+{
+	int count = appliedCount < LATENCY_SAMPLES ? appliedCount : LATENCY_SAMPLES;
+	if (count == 0)
+		return 0;
+
+	double total = 0;
+	for (int i = 0; i < count; i++)
+		total += latencySamples[i];
+
+	return total / count;
+}
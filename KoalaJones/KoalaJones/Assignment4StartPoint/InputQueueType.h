@@ -0,0 +1,68 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Wait-free single producer, single consumer queue of input events. The window thread
+// pushes each mouse and key event with the time it arrived. The sim pops them at the start
+// of its tick and applies them there, so nothing the message handler does touches the
+// game directly and the sim could run on a thread of its own.
+//
+// The ring holds a power of two events. The write index is only stored by the producer and
+// the read index only by the consumer, each on its own cache line. A full ring drops the
+// new event and counts it rather than waiting.
+//
+// The consumer also keeps the input latency: the time from an event arriving to the tick
+// that applied it. Timestamps are nanoseconds on a ClockType, the same clock the frame
+// pacer reads.
+//----------------------------------------------------------------------------------------
+
+#include <atomic>
+#include <cstdint>
+#include "FlightRecordFormat.h"
+
+// one mouse or key event, as the window thread saw it
+struct InputEvent
+{
+	FlightRecord::Input type;
+	int key; // Virtual key for KeyUp events
+	int x, y; // Mouse position for mouse events
+	int64_t timestamp; // Clock time in nanoseconds when the message arrived
+};
+
+class InputQueueType
+{
+	public:
+		static const uint32_t CAPACITY = 256; // Must be a power of two
+		static const int LATENCY_SAMPLES = 64; // Recent latencies the mean is taken over
+
+		// constructor
+		InputQueueType();
+
+		// add an event, producer only. Returns false and counts the event if the ring is full
+		bool Push(const InputEvent& event);
+
+		// take the oldest event, consumer only. Returns false once the ring is empty
+		bool Pop(InputEvent& event);
+
+		// record that the sim has applied an event at this clock time, consumer only
+		void MarkApplied(const InputEvent& event, int64_t appliedTime);
+
+		// get the latency of the last event applied, the mean of the recent ones and the worst so far, in milliseconds
+		double GetLastLatencyMs() const { return lastLatencyMs; }
+		double GetMeanLatencyMs() const;
+		double GetMaxLatencyMs() const { return maxLatencyMs; }
+
+		int GetAppliedCount() const { return appliedCount; }
+		int GetDroppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+	private:
+		alignas(64) std::atomic<uint32_t> writeIndex; // Events pushed so far, wraps
+		alignas(64) std::atomic<uint32_t> readIndex; // Events popped so far, wraps
+		std::atomic<int> dropped;
+
+		alignas(64) InputEvent events[CAPACITY];
+
+		// consumer side latency, only touched by the sim
+		double lastLatencyMs;
+		double maxLatencyMs;
+		float latencySamples[LATENCY_SAMPLES];
+		int appliedCount;
+};
@@ -0,0 +1,394 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for the work-stealing job system and job graphs
+//----------------------------------------------------------------------------------------
+
+#include "JobSystemType.h"
+#include "TraceType.h"
+#include "AllocTrackerType.h"
+
+static thread_local int threadIndex = 0; // 0 for the thread that owns the job system
+
+static void Lock(std::atomic_flag& lock)
+{
+	while (lock.test_and_set(std::memory_order_acquire))
+		; // Only ever held for a few instructions
+}
+
+static void Unlock(std::atomic_flag& lock)
+{
+	lock.clear(std::memory_order_release);
+}
+
+// -----------------------------------------------------------------------------
+// Add a job at the back, fails if the deque is full
+bool JobSystemType::Deque::PushBack(Job* job)
+{
+	Lock(lock);
+
+	bool pushed = tail - head < CAPACITY;
+	if (pushed)
+		jobs[tail++ % CAPACITY] = job;
+
+	Unlock(lock);
+	return pushed;
+}
+
+// -----------------------------------------------------------------------------
+// Take the newest job, used by the owning thread
+JobSystemType::Job* JobSystemType::Deque::PopBack()
+{
+	Lock(lock);
+
+	Job* job = NULL;
+	if (tail > head)
+		job = jobs[--tail % CAPACITY];
+
+	if (head == tail)
+		head = tail = 0; // Keep the counters small
+
+	Unlock(lock);
+	return job;
+}
+
+// -----------------------------------------------------------------------------
+// Take the oldest job, used by other threads stealing
+JobSystemType::Job* JobSystemType::Deque::PopFront()
+{
+	Lock(lock);
+
+	Job* job = NULL;
+	if (tail > head)
+		job = jobs[head++ % CAPACITY];
+
+	if (head == tail)
+		head = tail = 0;
+
+	Unlock(lock);
+	return job;
+}
+
+// -----------------------------------------------------------------------------
+// Nothing runs until Start
+JobSystemType::JobSystemType() : threadCount(1), running(false), enabled(true), queued(0), sleeping(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+// Join the workers
+JobSystemType::~JobSystemType()
+{
+	Stop();
+}
+
+// -----------------------------------------------------------------------------
+// Start the worker threads
+void JobSystemType::Start(int workerCount)
+{
+	Stop();
+
+	if (workerCount < 0)
+		workerCount = int(std::thread::hardware_concurrency()) - 1;
+	if (workerCount > MAX_WORKERS)
+		workerCount = MAX_WORKERS;
+
+	running = true;
+	threadCount = workerCount + 1;
+
+	for (int i = 0; i < workerCount; i++)
+		workers.push_back(std::thread(&JobSystemType::WorkerLoop, this, i + 1));
+}
+
+// -----------------------------------------------------------------------------
+// Wake the workers and wait for them to finish
+void JobSystemType::Stop()
+{
+	if (!running)
+		return;
+
+	{
+		std::lock_guard<std::mutex> guard(sleepLock);
+		running = false;
+	}
+	wake.notify_all();
+
+	for (size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+
+	workers.clear();
+	threadCount = 1;
+}
+
+// -----------------------------------------------------------------------------
+// Run jobs until told to stop, sleeping when there is nothing to do
+void JobSystemType::WorkerLoop(int index)
+{
+	threadIndex = index;
+#ifdef ALLOC_TRACKING_ENABLED
+	AllocTrackerType::JoinSteadyState(); // Frame tasks run here, so their allocations count as the frame's
+#endif
+
+	while (running)
+	{
+		if (RunOne())
+			continue;
+
+		// Spin for a moment before sleeping, jobs tend to arrive in bursts
+		for (int spin = 0; spin < 64 && queued == 0 && running; spin++)
+			std::this_thread::yield();
+
+		if (queued > 0)
+			continue;
+
+		sleeping++;
+		{
+			std::unique_lock<std::mutex> guard(sleepLock);
+			wake.wait(guard, [this] { return queued > 0 || !running; });
+		}
+		sleeping--;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Get the calling thread's index
+int JobSystemType::GetThreadIndex()
+{
+	return threadIndex;
+}
+
+// -----------------------------------------------------------------------------
+// Queue a job on the calling thread's deque and wake a worker to steal it
+void JobSystemType::Push(Job* job)
+{
+	if (!deques[threadIndex].PushBack(job))
+	{
+		// Deque is full, just run it here
+		std::atomic<int>* pending = job->pending;
+		job->function(*job);
+		if (pending != NULL)
+			pending->fetch_sub(1, std::memory_order_release);
+		return;
+	}
+
+	queued++;
+
+	if (sleeping > 0)
+	{
+		std::lock_guard<std::mutex> guard(sleepLock);
+		wake.notify_one();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Pop a job from this thread's deque, or steal one, and run it
+bool JobSystemType::RunOne()
+{
+	Job* job = deques[threadIndex].PopBack();
+
+	for (int i = 1; i < threadCount && job == NULL; i++)
+		job = deques[(threadIndex + i) % threadCount].PopFront();
+
+	if (job == NULL)
+		return false;
+
+	queued--;
+
+	std::atomic<int>* pending = job->pending; // The job can be gone once pending is decremented
+	job->function(*job);
+	if (pending != NULL)
+		pending->fetch_sub(1, std::memory_order_release);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Help run jobs until the counter reaches 0
+void JobSystemType::WaitFor(std::atomic<int>& pending)
+{
+	while (pending.load(std::memory_order_acquire) > 0)
+	{
+		if (!RunOne())
+			std::this_thread::yield();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Run one ParallelFor piece
+void JobSystemType::RunRange(Job& job)
+{
+	RangeContext* context = (RangeContext*)job.context;
+	context->function(context->userFunction, job.begin, job.end);
+}
+
+// -----------------------------------------------------------------------------
+// Split a range into pieces, queue all but the first, run the first here and help with the rest
+void JobSystemType::RunRanges(int count, int grain, void (*function)(void*, int, int), void* userFunction)
+{
+	if (count <= 0)
+		return;
+	if (grain < 1)
+		grain = 1;
+
+	int pieces = (count + grain - 1) / grain;
+	if (pieces > (GetWorkerCount() + 1) * 4) // A few pieces per thread lets stealing even out uneven pieces
+		pieces = (GetWorkerCount() + 1) * 4;
+	if (pieces > MAX_RANGES)
+		pieces = MAX_RANGES;
+
+	if (!enabled || threadCount == 1 || pieces <= 1)
+	{
+		function(userFunction, 0, count); // Serial path
+		return;
+	}
+
+	RangeContext context = { function, userFunction };
+	Job jobs[MAX_RANGES];
+	std::atomic<int> pending(pieces);
+
+	for (int i = 0; i < pieces; i++)
+	{
+		jobs[i].function = &JobSystemType::RunRange;
+		jobs[i].context = &context;
+		jobs[i].begin = int((long long)count * i / pieces);
+		jobs[i].end = int((long long)count * (i + 1) / pieces);
+		jobs[i].pending = &pending;
+	}
+
+	for (int i = pieces - 1; i >= 1; i--)
+		Push(&jobs[i]);
+
+	RunRange(jobs[0]);
+	pending--;
+
+	WaitFor(pending);
+}
+
+// -----------------------------------------------------------------------------
+// Start with no tasks
+JobGraphType::JobGraphType() : jobSystem(NULL), tasksLeft(0)
+{
+	mainLock.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Free the tasks
+JobGraphType::~JobGraphType()
+{
+	for (size_t i = 0; i < tasks.size(); i++)
+		delete tasks[i];
+}
+
+// -----------------------------------------------------------------------------
+// Add a task with no dependencies yet
+int JobGraphType::AddTask(const char* name, Affinity affinity, TaskFunction function, void* context)
+{
+	Task* task = new Task;
+	task->name = name;
+	task->affinity = affinity;
+	task->function = function;
+	task->context = context;
+	task->dependencyCount = 0;
+	task->remaining = 0;
+	task->graph = this;
+
+	task->job.function = &JobGraphType::RunTask;
+	task->job.context = task;
+	task->job.begin = 0;
+	task->job.end = 0;
+	task->job.pending = NULL;
+
+	tasks.push_back(task);
+	mainReady.reserve(tasks.size()); // Run never allocates
+
+	return int(tasks.size()) - 1;
+}
+
+// -----------------------------------------------------------------------------
+// Make one task wait for another
+void JobGraphType::AddDependency(int before, int after)
+{
+	tasks[before]->dependents.push_back(after);
+	tasks[after]->dependencyCount++;
+}
+
+// -----------------------------------------------------------------------------
+// Start the tasks with no dependencies, then run main thread tasks and help with the rest until all are done
+void JobGraphType::Run(JobSystemType& jobs)
+{
+	jobSystem = &jobs;
+	tasksLeft = int(tasks.size());
+
+	for (size_t i = 0; i < tasks.size(); i++)
+		tasks[i]->remaining = tasks[i]->dependencyCount;
+
+	for (size_t i = 0; i < tasks.size(); i++)
+	{
+		if (tasks[i]->dependencyCount == 0)
+			Ready(*tasks[i]);
+	}
+
+	while (tasksLeft > 0)
+	{
+		Task* task = NULL;
+
+		Lock(mainLock);
+		if (!mainReady.empty())
+		{
+			task = mainReady.back();
+			mainReady.pop_back();
+		}
+		Unlock(mainLock);
+
+		if (task != NULL)
+		{
+			TRACE_SCOPE("jobs", task->name);
+			task->function(task->context);
+			Finish(*task);
+		}
+		else if (!jobs.RunOne())
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Queue a task whose dependencies have all finished
+void JobGraphType::Ready(Task& task)
+{
+	if (task.affinity == MainThread || !jobSystem->IsEnabled())
+	{
+		Lock(mainLock);
+		mainReady.push_back(&task);
+		Unlock(mainLock);
+	}
+	else
+	{
+		jobSystem->Push(&task.job);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Release the tasks waiting on this one, then count it as done
+void JobGraphType::Finish(Task& task)
+{
+	for (size_t i = 0; i < task.dependents.size(); i++)
+	{
+		Task& dependent = *tasks[task.dependents[i]];
+
+		if (--dependent.remaining == 0)
+			Ready(dependent);
+	}
+
+	tasksLeft--; // Last, so Run can't return before the dependents are queued
+}
+
+// -----------------------------------------------------------------------------
+// Run an AnyThread task on whichever thread picked it up
+void JobGraphType::RunTask(JobSystemType::Job& job)
+{
+	Task& task = *(Task*)job.context;
+
+	TRACE_SCOPE("jobs", task.name);
+	task.function(task.context);
+	task.graph->Finish(task);
+}
@@ -0,0 +1,177 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Work-stealing job system. Each thread has its own deque of jobs. A thread pushes and
+// pops at the back of its own deque (newest first). When its deque is empty it steals from
+// the front of another thread's deque (oldest first, the biggest pieces of work). The
+// thread that created the system is thread 0 and helps run jobs while it waits.
+//
+// ParallelFor splits a range into contiguous pieces and returns once every piece has run.
+// JobGraphType runs a set of tasks in dependency order, see below.
+//
+// When disabled, or started with no workers, every job runs on the calling thread in
+// order. That is the serial path, and the parallel path has to give the same results.
+// That works because jobs only ever write to their own part of the output.
+//----------------------------------------------------------------------------------------
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystemType
+{
+	public:
+		// a piece of work, begin and end are the range for ParallelFor pieces
+		struct Job
+		{
+			void (*function)(Job& job);
+			void* context;
+			int begin, end;
+			std::atomic<int>* pending; // Decremented once the job has run, can be NULL
+		};
+
+		static const int MAX_WORKERS = 31;
+		static const int MAX_RANGES = 256; // Most pieces a ParallelFor is split into
+
+		// constructor and destructor
+		JobSystemType();
+		~JobSystemType();
+
+		// start the worker threads, -1 uses one per core less the calling thread
+		void Start(int workerCount = -1);
+		void Stop();
+
+		int GetWorkerCount() const { return threadCount - 1; }
+
+		// get and set whether jobs are spread across the workers or all run on the calling thread
+		bool IsEnabled() const { return enabled; }
+		void SetEnabled(bool inEnabled) { enabled = inEnabled; }
+
+		// run function(begin, end) over [0, count) in pieces of at least grain, returns when they have all run
+		template <class Function>
+		void ParallelFor(int count, int grain, Function function)
+		{
+			RunRanges(count, grain, &InvokeRange<Function>, &function);
+		}
+
+		// queue a job on the calling thread's deque
+		void Push(Job* job);
+
+		// run one queued job, from this thread's deque or stolen from another. Returns false if there were none
+		bool RunOne();
+
+		// run jobs until pending reaches 0
+		void WaitFor(std::atomic<int>& pending);
+
+		// index of the calling thread, 0 for the thread that started the system
+		static int GetThreadIndex();
+
+	private:
+		// one thread's jobs, guarded by a spin lock as it is only held for a few instructions
+		struct Deque
+		{
+			static const int CAPACITY = 1024;
+
+			std::atomic_flag lock;
+			Job* jobs[CAPACITY];
+			int head; // Oldest job, stolen from here
+			int tail; // One past the newest job, the owner pushes and pops here
+
+			Deque() : head(0), tail(0) { lock.clear(); }
+
+			bool PushBack(Job* job);
+			Job* PopBack();
+			Job* PopFront();
+		};
+
+		struct RangeContext
+		{
+			void (*function)(void* function, int begin, int end);
+			void* userFunction;
+		};
+
+		Deque deques[MAX_WORKERS + 1];
+		std::vector<std::thread> workers;
+		int threadCount; // Workers plus the owning thread, set before the workers start so they never read workers
+
+		std::atomic<bool> running;
+		std::atomic<bool> enabled;
+		std::atomic<int> queued; // Jobs pushed but not yet taken
+
+		std::mutex sleepLock;
+		std::condition_variable wake;
+		std::atomic<int> sleeping;
+
+		void WorkerLoop(int index);
+		void RunRanges(int count, int grain, void (*function)(void*, int, int), void* userFunction);
+
+		static void RunRange(Job& job);
+
+		template <class Function>
+		static void InvokeRange(void* function, int begin, int end) { (*(Function*)function)(begin, end); }
+
+		// job systems own threads and can't be copied
+		JobSystemType(const JobSystemType&);
+		JobSystemType& operator=(const JobSystemType&);
+};
+
+//----------------------------------------------------------------------------------------
+// A fixed set of tasks with dependencies between them, built once and run every frame.
+// A task starts once every task it depends on has finished. MainThread tasks only run on
+// the thread that calls Run. Use it for anything that isn't thread safe, or that must
+// happen on one thread to stay deterministic, such as anything calling rand().
+class JobGraphType
+{
+	public:
+		enum Affinity { AnyThread, MainThread };
+
+		typedef void (*TaskFunction)(void* context);
+
+		// constructor and destructor
+		JobGraphType();
+		~JobGraphType();
+
+		// add a task, returns its id for AddDependency
+		int AddTask(const char* name, Affinity affinity, TaskFunction function, void* context);
+
+		// after can't start until before has finished
+		void AddDependency(int before, int after);
+
+		// run every task, returns once they have all finished. Must be called on the main thread
+		void Run(JobSystemType& jobs);
+
+	private:
+		struct Task
+		{
+			const char* name;
+			Affinity affinity;
+			TaskFunction function;
+			void* context;
+
+			std::vector<int> dependents;
+			int dependencyCount;
+			std::atomic<int> remaining; // Dependencies still running this time round
+
+			JobSystemType::Job job;
+			JobGraphType* graph;
+		};
+
+		std::vector<Task*> tasks;
+
+		JobSystemType* jobSystem;
+		std::atomic<int> tasksLeft;
+
+		// MainThread tasks that are ready to run
+		std::atomic_flag mainLock;
+		std::vector<Task*> mainReady;
+
+		void Ready(Task& task);
+		void Finish(Task& task);
+
+		static void RunTask(JobSystemType::Job& job);
+
+		// graphs own their tasks and can't be copied
+		JobGraphType(const JobGraphType&);
+		JobGraphType& operator=(const JobGraphType&);
+};
@@ -0,0 +1,338 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for the per-lane obstacle index
+//----------------------------------------------------------------------------------------
+
+#include "LaneIndexType.h"
+#include "AllocTrackerType.h"
+
+#include <cfloat>
+#include <cmath>
+
+// -----------------------------------------------------------------------------
+// No lanes until SetLanes
+LaneIndexType::LaneIndexType()
+{
+	laneCount = 0;
+	halfWidth = 0;
+	Clear();
+}
+
+// -----------------------------------------------------------------------------
+// Keep the lane table, anything already indexed was sorted onto the old lanes
+void LaneIndexType::SetLanes(const int* inLaneX, int inLaneCount, float inHalfWidth)
+{
+	laneCount = inLaneCount < MAX_LANES ? inLaneCount : MAX_LANES;
+	for (int lane = 0; lane < laneCount; lane++)
+		laneX[lane] = inLaneX[lane];
+
+	halfWidth = inHalfWidth;
+	Clear();
+}
+
+// -----------------------------------------------------------------------------
+// Empty every list, they keep their capacity for the next game
+void LaneIndexType::Clear()
+{
+	for (int lane = 0; lane < MAX_LANES; lane++)
+	{
+		lanes[lane].clear();
+		maxStep[lane] = 0;
+		maxHalfHeight[lane] = 0;
+		occupancy[lane] = 0;
+	}
+
+	crossers.clear();
+	maxCrosserHalfHeight = 0;
+	laneMask = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Insert a new obstacle in y order on its lane, or in the crossing list. The bounds and
+// bits only take it in at the next Update, so it counts from the first tick it moves
+void LaneIndexType::Add(EntityWorldType& world, Entity entity)
+{
+	if (!world.IsAlive(entity) || world.GetKind(entity) >= OBSTACLE_KIND_COUNT)
+		return;
+
+	ALLOC_TAG(Sprites);
+
+	Interval interval;
+	interval.entity = entity;
+	Read(world, interval);
+
+	std::vector<Interval>* list = &crossers;
+	if (obstacleTraits[interval.kind].axis == ObstacleRule::Vertical)
+	{
+		int lane = FindLane(interval.x);
+		if (lane < 0)
+			return; // Not on a vine, nothing asks about it
+
+		list = &lanes[lane];
+	}
+
+	// After any with the same y, so obstacles spawned together stay in spawn order
+	int index = LowerBound(*list, interval.y);
+	while (index < int(list->size()) && (*list)[index].y == interval.y)
+		index++;
+
+	list->insert(list->begin() + index, interval);
+}
+
+// -----------------------------------------------------------------------------
+// Refresh each list from the world in one pass, dropping the dead, then fix its order and
+// rebuild the bounds and occupancy bits from it
+void LaneIndexType::Update(EntityWorldType& world)
+{
+	laneMask = 0;
+
+	for (int lane = 0; lane < laneCount; lane++)
+	{
+		std::vector<Interval>& list = lanes[lane];
+
+		int kept = 0;
+		for (int i = 0; i < int(list.size()); i++)
+		{
+			if (Read(world, list[i]))
+				list[kept++] = list[i];
+		}
+		list.resize(kept);
+
+		Sort(list);
+
+		maxStep[lane] = 0;
+		maxHalfHeight[lane] = 0;
+		occupancy[lane] = 0;
+
+		for (int i = 0; i < kept; i++)
+		{
+			float step = fabsf(list[i].step);
+			if (step > maxStep[lane])
+				maxStep[lane] = step;
+			if (list[i].halfHeight > maxHalfHeight[lane])
+				maxHalfHeight[lane] = list[i].halfHeight;
+
+			Mark(lane, list[i].y - list[i].halfHeight, list[i].y + list[i].halfHeight);
+		}
+	}
+
+	int kept = 0;
+	for (int i = 0; i < int(crossers.size()); i++)
+	{
+		if (Read(world, crossers[i]))
+			crossers[kept++] = crossers[i];
+	}
+	crossers.resize(kept);
+
+	Sort(crossers); // Darts don't move in y, this only places ones that were added out of order
+
+	maxCrosserHalfHeight = 0;
+	for (int i = 0; i < kept; i++)
+	{
+		const Interval& crosser = crossers[i];
+		if (crosser.halfHeight > maxCrosserHalfHeight)
+			maxCrosserHalfHeight = crosser.halfHeight;
+
+		// Every lane the dart is over right now
+		for (int lane = 0; lane < laneCount; lane++)
+		{
+			if (fabsf(crosser.x - laneX[lane]) <= crosser.halfWidth + halfWidth)
+				Mark(lane, crosser.y - crosser.halfHeight, crosser.y + crosser.halfHeight);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Find the lane whose x is closest, as long as it is within the lane's half width
+int LaneIndexType::FindLane(float x) const
+{
+	int closest = -1;
+	float closestDistance = halfWidth;
+
+	for (int lane = 0; lane < laneCount; lane++)
+	{
+		float distance = fabsf(x - laneX[lane]);
+		if (distance <= closestDistance)
+		{
+			closest = lane;
+			closestDistance = distance;
+		}
+	}
+
+	return closest;
+}
+
+// -----------------------------------------------------------------------------
+// The one before the first at or below y is the nearest above
+bool LaneIndexType::FindAbove(int lane, float y, LaneThreat& threat) const
+{
+	int index = LowerBound(lanes[lane], y) - 1;
+	if (index < 0)
+		return false;
+
+	MakeThreat(lanes[lane][index], y, threat);
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// The first at or below y is the nearest below
+bool LaneIndexType::FindBelow(int lane, float y, LaneThreat& threat) const
+{
+	int index = LowerBound(lanes[lane], y);
+	if (index == int(lanes[lane].size()))
+		return false;
+
+	MakeThreat(lanes[lane][index], y, threat);
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Only obstacles that could cover the distance at the lane's fastest speed are looked at,
+// they are found with a binary search either side of the range
+bool LaneIndexType::IsSafe(int lane, float top, float bottom, float ticks) const
+{
+	const std::vector<Interval>& list = lanes[lane];
+	float reach = maxStep[lane] * ticks + maxHalfHeight[lane];
+
+	int end = int(list.size());
+	for (int i = LowerBound(list, top - reach); i < end && list[i].y <= bottom + reach; i++)
+	{
+		if (ArrivalAlong(list[i], top, bottom) <= ticks)
+			return false;
+	}
+
+	// Darts only move sideways, so only ones already level with the range can reach it
+	end = int(crossers.size());
+	for (int i = LowerBound(crossers, top - maxCrosserHalfHeight); i < end && crossers[i].y <= bottom + maxCrosserHalfHeight; i++)
+	{
+		if (ArrivalAcross(crossers[i], lane, top, bottom) <= ticks)
+			return false;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Read the obstacle's box and how it moves from its components
+bool LaneIndexType::Read(EntityWorldType& world, Interval& interval)
+{
+	if (!world.IsAlive(interval.entity))
+		return false;
+
+	interval.kind = world.GetKind(interval.entity);
+	const ObstacleTraits& traits = obstacleTraits[interval.kind];
+
+	const TransformComponent& transform = world.Get<TransformComponent>(interval.entity);
+	const MotionComponent& motion = world.Get<MotionComponent>(interval.entity);
+	const ColliderComponent& collider = world.Get<ColliderComponent>(interval.entity);
+
+	interval.x = transform.x;
+	interval.y = transform.y;
+	interval.halfWidth = collider.halfWidth;
+	interval.halfHeight = collider.halfHeight;
+	interval.step = (traits.axis == ObstacleRule::Vertical ? motion.dirY : motion.dirX) * motion.speed;
+	interval.mayReverse = traits.path == ObstacleRule::ReverseOnce && world.Get<PatrolComponent>(interval.entity).reversed == 0;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Insertion sort, each obstacle only moves past the few it has overtaken since the last tick
+void LaneIndexType::Sort(std::vector<Interval>& list)
+{
+	for (int i = 1; i < int(list.size()); i++)
+	{
+		if (list[i - 1].y <= list[i].y)
+			continue;
+
+		Interval moving = list[i];
+		int j = i;
+		while (j > 0 && list[j - 1].y > moving.y)
+		{
+			list[j] = list[j - 1];
+			j--;
+		}
+		list[j] = moving;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Binary search on the centres
+int LaneIndexType::LowerBound(const std::vector<Interval>& list, float y)
+{
+	int low = 0, high = int(list.size());
+
+	while (low < high)
+	{
+		int middle = (low + high) / 2;
+		if (list[middle].y < y)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	return low;
+}
+
+// -----------------------------------------------------------------------------
+// How long until the obstacle's box closes the gap to the range. A snake that hasn't
+// turned round yet might head back, so it counts as coming whichever way it is going
+float LaneIndexType::ArrivalAlong(const Interval& interval, float top, float bottom)
+{
+	float boxTop = interval.y - interval.halfHeight;
+	float boxBottom = interval.y + interval.halfHeight;
+
+	if (boxBottom >= top && boxTop <= bottom)
+		return 0;
+
+	if (boxBottom < top)
+	{
+		float down = interval.mayReverse ? fabsf(interval.step) : interval.step; // Above, has to be falling
+		return down > 0 ? (top - boxBottom) / down : FLT_MAX;
+	}
+
+	float up = interval.mayReverse ? fabsf(interval.step) : -interval.step; // Below, has to be rising
+	return up > 0 ? (boxTop - bottom) / up : FLT_MAX;
+}
+
+// -----------------------------------------------------------------------------
+// A dart level with the range arrives when its box reaches the lane's edge
+float LaneIndexType::ArrivalAcross(const Interval& interval, int lane, float top, float bottom) const
+{
+	if (interval.y + interval.halfHeight < top || interval.y - interval.halfHeight > bottom)
+		return FLT_MAX; // Passes above or below
+
+	float gap = fabsf(interval.x - laneX[lane]) - interval.halfWidth - halfWidth;
+	if (gap <= 0)
+		return 0;
+
+	bool heading = interval.x < laneX[lane] ? interval.step > 0 : interval.step < 0;
+	return heading ? gap / fabsf(interval.step) : FLT_MAX;
+}
+
+// -----------------------------------------------------------------------------
+// Describe an obstacle as seen from y
+void LaneIndexType::MakeThreat(const Interval& interval, float y, LaneThreat& threat)
+{
+	threat.entity = interval.entity;
+	threat.kind = interval.kind;
+	threat.y = interval.y;
+
+	float gap = fabsf(interval.y - y) - interval.halfHeight;
+	threat.distance = gap > 0 ? gap : 0;
+	threat.arrivalTicks = ArrivalAlong(interval, y, y);
+}
+
+// -----------------------------------------------------------------------------
+// Set every cell the range touches, clipped to the cells there are
+void LaneIndexType::Mark(int lane, float top, float bottom)
+{
+	if (bottom < 0 || top >= CELL_COUNT * CELL_HEIGHT)
+		return;
+
+	int first = top > 0 ? int(top) / CELL_HEIGHT : 0;
+	int last = bottom < CELL_COUNT * CELL_HEIGHT ? int(bottom) / CELL_HEIGHT : CELL_COUNT - 1;
+
+	uint64_t upTo = last == CELL_COUNT - 1 ? ~uint64_t(0) : (uint64_t(1) << (last + 1)) - 1;
+	occupancy[lane] |= upTo & ~((uint64_t(1) << first) - 1);
+	laneMask |= 1u << lane;
+}
@@ -0,0 +1,134 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Per-lane index of the obstacles, for questions like "what is the nearest obstacle above
+// this point on vine 3, and how long until it gets here?" without scanning every kind.
+//
+// Each lane (vine) keeps the obstacles moving along it as intervals sorted by their centre
+// y. New obstacles are inserted in place when they spawn. Update reads where everything is
+// after the tick's move and drops the dead ones. It then puts the order right with an
+// insertion sort, which is close to linear because obstacles hardly ever pass each other.
+// Nearest above/below is a binary search. A safety check is a binary search plus a look at
+// the few obstacles close enough to arrive in time.
+//
+// Obstacles that cross the lanes sideways (darts) are kept in one more list sorted by y.
+// They are checked against a lane by when they reach its x.
+//
+// Each lane also has an occupancy bitset, one bit per CELL_HEIGHT pixels of height. A bit
+// is set if any obstacle covers that cell, so "is anything here right now" is one test.
+//
+// Times are in ticks, because obstacles move a fixed step every tick whatever the frame
+// time is.
+//----------------------------------------------------------------------------------------
+
+#include <vector>
+#include <cstdint>
+#include "EntityWorldType.h"
+#include "ObstacleTraits.h"
+
+// an obstacle near a point on a lane
+struct LaneThreat
+{
+	Entity entity;
+	EntityKind::Kind kind;
+	float y; // Centre
+	float distance; // Gap between its box and the point, 0 if it covers the point
+	float arrivalTicks; // Ticks until its box reaches the point, FLT_MAX if it never will
+};
+
+class LaneIndexType
+{
+	public:
+		static const int MAX_LANES = 8;
+		static const int CELL_HEIGHT = 16; // Pixels of height per occupancy bit
+		static const int CELL_COUNT = 64; // Bits per lane, covers 1024 pixels
+
+		// constructor
+		LaneIndexType();
+
+		// set the x of each lane and how far either side of it counts as on the lane, this clears the index
+		void SetLanes(const int* inLaneX, int inLaneCount, float inHalfWidth);
+
+		// forget every obstacle
+		void Clear();
+
+		// add an obstacle that has just spawned, anything that isn't an obstacle is ignored
+		void Add(EntityWorldType& world, Entity entity);
+
+		// read where every obstacle is after the tick's move and drop the ones that have gone, call once the dead are destroyed
+		void Update(EntityWorldType& world);
+
+		// get the lane an x is on, -1 if it isn't on any
+		int FindLane(float x) const;
+
+		// get the nearest obstacle on a lane with its centre above or at/below y, returns false if there isn't one
+		bool FindAbove(int lane, float y, LaneThreat& threat) const;
+		bool FindBelow(int lane, float y, LaneThreat& threat) const;
+
+		// is the part of the lane from top to bottom clear now and for the next ticks, darts crossing it included
+		bool IsSafe(int lane, float top, float bottom, float ticks) const;
+
+		// is anything covering this height of the lane right now
+		bool IsOccupied(int lane, float y) const
+		{
+			int cell = int(y) / CELL_HEIGHT;
+			return y >= 0 && cell < CELL_COUNT && (occupancy[lane] >> cell) & 1;
+		}
+
+		// get the occupancy bits of a lane, bit n covers y from n * CELL_HEIGHT
+		uint64_t GetOccupancy(int lane) const { return occupancy[lane]; }
+
+		// get a bit for each lane with anything on or crossing it
+		uint32_t GetLaneMask() const { return laneMask; }
+
+		int GetLaneCount() const { return laneCount; }
+		int GetCount(int lane) const { return int(lanes[lane].size()); }
+		int GetCrossingCount() const { return int(crossers.size()); }
+
+	private:
+		// one obstacle's box and how it moves
+		struct Interval
+		{
+			float x, y; // Centre
+			float halfWidth, halfHeight;
+			float step; // Pixels moved each tick along its axis, signed
+			bool mayReverse; // A snake that hasn't turned round yet, it could come back the other way
+			Entity entity;
+			EntityKind::Kind kind;
+		};
+
+		int laneX[MAX_LANES];
+		int laneCount;
+		float halfWidth; // Either side of a lane's x that counts as on it
+
+		std::vector<Interval> lanes[MAX_LANES]; // Obstacles moving along each lane, sorted by y
+		std::vector<Interval> crossers; // Obstacles moving across the lanes, sorted by y
+
+		// set by Update, bounds how far from a point IsSafe has to look
+		float maxStep[MAX_LANES]; // Fastest obstacle on each lane
+		float maxHalfHeight[MAX_LANES]; // Tallest obstacle on each lane
+		float maxCrosserHalfHeight;
+
+		uint64_t occupancy[MAX_LANES];
+		uint32_t laneMask;
+
+		// fill in an interval from the entity's components, returns false if it has been destroyed
+		static bool Read(EntityWorldType& world, Interval& interval);
+
+		// put a list back in order after its obstacles have moved
+		static void Sort(std::vector<Interval>& list);
+
+		// get the first interval in a list with its centre at or below y
+		static int LowerBound(const std::vector<Interval>& list, float y);
+
+		// get the ticks until an obstacle moving along the lane overlaps top to bottom, FLT_MAX if it never will
+		static float ArrivalAlong(const Interval& interval, float top, float bottom);
+
+		// get the ticks until an obstacle crossing the lanes overlaps top to bottom on a lane, FLT_MAX if it never will
+		float ArrivalAcross(const Interval& interval, int lane, float top, float bottom) const;
+
+		// fill in the lane's threat from an interval
+		static void MakeThreat(const Interval& interval, float y, LaneThreat& threat);
+
+		// set the bits for y from top to bottom in a lane's occupancy
+		void Mark(int lane, float top, float bottom);
+};
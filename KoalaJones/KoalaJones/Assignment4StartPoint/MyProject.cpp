@@ -1,1025 +1,1672 @@
-/*
-
-Author: Matthew Minnett
-Date: 2022-03-31
-Purpose:
-1.	To create a unique simple point and click game utilizing multiple classes/objects
-2.	To utilize a dynamic memory data structure class to control game objects
-3.	To apply the pointer data type and address operators appropriately
-4.	To integrate textures and sprites into a DirectX application
-
-*/
-
-
-#include <string>
-#include <sstream>
-#include "MyProject.h"
-
-using namespace std;
-using namespace DirectX;
-
-float RandFloat() { return float(rand()) / float(RAND_MAX); }
-
-//----------------------------------------------------------------------------------------------
-// Constructor
-MyProject::MyProject(HINSTANCE hInstance) : DirectXClass(hInstance)
-{
-	DisplayFPS(true);
-
-	// Set everything to starting values
-	currentState = eGameStates::START;
-
-	// Obstacle settings
-	obstacleLevel = 1; // Difficulty of obstacles
-	obstacleSpeed = 1;
-	timeToNextObstacle = 3;
-	obstacleTime = 3;
-
-	// Item settings
-	itemCombo = 100; // Score gained from item starts at 100
-	itemLevel = 1;
-	itemDespawn = 5; // items despawn every 5 seconds
-
-	// General play settings
-	score = 0;
-	lives = 2;
-	elapsedTime = 0;
-	gracePeriod = 0;
-	gameOverTime = 1; // Player must stare at their defeat for at least 1 second
-	timeToNextChange = 15; // How many seconds until difficulty increase/item spawn
-	scoreForExtraLife = 10000; // Score needed for extra life starts at 10,000
-	koalaColor = Color(1, 1, 1);
-
-	// Setting x-pos for each vine
-	vineX[0] = 131;
-	vineX[1] = 283;
-	vineX[2] = 435;
-	vineX[3] = 588;
-	vineX[4] = 740;
-	vineX[5] = 893;
-	currentVine = 2; // player starts on 3rd vine in array
-}
-
-//----------------------------------------------------------------------------------------------
-//	Called by the game loop to render a single frame
-void MyProject::Render(void)
-{
-	if (currentState == eGameStates::START)
-	{
-		// We are in the main menu
-		startTex.Draw(DeviceContext, BackBuffer, 0, 0);
-	}
-	else if (currentState == eGameStates::PLAYING)
-	{
-		// We are playing our game
-
-		// Draw Background First
-		backgroundTex.Draw(DeviceContext, BackBuffer, 0, 0);
-
-		// Render our sprites
-		spriteBatch->Begin(SpriteSortMode_BackToFront, GetBlendState()->NonPremultiplied());
-		{
-			koalaSprite.Draw(spriteBatch);
-
-			for (int i = 0; i < itemSprites.GetSpriteCount(); i++)
-			{
-				itemSprites.GetSprite(i).Draw(spriteBatch);
-			}
-
-			for (int i = 0; i < snakeSprites.GetSpriteCount(); i++)
-			{
-				snakeSprites.GetSprite(i).Draw(spriteBatch);
-			}
-			for (int i = 0; i < dartSprites.GetSpriteCount(); i++)
-			{
-				dartSprites.GetSprite(i).Draw(spriteBatch);
-			}
-			for (int i = 0; i < fireSprites.GetSpriteCount(); i++)
-			{
-				fireSprites.GetSprite(i).Draw(spriteBatch);
-			}
-			for (int i = 0; i < rockSprites.GetSpriteCount(); i++)
-			{
-				rockSprites.GetSprite(i).Draw(spriteBatch);
-			}
-		}
-		spriteBatch->End();
-
-		// Lava is in front of sprites
-		lavaTex.Draw(DeviceContext, BackBuffer, 0, 768 - lavaTex.GetHeight());
-
-		DisplayUI(); // UI displays above lava
-	}
-	else if (currentState == eGameStates::OVER)
-	{
-		// Game Over!
-		GameOver();
-	}
-}
-
-//----------------------------------------------------------------------------------------------
-//	Called every frame to update objects.
-//	deltaTime: how much time in seconds has elapsed since the last frame
-void MyProject::Update(float deltaTime)
-{
-	if (currentState == eGameStates::PLAYING) // While we are PLAYING
-	{
-		CheckForCollisions(); // Every frame check to see if player has collided with obstacle/item
-
-		elapsedTime += deltaTime; // Add to elapsed time
-	
-		if (score >= scoreForExtraLife)
-		{
-			lives += 1; // Add an extra life if score is equal to or greater than or equal to scoreForExtraLife
-			scoreForExtraLife = scoreForExtraLife * 2.5; // scoreForExtraLife is multiplied by 2.5
-		}
-
-		if (gracePeriod > 0) // If the player is damaged, then gracePeriod will be greater than 0
-		{
-			gracePeriod -= deltaTime; // Grace period counts down to 0
-			
-			if (gracePeriod <= 0) 
-			{
-				koalaSprite.SetColor(Color(1, 1, 1)); // Set koala back to normal colour once grace period is over
-			}
-		}
-
-		UpdateLevel(deltaTime); // Check to see if item level and obstacle level should be added to
-
-		UpdateObstacles(); // Move obstacles
-
-		AddObstacles(deltaTime); // Add new obstacles
-
-		RemoveObstacles(); // Remove off-screen obstacles
-	}
-	else if (currentState == eGameStates::OVER)
-	{
-		gameOverTime -= deltaTime; // Game over time counts down
-	}
-}
-
-
-//----------------------------------------------------------------------------------------------
-//	Window message handler which intercepts messages from the Windows OS. The programmer can check
-//	which message occurred and take appropriate actions
-LRESULT MyProject::ProcessWindowMessages(UINT msg, WPARAM wParam, LPARAM lParam)
-{
-	switch (msg)
-	{
-	case WM_LBUTTONUP:		// Left mouse button let up, set the boolean variable and get the mouse coordinates
-		buttonDownLeft = false;
-		mousePos.x = (float)GET_X_LPARAM(lParam);
-		mousePos.y = (float)GET_Y_LPARAM(lParam);
-		if (currentState == eGameStates::START)
-		{
-			currentState = eGameStates::PLAYING; // If left click on start screen, play game
-		}
-		else if (currentState == eGameStates::PLAYING)
-		{
-			Move(); // If left click in-game, move koala sprite
-		}
-		else if (currentState == eGameStates::OVER && gameOverTime <= 0)
-		{
-			Reset(); // If left click on game over, and game over timer is less than or equal to 0, reset
-		}
-		break;
-	case WM_LBUTTONDOWN:	// Left mouse button down, set the boolean variable and get the mouse coordinates
-		buttonDownLeft = true;
-		mousePos.x = (float)GET_X_LPARAM(lParam);
-		mousePos.y = (float)GET_Y_LPARAM(lParam);
-		break;
-	case WM_KEYUP:		// check for VK_???? and perform an action based on a specific keyboard key being let up
-		if (wParam >= '0' && wParam <= '4')		// setting the screen refesh rate setting keys 0 - 4
-			presentInterval = wParam - '0';
-		break;
-	case WM_KEYDOWN:
-		break;
-	}
-
-	// Let the base class handle remaining messages, THIS IS REQUIRED as all messages should be handled appropriately
-	return DirectXClass::ProcessWindowMessages(msg, wParam, lParam);
-}
-
-// -----------------------------------------------------------------------------
-// Load all textures
-void MyProject::InitalizeTextures()
-{
-	startTex.Load(D3DDevice, L"..\\Textures\\title.jpg");
-	backgroundTex.Load(D3DDevice, L"..\\Textures\\background.jpg");
-	lavaTex.Load(D3DDevice, L"..\\Textures\\lava.jpg");
-	endTex.Load(D3DDevice, L"..\\Textures\\end.jpg");
-
-	// Player and obstacles
-	koalaTex.Load(D3DDevice, L"..\\Textures\\player\\koala_jones.png");
-	rockTex.Load(D3DDevice, L"..\\Textures\\obstacles\\rock.png");
-	fireTex.Load(D3DDevice, L"..\\Textures\\obstacles\\fireball.png");
-	dartTex.Load(D3DDevice, L"..\\Textures\\obstacles\\poison_dart.png");
-	snakeTex.Load(D3DDevice, L"..\\Textures\\obstacles\\snake.png");
-
-	// Items
-	orangeTex.Load(D3DDevice, L"..\\Textures\\items\\item1.png");
-	pearTex.Load(D3DDevice, L"..\\Textures\\items\\item2.png");
-	appleTex.Load(D3DDevice, L"..\\Textures\\items\\item3.png");
-	bananaTex.Load(D3DDevice, L"..\\Textures\\items\\item4.png");
-	chaliceTex.Load(D3DDevice, L"..\\Textures\\items\\item5.png");
-	necklaceTex.Load(D3DDevice, L"..\\Textures\\items\\item6.png");
-	tripowerTex.Load(D3DDevice, L"..\\Textures\\items\\item7.png");
-	idolTex.Load(D3DDevice, L"..\\Textures\\items\\item8.png");
-}
-
-// -----------------------------------------------------------------------------
-// Initalize all sprites, including obstacles and items for sprite lists
-void MyProject::InitalizeSprites()
-{
-	spriteBatch = new DirectX::SpriteBatch(DeviceContext);
-
-	koalaSprite.Initialize(&koalaTex, Vector2(vineX[currentVine], 768/2), 0, 0, 1, koalaColor, 0);
-	koalaSprite.SetPivot(SpriteType::Pivot::CenterLeft);
-
-	AddRocks();
-	AddFire();
-	AddDart();
-	AddSnake();
-
-	AddItems();
-}
-
-// -----------------------------------------------------------------------------
-// Prints out elapsed time, current score, current lives, as well as list info
-void MyProject::DisplayUI()
-{
-	wostringstream message;
-	wstring messageOut;
-
-	message << L"Time: " << elapsedTime;
-	messageOut = message.str();
-	font.PrintMessage(0, 700, messageOut.c_str(), FC_BLACK);
-
-	message.str(L"");
-
-	message << L"Score: " << score;
-	messageOut = message.str();
-	font.PrintMessage(0, 720, messageOut.c_str(), FC_BLACK);
-
-	message.str(L"");
-
-	message << L"Lives: " << lives;
-	messageOut = message.str();
-	font.PrintMessage(0, 740, messageOut.c_str(), FC_BLACK);
-
-	if (obstacleLevel == 1) // When obstacle level is 1, print rock list sprite count and capacity
-	{
-		message.str(L"");
-
-		message << L"Rocks: " << rockSprites.GetSpriteCount();
-		messageOut = message.str();
-		font.PrintMessage(200, 700, messageOut.c_str(), FC_BLACK);
-
-		message.str(L"");
-
-		message << L"Rock Capacity: " << rockSprites.GetCapacity();
-		messageOut = message.str();
-		font.PrintMessage(200, 720, messageOut.c_str(), FC_BLACK);
-	}
-
-	else if (obstacleLevel == 2) // When obstacle level is 2, print fire list sprite count and capacity
-	{
-		message.str(L"");
-
-		message << L"FireBalls: " << fireSprites.GetSpriteCount();
-		messageOut = message.str();
-		font.PrintMessage(200, 700, messageOut.c_str(), FC_BLACK);
-
-		message.str(L"");
-
-		message << L"FireBall Capacity: " << fireSprites.GetCapacity();
-		messageOut = message.str();
-		font.PrintMessage(200, 720, messageOut.c_str(), FC_BLACK);
-	}
-
-	else if (obstacleLevel == 3) // When obstacle level is 3, print dart list sprite count and capacity
-	{
-		message.str(L"");
-
-		message << L"PoisonDarts: " << dartSprites.GetSpriteCount();
-		messageOut = message.str();
-		font.PrintMessage(200, 700, messageOut.c_str(), FC_BLACK);
-
-		message.str(L"");
-
-		message << L"PoisonDart Capacity: " << dartSprites.GetCapacity();
-		messageOut = message.str();
-		font.PrintMessage(200, 720, messageOut.c_str(), FC_BLACK);
-	}
-
-	else if (obstacleLevel == 4) // When obstacle level is 4, print snake list sprite count and capacity
-	{
-		message.str(L"");
-
-		message << L"Snakes: " << snakeSprites.GetSpriteCount();
-		messageOut = message.str();
-		font.PrintMessage(200, 700, messageOut.c_str(), FC_BLACK);
-
-		message.str(L"");
-
-		message << L"Snake Capacity: " << snakeSprites.GetCapacity();
-		messageOut = message.str();
-		font.PrintMessage(200, 720, messageOut.c_str(), FC_BLACK);
-	}
-}
-
-// -----------------------------------------------------------------------------
-// Displays game over screen, with elapsed time and final score
-void MyProject::GameOver()
-{
-	endTex.Draw(DeviceContext, BackBuffer, 0, 0);
-
-	wostringstream message;
-	wstring messageOut;
-
-	message << L"Time Survived: " << elapsedTime;
-	messageOut = message.str();
-	font.PrintMessage(400, 384, messageOut.c_str(), Color(1,1,1));
-
-	message.str(L"");
-
-	message << L"Final Score: " << score;
-	messageOut = message.str();
-	font.PrintMessage(400, 404, messageOut.c_str(), Color(1, 1, 1));
-}
-
-// -----------------------------------------------------------------------------
-// Resets to starting values
-void MyProject::Reset()
-{
-	// Set everything to starting values
-	currentState = eGameStates::START;
-
-	// Obstacle settings
-	obstacleLevel = 1;
-	obstacleSpeed = 1;
-	timeToNextObstacle = 3;
-	obstacleTime = 3;
-
-	// Item settings
-	itemCombo = 100;
-	itemLevel = 1;
-	itemDespawn = 5;
-
-	// General play settings
-	score = 0;
-	lives = 2;
-	elapsedTime = 0;
-	gracePeriod = 0;
-	gameOverTime = 1;
-	timeToNextChange = 15;
-	scoreForExtraLife = 10000;
-	koalaColor = Color(1, 1, 1);
-	currentVine = 2;
-
-	// Remove all obstacle and item sprites
-	rockSprites.RemoveAll();
-	fireSprites.RemoveAll();
-	dartSprites.RemoveAll();
-	snakeSprites.RemoveAll();
-	itemSprites.RemoveAll();
-
-	// Re-initalize sprites
-	InitalizeSprites();
-}
-
-// -----------------------------------------------------------------------------
-// Add rocks to the rock sprite list, get a random vine position
-void MyProject::AddRocks()
-{
-	if (currentState == eGameStates::PLAYING)
-	{
-		SpriteType newSprite;
-
-		Vector2 startPos;
-
-		switch (rand() % 6) // Gets a random vine position for x
-		{
-		case 0: // Vine 1
-			startPos.x = vineX[0];
-			startPos.y = 0;
-			break;
-		case 1: // Vine 2
-			startPos.x = vineX[1];
-			startPos.y = 0;
-			break;
-		case 2: // Vine 3
-			startPos.x = vineX[2];
-			startPos.y = 0;
-			break;
-		case 3: // Vine 4
-			startPos.x = vineX[3];
-			startPos.y = 0;
-			break;
-		case 4: // Vine 5
-			startPos.x = vineX[4];
-			startPos.y = 0;
-			break;
-		case 5: // Vine 6
-			startPos.x = vineX[5];
-			startPos.y = 0;
-			break;
-		}
-
-		newSprite.Initialize(&rockTex, startPos, 0, 0, 1, Color(1, 1, 1), 0);
-		newSprite.SetPivot(SpriteType::Pivot::Center);
-
-		newSprite.startPoint = startPos;
-		newSprite.endPoint = Vector2(startPos.x, 768); // Endpoint is bottom of screen
-
-		newSprite.direction = newSprite.endPoint - newSprite.startPoint;
-		newSprite.direction.Normalize();
-
-		newSprite.speed = rand() % int(obstacleSpeed) + 1; // speed that they fall is random
-
-		rockSprites.Add(newSprite); // Add to rock sprite list
-	}
-}
-
-// -----------------------------------------------------------------------------
-// Add fire balls to the fire sprite list, at a random vine position
-void MyProject::AddFire()
-{
-	if (currentState == eGameStates::PLAYING)
-	{
-		SpriteType newSprite;
-
-		Vector2 startPos;
-
-		switch (rand() % 6) // Get random vine pos for x, y is at bottom of screen
-		{
-		case 0: // Vine 1
-			startPos.x = vineX[0];
-			startPos.y = 768;
-			break;
-		case 1: // Vine 2
-			startPos.x = vineX[1];
-			startPos.y = 768;
-			break;
-		case 2: // Vine 3
-			startPos.x = vineX[2];
-			startPos.y = 768;
-			break;
-		case 3: // Vine 4
-			startPos.x = vineX[3];
-			startPos.y = 768;
-			break;
-		case 4: // Vine 5
-			startPos.x = vineX[4];
-			startPos.y = 768;
-			break;
-		case 5: // Vine 6
-			startPos.x = vineX[5];
-			startPos.y = 768;
-			break;
-		}
-
-		newSprite.Initialize(&fireTex, startPos, 0, 0, 1, Color(1, 1, 1), 0);
-		newSprite.SetPivot(SpriteType::Pivot::Center);
-
-		newSprite.startPoint = startPos;
-		newSprite.endPoint = Vector2(startPos.x, 0); // End point is top of screen
-
-		newSprite.direction = newSprite.endPoint - newSprite.startPoint;
-		newSprite.direction.Normalize();
-
-		newSprite.speed = obstacleSpeed + 1;
-
-		fireSprites.Add(newSprite); // Add to fire sprite list
-	}
-}
-
-// -----------------------------------------------------------------------------
-// Add darts to the dart sprite list, at a random y position
-void MyProject::AddDart()
-{
-	if (currentState == eGameStates::PLAYING)
-	{
-		SpriteType newSprite;
-
-		Vector2 startPos;
-		int startX = rand() % 2 + 1; // Start at left side of screen, or right?
-
-		if (startX == 1) // Spawn left
-		{
-			startPos.x = 0;
-		}
-		else // Spawn right
-		{
-			startPos.x = 1024;
-		}
-		startPos.y = rand() % (768 - lavaTex.GetHeight() - 50) + 50; // Random y-pos
-
-		newSprite.Initialize(&dartTex, startPos, 0, 0, 1, Color(1, 1, 1), 0);
-
-		newSprite.startPoint = startPos;
-		if (startX == 1) // If start on the left
-		{
-			newSprite.SetRotation(180); // Rotate to face the right
-			newSprite.SetPivot(SpriteType::Pivot::CenterRight); // Set pivot to be further back so collision with player sprite feels better
-			newSprite.endPoint = Vector2(1100, startPos.y); // End on right side of screen
-		}
-		else // else, start on right
-		{
-			newSprite.endPoint = Vector2(-100, startPos.y); // endpoint is left of screen
-			newSprite.SetPivot(SpriteType::Pivot::Center);
-		}
-
-		newSprite.direction = newSprite.endPoint - newSprite.startPoint;
-		newSprite.direction.Normalize();
-
-		newSprite.speed = obstacleSpeed + 1;
-
-		dartSprites.Add(newSprite); // Add to dart sprite list
-	}
-}
-
-// -----------------------------------------------------------------------------
-// Add snakes to the snake sprite list, at a random vine position
-void MyProject::AddSnake()
-{
-	if (currentState == eGameStates::PLAYING)
-	{
-		SpriteType newSprite;
-		Color snakeColor;
-		Vector2 startPos;
-		int startY = rand() % 2 + 1; // Start at bottom or top?
-
-		switch (rand() % 6) // Get random vine position
-		{
-		case 0: // Vine 1
-			startPos.x = vineX[0];
-			break;
-		case 1: // Vine 2
-			startPos.x = vineX[1];
-			break;
-		case 2: // Vine 3
-			startPos.x = vineX[2];
-			break;
-		case 3: // Vine 4
-			startPos.x = vineX[3];
-			break;
-		case 4: // Vine 5
-			startPos.x = vineX[4];
-			break;
-		case 5: // Vine 6
-			startPos.x = vineX[5];
-			break;
-		}
-
-		if (startY == 1) // Start at top
-		{
-			startPos.y = 0;
-			snakeColor = Color(1, 1, 1); // Regular colour
-		}
-		else if (startY == 2) // Start at bottom
-		{
-			startPos.y = 768;
-			snakeColor = DirectX::Colors::OrangeRed; // Lava snake!
-		}
-
-		newSprite.Initialize(&snakeTex, startPos, 0, 0, 1, snakeColor, 0);
-		newSprite.SetPivot(SpriteType::Pivot::Center);
-
-		newSprite.startPoint = startPos;
-
-		if (startY == 1) // If start at top, end at bottom
-		{
-			newSprite.endPoint = Vector2(startPos.x, (768 - lavaTex.GetHeight() - 20));
-		}
-
-		else if (startY == 2) // If start at bottom, end at top
-		{
-			newSprite.SetRotation(180); // Flip around to face top of screen
-			newSprite.SetScale(0.8); // Lava snakes are slightly smaller
-			newSprite.endPoint = Vector2(startPos.x, 0);
-		}
-
-		newSprite.direction = newSprite.endPoint - newSprite.startPoint;
-		newSprite.direction.Normalize();
-
-		newSprite.speed = rand() % int(obstacleSpeed) + 1; // Move at random speeds
-
-		snakeSprites.Add(newSprite); // Add to snake sprite list
-	}
-}
-
-// -----------------------------------------------------------------------------
-// Add items to the item sprite list, at a random vine position
-void MyProject::AddItems()
-{
-	if (currentState == eGameStates::PLAYING)
-	{
-		SpriteType newSprite;
-		Vector2 pos = ItemPos(); // Go to item pos function to get a random position
-
-		switch (itemLevel) // Based on item level, initialize item sprite
-		{
-		case 1:
-			newSprite.Initialize(&orangeTex, pos, 0, 0, 1, Color(1, 1, 1), 0);
-			break;
-		case 2:
-			newSprite.Initialize(&pearTex, pos, 0, 0, 1, Color(1, 1, 1), 0);
-			break;
-		case 3:
-			newSprite.Initialize(&appleTex, pos, 0, 0, 1, Color(1, 1, 1), 0);
-			break;
-		case 4:
-			newSprite.Initialize(&bananaTex, pos, 0, 0, 1, Color(1, 1, 1), 0);
-			break;
-		case 5:
-			newSprite.Initialize(&chaliceTex, pos, 0, 0, 1, Color(1, 1, 1), 0);
-			break;
-		case 6:
-			newSprite.Initialize(&necklaceTex, pos, 0, 0, 1, Color(1, 1, 1), 0);
-			break;
-		case 7:
-			newSprite.Initialize(&tripowerTex, pos, 0, 0, 1, Color(1, 1, 1), 0);
-			break;
-		case 8:
-			newSprite.Initialize(&idolTex, pos, 0, 0, 1, Color(1, 1, 1), 0);
-			break;
-		}
-
-		newSprite.SetPivot(SpriteType::Pivot::Center);
-
-		itemSprites.Add(newSprite); // Add to item sprite list
-	}
-}
-
-// -----------------------------------------------------------------------------
-// Get a random position for item
-Vector2 MyProject::ItemPos()
-{
-	if (currentState == eGameStates::PLAYING)
-	{
-		Vector2 pos = koalaSprite.GetPosition();
-
-		while (pos.x == koalaSprite.GetPosition().x) // Keep looping until the x of the item pos is not equal to the player's x pos
-		{
-			switch (rand() % 6) // Random vine
-			{
-			case 0: // Vine 1
-				pos.x = vineX[0];
-				break;
-			case 1: // Vine 2
-				pos.x = vineX[1];
-				break;
-			case 2: // Vine 3
-				pos.x = vineX[2];
-				break;
-			case 3: // Vine 4
-				pos.x = vineX[3];
-				break;
-			case 4: // Vine 5
-				pos.x = vineX[4];
-				break;
-			case 5: // Vine 6
-				pos.x = vineX[5];
-				break;
-			}
-			pos.y = rand() % (768 - lavaTex.GetHeight() - 30) + 30; // Random y
-		}
-		return pos;
-	}
-}
-
-// -----------------------------------------------------------------------------
-// Move player sprite based on mouse pos
-void MyProject::Move()
-{
-	// If mouse is clicked on the same vine as player, and mouse is clicked above the koala sprite
-	if (mousePos.y <= (koalaSprite.GetPosition().y - 50) && mousePos.x >= (koalaSprite.GetPosition().x - 20) && mousePos.x <= (koalaSprite.GetPosition().x + 20))
-	{
-		Vector2 newPos = koalaSprite.GetPosition(); // Set new pos to koala pos
-		newPos.y -= 50; // Move new pos up by 50
-		koalaSprite.SetPosition(newPos); // Update koala pos
-	}
-
-	// If mouse is clicked on the same vine as player, and mouse is clicked below the koala sprite
-	else if (mousePos.y >= (koalaSprite.GetPosition().y + 50) && mousePos.x >= (koalaSprite.GetPosition().x - 20) && mousePos.x <= (koalaSprite.GetPosition().x + 20) && mousePos.y < (768 - lavaTex.GetHeight() - 20))
-	{
-		Vector2 newPos = koalaSprite.GetPosition();
-		newPos.y += 50; // Move new pos down by 50
-		koalaSprite.SetPosition(newPos); // Update koala pos
-	}
-
-	// If mouse is clicked on the vine to the right of the current vine, and current vine is less than or equal to vine count
-	else if (mousePos.x >= (vineX[currentVine + 1] - 20) && mousePos.x <= (vineX[currentVine + 1] + 20) && currentVine <= VINE_COUNT)
-	{
-		Vector2 newPos = koalaSprite.GetPosition();
-		newPos.x = vineX[currentVine + 1]; // new x pos = vine that was clicked on
-		koalaSprite.SetPosition(newPos); // Koala sprite moves to new vine
-		currentVine++; // Add to currentVine to keep track of vine position
-		score += 20; // Movement adds to the score
-	}
-
-	// If mouse is clicked on the vine to the left of the current vine, and current vine is greater than 0
-	else if (mousePos.x >= (vineX[currentVine - 1] - 20) && mousePos.x <= (vineX[currentVine - 1] + 20) && currentVine > 0)
-	{
-		Vector2 newPos = koalaSprite.GetPosition();
-		newPos.x = vineX[currentVine - 1]; // new x pos = vine that was clicked on
-		koalaSprite.SetPosition(newPos); // Update koala position to new vine
-		currentVine--; // Subtract from current vine
-		score += 20; // Movement adds to score
-	}
-}
-
-// -----------------------------------------------------------------------------
-// Check to see if koala sprite collides any with items or obstacles
-void MyProject::CheckForCollisions()
-{
-	for (int i = 0; i < rockSprites.GetSpriteCount(); i++)
-	{
-		if (rockSprites.GetSprite(i).SpriteCollision(koalaSprite) && gracePeriod <= 0) // If collision and invulnerability period is 0
-		{
-			rockSprites.Remove(i); // Remove sprite
-			lives--; // Lose a life
-			gracePeriod = 1; // Give a second of invulnerability
-			koalaSprite.SetColor(Color(1, 0, 0)); // Koala turns red
-			Vector2 newPos = koalaSprite.GetPosition();
-			newPos.y += 20; // Move koala down a bit
-			koalaSprite.SetPosition(newPos);
-			if (lives < 0)
-			{
-				currentState = eGameStates::OVER; // When lives are less than 0, game over!
-			}
-		}
-	}
-	
-	// Same effects as rock collision
-	for (int i = 0; i < fireSprites.GetSpriteCount(); i++)
-	{
-		if (fireSprites.GetSprite(i).SpriteCollision(koalaSprite) && gracePeriod <= 0)
-		{
-			fireSprites.Remove(i);
-			lives--;
-			gracePeriod = 1;
-			koalaSprite.SetColor(Color(1, 0, 0));
-			Vector2 newPos = koalaSprite.GetPosition();
-			newPos.y -= 20; // Koala moves up a bit, rather than down
-			koalaSprite.SetPosition(newPos);
-			if (lives < 0)
-			{
-				currentState = eGameStates::OVER;
-			}
-		}
-	}
-
-	// Same effects as rock collision
-	for (int i = 0; i < dartSprites.GetSpriteCount(); i++)
-	{
-		if (dartSprites.GetSprite(i).SpriteCollision(koalaSprite) && gracePeriod <= 0)
-		{
-			dartSprites.Remove(i);
-			lives--;
-			gracePeriod = 1;
-			koalaSprite.SetColor(Color(1, 0, 0));
-			Vector2 newPos = koalaSprite.GetPosition();
-			newPos.y += 20;
-			koalaSprite.SetPosition(newPos);
-			if (lives < 0)
-			{
-				currentState = eGameStates::OVER;
-			}
-		}
-	}
-
-	// Same effects as rock collision
-	for (int i = 0; i < snakeSprites.GetSpriteCount(); i++)
-	{
-		if (snakeSprites.GetSprite(i).SpriteCollision(koalaSprite) && gracePeriod <= 0)
-		{
-			snakeSprites.Remove(i);
-			lives--;
-			gracePeriod = 1;
-			koalaSprite.SetColor(Color(1, 0, 0));
-			Vector2 newPos = koalaSprite.GetPosition();
-			newPos.y += 20;
-			koalaSprite.SetPosition(newPos);
-			if (lives < 0)
-			{
-				currentState = eGameStates::OVER;
-			}
-		}
-	}
-
-	for (int i = 0; i < itemSprites.GetSpriteCount(); i++)
-	{
-		if (itemSprites.GetSprite(i).SpriteCollision(koalaSprite)) // If collision
-		{
-			itemSprites.Remove(i); // Remove item
-			score += itemCombo; // Add current itemCombo score to score
-			itemCombo = itemCombo * 2; // Double current itemCombo
-		}
-	}
-}
-
-// -----------------------------------------------------------------------------
-// Updates obstacle and item levels
-void MyProject::UpdateLevel(float deltaTime)
-{
-	if (elapsedTime >= timeToNextChange && elapsedTime < timeToNextChange + 15) // If timeToNextChange has been reached
-	{
-		if (itemLevel > 8) // If itemLevel is greater than 8
-		{
-			itemLevel = 1; // Set level back to 1 (orange/item1)
-			itemCombo = 100; // Reset combo (how much score gained from item)
-		}
-
-		// Spawn new item
-		AddItems();
-		itemLevel++; // Item level goes up by 1
-
-		itemDespawn = 5; // Despawn timer is reset
-		timeToNextChange += 15; // 15 seconds is added to the timer
-
-		if (obstacleLevel <= 4)
-		{
-			obstacleLevel++; // Obstacle level goes up until it reaches 4,
-		}
-		else if (obstacleLevel >= 5)
-		{
-			obstacleSpeed += 0.5; // at which point obstacle speed is added to instead
-		}
-	}
-
-	if (itemSprites.GetSpriteCount() > 0) // If there is an item on screen
-	{
-		itemDespawn -= deltaTime; // despawn timer counts down
-		if (itemDespawn <= 0) // if less than or equal to 0,
-		{
-			itemSprites.Remove(itemLevel); // remove item
-			itemCombo = 100; // reset score gained from item
-			itemLevel = 1; // reset item level
-		}
-	}
-}
-
-// -----------------------------------------------------------------------------
-// Updates obstacle positions
-void MyProject::UpdateObstacles()
-{
-	for (int i = 0; i < rockSprites.GetSpriteCount(); i++)
-	{
-		SpriteType& currentSprite = rockSprites.GetSprite(i);
-
-		Vector2 curPos = currentSprite.GetPosition();
-
-		curPos += (currentSprite.direction * currentSprite.speed);
-
-		float distToTargetX = abs(currentSprite.endPoint.x - curPos.x); 
-		float distToTargetY = abs(currentSprite.endPoint.y - curPos.y);
-
-		currentSprite.SetRotation(currentSprite.GetRotation() + currentSprite.speed);
-
-		currentSprite.SetPosition(curPos);
-	}
-
-	for (int i = 0; i < fireSprites.GetSpriteCount(); i++)
-	{
-		SpriteType& currentSprite = fireSprites.GetSprite(i);
-
-		Vector2 curPos = currentSprite.GetPosition();
-
-		curPos += (currentSprite.direction * currentSprite.speed);
-
-		float distToTargetX = abs(currentSprite.endPoint.x - curPos.x);
-		float distToTargetY = abs(currentSprite.endPoint.y - curPos.y);
-
-		currentSprite.SetPosition(curPos);
-	}
-
-	for (int i = 0; i < dartSprites.GetSpriteCount(); i++)
-	{
-		SpriteType& currentSprite = dartSprites.GetSprite(i);
-
-		Vector2 curPos = currentSprite.GetPosition();
-
-		curPos += (currentSprite.direction * currentSprite.speed);
-
-		float distToTargetX = abs(currentSprite.endPoint.x - curPos.x); 
-		float distToTargetY = abs(currentSprite.endPoint.y - curPos.y);
-
-		currentSprite.SetPosition(curPos);
-	}
-
-	for (int i = 0; i < snakeSprites.GetSpriteCount(); i++)
-	{
-		SpriteType& currentSprite = snakeSprites.GetSprite(i);
-
-		Vector2 curPos = currentSprite.GetPosition();
-
-		curPos += (currentSprite.direction * currentSprite.speed);
-
-		float distToTargetX = abs(currentSprite.endPoint.x - curPos.x);
-		float distToTargetY = abs(currentSprite.endPoint.y - curPos.y);
-
-		if (distToTargetX < 5 && distToTargetY < 5 && currentSprite.hasSwapped == false)
-		{
-			// Swapping start and end point
-			Vector2 temp = currentSprite.endPoint;
-			currentSprite.endPoint = currentSprite.startPoint;
-			currentSprite.startPoint = temp;
-
-			currentSprite.SetRotation(currentSprite.GetRotation() + 180); // Rotate around to face other direction
-
-			currentSprite.direction = currentSprite.endPoint - currentSprite.startPoint;
-			currentSprite.direction.Normalize();
-
-			currentSprite.hasSwapped = true; // Set hasSwapped to true, don't swap start and end again
-		}
-
-		currentSprite.SetPosition(curPos);
-	}
-}
-
-// -----------------------------------------------------------------------------
-// Add new obstacles
-void MyProject::AddObstacles(float deltaTime)
-{
-	int toSpawn = rand() % obstacleLevel; // Choose a random obstacle to spawn in
-
-	obstacleTime -= deltaTime; // Obstacle time counts down
-
-	if (obstacleTime <= 0) // When obstacle time reaches 0,
-	{
-		obstacleTime = rand() % timeToNextObstacle + 0.5; // Obstacle time is set to new random value
-
-		switch (toSpawn) // Spawn in obstacle that corresponds to toSpawn's value
-		{
-		case ROCK:
-			AddRocks();
-			break;
-		case FIRE:
-			AddFire();
-			break;
-		case DART:
-			AddDart();
-			break;
-		case SNAKE:
-			AddSnake();
-			break;
-		default:
-			break;
-		}
-	}
-}
-
-// -----------------------------------------------------------------------------
-// Remove obstacles if they go off-screen
-void MyProject::RemoveObstacles()
-{
-	for (int i = 0; i < rockSprites.GetSpriteCount(); i++)
-	{
-		SpriteType& currentSprite = rockSprites.GetSprite(i);
-
-		Vector2 curPos = currentSprite.GetPosition();
-
-		if (curPos.y > 768)
-		{
-			rockSprites.Remove(i);
-		}
-	}
-
-	for (int i = 0; i < fireSprites.GetSpriteCount(); i++)
-	{
-		SpriteType& currentSprite = fireSprites.GetSprite(i);
-
-		Vector2 curPos = currentSprite.GetPosition();
-
-		if (curPos.y < -100)
-		{
-			fireSprites.Remove(i);
-		}
-	}
-
-	for (int i = 0; i < dartSprites.GetSpriteCount(); i++)
-	{
-		SpriteType& currentSprite = dartSprites.GetSprite(i);
-
-		Vector2 curPos = currentSprite.GetPosition();
-
-		if (curPos.x > 1124 || curPos.x < -100)
-		{
-			dartSprites.Remove(i);
-		}
-	}
-
-	for (int i = 0; i < snakeSprites.GetSpriteCount(); i++)
-	{
-		SpriteType& currentSprite = snakeSprites.GetSprite(i);
-
-		Vector2 curPos = currentSprite.GetPosition();
-
-		if (curPos.y < -100 || curPos.y > 768)
-		{
-			snakeSprites.Remove(i);
-		}
-	}
-}
\ No newline at end of file
+/*
+
+Author: Matthew Minnett
+Date: 2022-03-31
+Purpose:
+1.	To create a unique simple point and click game utilizing multiple classes/objects
+2.	To utilize a dynamic memory data structure class to control game objects
+3.	To apply the pointer data type and address operators appropriately
+4.	To integrate textures and sprites into a DirectX application
+
+*/
+
+
+#include <string>
+#include <sstream>
+#include <cstring>
+#include "MyProject.h"
+
+using namespace std;
+using namespace DirectX;
+
+float RandFloat() { return float(rand()) / float(RAND_MAX); }
+
+//----------------------------------------------------------------------------------------------
+// Constructor
+MyProject::MyProject(HINSTANCE hInstance) : DirectXClass(hInstance), pacer(clock)
+{
+	DisplayFPS(true);
+
+	spriteBatch = NULL; // Created in InitalizeSprites once DirectX is running
+	particleBatch = NULL;
+	particleEffect = NULL;
+	particleLayout = NULL;
+	snapshotTick = 0;
+
+#ifdef ALLOC_TRACKING_ENABLED
+	playingTicks = 0;
+	steadyStateAllocations = 0;
+	steadyStateTicks = 0;
+	allocatingTicks = 0;
+#endif
+
+	// Set everything to starting values
+	currentState = eGameStates::START;
+
+	// Obstacle settings
+	obstacleLevel = 1; // Difficulty of obstacles
+	obstacleSpeed = 1;
+	timeToNextObstacle = 3;
+
+	// Item settings
+	itemCombo = 100; // Score gained from item starts at 100
+	itemLevel = 1;
+
+	// General play settings
+	score = 0;
+	lives = 2;
+	elapsedTime = 0;
+	graceTimer.index = graceTimer.generation = 0; // Zeroed handles are never pending
+	gameOverTimer.index = gameOverTimer.generation = 0;
+	scoreForExtraLife = 10000; // Score needed for extra life starts at 10,000
+	koalaColor = Color(1, 1, 1);
+
+	// Setting x-pos for each vine
+	vineX[0] = 131;
+	vineX[1] = 283;
+	vineX[2] = 435;
+	vineX[3] = 588;
+	vineX[4] = 740;
+	vineX[5] = 893;
+	currentVine = 2; // player starts on 3rd vine in array
+	lanes.SetLanes(vineX, VINE_COUNT, 20); // The same 20 pixels either side of a vine that Move takes clicks on
+
+	jobs.Start(); // One worker per core, less the main thread
+	obstacleSystems.SetJobSystem(&jobs);
+	obstacleSystems.SetNarrowPhase(&narrowPhase);
+	impacts.SetNarrowPhase(&narrowPhase);
+	particles.SetJobSystem(&jobs);
+	particleMs = 0;
+	particleBuildMs = 0;
+	particleFlood = false;
+	koalaClip = -1; // Added with the sprite sheets in InitalizeSprites
+	koalaAnimation.clip = -1;
+	frameDeltaTime = 0;
+	predictiveCollisions = false;
+	BuildFrameGraph();
+
+	HeadlessGameType::SetDefaults(headlessConfig); // Collision sizes are set from the textures once they load
+	autoplay = false;
+	autoplayWait = 0;
+	autoplayDropped = 0;
+	autoplayDroppedTotal = 0;
+
+	spawnDirector.Initialize(&timers, ScriptWake, &world);
+	waveCount = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Build the PLAYING update as a graph of tasks. Up to RemoveObstacles each step reads what
+// the step before it wrote, so they form a chain, and what that buys is that the AnyThread
+// steps spread their chunks across every core while the steps that call rand(), change the
+// game values or create and destroy entities stay on the main thread. After the removal,
+// Animate only writes animation and render components and the koala's sprite, and the
+// particles only read transforms and motion, so the two run side by side
+void MyProject::BuildFrameGraph()
+{
+	static const struct { const char* name; JobGraphType::Affinity affinity; } taskInfo[FRAME_TASK_COUNT] =
+	{
+		{ "Broadphase", JobGraphType::AnyThread },
+		{ "CheckForCollisions", JobGraphType::MainThread },
+		{ "UpdateTimers", JobGraphType::MainThread }, // Level changes and spawns call rand(), which is per thread
+		{ "UpdateObstacles", JobGraphType::AnyThread },
+		{ "MarkDespawns", JobGraphType::AnyThread },
+		{ "RemoveObstacles", JobGraphType::MainThread },
+		{ "Animate", JobGraphType::AnyThread },
+		{ "UpdateParticles", JobGraphType::MainThread }, // Emitting calls the particles' random numbers, the update spreads itself across the workers
+	};
+
+	for (int i = 0; i < FRAME_TASK_COUNT; i++)
+	{
+		frameTasks[i].project = this;
+		frameTasks[i].task = FrameTask(i);
+
+		int id = frameGraph.AddTask(taskInfo[i].name, taskInfo[i].affinity, &MyProject::RunFrameTask, &frameTasks[i]);
+		if (id == ParticlesTask)
+			frameGraph.AddDependency(RemoveTask, id); // Alongside Animate
+		else if (id > 0)
+			frameGraph.AddDependency(id - 1, id);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Run one step of the PLAYING update
+void MyProject::RunFrameTask(void* context)
+{
+	FrameTaskContext& frameTask = *(FrameTaskContext*)context;
+	MyProject& project = *frameTask.project;
+	float deltaTime = project.frameDeltaTime;
+
+	switch (frameTask.task)
+	{
+	case BroadphaseTask:
+		if (!project.predictiveCollisions) // The impact events don't need the candidates
+			project.obstacleSystems.Broadphase(project.world, project.GetPlayerBox());
+		break;
+	case CollisionTask:
+		project.CheckForCollisions(); // Every frame check to see if player has collided with obstacle/item
+		break;
+	case TimersTask:
+		project.UpdateTimers(deltaTime);
+		break;
+	case MoveTask:
+		project.UpdateObstacles(); // Move obstacles
+		break;
+	case MarkDespawnsTask:
+		project.obstacleSystems.MarkDespawns(project.world);
+		break;
+	case RemoveTask:
+		project.RemoveObstacles(); // Remove off-screen obstacles
+		break;
+	case AnimateTask:
+		project.Animate(deltaTime);
+		break;
+	case ParticlesTask:
+		project.UpdateParticles(deltaTime);
+		break;
+	}
+}
+
+//----------------------------------------------------------------------------------------------
+// Destructor
+MyProject::~MyProject()
+{
+	jobs.Stop();
+
+	TraceType::Stop(); // Close off the trace file if one is still being recorded
+
+	delete spriteBatch;
+	delete particleBatch;
+	delete particleEffect;
+	if (particleLayout != NULL)
+		particleLayout->Release();
+
+	wchar_t report[128];
+#ifdef ALLOC_TRACKING_ENABLED
+	swprintf(report, 128, L"Steady state: %lld heap allocations in %d of %d PLAYING ticks after the warm up\n",
+		steadyStateAllocations, allocatingTicks, steadyStateTicks);
+	OutputDebugStringW(report);
+#endif
+
+	swprintf(report, 128, L"Input latency: %d events, mean %.2f ms over the last %d, worst %.2f ms, %d dropped\n",
+		input.GetAppliedCount(), input.GetMeanLatencyMs(), InputQueueType::LATENCY_SAMPLES, input.GetMaxLatencyMs(), input.GetDroppedCount());
+	OutputDebugStringW(report);
+
+	if (autoplayer.GetDecisionCount() > 0)
+	{
+		swprintf(report, 128, L"Bot: %d decisions, %.0f nodes/s, %.0f headless ticks/s, %lld left out of its view, %u KB arenas\n",
+			autoplayer.GetDecisionCount(), autoplayer.GetNodesPerSecond(), autoplayer.GetTicksPerSecond(), autoplayDroppedTotal,
+			(unsigned int)(autoplayer.GetPoolBytes() / 1024));
+		OutputDebugStringW(report);
+	}
+
+	swprintf(report, 128, L"Input to present: mean %.2f ms over the last %d frames with input, frame jitter %.2f ms, %d missed deadlines\n",
+		pacer.GetMeanInputToPresentMs(), FramePacerType::HISTORY, pacer.GetJitterMs(), pacer.GetMissedCount());
+	OutputDebugStringW(report);
+}
+
+//----------------------------------------------------------------------------------------------
+//	Called by the game loop to render a single frame
+void MyProject::Render(void)
+{
+	FRAME_PHASE(Render);
+
+	snapshots.Acquire(); // The newest tick the sim has published, or the last one again if it hasn't published since
+	const RenderSnapshotType& snapshot = snapshots.GetFront();
+	const RenderHud& hud = snapshot.hud;
+
+	if (hud.state == eGameStates::START)
+	{
+		// We are in the main menu
+		startTex.Draw(DeviceContext, BackBuffer, 0, 0);
+	}
+	else if (hud.state == eGameStates::PLAYING)
+	{
+		// We are playing our game
+
+		// Draw Background First
+		backgroundTex.Draw(DeviceContext, BackBuffer, 0, 0);
+
+		// Render our sprites
+		DrawWorld(snapshot);
+
+		// Lava is in front of sprites
+		lavaTex.Draw(DeviceContext, BackBuffer, 0, 768 - lavaTex.GetHeight());
+
+		DrawParticles(snapshot); // Splashes show over the lava
+
+		DisplayUI(hud); // UI displays above lava
+	}
+	else if (hud.state == eGameStates::STRESS)
+	{
+		backgroundTex.Draw(DeviceContext, BackBuffer, 0, 0);
+
+		__int64 startTicks = StressTestType::GetTicks();
+		DrawWorld(snapshot); // Submission time, End sorts and sends the batch
+		stressTest.AddRenderTime(StressTestType::GetTicks() - startTicks);
+
+		lavaTex.Draw(DeviceContext, BackBuffer, 0, 768 - lavaTex.GetHeight());
+
+		DisplayStress(hud);
+	}
+	else if (hud.state == eGameStates::OVER)
+	{
+		// Game Over!
+		GameOver(hud);
+	}
+
+#ifdef PROFILER_ENABLED
+	if (profiler.IsOverlayVisible())
+	{
+		profiler.DrawOverlay(font, 560, 10); // Per-phase frame timings
+	}
+#endif
+#ifdef ALLOC_TRACKING_ENABLED
+	if (AllocTrackerType::IsOverlayVisible())
+	{
+		AllocTrackerType::DrawOverlay(font, 560, 190); // Heap traffic per subsystem
+
+		wchar_t steadyLine[128];
+		swprintf(steadyLine, 128, L"Steady state %lld allocations in %d of %d ticks", steadyStateAllocations, allocatingTicks, steadyStateTicks);
+		font.PrintMessage(560, 190 + (AllocTrackerType::TAG_COUNT + 1) * 18, steadyLine, FC_BLACK);
+	}
+#endif
+
+	pacer.EndRender(); // Present from here on, time blocked in it isn't render cost
+}
+
+//----------------------------------------------------------------------------------------------
+//	Called every frame to update objects.
+//	deltaTime: how much time in seconds has elapsed since the last frame
+void MyProject::Update(float deltaTime)
+{
+#ifdef PROFILER_ENABLED
+	profiler.MarkFrameStart(); // Finishes timing the last frame's Present
+#endif
+#ifdef ALLOC_TRACKING_ENABLED
+	AllocTrackerType::BeginFrame(); // Per-frame allocation counts start again
+#endif
+	flightRecorder.BeginFrame(deltaTime); // Dumps the recorder if the last frame was over budget
+
+	{
+		TRACE_SCOPE("frame", "PaceWait");
+		pacer.BeginFrame(); // Sleeps out the time this frame doesn't need, so the input it reads is as fresh as it can be
+	}
+
+	TRACE_SCOPE("frame", "Update");
+
+	ProcessInput(); // Clicks and keys from the window thread, applied at the tick boundary
+
+	if (currentState == eGameStates::PLAYING) // While we are PLAYING
+	{
+		if (autoplay)
+			Autoplay(); // Clicks for the koala, after any the player made
+
+		frameDeltaTime = deltaTime;
+
+#ifdef ALLOC_TRACKING_ENABLED
+		// Past the warm up every allocation is counted, not asserted, as a new wave can still need a new chunk
+		bool steadyState = ++playingTicks > STEADY_STATE_WARMUP;
+		if (steadyState)
+			AllocTrackerType::ExpectNoAllocations(true, false);
+#endif
+
+		frameGraph.Run(jobs); // Collisions, timers, move and remove obstacles, animation, then particles
+
+#ifdef ALLOC_TRACKING_ENABLED
+		if (steadyState)
+		{
+			long long unexpected = AllocTrackerType::GetUnexpectedAllocations();
+			AllocTrackerType::ExpectNoAllocations(false);
+
+			steadyStateAllocations += unexpected;
+			steadyStateTicks++;
+			allocatingTicks += unexpected > 0 ? 1 : 0;
+		}
+#endif
+	}
+	else if (currentState == eGameStates::OVER)
+	{
+		timers.Advance(deltaTime); // Game over timer counts down
+
+		TimerEvent event;
+		while (timers.PopExpired(event)) {} // Only gameOverTimer matters here, and IsPending says when it is done
+	}
+	else if (currentState == eGameStates::STRESS)
+	{
+		UpdateStress(); // Fixed ticks, deltaTime is ignored so every run of a scenario is the same
+	}
+
+	RecordFrameState();
+	PublishSnapshot();
+	pacer.EndSim(); // Render and Present from here on
+}
+
+// -----------------------------------------------------------------------------
+// Copy what this tick looks like into the back snapshot and hand it to the renderer
+void MyProject::PublishSnapshot()
+{
+	TRACE_SCOPE("frame", "PublishSnapshot");
+
+	RenderSnapshotType& snapshot = snapshots.GetBack();
+	snapshot.Begin(snapshotTick++);
+
+	if (currentState == eGameStates::PLAYING || currentState == eGameStates::STRESS)
+	{
+		snapshot.AddSprite(koalaSprite);
+
+		// Every obstacle and item, whatever its kind
+		world.ForEachChunk(ComponentBit<TransformComponent>() | ComponentBit<RenderComponent>(), [&](ArchetypeType& archetype, int chunk, int count)
+		{
+			snapshot.AddChunk(archetype, chunk, count);
+		});
+
+		int64_t start = clock.Now();
+		snapshot.SetParticles(particles);
+		snapshot.hud.particleCopyMs = float(double(clock.Now() - start) / double(ClockType::NANOSECONDS_PER_MILLISECOND));
+	}
+	else
+		snapshot.hud.particleCopyMs = 0;
+
+	RenderHud& hud = snapshot.hud;
+	hud.state = currentState;
+	hud.elapsedTime = elapsedTime;
+	hud.score = score;
+	hud.lives = lives;
+	hud.obstacleLevel = obstacleLevel;
+
+	for (int kind = 0; kind < OBSTACLE_KIND_COUNT; kind++)
+	{
+		hud.counts[kind] = world.GetCount(EntityKind::Kind(kind));
+		hud.capacities[kind] = world.GetCapacity(EntityKind::Kind(kind));
+	}
+
+	hud.inputLatencyMs = float(input.GetLastLatencyMs());
+	hud.inputMeanLatencyMs = float(input.GetMeanLatencyMs());
+	hud.inputMaxLatencyMs = float(input.GetMaxLatencyMs());
+	hud.autoplay = autoplay;
+	hud.autoplayNodes = autoplayer.GetNodeCount();
+	hud.autoplayDepth = autoplayer.GetDepth();
+	hud.autoplayMs = float(autoplayer.GetDecisionMs());
+	hud.autoplayDropped = autoplayDropped;
+	hud.pacing = pacer.IsEnabled();
+	hud.inputToPresentMs = float(pacer.GetInputToPresentMs());
+	hud.jitterMs = float(pacer.GetJitterMs());
+	hud.paceWaitMs = float(pacer.GetLastWaitMs());
+	hud.particleCount = particles.GetCount();
+	hud.particleMs = particleMs;
+
+	if (currentState == eGameStates::STRESS)
+	{
+		const StressScenario& scenario = stressTest.GetScenario();
+
+		strncpy(hud.stressName, scenario.name, sizeof(hud.stressName) - 1);
+		hud.stressName[sizeof(hud.stressName) - 1] = 0;
+		hud.stressTarget = stressTest.GetTargetCount();
+		hud.stressStep = stressTest.GetStep();
+		hud.stressStepCount = scenario.stepCount;
+		hud.stressAlive = GetObstacleCount();
+		hud.stressMemoryKB = (unsigned int)(world.GetMemoryBytes() / 1024);
+	}
+
+	snapshots.Publish();
+}
+
+// -----------------------------------------------------------------------------
+// Store the list sizes and game values in the flight recorder's current frame
+void MyProject::RecordFrameState()
+{
+	flightRecorder.SetList(FlightRecord::Rocks, world.GetCount(EntityKind::Rock), world.GetCapacity(EntityKind::Rock));
+	flightRecorder.SetList(FlightRecord::FireBalls, world.GetCount(EntityKind::FireBall), world.GetCapacity(EntityKind::FireBall));
+	flightRecorder.SetList(FlightRecord::Darts, world.GetCount(EntityKind::Dart), world.GetCapacity(EntityKind::Dart));
+	flightRecorder.SetList(FlightRecord::Snakes, world.GetCount(EntityKind::Snake), world.GetCapacity(EntityKind::Snake));
+	flightRecorder.SetList(FlightRecord::Items, world.GetCount(EntityKind::Item), world.GetCapacity(EntityKind::Item));
+
+	flightRecorder.SetGameState(score, lives, obstacleLevel, currentState);
+}
+
+
+//----------------------------------------------------------------------------------------------
+//	Window message handler which intercepts messages from the Windows OS. The programmer can check
+//	which message occurred and take appropriate actions
+LRESULT MyProject::ProcessWindowMessages(UINT msg, WPARAM wParam, LPARAM lParam)
+{
+	InputEvent event = {};
+	event.timestamp = clock.Now(); // When the message arrived, the latency runs from here
+
+	switch (msg)
+	{
+	case WM_LBUTTONUP:		// Left mouse button let up, queue it with the mouse coordinates
+	case WM_LBUTTONDOWN:	// Left mouse button down, queue it with the mouse coordinates
+		event.type = msg == WM_LBUTTONUP ? FlightRecord::MouseUp : FlightRecord::MouseDown;
+		event.x = GET_X_LPARAM(lParam);
+		event.y = GET_Y_LPARAM(lParam);
+		input.Push(event); // Applied by the sim at the start of its next tick
+		break;
+	case WM_KEYUP:		// queue the VK_???? of the key that was let up
+		event.type = FlightRecord::KeyUp;
+		event.key = (int)wParam;
+		input.Push(event);
+		break;
+	case WM_KEYDOWN:
+		break;
+	}
+
+	// Let the base class handle remaining messages, THIS IS REQUIRED as all messages should be handled appropriately
+	return DirectXClass::ProcessWindowMessages(msg, wParam, lParam);
+}
+
+// -----------------------------------------------------------------------------
+// Apply every input event queued since the last tick, in the order they arrived
+void MyProject::ProcessInput()
+{
+	InputEvent event;
+	while (input.Pop(event))
+	{
+		ApplyInput(event);
+		input.MarkApplied(event, clock.Now());
+		pacer.AddInput(event.timestamp); // Input to present is finished off once this frame presents
+		TRACE_INSTANT("input", "InputLatencyUs", int(input.GetLastLatencyMs() * 1000));
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Act on one mouse or key event
+void MyProject::ApplyInput(const InputEvent& event)
+{
+	flightRecorder.AddInput(event.type, event.key, event.x, event.y);
+
+	if (event.type == FlightRecord::MouseDown)
+	{
+		buttonDownLeft = true;
+		mousePos.x = (float)event.x;
+		mousePos.y = (float)event.y;
+	}
+	else if (event.type == FlightRecord::MouseUp)
+	{
+		buttonDownLeft = false;
+		mousePos.x = (float)event.x;
+		mousePos.y = (float)event.y;
+
+		if (currentState == eGameStates::START)
+		{
+			currentState = eGameStates::PLAYING; // If left click on start screen, play game
+			StartGameTimers();
+		}
+		else if (currentState == eGameStates::PLAYING)
+		{
+			Move(); // If left click in-game, move koala sprite
+		}
+		else if (currentState == eGameStates::OVER && !timers.IsPending(gameOverTimer))
+		{
+			Reset(); // If left click on game over, and the game over timer has run out, reset
+		}
+	}
+	else if (event.type == FlightRecord::KeyUp)
+	{
+		int key = event.key;
+
+		if (key >= '0' && key <= '4')		// setting the screen refesh rate setting keys 0 - 4
+			presentInterval = key - '0';
+#ifdef PROFILER_ENABLED
+		if (key == 'P')		// show or hide the profiler overlay
+			profiler.ToggleOverlay();
+#endif
+#ifdef ALLOC_TRACKING_ENABLED
+		if (key == 'M')		// show or hide the allocation overlay
+			AllocTrackerType::ToggleOverlay();
+#endif
+		if (key == 'S')		// start a stress test from the start screen, or stop the one running
+		{
+			if (currentState == eGameStates::START)
+				StartStressTest();
+			else if (currentState == eGameStates::STRESS)
+			{
+				stressTest.Stop();
+				Reset();
+			}
+		}
+		if (key == 'C')		// switch between checking every obstacle each frame and predicted impact events
+		{
+			predictiveCollisions = !predictiveCollisions;
+			impacts.Clear(); // Rebuilt from the world on the next check
+		}
+		if (key == 'K')		// step through the old boxes, the drawn boxes and the drawn pixels
+		{
+			narrowPhase.SetMode(NarrowPhaseType::Mode((narrowPhase.GetMode() + 1) % NarrowPhaseType::MODE_COUNT));
+			impacts.Clear(); // The events were for the other shapes
+		}
+		if (key == 'E' && currentState == eGameStates::START)		// time the batched headless games
+			RunBatchBenchmark();
+		if (key == 'D' && currentState == eGameStates::START)		// check the job system gives the same game as the main thread alone
+			RunDeterminismCheck();
+		if (key == 'B')		// hand the koala to the bot, or take it back
+		{
+			autoplay = !autoplay;
+			autoplayWait = 0; // Decide straight away
+		}
+		if (key == 'F')		// keep the particles topped up to FLOOD_PARTICLES, or let them die out
+			particleFlood = !particleFlood;
+		if (key == 'L')		// hold frames back to their latest safe start, or start each one as soon as the last has presented
+			pacer.SetEnabled(!pacer.IsEnabled());
+		if (key == 'J')		// spread obstacle updates across the worker threads, or run everything on the main thread
+			jobs.SetEnabled(!jobs.IsEnabled());
+		if (key == 'T' || key == 'Y')		// start/stop recording a trace, T for Chrome JSON, Y for Perfetto
+		{
+			if (TraceType::IsRecording())
+				TraceType::Stop();
+			else if (key == 'T')
+				TraceType::Start("koala_trace.json", TraceType::ChromeJson);
+			else
+				TraceType::Start("koala_trace.perfetto-trace", TraceType::PerfettoProtobuf);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Draw the koala and every obstacle and item in the snapshot in one sprite batch
+void MyProject::DrawWorld(const RenderSnapshotType& snapshot)
+{
+	spriteBatch->Begin(SpriteSortMode_BackToFront, GetBlendState()->NonPremultiplied());
+	{
+		const DrawInstance* instances = snapshot.GetInstances();
+		int count = snapshot.GetInstanceCount();
+
+		for (int i = 0; i < count; i++)
+		{
+			const TransformComponent& transform = instances[i].transform;
+			const RenderComponent& render = instances[i].render;
+			RECT region = { render.regionLeft, render.regionTop, render.regionRight, render.regionBottom };
+
+			spriteBatch->Draw(render.texture->GetResourceView(), Vector2(transform.x, transform.y), &region, Color(render.r, render.g, render.b, render.a),
+				transform.rotation * 3.141592f / 180.0f, Vector2(render.originX, render.originY), transform.scale, DirectX::SpriteEffects_None, render.layer);
+		}
+	}
+	spriteBatch->End();
+}
+
+// -----------------------------------------------------------------------------
+// Draw the snapshot's particles as additive quads, centred on each particle and its size
+// across. Every particle goes through one Begin and End with one effect and input layout,
+// handed to the primitive batch PARTICLE_QUADS at a time as that is all it holds
+void MyProject::DrawParticles(const RenderSnapshotType& snapshot)
+{
+	int count = snapshot.GetParticleCount();
+	particleBuildMs = 0;
+	if (count == 0)
+		return;
+
+	TRACE_SCOPE("frame", "DrawParticles");
+
+	const float* x = snapshot.GetParticleX();
+	const float* y = snapshot.GetParticleY();
+	const float* sizes = snapshot.GetParticleSizes();
+	const uint32_t* colors = snapshot.GetParticleColors();
+
+	DeviceContext->OMSetBlendState(GetBlendState()->Additive(), NULL, 0xFFFFFFFF);
+	DeviceContext->OMSetDepthStencilState(GetBlendState()->DepthNone(), 0);
+	DeviceContext->RSSetState(GetBlendState()->CullNone());
+	particleEffect->Apply(DeviceContext);
+	DeviceContext->IASetInputLayout(particleLayout);
+
+	int64_t buildTime = 0; // Filling in the quads, the draws are timed by the GPU
+	particleBatch->Begin();
+	for (int first = 0; first < count; first += PARTICLE_QUADS)
+	{
+		int quads = count - first < PARTICLE_QUADS ? count - first : PARTICLE_QUADS;
+		VertexPositionColor* vertex = &particleVertices[0];
+		int64_t buildStart = clock.Now();
+
+		for (int i = first; i < first + quads; i++)
+		{
+			float half = sizes[i] * 0.5f;
+			uint32_t packed = colors[i];
+			XMFLOAT4 color(float(packed & 0xFF) / 255.0f, float((packed >> 8) & 0xFF) / 255.0f, float((packed >> 16) & 0xFF) / 255.0f, float(packed >> 24) / 255.0f);
+
+			vertex[0] = VertexPositionColor(XMFLOAT3(x[i] - half, y[i] - half, 0), color);
+			vertex[1] = VertexPositionColor(XMFLOAT3(x[i] + half, y[i] - half, 0), color);
+			vertex[2] = VertexPositionColor(XMFLOAT3(x[i] + half, y[i] + half, 0), color);
+			vertex[3] = VertexPositionColor(XMFLOAT3(x[i] - half, y[i] + half, 0), color);
+			vertex += 4;
+		}
+
+		buildTime += clock.Now() - buildStart;
+		particleBatch->DrawIndexed(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST, &particleIndices[0], quads * 6, &particleVertices[0], quads * 4);
+	}
+	particleBatch->End();
+	particleBuildMs = float(double(buildTime) / double(ClockType::NANOSECONDS_PER_MILLISECOND));
+
+	DeviceContext->RSSetState(RasterState); // Back to what the framework draws with
+}
+
+// -----------------------------------------------------------------------------
+// Load all textures
+void MyProject::InitalizeTextures()
+{
+	LoadTexture(startTex, L"..\\Textures\\title.jpg");
+	LoadTexture(backgroundTex, L"..\\Textures\\background.jpg");
+	LoadTexture(lavaTex, L"..\\Textures\\lava.jpg");
+	LoadTexture(endTex, L"..\\Textures\\end.jpg");
+
+	// Player and obstacles
+	LoadTexture(koalaTex, L"..\\Textures\\player\\koala_jones.png");
+	LoadTexture(rockTex, L"..\\Textures\\obstacles\\rock.png");
+	LoadTexture(fireTex, L"..\\Textures\\obstacles\\fireball.png");
+	LoadTexture(dartTex, L"..\\Textures\\obstacles\\poison_dart.png");
+	LoadTexture(snakeTex, L"..\\Textures\\obstacles\\snake.png");
+
+	// Sprite sheets, SHEET_FRAMES frames side by side, each the size of the texture above
+	LoadTexture(koalaSheetTex, L"..\\Textures\\player\\koala_jones_sheet.png");
+	LoadTexture(dartSheetTex, L"..\\Textures\\obstacles\\poison_dart_sheet.png");
+	LoadTexture(snakeSheetTex, L"..\\Textures\\obstacles\\snake_sheet.png");
+
+	// Items
+	LoadTexture(orangeTex, L"..\\Textures\\items\\item1.png");
+	LoadTexture(pearTex, L"..\\Textures\\items\\item2.png");
+	LoadTexture(appleTex, L"..\\Textures\\items\\item3.png");
+	LoadTexture(bananaTex, L"..\\Textures\\items\\item4.png");
+	LoadTexture(chaliceTex, L"..\\Textures\\items\\item5.png");
+	LoadTexture(necklaceTex, L"..\\Textures\\items\\item6.png");
+	LoadTexture(tripowerTex, L"..\\Textures\\items\\item7.png");
+	LoadTexture(idolTex, L"..\\Textures\\items\\item8.png");
+}
+
+// -----------------------------------------------------------------------------
+// Load a single texture, traced so slow loads show up in the trace
+void MyProject::LoadTexture(TextureType& texture, const wchar_t* fileName)
+{
+	TRACE_SCOPE("load", "LoadTexture");
+	ALLOC_TAG(Textures);
+
+	texture.Load(D3DDevice, fileName);
+}
+
+// -----------------------------------------------------------------------------
+// Initalize all sprites, including obstacles and items for sprite lists
+void MyProject::InitalizeSprites()
+{
+	if (spriteBatch == NULL) // Reset calls this again, the batch and obstacle prototypes are kept between games
+	{
+		ALLOC_TAG(Rendering);
+		spriteBatch = new DirectX::SpriteBatch(DeviceContext);
+
+		// The particles draw in screen pixels, the same space as the sprite batch
+		particleBatch = new DirectX::PrimitiveBatch<VertexPositionColor>(DeviceContext);
+		particleEffect = new DirectX::BasicEffect(D3DDevice);
+		particleEffect->SetVertexColorEnabled(true);
+		particleEffect->SetProjection(XMMatrixOrthographicOffCenterRH(0, float(clientWidth), float(clientHeight), 0, 0, 1));
+
+		const void* shaderByteCode;
+		size_t byteCodeLength;
+		particleEffect->GetVertexShaderBytecode(&shaderByteCode, &byteCodeLength);
+		D3DDevice->CreateInputLayout(VertexPositionColor::InputElements, VertexPositionColor::InputElementCount, shaderByteCode, byteCodeLength, &particleLayout);
+
+		particleVertices.resize(PARTICLE_QUADS * 4);
+		particleIndices.resize(PARTICLE_QUADS * 6);
+		for (int quad = 0; quad < PARTICLE_QUADS; quad++)
+		{
+			static const uint16_t corners[6] = { 0, 1, 2, 0, 2, 3 };
+			for (int corner = 0; corner < 6; corner++)
+				particleIndices[quad * 6 + corner] = uint16_t(quad * 4 + corners[corner]);
+		}
+
+		TextureType* obstacleTextures[OBSTACLE_KIND_COUNT] = { &rockTex, &fireTex, &dartTex, &snakeTex }; // In EntityKind order
+		obstaclePool.Initialize(obstacleTextures);
+
+		// Every texture the koala or an obstacle is drawn from, for the pixel tests
+		TextureType* maskedTextures[] = { &rockTex, &fireTex, &dartTex, &snakeTex, &dartSheetTex, &snakeSheetTex, &koalaSheetTex };
+		for (TextureType* texture : maskedTextures)
+			narrowPhase.AddMask(D3DDevice, DeviceContext, texture); // Collides as its box if it can't be read
+
+		// A clip for each side of each animated kind, with the origin that side's pivot gives
+		TextureType* obstacleSheets[OBSTACLE_KIND_COUNT] = { NULL, NULL, &dartSheetTex, &snakeSheetTex };
+		static const float secondsPerFrame[OBSTACLE_KIND_COUNT] = { 0, 0, 0.08f, 0.15f };
+		for (int kind = 0; kind < OBSTACLE_KIND_COUNT; kind++)
+		{
+			if (obstacleTraits[kind].animation != ObstacleRule::Animated)
+				continue;
+
+			int width = obstacleTextures[kind]->GetWidth();
+			int height = obstacleTextures[kind]->GetHeight();
+			for (int side = 0; side < 2; side++)
+			{
+				const ObstacleSide& traits = obstacleTraits[kind].sides[side];
+				int clip = animator.AddClip(obstacleSheets[kind], width, height, SHEET_FRAMES, secondsPerFrame[kind], Vector2(width * traits.pivotX, height * traits.pivotY));
+				obstaclePool.SetAnimation(EntityKind::Kind(kind), side, animator, clip);
+			}
+		}
+
+		koalaClip = animator.AddClip(&koalaSheetTex, koalaTex.GetWidth(), koalaTex.GetHeight(), SHEET_FRAMES, 0.25f,
+			SpriteType::GetPivotOrigin(SpriteType::CenterLeft, koalaTex.GetWidth(), koalaTex.GetHeight()));
+
+		SpawnArea area = { vineX, VINE_COUNT, 768 - lavaTex.GetHeight() };
+		spawnDirector.SetArea(area);
+
+		// The bot's copies of the game collide with the same sizes
+		headlessConfig.lavaTop = 768 - lavaTex.GetHeight();
+		headlessConfig.koalaWidth = koalaTex.GetWidth();
+		headlessConfig.koalaHeight = koalaTex.GetHeight();
+		for (int kind = 0; kind < OBSTACLE_KIND_COUNT; kind++)
+		{
+			headlessConfig.obstacleHalfWidth[kind] = float(obstacleTextures[kind]->GetWidth() / 2);
+			headlessConfig.obstacleHalfHeight[kind] = float(obstacleTextures[kind]->GetHeight() / 2);
+		}
+	}
+
+	koalaSprite.Initialize(&koalaSheetTex, Vector2(vineX[currentVine], 768/2), 0, 0, 1, koalaColor, 0);
+	koalaSprite.SetPivot(SpriteType::Pivot::CenterLeft);
+	animator.Start(koalaSprite, koalaAnimation, koalaClip); // Onto the sheet's first frame, the clip's origin is for CenterLeft
+
+	for (int kind = 0; kind < OBSTACLE_KIND_COUNT; kind++)
+	{
+		AddObstacle(EntityKind::Kind(kind));
+	}
+
+	AddItems();
+}
+
+// -----------------------------------------------------------------------------
+// Prints out elapsed time, current score, current lives, as well as list info
+void MyProject::DisplayUI(const RenderHud& hud)
+{
+	FRAME_PHASE(DisplayUI);
+	ALLOC_TAG(UI);
+
+	wchar_t message[128]; // Formatted on the stack, no heap traffic
+
+	swprintf(message, 128, L"Time: %g", hud.elapsedTime);
+	font.PrintMessage(0, 700, message, FC_BLACK);
+
+	swprintf(message, 128, L"Score: %d", hud.score);
+	font.PrintMessage(0, 720, message, FC_BLACK);
+
+	swprintf(message, 128, L"Lives: %d", hud.lives);
+	font.PrintMessage(0, 740, message, FC_BLACK);
+
+	swprintf(message, 128, L"Input latency: %.3g ms, mean %.3g, worst %.3g", hud.inputLatencyMs, hud.inputMeanLatencyMs, hud.inputMaxLatencyMs);
+	font.PrintMessage(500, 740, message, FC_BLACK);
+
+	swprintf(message, 128, L"Input to present: %.3g ms, jitter %.3g, waited %.3g%ls", hud.inputToPresentMs, hud.jitterMs, hud.paceWaitMs,
+		hud.pacing ? L"" : L" (pacing off)");
+	font.PrintMessage(500, 720, message, FC_BLACK);
+
+	// The update on the sim side, the copy into the snapshot and the quads built from it on the render side
+	swprintf(message, 128, L"Particles: %d, update %.3g ms, copy %.3g, quads %.3g", hud.particleCount, hud.particleMs, hud.particleCopyMs,
+		particleBuildMs);
+	font.PrintMessage(500, 680, message, FC_BLACK);
+
+	if (hud.autoplay) // The bot's last decision
+	{
+		swprintf(message, 128, L"Bot: %d nodes, %d deep, %.3g ms, %d unseen", hud.autoplayNodes, hud.autoplayDepth, hud.autoplayMs, hud.autoplayDropped);
+		font.PrintMessage(500, 700, message, FC_BLACK);
+	}
+
+	// The count and capacity of the kind the obstacle level brought in, in EntityKind order
+	static const wchar_t* countNames[OBSTACLE_KIND_COUNT] = { L"Rocks", L"FireBalls", L"PoisonDarts", L"Snakes" };
+	static const wchar_t* capacityNames[OBSTACLE_KIND_COUNT] = { L"Rock", L"FireBall", L"PoisonDart", L"Snake" };
+
+	if (hud.obstacleLevel >= 1 && hud.obstacleLevel <= OBSTACLE_KIND_COUNT)
+	{
+		int kind = hud.obstacleLevel - 1;
+
+		swprintf(message, 128, L"%ls: %d", countNames[kind], hud.counts[kind]);
+		font.PrintMessage(200, 700, message, FC_BLACK);
+
+		swprintf(message, 128, L"%ls Capacity: %d", capacityNames[kind], hud.capacities[kind]);
+		font.PrintMessage(200, 720, message, FC_BLACK);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Display which count the stress test is on
+void MyProject::DisplayStress(const RenderHud& hud)
+{
+	ALLOC_TAG(UI);
+
+	wchar_t message[160];
+
+	swprintf(message, 160, L"Stress test %hs: %d obstacles, count %d of %d", hud.stressName, hud.stressTarget, hud.stressStep + 1, hud.stressStepCount);
+	font.PrintMessage(0, 700, message, FC_BLACK);
+
+	swprintf(message, 160, L"Alive: %d   World memory: %u KB", hud.stressAlive, hud.stressMemoryKB);
+	font.PrintMessage(0, 720, message, FC_BLACK);
+
+	font.PrintMessage(0, 740, L"S to stop, the report is written when the last count finishes", FC_BLACK);
+}
+
+// -----------------------------------------------------------------------------
+// Displays game over screen, with elapsed time and final score
+void MyProject::GameOver(const RenderHud& hud)
+{
+	ALLOC_TAG(UI);
+
+	endTex.Draw(DeviceContext, BackBuffer, 0, 0);
+
+	wchar_t message[64];
+
+	swprintf(message, 64, L"Time Survived: %g", hud.elapsedTime);
+	font.PrintMessage(400, 384, message, Color(1,1,1));
+
+	swprintf(message, 64, L"Final Score: %d", hud.score);
+	font.PrintMessage(400, 404, message, Color(1, 1, 1));
+}
+
+// -----------------------------------------------------------------------------
+// Resets to starting values
+void MyProject::Reset()
+{
+	// Set everything to starting values
+	currentState = eGameStates::START;
+
+	// Obstacle settings
+	obstacleLevel = 1;
+	obstacleSpeed = 1;
+	timeToNextObstacle = 3;
+
+	// Item settings
+	itemCombo = 100;
+	itemLevel = 1;
+
+	// General play settings
+	score = 0;
+	lives = 2;
+	elapsedTime = 0;
+#ifdef ALLOC_TRACKING_ENABLED
+	playingTicks = 0; // The new game warms up again
+#endif
+	timers.Clear(); // Grace, game over, script, level and item timers
+	graceTimer.generation = gameOverTimer.generation = 0;
+	spawnDirector.Clear();
+	waveCount = 0;
+	scoreForExtraLife = 10000;
+	koalaColor = Color(1, 1, 1);
+	currentVine = 2;
+
+	// Remove all obstacles and items
+	world.Clear();
+	impacts.Clear();
+	lanes.Clear();
+	particles.Clear();
+
+	// Re-initalize sprites
+	InitalizeSprites();
+}
+
+// -----------------------------------------------------------------------------
+// Add an obstacle, where it spawns and how fast it goes come from its kind's traits
+void MyProject::AddObstacle(EntityKind::Kind kind)
+{
+	if (currentState == eGameStates::PLAYING)
+	{
+		SpawnArea area = { vineX, VINE_COUNT, 768 - lavaTex.GetHeight() };
+
+		Entity entity = obstaclePool.Spawn(world, kind, area, obstacleSpeed);
+		lanes.Add(world, entity);
+		if (predictiveCollisions)
+			impacts.Schedule(world, entity);
+		TRACE_INSTANT("spawn", EntityKind::GetName(kind), world.GetCount(kind));
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Start the stress test from a clean world
+void MyProject::StartStressTest()
+{
+	StressScenario scenario;
+	StressTestType::SetDefaults(scenario);
+	StressTestType::LoadScenario("stress_scenario.txt", scenario); // Defaults are used if there is no file
+
+	Reset();
+	stressTest.Start(scenario);
+	currentState = eGameStates::STRESS;
+}
+
+// -----------------------------------------------------------------------------
+// Run one tick of the stress test: collide, move and despawn the obstacles, then top the
+// world back up to the target count. The timed part is the same work the PLAYING update
+// does to obstacles, without the game rules that would stop the run such as losing lives
+void MyProject::UpdateStress()
+{
+	if (!stressTest.BeginFrame()) // The report has been written
+	{
+		Reset();
+		return;
+	}
+
+	const StressScenario& scenario = stressTest.GetScenario();
+
+	if (stressTest.IsStepStarting())
+	{
+		world.Clear();
+		impacts.Clear();
+		lanes.Clear();
+		srand(scenario.seed + stressTest.GetStep()); // Each count starts from the same place every run
+		AddStressObstacles(stressTest.GetTargetCount(), true);
+	}
+
+	if (scenario.koalaPolicy == StressScenario::Wander && rand() % (StressTestType::TICKS_PER_SECOND / 2) == 0)
+	{
+		currentVine = rand() % VINE_COUNT;
+		Vector2 newPos = koalaSprite.GetPosition();
+		newPos.x = float(vineX[currentVine]);
+		koalaSprite.SetPosition(newPos);
+	}
+
+	__int64 startTicks = StressTestType::GetTicks();
+
+	PlayerBox player = GetPlayerBox();
+	if (!predictiveCollisions)
+		obstacleSystems.Broadphase(world, player);
+
+	int hits = 0;
+	ObstacleHit hit;
+	if (FindObstacleHit(player, hit)) // Only the first, the same as the game
+	{
+		world.Destroy(hit.entity);
+		hits++;
+	}
+
+	obstacleSystems.Move(world);
+	impacts.AdvanceTick();
+	obstacleSystems.MarkDespawns(world);
+	obstacleSystems.Compact(world);
+	lanes.Update(world);
+	animator.Advance(world, 1.0f / StressTestType::TICKS_PER_SECOND);
+
+	int alive = GetObstacleCount();
+	AddStressObstacles(stressTest.GetTargetCount() - alive, false); // Replace what left, at the edges like normal spawns
+
+	stressTest.AddSimTime(StressTestType::GetTicks() - startTicks, alive, world.GetMemoryBytes(), hits);
+}
+
+// -----------------------------------------------------------------------------
+// Spawn obstacles with kinds picked by the scenario's spawn rates. Scattered obstacles are
+// moved a random distance along their path, so a new count doesn't start as one wave
+void MyProject::AddStressObstacles(int count, bool scatter)
+{
+	const StressScenario& scenario = stressTest.GetScenario();
+	SpawnArea area = { vineX, VINE_COUNT, 768 - lavaTex.GetHeight() };
+
+	for (int i = 0; i < count; i++)
+	{
+		EntityKind::Kind kind = scenario.PickKind(float(rand()) / (float(RAND_MAX) + 1));
+		Entity entity = obstaclePool.Spawn(world, kind, area, scenario.obstacleSpeed);
+
+		if (scatter)
+		{
+			TransformComponent& transform = world.Get<TransformComponent>(entity);
+			const MotionComponent& motion = world.Get<MotionComponent>(entity);
+			float along = float(rand() % 600);
+
+			transform.x += motion.dirX * along;
+			transform.y += motion.dirY * along;
+		}
+
+		lanes.Add(world, entity);
+		if (predictiveCollisions)
+			impacts.Schedule(world, entity);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Add up the obstacles of every kind
+int MyProject::GetObstacleCount()
+{
+	int count = 0;
+
+	for (int kind = 0; kind < OBSTACLE_KIND_COUNT; kind++)
+		count += world.GetCount(EntityKind::Kind(kind));
+
+	return count;
+}
+
+// -----------------------------------------------------------------------------
+// Add an item at a random vine position
+void MyProject::AddItems()
+{
+	if (currentState == eGameStates::PLAYING)
+	{
+		SpriteType newSprite;
+		Vector2 pos = ItemPos(); // Go to item pos function to get a random position
+
+		switch (itemLevel) // Based on item level, initialize item sprite
+		{
+		case 1:
+			newSprite.Initialize(&orangeTex, pos, 0, 0, 1, Color(1, 1, 1), 0);
+			break;
+		case 2:
+			newSprite.Initialize(&pearTex, pos, 0, 0, 1, Color(1, 1, 1), 0);
+			break;
+		case 3:
+			newSprite.Initialize(&appleTex, pos, 0, 0, 1, Color(1, 1, 1), 0);
+			break;
+		case 4:
+			newSprite.Initialize(&bananaTex, pos, 0, 0, 1, Color(1, 1, 1), 0);
+			break;
+		case 5:
+			newSprite.Initialize(&chaliceTex, pos, 0, 0, 1, Color(1, 1, 1), 0);
+			break;
+		case 6:
+			newSprite.Initialize(&necklaceTex, pos, 0, 0, 1, Color(1, 1, 1), 0);
+			break;
+		case 7:
+			newSprite.Initialize(&tripowerTex, pos, 0, 0, 1, Color(1, 1, 1), 0);
+			break;
+		case 8:
+			newSprite.Initialize(&idolTex, pos, 0, 0, 1, Color(1, 1, 1), 0);
+			break;
+		}
+
+		newSprite.SetPivot(SpriteType::Pivot::Center);
+
+		Entity item = world.Create(ObstaclePoolType::ITEM_MASK, EntityKind::Item);
+		ObstaclePoolType::CopySprite(newSprite, world.Get<TransformComponent>(item), world.Get<RenderComponent>(item), world.Get<ColliderComponent>(item));
+
+		world.Get<PickupComponent>(item).level = itemLevel;
+
+		world.Get<LifetimeComponent>(item).timer = timers.Start(5, ItemExpired, item.index, item.generation); // items despawn after 5 seconds
+
+		TRACE_INSTANT("sim", "SpawnItem", world.GetCount(EntityKind::Item));
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Get a random position for item
+Vector2 MyProject::ItemPos()
+{
+	if (currentState == eGameStates::PLAYING)
+	{
+		Vector2 pos = koalaSprite.GetPosition();
+		int tries = 0; // Give up on finding a clear spot after a few, the item still has to go somewhere
+
+		// Keep looping until the x of the item pos is not equal to the player's x pos, and nothing will reach it straight away
+		while (pos.x == koalaSprite.GetPosition().x || (tries++ < 8 && !lanes.IsSafe(lanes.FindLane(pos.x), pos.y - 20, pos.y + 20, ITEM_SAFE_TICKS)))
+		{
+			switch (rand() % 6) // Random vine
+			{
+			case 0: // Vine 1
+				pos.x = vineX[0];
+				break;
+			case 1: // Vine 2
+				pos.x = vineX[1];
+				break;
+			case 2: // Vine 3
+				pos.x = vineX[2];
+				break;
+			case 3: // Vine 4
+				pos.x = vineX[3];
+				break;
+			case 4: // Vine 5
+				pos.x = vineX[4];
+				break;
+			case 5: // Vine 6
+				pos.x = vineX[5];
+				break;
+			}
+			pos.y = rand() % (768 - lavaTex.GetHeight() - 30) + 30; // Random y
+		}
+		return pos;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Move player sprite based on mouse pos
+void MyProject::Move()
+{
+	// If mouse is clicked on the same vine as player, and mouse is clicked above the koala sprite
+	if (mousePos.y <= (koalaSprite.GetPosition().y - 50) && mousePos.x >= (koalaSprite.GetPosition().x - 20) && mousePos.x <= (koalaSprite.GetPosition().x + 20))
+	{
+		Vector2 newPos = koalaSprite.GetPosition(); // Set new pos to koala pos
+		newPos.y -= 50; // Move new pos up by 50
+		koalaSprite.SetPosition(newPos); // Update koala pos
+	}
+
+	// If mouse is clicked on the same vine as player, and mouse is clicked below the koala sprite
+	else if (mousePos.y >= (koalaSprite.GetPosition().y + 50) && mousePos.x >= (koalaSprite.GetPosition().x - 20) && mousePos.x <= (koalaSprite.GetPosition().x + 20) && mousePos.y < (768 - lavaTex.GetHeight() - 20))
+	{
+		Vector2 newPos = koalaSprite.GetPosition();
+		newPos.y += 50; // Move new pos down by 50
+		koalaSprite.SetPosition(newPos); // Update koala pos
+	}
+
+	// If mouse is clicked on the vine to the right of the current vine, and current vine is less than or equal to vine count
+	else if (mousePos.x >= (vineX[currentVine + 1] - 20) && mousePos.x <= (vineX[currentVine + 1] + 20) && currentVine <= VINE_COUNT)
+	{
+		Vector2 newPos = koalaSprite.GetPosition();
+		newPos.x = vineX[currentVine + 1]; // new x pos = vine that was clicked on
+		koalaSprite.SetPosition(newPos); // Koala sprite moves to new vine
+		currentVine++; // Add to currentVine to keep track of vine position
+		score += 20; // Movement adds to the score
+	}
+
+	// If mouse is clicked on the vine to the left of the current vine, and current vine is greater than 0
+	else if (mousePos.x >= (vineX[currentVine - 1] - 20) && mousePos.x <= (vineX[currentVine - 1] + 20) && currentVine > 0)
+	{
+		Vector2 newPos = koalaSprite.GetPosition();
+		newPos.x = vineX[currentVine - 1]; // new x pos = vine that was clicked on
+		koalaSprite.SetPosition(newPos); // Update koala position to new vine
+		currentVine--; // Subtract from current vine
+		score += 20; // Movement adds to score
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Check to see if koala sprite collides any with items or obstacles
+void MyProject::CheckForCollisions()
+{
+	FRAME_PHASE(CheckForCollisions);
+
+	PlayerBox player = GetPlayerBox();
+
+	ObstacleHit hit;
+	if (!timers.IsPending(graceTimer) && FindObstacleHit(player, hit)) // If collision and not invulnerable
+	{
+		TRACE_INSTANT("hit", EntityKind::GetName(hit.kind), lives);
+		world.Destroy(hit.entity); // Remove obstacle
+		lives -= hit.lives; // Lose a life
+		graceTimer = timers.Start(1, GraceOver); // Give a second of invulnerability
+		koalaSprite.SetColor(Color(1, 0, 0)); // Koala turns red
+		Vector2 newPos = koalaSprite.GetPosition();
+		particles.Emit(ParticleSystemType::KoalaHit, newPos.x, newPos.y, HIT_PARTICLES); // Burst where the koala was hit
+		newPos.y += hit.knockbackY; // Knock koala down a bit, or up for fire
+		koalaSprite.SetPosition(newPos);
+		if (lives < 0)
+		{
+			currentState = eGameStates::OVER; // When lives are less than 0, game over!
+			gameOverTimer = timers.Start(1, GameOverWait); // Player must stare at their defeat for at least 1 second
+		}
+	}
+
+	world.ForEachChunk(ComponentBit<TransformComponent>() | ComponentBit<ColliderComponent>() | ComponentBit<PickupComponent>(), [&](ArchetypeType& archetype, int chunk, int count)
+	{
+		const TransformComponent* transforms = archetype.GetArray<TransformComponent>(chunk);
+		const ColliderComponent* colliders = archetype.GetArray<ColliderComponent>(chunk);
+		LifetimeComponent* lifetimes = archetype.GetArray<LifetimeComponent>(chunk);
+		const Entity* entities = archetype.GetEntities(chunk);
+
+		for (int i = 0; i < count; i++)
+		{
+			if (player.Overlaps(transforms[i].x, transforms[i].y, colliders[i].halfWidth, colliders[i].halfHeight)) // If collision
+			{
+				TRACE_INSTANT("sim", "CollectItem", itemCombo);
+				timers.Cancel(lifetimes[i].timer); // Collected, so it won't expire
+				world.DestroyLater(entities[i]); // Remove item
+				score += itemCombo; // Add current itemCombo score to score
+				itemCombo = itemCombo * 2; // Double current itemCombo
+			}
+		}
+	});
+
+	world.FlushDestroyed();
+}
+
+// -----------------------------------------------------------------------------
+// Find the first obstacle touching the player. Checking every Broadphase candidate finds
+// what is touching now, the impact events also catch anything that passed through since
+// the last frame
+bool MyProject::FindObstacleHit(const PlayerBox& player, ObstacleHit& hit)
+{
+	if (narrowPhase.TestsShapes())
+	{
+		TransformComponent transform;
+		RenderComponent render;
+		ColliderComponent collider;
+		ObstaclePoolType::CopySprite(koalaSprite, transform, render, collider);
+		narrowPhase.SetPlayer(transform, render);
+	}
+
+	if (!predictiveCollisions)
+		return obstacleSystems.FindHit(world, player, hit);
+
+	impacts.SetPlayerBox(player); // Rebuilds the events if the koala has moved or been knocked back
+	return impacts.FindHit(world, hit);
+}
+
+// -----------------------------------------------------------------------------
+// Work out the koala's collision box once, the same way SpriteType::PointCollision does, or
+// around its drawn shape when the narrow phase tests those
+PlayerBox MyProject::GetPlayerBox()
+{
+	if (narrowPhase.TestsShapes())
+	{
+		TransformComponent transform;
+		RenderComponent render;
+		ColliderComponent collider;
+		ObstaclePoolType::CopySprite(koalaSprite, transform, render, collider);
+
+		float left, top, right, bottom;
+		OrientedBox::FromSprite(transform, render).GetBounds(left, top, right, bottom);
+
+		PlayerBox drawn = { int(floorf(left)), int(floorf(top)), int(ceilf(right)), int(ceilf(bottom)) };
+		return drawn;
+	}
+
+	RECT region = koalaSprite.GetTextureRegion();
+	Vector2 position = koalaSprite.GetPosition();
+	float scale = koalaSprite.GetScale();
+
+	PlayerBox box;
+	int width = region.right - region.left; // The koala's region is a frame of its sheet
+	int height = region.bottom - region.top;
+
+	box.left = position.x - (width >> 1) * scale;
+	box.right = box.left + width * scale;
+	box.top = position.y - (height >> 1) * scale;
+	box.bottom = box.top + height * scale;
+
+	return box;
+}
+
+// -----------------------------------------------------------------------------
+// Every SEGMENT_TICKS ticks copy the game for the bot and click where its action says, the
+// same way a player would, so the click goes through Move and into the flight recorder
+void MyProject::Autoplay()
+{
+	if (--autoplayWait > 0)
+		return;
+	autoplayWait = AutoplayerType::SEGMENT_TICKS;
+
+	TRACE_SCOPE("sim", "Autoplay");
+
+	autoplayDropped = CaptureHeadless(autoplayView); // Past MAX_OBSTACLES the bot can't dodge what it can't see
+	autoplayDroppedTotal += autoplayDropped;
+	HeadlessGameType::Action action = autoplayer.Decide(autoplayView, clock);
+
+	Vector2 position = koalaSprite.GetPosition();
+
+	InputEvent event = {};
+	event.type = FlightRecord::MouseUp;
+	event.x = int(position.x);
+	event.y = int(position.y);
+
+	switch (action)
+	{
+	case HeadlessGameType::Up:
+		event.y -= 50;
+		break;
+	case HeadlessGameType::Down:
+		event.y += 50;
+		break;
+	case HeadlessGameType::Left:
+		event.x = vineX[currentVine - 1];
+		break;
+	case HeadlessGameType::Right:
+		event.x = vineX[currentVine + 1];
+		break;
+	default:
+		return; // Waiting, no click
+	}
+
+	event.timestamp = clock.Now();
+	ApplyInput(event);
+}
+
+// -----------------------------------------------------------------------------
+// Fill in a headless game from where everything is now. Timers become ticks at the
+// headless game's rate. The game has fixed room, anything past it is counted and left out
+int MyProject::CaptureHeadless(HeadlessGameType& game)
+{
+	int dropped = 0;
+
+	Vector2 position = koalaSprite.GetPosition();
+	int graceTicks = int(ceilf(timers.GetTimeLeft(graceTimer) * HeadlessGameType::TICKS_PER_SECOND));
+
+	game.Begin(&headlessConfig, 1, 0); // The seed only matters to spawning, which the bot has off
+	game.SetPlayer(currentVine, position.x, position.y, lives, score, itemCombo, graceTicks);
+	game.SetLevels(itemLevel, obstacleLevel, obstacleSpeed, scoreForExtraLife);
+
+	world.ForEachChunk(ObstaclePoolType::OBSTACLE_MASK, [&](ArchetypeType& archetype, int chunk, int count)
+	{
+		EntityKind::Kind kind = archetype.GetKind();
+		const TransformComponent* transforms = archetype.GetArray<TransformComponent>(chunk);
+		const MotionComponent* motions = archetype.GetArray<MotionComponent>(chunk);
+		const ColliderComponent* colliders = archetype.GetArray<ColliderComponent>(chunk);
+		const PatrolComponent* patrols = archetype.Has(ComponentBit<PatrolComponent>()) ? archetype.GetArray<PatrolComponent>(chunk) : NULL;
+
+		for (int i = 0; i < count; i++)
+		{
+			float startY = patrols != NULL ? patrols[i].startY : transforms[i].y;
+			float endY = patrols != NULL ? patrols[i].endY : transforms[i].y;
+			bool reversed = patrols == NULL || patrols[i].reversed != 0;
+
+			if (!game.AddObstacle(kind, transforms[i].x, transforms[i].y, motions[i].speed, motions[i].dirX, motions[i].dirY,
+				colliders[i].halfWidth, colliders[i].halfHeight, startY, endY, reversed))
+				dropped++;
+		}
+	});
+
+	world.ForEachChunk(ObstaclePoolType::ITEM_MASK, [&](ArchetypeType& archetype, int chunk, int count)
+	{
+		const TransformComponent* transforms = archetype.GetArray<TransformComponent>(chunk);
+		const ColliderComponent* colliders = archetype.GetArray<ColliderComponent>(chunk);
+		const LifetimeComponent* lifetimes = archetype.GetArray<LifetimeComponent>(chunk);
+
+		for (int i = 0; i < count; i++)
+		{
+			int expiryTicks = int(timers.GetTimeLeft(lifetimes[i].timer) * HeadlessGameType::TICKS_PER_SECOND);
+			if (!game.AddItem(transforms[i].x, transforms[i].y, colliders[i].halfWidth, colliders[i].halfHeight, expiryTicks))
+				dropped++;
+		}
+	});
+
+	return dropped;
+}
+
+// -----------------------------------------------------------------------------
+// Step a batch of headless games for half a second, waiting most ticks and clicking at
+// random otherwise, and report the ticks per second and how long the games lasted. Every
+// game that ends is added to batch_results.kjrs for the ResultsQuery tool
+void MyProject::RunBatchBenchmark()
+{
+	TRACE_SCOPE("sim", "BatchBenchmark");
+
+	static const int GAMES = 256;
+	static const int64_t RUN_TIME = ClockType::NANOSECONDS_PER_SECOND / 2;
+
+	ResultsStoreType results;
+	results.Open("batch_results.kjrs"); // Each run adds to the store
+
+	BatchEnvironmentType batch;
+	batch.Initialize(&headlessConfig, GAMES, uint32_t(clock.Now() / ClockType::NANOSECONDS_PER_MILLISECOND)); // Different games each run
+	batch.SetResults(results.IsOpen() ? &results : NULL, 0);
+
+	uint8_t actions[GAMES];
+	uint32_t random = 1;
+	int64_t start = clock.Now();
+	int64_t elapsed = 0;
+
+	while (elapsed < RUN_TIME)
+	{
+		for (int step = 0; step < 64; step++)
+		{
+			for (int game = 0; game < GAMES; game++)
+			{
+				random = random * 1103515245 + 12345;
+				int roll = (random >> 16) % 64; // A click about every 13 ticks
+				actions[game] = uint8_t(roll < HeadlessGameType::ACTION_COUNT ? roll : HeadlessGameType::Wait);
+			}
+			batch.Step(actions);
+		}
+		elapsed = clock.Now() - start;
+	}
+
+	double seconds = double(elapsed) / double(ClockType::NANOSECONDS_PER_SECOND);
+	long long episodes = batch.GetEpisodeCount();
+
+	wchar_t report[160];
+	swprintf(report, 160, L"Batch: %d games, %.1f M game ticks/s, %lld games ended lasting %.0f ticks and scoring %.0f on average\n",
+		GAMES, double(batch.GetTotalTicks()) / seconds / 1000000.0, episodes,
+		episodes > 0 ? double(batch.GetEpisodeTicks()) / double(episodes) : 0.0,
+		episodes > 0 ? double(batch.GetEpisodeScore()) / double(episodes) : 0.0);
+	OutputDebugStringW(report);
+}
+
+// -----------------------------------------------------------------------------
+// Play CHECK_TICKS fixed ticks of the PLAYING update from the same seed, once with the
+// jobs spread across the workers and once on the main thread, then compare the world
+// hashes. There is no input and the bot is off, so the koala stays on its vine and the
+// game may end early, which the tick count shows
+void MyProject::RunDeterminismCheck()
+{
+	TRACE_SCOPE("sim", "DeterminismCheck");
+
+	bool wasEnabled = jobs.IsEnabled();
+	bool wasAutoplay = autoplay;
+	autoplay = false;
+
+	uint64_t hashes[2];
+	int ticks[2];
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		jobs.SetEnabled(pass == 0);
+
+		Reset();
+		timers.Clear(true); // Both passes start at tick 0 with no part tick left over, or they fire a frame apart
+		srand(CHECK_SEED);
+		currentState = eGameStates::PLAYING;
+		StartGameTimers();
+
+		frameDeltaTime = 1.0f / 60.0f;
+		for (ticks[pass] = 0; ticks[pass] < CHECK_TICKS && currentState == eGameStates::PLAYING; ticks[pass]++)
+			frameGraph.Run(jobs);
+
+		hashes[pass] = HashWorld();
+	}
+
+	jobs.SetEnabled(wasEnabled);
+	autoplay = wasAutoplay;
+	Reset();
+
+	wchar_t report[160];
+	swprintf(report, 160, L"Determinism: %d workers %016llx after %d ticks, main thread %016llx after %d ticks, %ls\n",
+		jobs.GetWorkerCount(), (unsigned long long)hashes[0], ticks[0], (unsigned long long)hashes[1], ticks[1],
+		hashes[0] == hashes[1] && ticks[0] == ticks[1] ? L"the same" : L"DIFFERENT");
+	OutputDebugStringW(report);
+}
+
+// -----------------------------------------------------------------------------
+// FNV-1a over the bytes of every chunk's transforms, in archetype and row order, then the
+// koala and the game values. Handles are left out, Reset and every destroy move their
+// generations on, so the same game never has the same handles twice. Particles are left
+// out too, they have their own random numbers and never touch the game
+uint64_t MyProject::HashWorld()
+{
+	uint64_t hash = 14695981039346656037ull;
+
+	auto add = [&hash](const void* data, size_t size)
+	{
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= ((const uint8_t*)data)[i];
+			hash *= 1099511628211ull;
+		}
+	};
+
+	world.ForEachChunk(ComponentBit<TransformComponent>(), [&](ArchetypeType& archetype, int chunk, int count)
+	{
+		int kind = archetype.GetKind();
+		add(&kind, sizeof(kind));
+		add(archetype.GetArray<TransformComponent>(chunk), sizeof(TransformComponent) * count);
+	});
+
+	Vector2 koala = koalaSprite.GetPosition();
+	float values[] = { koala.x, koala.y, elapsedTime, obstacleSpeed };
+	int counts[] = { score, lives, currentVine, obstacleLevel, itemLevel, itemCombo };
+	add(values, sizeof(values));
+	add(counts, sizeof(counts));
+
+	return hash;
+}
+
+// -----------------------------------------------------------------------------
+// Start the spawn script and timers that run for the whole game
+void MyProject::StartGameTimers()
+{
+	spawnDirector.SetObstacleLevel(obstacleLevel);
+	spawnDirector.Run(RandomSpawns(spawnDirector, 3, timeToNextObstacle)); // First obstacle 3 seconds in
+	timers.StartRepeating(LEVEL_SECONDS, LEVEL_SECONDS, LevelChange); // Difficulty increase/item spawn every 15 seconds
+}
+
+// -----------------------------------------------------------------------------
+// Updates the game clock and extra lives, then acts on every timer that fired this frame
+void MyProject::UpdateTimers(float deltaTime)
+{
+	elapsedTime += deltaTime; // Add to elapsed time
+
+	if (score >= scoreForExtraLife)
+	{
+		lives += 1; // Add an extra life if score is equal to or greater than or equal to scoreForExtraLife
+		scoreForExtraLife = scoreForExtraLife * 2.5; // scoreForExtraLife is multiplied by 2.5
+	}
+
+	timers.Advance(deltaTime);
+
+	TimerEvent event;
+	while (timers.PopExpired(event))
+	{
+		HandleTimer(event);
+	}
+
+	spawnDirector.Update(); // Scripts waiting on a condition
+	AddObstacles();
+}
+
+// -----------------------------------------------------------------------------
+// Act on a timer that has fired
+void MyProject::HandleTimer(const TimerEvent& event)
+{
+	switch (event.type)
+	{
+	case GraceOver:
+		koalaSprite.SetColor(Color(1, 1, 1)); // Set koala back to normal colour once grace period is over
+		break;
+	case ScriptWake:
+		spawnDirector.Wake(event);
+		break;
+	case LevelChange:
+		UpdateLevel(); // Item level and obstacle level go up
+		break;
+	case ItemExpired:
+	{
+		Entity item = { event.index, event.generation };
+		ExpireItem(item);
+		break;
+	}
+	case GameOverWait:
+		break; // Checked with IsPending when the player clicks
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Updates obstacle and item levels
+void MyProject::UpdateLevel()
+{
+	FRAME_PHASE(UpdateLevel);
+
+	if (itemLevel > 8) // If itemLevel is greater than 8
+	{
+		itemLevel = 1; // Set level back to 1 (orange/item1)
+		itemCombo = 100; // Reset combo (how much score gained from item)
+	}
+
+	// Spawn new item
+	AddItems();
+	itemLevel++; // Item level goes up by 1
+
+	if (obstacleLevel <= 4)
+	{
+		obstacleLevel++; // Obstacle level goes up until it reaches 4,
+	}
+	else if (obstacleLevel >= 5)
+	{
+		obstacleSpeed += 0.5; // at which point obstacle speed is added to instead
+	}
+
+	spawnDirector.SetObstacleLevel(obstacleLevel);
+	spawnDirector.Run(StartWave(spawnDirector, waveCount++)); // Set piece on top of the random spawns
+
+	TRACE_INSTANT("sim", "LevelChange", obstacleLevel);
+}
+
+// -----------------------------------------------------------------------------
+// Updates obstacle positions
+void MyProject::UpdateObstacles()
+{
+	FRAME_PHASE(UpdateObstacles);
+
+	obstacleSystems.Move(world);
+	impacts.AdvanceTick();
+}
+
+// -----------------------------------------------------------------------------
+// Spawn what the scripts emitted, placed obstacles go in as one burst
+void MyProject::AddObstacles()
+{
+	FRAME_PHASE(AddObstacles);
+
+	spawnDirector.Flush(obstaclePool, obstacleSpeed);
+
+	const std::vector<Entity>& spawned = spawnDirector.GetSpawned();
+	for (size_t i = 0; i < spawned.size(); i++)
+	{
+		lanes.Add(world, spawned[i]);
+		if (predictiveCollisions)
+			impacts.Schedule(world, spawned[i]);
+		TRACE_INSTANT("spawn", EntityKind::GetName(world.GetKind(spawned[i])), world.GetCount(world.GetKind(spawned[i])));
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Remove an item whose time ran out, unless it was collected first
+void MyProject::ExpireItem(Entity item)
+{
+	if (!world.IsAlive(item))
+		return; // Gone with a Reset
+
+	itemCombo = 100; // reset score gained from item
+	itemLevel = 1; // reset item level
+
+	TRACE_INSTANT("despawn", EntityKind::GetName(EntityKind::Item), int(item.index));
+	world.Destroy(item);
+}
+
+// -----------------------------------------------------------------------------
+// Remove obstacles if they go off-screen
+void MyProject::RemoveObstacles()
+{
+	FRAME_PHASE(RemoveObstacles);
+
+	obstacleSystems.Compact(world); // Obstacles MarkDespawns found off-screen
+	lanes.Update(world); // Where everything left has moved to
+}
+
+// -----------------------------------------------------------------------------
+// Step the obstacles' animations and the koala's
+void MyProject::Animate(float deltaTime)
+{
+	TRACE_SCOPE("frame", "Animate");
+
+	animator.Advance(world, deltaTime);
+	animator.Advance(koalaSprite, koalaAnimation, deltaTime);
+}
+
+// -----------------------------------------------------------------------------
+// Trail embers off every fireball and splash wherever an obstacle crossed the top of the
+// lava this tick, going in or coming out. Then move, fade and age them all
+void MyProject::UpdateParticles(float deltaTime)
+{
+	TRACE_SCOPE("frame", "UpdateParticles");
+
+	float lavaTop = float(768 - lavaTex.GetHeight());
+
+	world.ForEachChunk(ComponentBit<TransformComponent>() | ComponentBit<MotionComponent>(), [&](ArchetypeType& archetype, int chunk, int count)
+	{
+		EntityKind::Kind kind = archetype.GetKind();
+		if (kind >= OBSTACLE_KIND_COUNT || obstacleTraits[kind].axis != ObstacleRule::Vertical)
+			return; // Nothing else gets near the lava
+
+		const TransformComponent* transforms = archetype.GetArray<TransformComponent>(chunk);
+		const MotionComponent* motions = archetype.GetArray<MotionComponent>(chunk);
+
+		for (int i = 0; i < count; i++)
+		{
+			float lastY = transforms[i].y - motions[i].dirY * motions[i].speed; // Where it was before this tick's move
+			if ((transforms[i].y >= lavaTop) != (lastY >= lavaTop))
+				particles.Emit(ParticleSystemType::LavaSplash, transforms[i].x, lavaTop, SPLASH_PARTICLES);
+
+			if (kind == EntityKind::FireBall)
+				particles.Emit(ParticleSystemType::FireTrail, transforms[i].x, transforms[i].y, TRAIL_PARTICLES);
+		}
+	});
+
+	if (particleFlood) // Splashes stepped along the lava until there are FLOOD_PARTICLES, rand() is left to the game
+	{
+		for (int splash = 0; particles.GetCount() < FLOOD_PARTICLES; splash++)
+			particles.Emit(ParticleSystemType::LavaSplash, float(splash * 97 % clientWidth), lavaTop, SPLASH_PARTICLES);
+	}
+
+	int64_t start = clock.Now();
+	particles.Update(deltaTime);
+	particleMs = float(double(clock.Now() - start) / double(ClockType::NANOSECONDS_PER_MILLISECOND));
+}
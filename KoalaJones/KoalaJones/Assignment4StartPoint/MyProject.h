@@ -1,129 +1,266 @@
-#pragma once
-
-//----------------------------------------------------------------------------------------------
-//	Main project class
-//	Creates a "MyProject" class which inherits the Directx class to help us initalize DirectX
-//  Since we inherit the "DirectXClass" publicly the "MyProject" class has access to all the 
-//	"DirectXClass" functionality.
-//
-//	Now we can add addition code to this class to build on what is provided by the "DirectXClass"
-//----------------------------------------------------------------------------------------------
-#pragma once
-
-#include <Windowsx.h>
-#include <SpriteBatch.h>
-#include "DirectX.h"
-#include "TextureType.h"
-#include "SpriteType.h"
-#include "SpriteListType.h"
-
-class MyProject : public DirectXClass
-{
-	public:
-		// constructor
-		MyProject(HINSTANCE hInstance);		// Constructor: required to initialize the base class, DirectXClass.
-
-											// Virtual function from DirectX class which we are implementing here
-		LRESULT ProcessWindowMessages(UINT msg, WPARAM wParam, LPARAM lParam);		// window message handler
-		void Render(void);				// Called by the render loop to render a single frame
-		void Update(float deltaTime);	// Called by DirectX framework to allow you to update any scene objects
-		
-		void InitalizeTextures();
-		void InitalizeSprites();
-
-		void DisplayUI(); // Display score, lives, time, obstacle list capacity and sprite count
-		void GameOver(); // Display final score and time
-		void Reset(); // Return everything to starting values
-
-		// Functions to add obstacles and items to sprite lists
-		void AddRocks();
-		void AddFire();
-		void AddDart();
-		void AddSnake();
-		void AddItems();
-		Vector2 ItemPos(); // Get random position for item
-
-		void Move(); // Player movement
-		void CheckForCollisions(); // Player and obstacle/item collision check
-
-		void UpdateLevel(float deltaTime); // Update difficulty/item level
-		void UpdateObstacles(); // Update positions of obstacles
-		void AddObstacles(float deltaTime); // Add new obstacles to scene
-		void RemoveObstacles(); // Remove obstacles from scene
-
-		void setScore(int inScore) { score = inScore; }
-		int getScore() const { return score; }
-		int getLives() const { return lives; }
-
-	private:
-		static enum eGameStates {START, PLAYING, OVER};		// Game State enumerated type
-
-		// sprite batch 
-		DirectX::SpriteBatch* spriteBatch;
-
-		// mouse variables
-		Vector2 mousePos;				// mouse position
-		bool buttonDownLeft = false;	// whether button is down or not
-
-		// Textures Variables
-		TextureType startTex; // Starting screen
-		TextureType backgroundTex; // Background for game
-		TextureType lavaTex; // Foreground for game
-		TextureType endTex; // Game over screen
-
-		// Player
-		TextureType koalaTex;
-
-		// Obstacles
-		TextureType rockTex;
-		TextureType fireTex;
-		TextureType dartTex;
-		TextureType snakeTex;
-
-		// Items
-		TextureType orangeTex;
-		TextureType pearTex;
-		TextureType appleTex;
-		TextureType bananaTex;
-		TextureType chaliceTex;
-		TextureType necklaceTex;
-		TextureType tripowerTex;
-		TextureType idolTex;
-
-		// Sprites Variables
-		SpriteType koalaSprite; // Player
-
-		static enum obstacleType { ROCK, FIRE, DART, SNAKE}; // enum for which obstacle type to spawn
-
-		// Lists for each obstacle type and for items
-		SpriteListType rockSprites;
-		SpriteListType fireSprites;
-		SpriteListType dartSprites;
-		SpriteListType snakeSprites;
-
-		SpriteListType itemSprites;
-
-		// Game Play Variables
-		static const int VINE_COUNT = 6; // Amount of vines
-		eGameStates currentState; // Game state to track the current state (start, play, over)
-
-		int score; // Track score
-		int lives; // Track lives
-		float gracePeriod; // When hit, brief period of time where player is invulnerable
-		float elapsedTime; // Timer to keep track of game's duration
-		int vineX[VINE_COUNT]; // Array to store x positions of each vine
-		int currentVine; // Tracks which vine the player is currently on
-		Color koalaColor; // Color of player sprite (changes on damage)
-
-		int itemCombo; // Score modifier based on how many items have been collected in a row
-		int itemLevel; // Tracks which item to spawn next (if item is obtained, itemLevel++)
-		float itemDespawn; // Countdown to despawn current item (5 seconds)
-		int obstacleLevel; // Number to track current obstacle difficulty (which types will spawn in)
-		float obstacleTime; // Countdown to next obstacle spawn
-		int timeToNextObstacle; // The time for the obstacleTime countdown to start at.
-		float obstacleSpeed; // Speed that obstacles move
-		int timeToNextChange; // Seconds until difficulty increase/item spawn
-		float gameOverTime; // Seconds until the player can play again (prevents skipping the game over screen accidentally if clicking rapidly)
-		int scoreForExtraLife; // Score needed to obtain extra life
-};
-
+#pragma once
+
+//----------------------------------------------------------------------------------------------
+//	Main project class
+//	Creates a "MyProject" class which inherits the Directx class to help us initalize DirectX
+//  Since we inherit the "DirectXClass" publicly the "MyProject" class has access to all the 
+//	"DirectXClass" functionality.
+//
+//	Now we can add addition code to this class to build on what is provided by the "DirectXClass"
+//----------------------------------------------------------------------------------------------
+#pragma once
+
+#include <Windowsx.h>
+#include <SpriteBatch.h>
+#include <PrimitiveBatch.h>
+#include <VertexTypes.h>
+#include <Effects.h>
+#include "DirectX.h"
+#include "TextureType.h"
+#include "SpriteType.h"
+#include "EntityWorldType.h"
+#include "ObstaclePoolType.h"
+#include "ObstacleSystemsType.h"
+#include "ImpactScheduleType.h"
+#include "NarrowPhaseType.h"
+#include "LaneIndexType.h"
+#include "JobSystemType.h"
+#include "TimerWheelType.h"
+#include "InputQueueType.h"
+#include "ClockType.h"
+#include "FramePacerType.h"
+#include "RenderSnapshotType.h"
+#include "ParticleSystemType.h"
+#include "AnimatorType.h"
+#include "TripleBufferType.h"
+#include "SpawnScripts.h"
+#include "AutoplayerType.h"
+#include "BatchEnvironmentType.h"
+#include "StressTestType.h"
+#include "ProfilerType.h"
+#include "TraceType.h"
+#include "FlightRecorderType.h"
+#include "AllocTrackerType.h"
+
+// Times a phase of the frame for the profiler, the flight recorder and the trace
+#define FRAME_PHASE(phase) PROFILE_SCOPE(phase); RECORD_PHASE(phase); TRACE_SCOPE("frame", #phase)
+
+class MyProject : public DirectXClass
+{
+	public:
+		// constructor
+		MyProject(HINSTANCE hInstance);		// Constructor: required to initialize the base class, DirectXClass.
+		~MyProject();						// Destructor: stops any trace that is still recording and frees the sprite batch
+
+											// Virtual function from DirectX class which we are implementing here
+		LRESULT ProcessWindowMessages(UINT msg, WPARAM wParam, LPARAM lParam);		// window message handler
+		void Render(void);				// Called by the render loop to render a single frame
+		void Update(float deltaTime);	// Called by DirectX framework to allow you to update any scene objects
+		
+		void ProcessInput(); // Apply the input events queued by the window thread
+		void ApplyInput(const InputEvent& event); // Act on one click or key
+
+		void InitalizeTextures();
+		void LoadTexture(TextureType& texture, const wchar_t* fileName); // Load one texture from disk
+		void InitalizeSprites();
+
+		void PublishSnapshot(); // Copy this tick's sprites and HUD values for the renderer
+		void DrawWorld(const RenderSnapshotType& snapshot); // Draw the koala, obstacles and items with the sprite batch
+		void DrawParticles(const RenderSnapshotType& snapshot); // Draw every particle as a quad in one primitive batch
+		void DisplayUI(const RenderHud& hud); // Display score, lives, time, obstacle list capacity and sprite count
+		void DisplayStress(const RenderHud& hud); // Display the stress test's progress
+		void GameOver(const RenderHud& hud); // Display final score and time
+		void Reset(); // Return everything to starting values
+
+		// Functions to add obstacles and items to the world
+		void AddObstacle(EntityKind::Kind kind);
+		void AddItems();
+		Vector2 ItemPos(); // Get random position for item
+
+		void StartStressTest(); // Run stress_scenario.txt, or the default scenario if there isn't one
+		void UpdateStress(); // One fixed tick of the stress test
+		void AddStressObstacles(int count, bool scatter); // Spawn obstacles in the scenario's mix of kinds
+		int GetObstacleCount(); // Obstacles of every kind
+
+		void Move(); // Player movement
+		void CheckForCollisions(); // Player and obstacle/item collision check
+		PlayerBox GetPlayerBox(); // Player's collision box for this frame
+		bool FindObstacleHit(const PlayerBox& player, ObstacleHit& hit); // First obstacle touching the player, by whichever collision mode is on
+
+		void Autoplay(); // Let the bot decide, every AutoplayerType::SEGMENT_TICKS ticks
+		int CaptureHeadless(HeadlessGameType& game); // Copy the koala, levels, obstacles and items into a headless game, returns how many didn't fit
+		void RunBatchBenchmark(); // Step a batch of headless games for half a second and report the throughput
+		void RunDeterminismCheck(); // Play the same seeded game with the jobs on and off and compare the worlds
+		uint64_t HashWorld(); // Every entity's kind and transform in row order, the koala and the game values
+
+		void StartGameTimers(); // Start the spawn script and level timer when play starts
+		void UpdateTimers(float deltaTime); // Game clock, extra lives, then whatever timers have fired
+		void HandleTimer(const TimerEvent& event); // Act on one timer that has fired
+		void UpdateLevel(); // Update difficulty/item level
+		void UpdateObstacles(); // Update positions of obstacles
+		void AddObstacles(); // Add the obstacles the spawn scripts emitted this frame
+		void ExpireItem(Entity item); // Remove an item that wasn't collected in time
+		void RemoveObstacles(); // Remove off-screen obstacles from scene
+		void Animate(float deltaTime); // Step the obstacles' and the koala's sprite-sheet animations
+		void UpdateParticles(float deltaTime); // Emit fireball trails and lava splashes, then move and age the particles
+		void RecordFrameState(); // Store list sizes and game values in the flight recorder
+
+		void setScore(int inScore) { score = inScore; }
+		int getScore() const { return score; }
+		int getLives() const { return lives; }
+
+	private:
+		static enum eGameStates {START, PLAYING, OVER, STRESS};		// Game State enumerated type
+
+		// the PLAYING update, one task per step in the order they ran before the job graph
+		enum FrameTask { BroadphaseTask, CollisionTask, TimersTask, MoveTask, MarkDespawnsTask, RemoveTask, AnimateTask, ParticlesTask, FRAME_TASK_COUNT };
+
+		// what each timer in the wheel is for
+		enum GameTimer { GraceOver, ScriptWake, LevelChange, ItemExpired, GameOverWait };
+
+		struct FrameTaskContext
+		{
+			MyProject* project;
+			FrameTask task;
+		};
+
+		void BuildFrameGraph(); // Add the frame tasks to frameGraph, a chain until the particles run alongside Animate
+		static void RunFrameTask(void* context); // Run one frame task, context is a FrameTaskContext
+
+		// sprite batch 
+		DirectX::SpriteBatch* spriteBatch;
+
+		// particle drawing, quads in a primitive batch with its own effect rather than the sprite batch
+		DirectX::PrimitiveBatch<DirectX::VertexPositionColor>* particleBatch;
+		DirectX::BasicEffect* particleEffect; // Vertex colours in screen pixels
+		ID3D11InputLayout* particleLayout;
+		std::vector<DirectX::VertexPositionColor> particleVertices; // One batch's worth of quads, filled then handed to particleBatch
+		std::vector<uint16_t> particleIndices; // Two triangles per quad, the same for every batch
+		float particleBuildMs; // How long the last DrawParticles took to fill in the quads, not counting the draws
+
+#ifdef PROFILER_ENABLED
+		ProfilerType profiler; // Frame phase timings, overlay toggled with the P key
+#endif
+		FlightRecorderType flightRecorder; // Last few seconds of frames, dumped when a frame goes over budget
+#ifdef ALLOC_TRACKING_ENABLED
+		static const int STEADY_STATE_WARMUP = 300; // PLAYING ticks before the update is expected not to allocate, the pools and chunks have grown by then
+		int playingTicks; // PLAYING ticks this game
+		long long steadyStateAllocations; // Heap allocations the PLAYING update made on the main thread and the job workers after the warm up, since startup
+		int steadyStateTicks; // Ticks checked after the warm up
+		int allocatingTicks; // Of those, ticks that allocated
+#endif
+
+		TripleBufferType<RenderSnapshotType> snapshots; // Published by the sim at the end of Update, read by Render
+		unsigned int snapshotTick; // Snapshots published so far
+
+		SystemClockType clock; // Input timestamps and frame pacing, safe to read from the window thread
+		InputQueueType input; // Mouse and key events from the window thread, drained at the start of each Update
+		FramePacerType pacer; // Holds each frame back to its latest safe start, L turns the waiting off and on
+
+		// mouse variables, set when the sim applies a mouse event
+		Vector2 mousePos;				// mouse position
+		bool buttonDownLeft = false;	// whether button is down or not
+
+		// Textures Variables
+		TextureType startTex; // Starting screen
+		TextureType backgroundTex; // Background for game
+		TextureType lavaTex; // Foreground for game
+		TextureType endTex; // Game over screen
+
+		// Player
+		TextureType koalaTex;
+
+		// Obstacles
+		TextureType rockTex;
+		TextureType fireTex;
+		TextureType dartTex;
+		TextureType snakeTex;
+
+		// Sprite sheets for the animated sprites, the textures above give the frame sizes
+		TextureType koalaSheetTex;
+		TextureType dartSheetTex;
+		TextureType snakeSheetTex;
+
+		// Items
+		TextureType orangeTex;
+		TextureType pearTex;
+		TextureType appleTex;
+		TextureType bananaTex;
+		TextureType chaliceTex;
+		TextureType necklaceTex;
+		TextureType tripowerTex;
+		TextureType idolTex;
+
+		// Sprites Variables
+		SpriteType koalaSprite; // Player
+		AnimationComponent koalaAnimation; // Sways on its vine
+
+		AnimatorType animator; // Every sprite-sheet clip, steps the obstacles in one pass
+		int koalaClip;
+
+		EntityWorldType world; // Every obstacle and item, stored by archetype
+		ObstaclePoolType obstaclePool; // Pre-initialized obstacle components that new obstacles are copied from
+		ObstacleSystemsType obstacleSystems; // Per-kind obstacle kernels, spread across the job system
+		ImpactScheduleType impacts; // Predicted collision events, used instead of the broadphase when predictiveCollisions is on
+		LaneIndexType lanes; // Obstacles on each vine sorted by height, for asking what is coming. Updated after despawns
+		bool predictiveCollisions; // C switches between checking every obstacle each frame and the impact events
+		NarrowPhaseType narrowPhase; // What touching the koala means, K switches between the old boxes, drawn boxes and pixels
+
+		JobSystemType jobs; // Worker threads, J switches between them and running everything on the main thread
+		JobGraphType frameGraph; // The PLAYING update, built once in the constructor
+		FrameTaskContext frameTasks[FRAME_TASK_COUNT];
+		float frameDeltaTime; // deltaTime for the tasks in frameGraph
+
+		TimerWheelType timers; // Every game countdown, advanced by deltaTime while PLAYING or OVER
+		TimerHandle graceTimer; // Pending while the player is invulnerable after a hit
+		TimerHandle gameOverTimer; // Pending until the player can play again (prevents skipping the game over screen accidentally if clicking rapidly)
+
+		SpawnDirectorType spawnDirector; // Spawn scripts, woken by ScriptWake timers. Declared after timers so it can cancel them as it goes
+		int waveCount; // Waves started this game, picks the next one
+
+		ParticleSystemType particles; // Fireball trails, lava splashes and hit bursts, updated after the obstacles move
+		float particleMs; // How long the last particle update took
+		bool particleFlood; // F keeps the particles topped up to FLOOD_PARTICLES, to time a full load
+
+		StressTestType stressTest; // Obstacle count ramp started with S on the start screen
+
+		AutoplayerType autoplayer; // Beam search bot, B hands it the koala while PLAYING
+		HeadlessConfig headlessConfig; // The vines and collision sizes, for the bot's copies of the game
+		HeadlessGameType autoplayView; // The game as the bot sees it, filled in before each decision
+		bool autoplay; // The bot is playing
+		int autoplayWait; // Ticks until the bot decides again
+		int autoplayDropped; // Obstacles and items the bot's last view had no room for
+		long long autoplayDroppedTotal; // And over every decision
+
+		// Game Play Variables
+		static const int VINE_COUNT = 6; // Amount of vines
+		eGameStates currentState; // Game state to track the current state (start, play, over)
+
+		int score; // Track score
+		int lives; // Track lives
+		float elapsedTime; // Timer to keep track of game's duration
+		int vineX[VINE_COUNT]; // Array to store x positions of each vine
+		int currentVine; // Tracks which vine the player is currently on
+		Color koalaColor; // Color of player sprite (changes on damage)
+
+		int itemCombo; // Score modifier based on how many items have been collected in a row
+		int itemLevel; // Tracks which item to spawn next (if item is obtained, itemLevel++)
+		int obstacleLevel; // Number to track current obstacle difficulty (which types will spawn in)
+		int timeToNextObstacle; // Upper bound on the random wait until the next obstacle spawn
+		float obstacleSpeed; // Speed that obstacles move
+		static const int LEVEL_SECONDS = 15; // Seconds between each difficulty increase/item spawn
+		static const int ITEM_SAFE_TICKS = 60; // A new item shouldn't have an obstacle reach it for this long
+		int scoreForExtraLife; // Score needed to obtain extra life
+
+		static const int SHEET_FRAMES = 4; // Frames in each sprite sheet
+
+		static const int CHECK_TICKS = 3600; // Length of RunDeterminismCheck's game, a minute at 60 ticks a second
+		static const unsigned int CHECK_SEED = 20240;
+
+		static const int TRAIL_PARTICLES = 2; // Each fireball sheds this many a tick
+		static const int SPLASH_PARTICLES = 40; // When an obstacle goes into or comes out of the lava
+		static const int HIT_PARTICLES = 60;
+		static const int FLOOD_PARTICLES = 500000;
+		static const int PARTICLE_QUADS = 1024; // Quads handed to the primitive batch at a time, 4096 vertices is as many as it holds
+};
+
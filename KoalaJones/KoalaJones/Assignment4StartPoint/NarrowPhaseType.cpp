@@ -0,0 +1,451 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for the narrow phase
+//----------------------------------------------------------------------------------------
+
+#include "NarrowPhaseType.h"
+#include "TextureType.h"
+#include "AllocTrackerType.h"
+#include "TraceType.h"
+
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+
+static const float DEGREES_TO_RADIANS = 3.141592f / 180.0f; // As SpriteType
+
+// -----------------------------------------------------------------------------
+// The sprite batch turns x by (cos, sin) and y by (-sin, cos) around the origin, then
+// puts the origin on the position
+OrientedBox OrientedBox::FromSprite(const TransformComponent& transform, const RenderComponent& render)
+{
+	float width = float(render.regionRight - render.regionLeft);
+	float height = float(render.regionBottom - render.regionTop);
+	float angle = transform.rotation * DEGREES_TO_RADIANS;
+
+	OrientedBox box;
+	box.axisX = cosf(angle);
+	box.axisY = sinf(angle);
+	box.halfWidth = width * 0.5f * transform.scale;
+	box.halfHeight = height * 0.5f * transform.scale;
+
+	// The centre of the region from the origin, scaled then turned
+	float localX = (width * 0.5f - render.originX) * transform.scale;
+	float localY = (height * 0.5f - render.originY) * transform.scale;
+	box.centerX = transform.x + localX * box.axisX - localY * box.axisY;
+	box.centerY = transform.y + localX * box.axisY + localY * box.axisX;
+
+	return box;
+}
+
+// -----------------------------------------------------------------------------
+// The furthest corner from the origin, as the origin is what the sprite turns around
+float OrientedBox::GetReach(int width, int height, float originX, float originY, float scale)
+{
+	float farX = fabsf(originX) > fabsf(width - originX) ? fabsf(originX) : fabsf(width - originX);
+	float farY = fabsf(originY) > fabsf(height - originY) ? fabsf(originY) : fabsf(height - originY);
+
+	return sqrtf(farX * farX + farY * farY) * scale;
+}
+
+// -----------------------------------------------------------------------------
+// On each axis the gap between the centres against the half lengths the two boxes cover
+bool OrientedBox::Overlaps(const OrientedBox& other) const
+{
+	float gapX = other.centerX - centerX;
+	float gapY = other.centerY - centerY;
+
+	const float axes[4][2] = { { axisX, axisY }, { -axisY, axisX }, { other.axisX, other.axisY }, { -other.axisY, other.axisX } };
+
+	for (int a = 0; a < 4; a++)
+	{
+		float x = axes[a][0];
+		float y = axes[a][1];
+
+		float reach = halfWidth * fabsf(axisX * x + axisY * y) + halfHeight * fabsf(-axisY * x + axisX * y);
+		float otherReach = other.halfWidth * fabsf(other.axisX * x + other.axisY * y) + other.halfHeight * fabsf(-other.axisY * x + other.axisX * y);
+
+		if (fabsf(gapX * x + gapY * y) > reach + otherReach)
+			return false; // Separated along this axis
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Half the box along x and y, each edge direction's share added up
+void OrientedBox::GetBounds(float& left, float& top, float& right, float& bottom) const
+{
+	float extentX = halfWidth * fabsf(axisX) + halfHeight * fabsf(axisY);
+	float extentY = halfWidth * fabsf(axisY) + halfHeight * fabsf(axisX);
+
+	left = centerX - extentX;
+	right = centerX + extentX;
+	top = centerY - extentY;
+	bottom = centerY + extentY;
+}
+
+// -----------------------------------------------------------------------------
+// The old boxes, the same as the headless games, with no masks until they are added
+NarrowPhaseType::NarrowPhaseType()
+{
+	mode = Boxes;
+
+	memset(&playerBox, 0, sizeof(playerBox));
+	memset(&playerKey, 0, sizeof(playerKey));
+	playerX = 0;
+	playerY = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Copy the top mip into a texture the CPU can read and make the mask from that. Both 8 bit
+// RGBA orders keep alpha in the fourth byte
+bool NarrowPhaseType::AddMask(ID3D11Device* device, ID3D11DeviceContext* context, TextureType* texture)
+{
+	TRACE_SCOPE("load", "AddMask");
+	ALLOC_TAG(Textures);
+
+	if (texture->GetResourceView() == NULL || FindMask(texture) != NULL)
+		return false;
+
+	ID3D11Resource* resource = NULL;
+	texture->GetResourceView()->GetResource(&resource);
+
+	ID3D11Texture2D* source = NULL;
+	HRESULT result = resource->QueryInterface(__uuidof(ID3D11Texture2D), (void**)&source);
+	resource->Release();
+	if (FAILED(result))
+		return false;
+
+	D3D11_TEXTURE2D_DESC desc;
+	source->GetDesc(&desc);
+
+	if (desc.Format != DXGI_FORMAT_R8G8B8A8_UNORM && desc.Format != DXGI_FORMAT_R8G8B8A8_UNORM_SRGB &&
+		desc.Format != DXGI_FORMAT_B8G8R8A8_UNORM && desc.Format != DXGI_FORMAT_B8G8R8A8_UNORM_SRGB)
+	{
+		source->Release();
+		return false; // No alpha we can read, so it stays solid
+	}
+
+	desc.MipLevels = 1;
+	desc.ArraySize = 1;
+	desc.Usage = D3D11_USAGE_STAGING;
+	desc.BindFlags = 0;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+	desc.MiscFlags = 0;
+
+	ID3D11Texture2D* staging = NULL;
+	if (FAILED(device->CreateTexture2D(&desc, NULL, &staging)))
+	{
+		source->Release();
+		return false;
+	}
+
+	context->CopySubresourceRegion(staging, 0, 0, 0, 0, source, 0, NULL);
+	source->Release();
+
+	D3D11_MAPPED_SUBRESOURCE mapped;
+	if (FAILED(context->Map(staging, 0, D3D11_MAP_READ, 0, &mapped)))
+	{
+		staging->Release();
+		return false;
+	}
+
+	bool added = AddMask(texture, int(desc.Width), int(desc.Height), (const uint8_t*)mapped.pData, mapped.RowPitch);
+
+	context->Unmap(staging, 0);
+	staging->Release();
+
+	return added;
+}
+
+// -----------------------------------------------------------------------------
+// Set a bit for every texel whose alpha reaches ALPHA_THRESHOLD
+bool NarrowPhaseType::AddMask(TextureType* texture, int width, int height, const uint8_t* texels, size_t rowPitch)
+{
+	ALLOC_TAG(Textures);
+
+	if (FindMask(texture) != NULL)
+		return false;
+
+	AlphaMask mask;
+	mask.texture = texture;
+	mask.width = width;
+	mask.height = height;
+	mask.wordsPerRow = (mask.width + 63) / 64;
+	mask.bits.assign(size_t(mask.wordsPerRow) * mask.height, 0);
+
+	for (int y = 0; y < mask.height; y++)
+	{
+		const uint8_t* texel = texels + size_t(y) * rowPitch;
+		uint64_t* row = &mask.bits[size_t(y) * mask.wordsPerRow];
+
+		for (int x = 0; x < mask.width; x++)
+		{
+			if (texel[x * 4 + 3] >= ALPHA_THRESHOLD)
+				row[x >> 6] |= uint64_t(1) << (x & 63);
+		}
+	}
+
+	masks.push_back(mask);
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// A handful of textures, so a straight search
+const NarrowPhaseType::AlphaMask* NarrowPhaseType::FindMask(const TextureType* texture) const
+{
+	for (size_t i = 0; i < masks.size(); i++)
+	{
+		if (masks[i].texture == texture)
+			return &masks[i];
+	}
+
+	return NULL;
+}
+
+// -----------------------------------------------------------------------------
+// The player's box, and the key its mask is looked up by when it's needed
+void NarrowPhaseType::SetPlayer(const TransformComponent& transform, const RenderComponent& render)
+{
+	playerBox = OrientedBox::FromSprite(transform, render);
+	playerKey = MakeKey(transform, render);
+	playerX = int(floorf(transform.x + 0.5f));
+	playerY = int(floorf(transform.y + 0.5f));
+}
+
+// -----------------------------------------------------------------------------
+// The boxes first, which is all OrientedBoxes asks. Masks are only looked at when the
+// boxes touch, and only built then
+bool NarrowPhaseType::Touches(const TransformComponent& transform, const RenderComponent& render)
+{
+	if (!OrientedBox::FromSprite(transform, render).Overlaps(playerBox))
+		return false;
+
+	if (mode != PixelMasks)
+		return true;
+
+	int obstacle = GetRotatedMask(MakeKey(transform, render));
+	int player = GetRotatedMask(playerKey);
+	if (obstacle < 0 || player < 0)
+		return true; // A texture without a mask is solid, so touching boxes are enough
+
+	int x = int(floorf(transform.x + 0.5f));
+	int y = int(floorf(transform.y + 0.5f));
+
+	return MasksOverlap(rotated[player], playerX + rotated[player].offsetX, playerY + rotated[player].offsetY,
+		rotated[obstacle], x + rotated[obstacle].offsetX, y + rotated[obstacle].offsetY);
+}
+
+// -----------------------------------------------------------------------------
+// Everything that changes the drawn pixels, with the rotation rounded to the nearest step
+NarrowPhaseType::MaskKey NarrowPhaseType::MakeKey(const TransformComponent& transform, const RenderComponent& render)
+{
+	MaskKey key;
+	memset(&key, 0, sizeof(key)); // Padding too, so keys can be compared whole
+
+	key.texture = render.texture;
+	key.regionLeft = render.regionLeft;
+	key.regionTop = render.regionTop;
+	key.regionRight = render.regionRight;
+	key.regionBottom = render.regionBottom;
+	key.originX = render.originX;
+	key.originY = render.originY;
+	key.scale = transform.scale;
+
+	int angle = int(floorf(transform.rotation * ANGLE_STEPS / 360.0f + 0.5f)) % ANGLE_STEPS;
+	key.angle = angle < 0 ? angle + ANGLE_STEPS : angle;
+
+	return key;
+}
+
+// -----------------------------------------------------------------------------
+// Field by field, so -0 and 0 origins match
+bool NarrowPhaseType::MaskKey::operator==(const MaskKey& other) const
+{
+	return texture == other.texture && regionLeft == other.regionLeft && regionTop == other.regionTop &&
+		regionRight == other.regionRight && regionBottom == other.regionBottom && originX == other.originX &&
+		originY == other.originY && scale == other.scale && angle == other.angle;
+}
+
+// -----------------------------------------------------------------------------
+// FNV-1a over the fields that pick the mask. Origins and scale go in as whole 1/256ths
+// so keys that compare equal hash the same
+uint32_t NarrowPhaseType::Hash(const MaskKey& key)
+{
+	uint32_t values[] = { uint32_t(uintptr_t(key.texture)), uint32_t(uint64_t(uintptr_t(key.texture)) >> 32),
+		uint32_t(key.regionLeft), uint32_t(key.regionTop), uint32_t(key.regionRight), uint32_t(key.regionBottom),
+		uint32_t(int(key.originX * 256)), uint32_t(int(key.originY * 256)), uint32_t(int(key.scale * 256)), uint32_t(key.angle) };
+
+	uint32_t hash = 2166136261u;
+	for (uint32_t value : values)
+	{
+		hash ^= value;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+// -----------------------------------------------------------------------------
+// Look the key up, building and adding the mask the first time
+int NarrowPhaseType::GetRotatedMask(const MaskKey& key)
+{
+	uint32_t hash = Hash(key);
+
+	if (!slots.empty())
+	{
+		int mask = int(slots.size()) - 1;
+		for (int slot = int(hash) & mask; slots[slot] >= 0; slot = (slot + 1) & mask)
+		{
+			if (rotated[slots[slot]].key == key)
+				return slots[slot];
+		}
+	}
+
+	const AlphaMask* source = FindMask(key.texture);
+	if (source == NULL)
+		return -1;
+
+	TRACE_SCOPE("sim", "BuildRotatedMask");
+	ALLOC_TAG(Sprites);
+
+	rotated.push_back(RotatedMask());
+	RotatedMask& built = rotated.back();
+	built.key = key;
+	BuildRotatedMask(*source, built);
+
+	Insert(int(rotated.size()) - 1);
+	return int(rotated.size()) - 1;
+}
+
+// -----------------------------------------------------------------------------
+// Linear probing, rehashing everything into a table twice the size when it's half full
+void NarrowPhaseType::Insert(int index)
+{
+	if (int(rotated.size()) * 2 > int(slots.size()))
+	{
+		ALLOC_TAG(Sprites);
+
+		slots.assign(slots.empty() ? 64 : slots.size() * 2, -1);
+		for (int i = 0; i < int(rotated.size()); i++)
+		{
+			if (i != index)
+				Insert(i);
+		}
+	}
+
+	int mask = int(slots.size()) - 1;
+	int slot = int(Hash(rotated[index].key)) & mask;
+	while (slots[slot] >= 0)
+		slot = (slot + 1) & mask;
+
+	slots[slot] = index;
+}
+
+// -----------------------------------------------------------------------------
+// Cover the turned quad with a screen aligned grid of pixels, and take each pixel from
+// the texel under its centre, the nearest one, by turning the centre back into the region
+void NarrowPhaseType::BuildRotatedMask(const AlphaMask& mask, RotatedMask& out) const
+{
+	const MaskKey& key = out.key;
+
+	int width = key.regionRight - key.regionLeft;
+	int height = key.regionBottom - key.regionTop;
+	float angle = float(key.angle) * 360.0f / ANGLE_STEPS * DEGREES_TO_RADIANS;
+	float cosine = cosf(angle);
+	float sine = sinf(angle);
+
+	// The corners from the position, the same turn and scale as OrientedBox::FromSprite
+	float left = FLT_MAX, top = FLT_MAX, right = -FLT_MAX, bottom = -FLT_MAX;
+	for (int corner = 0; corner < 4; corner++)
+	{
+		float localX = (float(corner & 1 ? width : 0) - key.originX) * key.scale;
+		float localY = (float(corner & 2 ? height : 0) - key.originY) * key.scale;
+		float x = localX * cosine - localY * sine;
+		float y = localX * sine + localY * cosine;
+
+		left = x < left ? x : left;
+		right = x > right ? x : right;
+		top = y < top ? y : top;
+		bottom = y > bottom ? y : bottom;
+	}
+
+	out.offsetX = int(floorf(left));
+	out.offsetY = int(floorf(top));
+	out.width = int(ceilf(right)) - out.offsetX;
+	out.height = int(ceilf(bottom)) - out.offsetY;
+	out.wordsPerRow = (out.width + 63) / 64 + 1;
+	out.bits.assign(size_t(out.wordsPerRow) * out.height, 0);
+
+	float inverseScale = key.scale != 0 ? 1.0f / key.scale : 0;
+
+	for (int row = 0; row < out.height; row++)
+	{
+		uint64_t* bits = &out.bits[size_t(row) * out.wordsPerRow];
+		float y = float(out.offsetY + row) + 0.5f;
+
+		for (int column = 0; column < out.width; column++)
+		{
+			float x = float(out.offsetX + column) + 0.5f;
+
+			// Back through the turn and scale into the region
+			float regionX = (x * cosine + y * sine) * inverseScale + key.originX;
+			float regionY = (y * cosine - x * sine) * inverseScale + key.originY;
+			if (regionX < 0 || regionY < 0 || regionX >= width || regionY >= height)
+				continue;
+
+			int texelX = key.regionLeft + int(regionX);
+			int texelY = key.regionTop + int(regionY);
+			if (texelX >= mask.width || texelY >= mask.height)
+				continue;
+
+			if (mask.bits[size_t(texelY) * mask.wordsPerRow + (texelX >> 6)] & (uint64_t(1) << (texelX & 63)))
+				bits[column >> 6] |= uint64_t(1) << (column & 63);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// 64 pixels of a row starting at any pixel, from the word it starts in and the next
+static inline uint64_t GetBits(const uint64_t* row, int first)
+{
+	int word = first >> 6;
+	int shift = first & 63;
+
+	uint64_t bits = row[word] >> shift;
+	if (shift != 0)
+		bits |= row[word + 1] << (64 - shift);
+
+	return bits;
+}
+
+// -----------------------------------------------------------------------------
+// Over the rows both masks cover, AND 64 columns of one with the same 64 of the other
+bool NarrowPhaseType::MasksOverlap(const RotatedMask& a, int ax, int ay, const RotatedMask& b, int bx, int by)
+{
+	int top = ay > by ? ay : by;
+	int bottom = ay + a.height < by + b.height ? ay + a.height : by + b.height;
+	int left = ax > bx ? ax : bx;
+	int right = ax + a.width < bx + b.width ? ax + a.width : bx + b.width;
+
+	if (top >= bottom || left >= right)
+		return false;
+
+	for (int y = top; y < bottom; y++)
+	{
+		const uint64_t* rowA = &a.bits[size_t(y - ay) * a.wordsPerRow];
+		const uint64_t* rowB = &b.bits[size_t(y - by) * b.wordsPerRow];
+
+		for (int x = left; x < right; x += 64)
+		{
+			uint64_t both = GetBits(rowA, x - ax) & GetBits(rowB, x - bx);
+			if (right - x < 64)
+				both &= (uint64_t(1) << (right - x)) - 1; // Past the shared columns
+
+			if (both != 0)
+				return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,157 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Collision against the shapes the sprites are actually drawn with, for the obstacles the
+// broadphase lets through. There are two layers on top of the old whole-texture boxes:
+//
+// - OrientedBoxes: the drawn quad of each sprite as an oriented box, from its texture
+//   region, origin, scale and rotation the same way the sprite batch places it. Two boxes
+//   touch unless one of their four edge directions separates them.
+// - PixelMasks: boxes that touch are then tested pixel by pixel. Each texture's alpha is
+//   read back once at load time into a mask of one bit per texel. A region of a mask
+//   turned to an angle and scaled is worked out the first time it is needed and cached,
+//   with angles rounded to ANGLE_STEPS a turn, so spinning rocks only ever build
+//   ANGLE_STEPS masks. Two masks are tested 64 pixels at a time, ANDing the words of the
+//   rows they share.
+//
+// A texture without a mask, or in a format whose alpha can't be read, counts as solid, so
+// it collides as its oriented box.
+//
+// Boxes is the default, as the headless game, the autoplayer, BatchEnvironmentType and
+// libkoala all collide with those boxes. The drawn shapes are turned on with K, and then
+// the live game no longer collides quite as they do: the koala's quad pivots CenterLeft,
+// so its drawn box sits half a koala to the right of its old box, items included.
+//
+// Obstacles reach outside their ColliderComponent box once they are turned or pivot off
+// centre, so while the drawn shapes are tested the broadphase uses the collider's reach
+// instead, the furthest the sprite gets from its position at any angle.
+//----------------------------------------------------------------------------------------
+
+#include <vector>
+#include <cstdint>
+#include <d3d11.h>
+#include "ComponentTypes.h"
+
+// a sprite's drawn quad, with its centre, the direction of its x axis and half its size
+struct OrientedBox
+{
+	float centerX, centerY;
+	float axisX, axisY; // Unit x axis, the y axis is (-axisY, axisX)
+	float halfWidth, halfHeight;
+
+	// where the sprite batch draws a sprite with these settings
+	static OrientedBox FromSprite(const TransformComponent& transform, const RenderComponent& render);
+
+	// the furthest a width by height region drawn around origin and scaled gets from its position, at any rotation
+	static float GetReach(int width, int height, float originX, float originY, float scale);
+
+	// separating axis test, the four edge directions are the only ones two boxes need
+	bool Overlaps(const OrientedBox& other) const;
+
+	// the screen aligned box around it
+	void GetBounds(float& left, float& top, float& right, float& bottom) const;
+};
+
+class NarrowPhaseType
+{
+	public:
+		static const int ANGLE_STEPS = 64; // Rotations a mask is cached at, 5.625 degrees apart
+		static const int ALPHA_THRESHOLD = 128; // Texels at least this opaque are solid
+
+		// what touching the player means
+		enum Mode
+		{
+			Boxes, // Whole texture boxes around the position, unturned and unscaled, as SpriteType::SpriteCollision
+			OrientedBoxes, // The drawn quads
+			PixelMasks, // The drawn quads, then their solid pixels
+			MODE_COUNT
+		};
+
+		// constructor
+		NarrowPhaseType();
+
+		// get and set the mode, the broadphase and player box change with it
+		Mode GetMode() const { return mode; }
+		void SetMode(Mode inMode) { mode = inMode; }
+
+		// are the drawn shapes tested, rather than the old boxes
+		bool TestsShapes() const { return mode != Boxes; }
+
+		// read a texture's alpha back from the GPU into a mask, call once it is loaded. Returns false, leaving
+		// the texture solid, if it can't be read
+		bool AddMask(ID3D11Device* device, ID3D11DeviceContext* context, TextureType* texture);
+
+		// make a texture's mask from 8 bit RGBA texels already on the CPU, alpha in the fourth byte and rows
+		// rowPitch bytes apart. Returns false if the texture already has one
+		bool AddMask(TextureType* texture, int width, int height, const uint8_t* texels, size_t rowPitch);
+
+		// set the player's drawn shape for the tests that follow
+		void SetPlayer(const TransformComponent& transform, const RenderComponent& render);
+
+		// does a sprite drawn this way touch the player
+		bool Touches(const TransformComponent& transform, const RenderComponent& render);
+
+		int GetCachedMaskCount() const { return int(rotated.size()); }
+
+	private:
+		// a texture's alpha, one bit per texel, LSB first
+		struct AlphaMask
+		{
+			TextureType* texture;
+			int width, height;
+			int wordsPerRow;
+			std::vector<uint64_t> bits;
+		};
+
+		// what a rotated mask was built from
+		struct MaskKey
+		{
+			TextureType* texture;
+			int regionLeft, regionTop, regionRight, regionBottom;
+			float originX, originY;
+			float scale;
+			int angle; // In ANGLE_STEPS
+
+			bool operator==(const MaskKey& other) const;
+		};
+
+		// a region of a mask turned and scaled, in screen pixels from the sprite's position
+		struct RotatedMask
+		{
+			MaskKey key;
+			int offsetX, offsetY; // Top left from the position rounded to a whole pixel
+			int width, height;
+			int wordsPerRow; // One more than the row needs, so reading 64 bits from any pixel stays in the row
+			std::vector<uint64_t> bits;
+		};
+
+		Mode mode;
+
+		std::vector<AlphaMask> masks;
+		std::vector<RotatedMask> rotated;
+		std::vector<int> slots; // Open addressed table of indices into rotated, -1 for empty
+
+		// the player's shape
+		OrientedBox playerBox;
+		MaskKey playerKey;
+		int playerX, playerY; // Position rounded to a whole pixel
+
+		// get the alpha mask of a texture, NULL if it has none
+		const AlphaMask* FindMask(const TextureType* texture) const;
+
+		// get the mask a sprite is drawn with from the cache, building it the first time. -1 if its texture has no mask
+		int GetRotatedMask(const MaskKey& key);
+
+		// turn and scale a region of a mask
+		void BuildRotatedMask(const AlphaMask& mask, RotatedMask& out) const;
+
+		// the key for a sprite drawn this way
+		static MaskKey MakeKey(const TransformComponent& transform, const RenderComponent& render);
+
+		static uint32_t Hash(const MaskKey& key);
+
+		// put a cached mask into the table, growing it once it is half full
+		void Insert(int index);
+
+		// do two masks with their positions in whole screen pixels share a solid pixel
+		static bool MasksOverlap(const RotatedMask& a, int ax, int ay, const RotatedMask& b, int bx, int by);
+};
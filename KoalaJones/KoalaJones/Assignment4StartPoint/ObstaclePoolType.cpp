@@ -0,0 +1,276 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for the obstacle prototypes
+//----------------------------------------------------------------------------------------
+
+#include "ObstaclePoolType.h"
+#include "NarrowPhaseType.h"
+
+#include <cstdlib>
+
+const ComponentMask ObstaclePoolType::OBSTACLE_MASK = ComponentBit<TransformComponent>() | ComponentBit<MotionComponent>() | ComponentBit<RenderComponent>() |
+	ComponentBit<ColliderComponent>() | ComponentBit<DamageComponent>();
+
+const ComponentMask ObstaclePoolType::ITEM_MASK = ComponentBit<TransformComponent>() | ComponentBit<RenderComponent>() | ComponentBit<ColliderComponent>() |
+	ComponentBit<PickupComponent>() | ComponentBit<LifetimeComponent>();
+
+// -----------------------------------------------------------------------------
+// Build every prototype once from the traits table
+void ObstaclePoolType::Initialize(TextureType* textures[OBSTACLE_KIND_COUNT])
+{
+	for (int kind = 0; kind < OBSTACLE_KIND_COUNT; kind++)
+	{
+		TextureType* texture = textures[kind];
+		int width = texture->GetWidth();
+		int height = texture->GetHeight();
+
+		for (int side = 0; side < 2; side++)
+		{
+			const ObstacleSide& traits = obstacleTraits[kind].sides[side];
+			Prototype& prototype = prototypes[kind][side];
+
+			prototype.transform.x = 0;
+			prototype.transform.y = 0;
+			prototype.transform.rotation = traits.rotation;
+			prototype.transform.scale = traits.scale;
+
+			prototype.motion.dirX = traits.dirX; // Every obstacle moves in a straight line along an axis, so this never needs normalizing
+			prototype.motion.dirY = traits.dirY;
+			prototype.motion.speed = 0;
+
+			prototype.render.texture = texture;
+			prototype.render.regionLeft = 0;
+			prototype.render.regionTop = 0;
+			prototype.render.regionRight = width;
+			prototype.render.regionBottom = height;
+			prototype.render.originX = float(width) * traits.pivotX; // Worked out once here rather than by SetPivot on every spawn
+			prototype.render.originY = float(height) * traits.pivotY;
+			prototype.render.r = traits.r;
+			prototype.render.g = traits.g;
+			prototype.render.b = traits.b;
+			prototype.render.a = 1;
+			prototype.render.layer = 0;
+
+			// The boxes use the whole texture, unscaled, the same as SpriteType::SpriteCollision. The reach is for
+			// the narrow phase's drawn shapes
+			prototype.collider.halfWidth = float(width / 2);
+			prototype.collider.halfHeight = float(height / 2);
+			prototype.collider.reach = OrientedBox::GetReach(width, height, prototype.render.originX, prototype.render.originY, traits.scale);
+
+			prototype.damage.lives = 1;
+
+			prototype.animation.clip = -1; // Until SetAnimation gives it one
+			prototype.animation.frame = 0;
+			prototype.animation.timeLeft = 0;
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Switch the prototype to the sheet, on the clip's first frame with that frame's origin
+void ObstaclePoolType::SetAnimation(EntityKind::Kind kind, int side, const AnimatorType& animator, int clip)
+{
+	Prototype& prototype = prototypes[kind][side];
+	const AnimationFrame& frame = animator.GetFrame(clip, 0);
+
+	prototype.render.texture = animator.GetClip(clip).sheet;
+	prototype.render.regionLeft = frame.regionLeft;
+	prototype.render.regionTop = frame.regionTop;
+	prototype.render.regionRight = frame.regionRight;
+	prototype.render.regionBottom = frame.regionBottom;
+	prototype.render.originX = frame.originX;
+	prototype.render.originY = frame.originY;
+	prototype.collider.reach = OrientedBox::GetReach(frame.regionRight - frame.regionLeft, frame.regionBottom - frame.regionTop, frame.originX, frame.originY, prototype.transform.scale);
+
+	animator.Start(prototype.animation, clip);
+}
+
+// -----------------------------------------------------------------------------
+// Copy the transform, draw settings and texture size out of a sprite
+void ObstaclePoolType::CopySprite(SpriteType& sprite, TransformComponent& transform, RenderComponent& render, ColliderComponent& collider)
+{
+	RECT region = sprite.GetTextureRegion();
+	Color color = sprite.GetColor();
+	Vector2 origin = sprite.GetOrigin();
+	TextureType* texture = sprite.GetTexture();
+
+	transform.x = sprite.GetPosition().x;
+	transform.y = sprite.GetPosition().y;
+	transform.rotation = sprite.GetRotation();
+	transform.scale = sprite.GetScale();
+
+	render.texture = texture;
+	render.regionLeft = region.left;
+	render.regionTop = region.top;
+	render.regionRight = region.right;
+	render.regionBottom = region.bottom;
+	render.originX = origin.x;
+	render.originY = origin.y;
+	render.r = color.R();
+	render.g = color.G();
+	render.b = color.B();
+	render.a = color.A();
+	render.layer = sprite.GetLayer();
+
+	collider.halfWidth = float((region.right - region.left) / 2); // The whole texture unless the sprite is on a frame of a sheet
+	collider.halfHeight = float((region.bottom - region.top) / 2);
+	collider.reach = OrientedBox::GetReach(region.right - region.left, region.bottom - region.top, origin.x, origin.y, transform.scale);
+}
+
+// -----------------------------------------------------------------------------
+// Spawn one obstacle of kind K. The traits are constants so the switch and the side and
+// speed choices fold away, leaving only the rand() calls this kind makes, in the order
+// side, position, speed
+template <EntityKind::Kind K>
+Entity ObstaclePoolType::SpawnKind(EntityWorldType& world, const SpawnArea& area, float obstacleSpeed) const
+{
+	constexpr ObstacleTraits traits = obstacleTraits[K];
+
+	int side = traits.sideCount > 1 ? rand() % 2 : 0; // Left or top first
+
+	float across;
+	if (traits.spawnEdge == ObstacleRule::LeftOrRight)
+		across = float(rand() % (area.lavaTop - 50) + 50); // Random height above the lava
+	else
+		across = float(area.vineX[rand() % area.vineCount]); // Random vine
+
+	float speed = traits.speed == ObstacleRule::RandomSpeed ? float(rand() % int(obstacleSpeed) + 1) : obstacleSpeed + 1;
+
+	Vector2 startPos, endPos;
+	Place(K, side, across, area, startPos, endPos);
+
+	ComponentMask mask = OBSTACLE_MASK;
+	if (traits.path == ObstacleRule::ReverseOnce)
+		mask |= ComponentBit<PatrolComponent>();
+	if (traits.animation == ObstacleRule::Animated)
+		mask |= ComponentBit<AnimationComponent>();
+
+	return Emplace(world, K, side, mask, startPos, endPos, speed);
+}
+
+// -----------------------------------------------------------------------------
+// Pick the spawn kernel for the kind, one table lookup per spawn
+Entity ObstaclePoolType::Spawn(EntityWorldType& world, EntityKind::Kind kind, const SpawnArea& area, float obstacleSpeed) const
+{
+	typedef Entity (ObstaclePoolType::*SpawnFunction)(EntityWorldType&, const SpawnArea&, float) const;
+
+	static const SpawnFunction spawnKinds[OBSTACLE_KIND_COUNT] =
+	{
+		&ObstaclePoolType::SpawnKind<EntityKind::Rock>,
+		&ObstaclePoolType::SpawnKind<EntityKind::FireBall>,
+		&ObstaclePoolType::SpawnKind<EntityKind::Dart>,
+		&ObstaclePoolType::SpawnKind<EntityKind::Snake>
+	};
+
+	return (this->*spawnKinds[kind])(world, area, obstacleSpeed);
+}
+
+// -----------------------------------------------------------------------------
+// Reserve room for each kind in the burst, so a burst of one kind grows its archetype once
+void ObstaclePoolType::SpawnBurst(EntityWorldType& world, const SpawnOrder* orders, int count, const SpawnArea& area, float obstacleSpeed, Entity* spawned) const
+{
+	int kindCounts[OBSTACLE_KIND_COUNT] = {};
+	for (int i = 0; i < count; i++)
+		kindCounts[orders[i].kind]++;
+
+	for (int kind = 0; kind < OBSTACLE_KIND_COUNT; kind++)
+	{
+		if (kindCounts[kind] > 0)
+			world.Reserve(GetMask(EntityKind::Kind(kind)), EntityKind::Kind(kind), kindCounts[kind]);
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		const SpawnOrder& order = orders[i];
+		const ObstacleTraits& traits = obstacleTraits[order.kind];
+
+		int side = traits.sideCount > 1 ? order.side : 0;
+		float speed = traits.speed == ObstacleRule::RandomSpeed ? float(rand() % int(obstacleSpeed) + 1) : obstacleSpeed + 1;
+
+		Vector2 startPos, endPos;
+		Place(order.kind, side, order.across, area, startPos, endPos);
+
+		spawned[i] = Emplace(world, order.kind, side, GetMask(order.kind), startPos, endPos, speed);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Every obstacle has the same components, apart from the patrol for kinds that reverse and
+// the animation for kinds that are animated
+ComponentMask ObstaclePoolType::GetMask(EntityKind::Kind kind)
+{
+	ComponentMask mask = OBSTACLE_MASK;
+	if (obstacleTraits[kind].path == ObstacleRule::ReverseOnce)
+		mask |= ComponentBit<PatrolComponent>();
+	if (obstacleTraits[kind].animation == ObstacleRule::Animated)
+		mask |= ComponentBit<AnimationComponent>();
+
+	return mask;
+}
+
+// -----------------------------------------------------------------------------
+// Start on the spawn edge at the position across it, and head for the far side
+void ObstaclePoolType::Place(EntityKind::Kind kind, int side, float across, const SpawnArea& area, Vector2& startPos, Vector2& endPos)
+{
+	switch (obstacleTraits[kind].spawnEdge)
+	{
+	case ObstacleRule::Top:
+		startPos = Vector2(across, 0);
+		endPos = Vector2(across, 768);
+		break;
+	case ObstacleRule::Bottom:
+		startPos = Vector2(across, 768);
+		endPos = Vector2(across, 0);
+		break;
+	case ObstacleRule::LeftOrRight:
+		startPos = Vector2(side == 0 ? 0.0f : 1024.0f, across);
+		endPos = Vector2(side == 0 ? 1100.0f : -100.0f, across);
+		break;
+	case ObstacleRule::TopOrBottom:
+		startPos = Vector2(across, side == 0 ? 0.0f : 768.0f);
+		endPos = Vector2(across, side == 0 ? float(area.lavaTop - 20) : 0.0f); // Top snakes stop just above the lava
+		break;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Create the obstacle, copy the prototype's components into it and fill in the per-spawn fields
+Entity ObstaclePoolType::Emplace(EntityWorldType& world, EntityKind::Kind kind, int side, ComponentMask mask, Vector2 startPos, Vector2 endPos, float speed) const
+{
+	const Prototype& prototype = prototypes[kind][side];
+
+	Entity entity = world.Create(mask, kind);
+
+	TransformComponent& transform = world.Get<TransformComponent>(entity);
+	transform = prototype.transform;
+	transform.x = startPos.x;
+	transform.y = startPos.y;
+
+	MotionComponent& motion = world.Get<MotionComponent>(entity);
+	motion = prototype.motion;
+	motion.speed = speed;
+
+	world.Get<RenderComponent>(entity) = prototype.render;
+	world.Get<ColliderComponent>(entity) = prototype.collider;
+	world.Get<DamageComponent>(entity) = prototype.damage;
+
+	if (mask & ComponentBit<PatrolComponent>())
+	{
+		PatrolComponent& patrol = world.Get<PatrolComponent>(entity);
+		patrol.startX = startPos.x;
+		patrol.startY = startPos.y;
+		patrol.endX = endPos.x;
+		patrol.endY = endPos.y;
+		patrol.reversed = 0;
+	}
+
+	if (mask & ComponentBit<AnimationComponent>())
+	{
+		// The first frame is cut short by a part that depends on the entity, so obstacles spawned
+		// together don't move in step, without calling rand()
+		AnimationComponent& animation = world.Get<AnimationComponent>(entity);
+		animation = prototype.animation;
+		animation.timeLeft *= float(entity.index % 4 + 1) / 4.0f;
+	}
+
+	return entity;
+}
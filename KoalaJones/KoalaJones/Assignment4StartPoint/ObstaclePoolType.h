@@ -0,0 +1,81 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Pre-initialized obstacle prototypes. Each obstacle kind, and each side it can spawn
+// from, has a set of components built once from the obstacle traits table. Spawning one
+// creates the entity and copies the prototype's components into it, then fills in the
+// per-spawn fields.
+//----------------------------------------------------------------------------------------
+
+#include "SpriteType.h"
+#include "EntityWorldType.h"
+#include "ObstacleTraits.h"
+#include "AnimatorType.h"
+
+// the part of the screen obstacles spawn into
+struct SpawnArea
+{
+	const int* vineX; // x position of each vine
+	int vineCount;
+	int lavaTop; // y of the top of the lava
+};
+
+// one obstacle of a burst, placed exactly rather than at random
+struct SpawnOrder
+{
+	EntityKind::Kind kind;
+	int side; // 0 for left or top, 1 for right or bottom, ignored by kinds with one side
+	float across; // x for kinds that move vertically, y for kinds that move horizontally
+};
+
+class ObstaclePoolType
+{
+	public:
+
+		// components every obstacle has, obstacles that reverse also have a PatrolComponent and animated ones an AnimationComponent
+		static const ComponentMask OBSTACLE_MASK;
+
+		// components every item has
+		static const ComponentMask ITEM_MASK;
+
+		// build the prototypes, indexed by EntityKind. The textures must already be loaded
+		void Initialize(TextureType* textures[OBSTACLE_KIND_COUNT]);
+
+		// draw an animated kind, spawned from a side, from a clip's sheet starting on its first frame. Kinds
+		// without a clip keep their texture and don't change. Collision still uses the texture from Initialize
+		void SetAnimation(EntityKind::Kind kind, int side, const AnimatorType& animator, int clip);
+
+		// spawn an obstacle of a kind, placed and sped up by the kind's traits. Uses rand()
+		Entity Spawn(EntityWorldType& world, EntityKind::Kind kind, const SpawnArea& area, float obstacleSpeed) const;
+
+		// spawn a burst of obstacles at the places given, making room for each kind's share in one go. spawned gets
+		// the entity for each order. Only kinds with a random speed use rand()
+		void SpawnBurst(EntityWorldType& world, const SpawnOrder* orders, int count, const SpawnArea& area, float obstacleSpeed, Entity* spawned) const;
+
+		// get the components an obstacle of a kind is created with
+		static ComponentMask GetMask(EntityKind::Kind kind);
+
+		// fill in the components that come straight from a sprite
+		static void CopySprite(SpriteType& sprite, TransformComponent& transform, RenderComponent& render, ColliderComponent& collider);
+
+	private:
+		// the components an obstacle starts with
+		struct Prototype
+		{
+			TransformComponent transform;
+			MotionComponent motion;
+			RenderComponent render;
+			ColliderComponent collider;
+			DamageComponent damage;
+			AnimationComponent animation;
+		};
+
+		Prototype prototypes[OBSTACLE_KIND_COUNT][2]; // One for each side the obstacle can spawn from
+
+		template <EntityKind::Kind K>
+		Entity SpawnKind(EntityWorldType& world, const SpawnArea& area, float obstacleSpeed) const;
+
+		// work out where an obstacle starts and heads for from its spawn edge, side and position across it
+		static void Place(EntityKind::Kind kind, int side, float across, const SpawnArea& area, Vector2& startPos, Vector2& endPos);
+
+		Entity Emplace(EntityWorldType& world, EntityKind::Kind kind, int side, ComponentMask mask, Vector2 startPos, Vector2 endPos, float speed) const;
+};
@@ -0,0 +1,304 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for the obstacle systems and their per-kind kernels
+//----------------------------------------------------------------------------------------
+
+#include "ObstacleSystemsType.h"
+#include "TraceType.h"
+#include "AllocTrackerType.h"
+
+#include <cmath>
+
+// -----------------------------------------------------------------------------
+// Move one chunk of obstacles of kind K. Only the axis the kind moves along is updated,
+// spinning and reversing are compiled in only for the kinds that do them
+template <EntityKind::Kind K>
+static void MoveChunk(ArchetypeType& archetype, int chunk, int count)
+{
+	constexpr ObstacleTraits traits = obstacleTraits[K];
+
+	TransformComponent* transforms = archetype.GetArray<TransformComponent>(chunk);
+	MotionComponent* motions = archetype.GetArray<MotionComponent>(chunk);
+
+	for (int i = 0; i < count; i++)
+	{
+		if (traits.axis == ObstacleRule::Vertical)
+			transforms[i].y += motions[i].dirY * motions[i].speed;
+		else
+			transforms[i].x += motions[i].dirX * motions[i].speed;
+
+		if (traits.rotation == ObstacleRule::SpinWithSpeed)
+			transforms[i].rotation += motions[i].speed;
+	}
+
+	if (traits.path == ObstacleRule::ReverseOnce)
+	{
+		PatrolComponent* patrols = archetype.GetArray<PatrolComponent>(chunk);
+
+		for (int i = 0; i < count; i++)
+		{
+			PatrolComponent& patrol = patrols[i];
+
+			float distToTargetX = fabsf(patrol.endX - transforms[i].x);
+			float distToTargetY = fabsf(patrol.endY - transforms[i].y);
+
+			if (distToTargetX < 5 && distToTargetY < 5 && patrol.reversed == 0)
+			{
+				// Swapping start and end point
+				float tempX = patrol.endX;
+				float tempY = patrol.endY;
+				patrol.endX = patrol.startX;
+				patrol.endY = patrol.startY;
+				patrol.startX = tempX;
+				patrol.startY = tempY;
+
+				transforms[i].rotation += 180; // Rotate around to face other direction
+
+				float dirX = patrol.endX - patrol.startX;
+				float dirY = patrol.endY - patrol.startY;
+				float length = sqrtf(dirX * dirX + dirY * dirY);
+				if (length > 0)
+				{
+					motions[i].dirX = dirX / length;
+					motions[i].dirY = dirY / length;
+				}
+
+				patrol.reversed = 1; // Don't swap start and end again
+			}
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Write the rows of one chunk whose boxes overlap the player's box. This is a cheap box
+// against box test, anything the corner test in HitChunk would hit is always included.
+// For the drawn shapes the box is the square the reach covers, which holds the sprite at
+// any rotation
+template <EntityKind::Kind K>
+static int BroadphaseChunk(ArchetypeType& archetype, int chunk, int count, const PlayerBox& player, bool drawnShapes, int* rows)
+{
+	const TransformComponent* transforms = archetype.GetArray<TransformComponent>(chunk);
+	const ColliderComponent* colliders = archetype.GetArray<ColliderComponent>(chunk);
+
+	int found = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		float x = transforms[i].x;
+		float y = transforms[i].y;
+		float halfWidth = drawnShapes ? colliders[i].reach : colliders[i].halfWidth;
+		float halfHeight = drawnShapes ? colliders[i].reach : colliders[i].halfHeight;
+
+		bool overlapX = x + halfWidth >= player.left && x - halfWidth <= player.right;
+		bool overlapY = y + halfHeight >= player.top && y - halfHeight <= player.bottom;
+
+		if (overlapX && overlapY)
+			rows[found++] = i;
+	}
+
+	return found;
+}
+
+// -----------------------------------------------------------------------------
+// Check one chunk's candidates of kind K with the exact test, in row order. That is the
+// corner test, or the narrow phase's when it tests the drawn shapes
+template <EntityKind::Kind K>
+static bool HitChunk(ArchetypeType& archetype, int chunk, const int* rows, int rowCount, const PlayerBox& player, NarrowPhaseType* narrowPhase, ObstacleHit& hit)
+{
+	constexpr ObstacleTraits traits = obstacleTraits[K];
+
+	const TransformComponent* transforms = archetype.GetArray<TransformComponent>(chunk);
+	const ColliderComponent* colliders = archetype.GetArray<ColliderComponent>(chunk);
+	const RenderComponent* renders = archetype.GetArray<RenderComponent>(chunk);
+
+	for (int r = 0; r < rowCount; r++)
+	{
+		int i = rows[r];
+
+		bool touches = narrowPhase != NULL ? narrowPhase->Touches(transforms[i], renders[i]) :
+			player.Overlaps(transforms[i].x, transforms[i].y, colliders[i].halfWidth, colliders[i].halfHeight);
+
+		if (touches)
+		{
+			hit.entity = archetype.GetEntities(chunk)[i];
+			hit.kind = K;
+			hit.lives = archetype.GetArray<DamageComponent>(chunk)[i].lives;
+			hit.knockbackY = traits.knockbackY;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Write out every obstacle of kind K in a chunk that is outside the kind's despawn bounds.
+// Bounds of +/-FLT_MAX can never be crossed, so their comparisons are dropped
+template <EntityKind::Kind K>
+static int DespawnChunk(ArchetypeType& archetype, int chunk, int count, Entity* despawns)
+{
+	constexpr ObstacleTraits traits = obstacleTraits[K];
+
+	const TransformComponent* transforms = archetype.GetArray<TransformComponent>(chunk);
+	const Entity* entities = archetype.GetEntities(chunk);
+
+	int found = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		float x = transforms[i].x;
+		float y = transforms[i].y;
+
+		if ((traits.minX != -FLT_MAX && x < traits.minX) || (traits.maxX != FLT_MAX && x > traits.maxX) ||
+			(traits.minY != -FLT_MAX && y < traits.minY) || (traits.maxY != FLT_MAX && y > traits.maxY))
+		{
+			despawns[found++] = entities[i];
+		}
+	}
+
+	return found;
+}
+
+typedef void (*MoveKernel)(ArchetypeType&, int, int);
+typedef int (*BroadphaseKernel)(ArchetypeType&, int, int, const PlayerBox&, bool, int*);
+typedef bool (*HitKernel)(ArchetypeType&, int, const int*, int, const PlayerBox&, NarrowPhaseType*, ObstacleHit&);
+typedef int (*DespawnKernel)(ArchetypeType&, int, int, Entity*);
+
+// the kernels for each kind, indexed by EntityKind
+static const MoveKernel moveKernels[OBSTACLE_KIND_COUNT] = { MoveChunk<EntityKind::Rock>, MoveChunk<EntityKind::FireBall>, MoveChunk<EntityKind::Dart>, MoveChunk<EntityKind::Snake> };
+static const BroadphaseKernel broadphaseKernels[OBSTACLE_KIND_COUNT] = { BroadphaseChunk<EntityKind::Rock>, BroadphaseChunk<EntityKind::FireBall>, BroadphaseChunk<EntityKind::Dart>, BroadphaseChunk<EntityKind::Snake> };
+static const HitKernel hitKernels[OBSTACLE_KIND_COUNT] = { HitChunk<EntityKind::Rock>, HitChunk<EntityKind::FireBall>, HitChunk<EntityKind::Dart>, HitChunk<EntityKind::Snake> };
+static const DespawnKernel despawnKernels[OBSTACLE_KIND_COUNT] = { DespawnChunk<EntityKind::Rock>, DespawnChunk<EntityKind::FireBall>, DespawnChunk<EntityKind::Dart>, DespawnChunk<EntityKind::Snake> };
+
+// -----------------------------------------------------------------------------
+// No job system or narrow phase until they are set
+ObstacleSystemsType::ObstacleSystemsType()
+{
+	jobs = NULL;
+	narrowPhase = NULL;
+	gatheredWorld = NULL;
+	gatheredVersion = 0;
+}
+
+// -----------------------------------------------------------------------------
+// List every obstacle chunk, kinds in EntityKind order, and give each a slice of the outputs.
+// Move and MarkDespawns run back to back with nothing spawned or removed between them, so
+// the second one keeps the list
+void ObstacleSystemsType::GatherChunks(EntityWorldType& world)
+{
+	if (gatheredWorld == &world && gatheredVersion == world.GetLayoutVersion())
+		return;
+
+	gatheredWorld = &world;
+	gatheredVersion = world.GetLayoutVersion();
+
+	ALLOC_TAG(Sprites);
+
+	chunks.clear();
+	int total = 0;
+
+	for (int kind = 0; kind < OBSTACLE_KIND_COUNT; kind++)
+	{
+		for (int a = 0; a < world.GetArchetypeCount(); a++)
+		{
+			ArchetypeType& archetype = world.GetArchetype(a);
+			if (archetype.GetKind() != kind)
+				continue;
+
+			for (int chunk = 0; chunk < archetype.GetChunkCount(); chunk++)
+			{
+				ChunkRef ref = { &archetype, chunk, archetype.GetCountInChunk(chunk), total };
+				chunks.push_back(ref);
+				total += ref.count;
+			}
+		}
+	}
+
+	if (int(candidates.size()) < total)
+	{
+		candidates.resize(total);
+		despawns.resize(total);
+	}
+
+	candidateCounts.resize(chunks.size());
+	despawnCounts.resize(chunks.size());
+}
+
+// -----------------------------------------------------------------------------
+// Integrate every obstacle
+void ObstacleSystemsType::Move(EntityWorldType& world)
+{
+	GatherChunks(world);
+
+	ForEachGatheredChunk([&](int i)
+	{
+		const ChunkRef& ref = chunks[i];
+		moveKernels[ref.archetype->GetKind()](*ref.archetype, ref.chunk, ref.count);
+	});
+}
+
+// -----------------------------------------------------------------------------
+// Build the candidate lists for FindHit
+void ObstacleSystemsType::Broadphase(EntityWorldType& world, const PlayerBox& player)
+{
+	TRACE_SCOPE("frame", "Broadphase");
+
+	GatherChunks(world);
+
+	bool drawnShapes = narrowPhase != NULL && narrowPhase->TestsShapes();
+
+	ForEachGatheredChunk([&](int i)
+	{
+		const ChunkRef& ref = chunks[i];
+		candidateCounts[i] = broadphaseKernels[ref.archetype->GetKind()](*ref.archetype, ref.chunk, ref.count, player, drawnShapes, &candidates[ref.start]);
+	});
+}
+
+// -----------------------------------------------------------------------------
+// Find the first candidate touching the player, in the same order a plain scan would find it
+bool ObstacleSystemsType::FindHit(EntityWorldType& world, const PlayerBox& player, ObstacleHit& hit)
+{
+	NarrowPhaseType* shapes = narrowPhase != NULL && narrowPhase->TestsShapes() ? narrowPhase : NULL;
+
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		const ChunkRef& ref = chunks[i];
+
+		if (candidateCounts[i] > 0 && hitKernels[ref.archetype->GetKind()](*ref.archetype, ref.chunk, &candidates[ref.start], candidateCounts[i], player, shapes, hit))
+			return true;
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Find the obstacles that have left their bounds
+void ObstacleSystemsType::MarkDespawns(EntityWorldType& world)
+{
+	TRACE_SCOPE("frame", "MarkDespawns");
+
+	GatherChunks(world);
+
+	ForEachGatheredChunk([&](int i)
+	{
+		const ChunkRef& ref = chunks[i];
+		despawnCounts[i] = despawnKernels[ref.archetype->GetKind()](*ref.archetype, ref.chunk, ref.count, &despawns[ref.start]);
+	});
+}
+
+// -----------------------------------------------------------------------------
+// Remove what MarkDespawns found, in chunk order so the rows end up the same every run
+void ObstacleSystemsType::Compact(EntityWorldType& world)
+{
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		for (int d = 0; d < despawnCounts[i]; d++)
+		{
+			Entity entity = despawns[chunks[i].start + d];
+
+			TRACE_INSTANT("despawn", EntityKind::GetName(chunks[i].archetype->GetKind()), int(entity.index));
+			world.DestroyLater(entity);
+		}
+	}
+
+	world.FlushDestroyed();
+}
@@ -0,0 +1,115 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Per-frame obstacle systems. Each system walks the obstacle chunks and hands each chunk
+// to the kernel for that chunk's kind. The kernels are templates on the kind, generated
+// from the obstacle traits table, so the per-entity loops don't branch on the kind and
+// make no virtual calls. The only dispatch is one table lookup per chunk.
+//
+// Move, Broadphase and MarkDespawns split the chunks across the job system. Each chunk
+// only writes to its own components and its own slice of the candidate and despawn lists.
+// FindHit and Compact then walk those lists in chunk order on one thread, so the results
+// are the same however many threads ran the kernels.
+//
+// With a narrow phase that tests the drawn shapes, Broadphase takes each obstacle's reach
+// rather than its collider box, and FindHit asks the narrow phase instead of testing corners.
+//----------------------------------------------------------------------------------------
+
+#include <vector>
+#include "EntityWorldType.h"
+#include "ObstacleTraits.h"
+#include "JobSystemType.h"
+#include "NarrowPhaseType.h"
+
+// the player's collision box, in whole pixels the same way SpriteType::PointCollision works it out
+struct PlayerBox
+{
+	int left, top, right, bottom;
+
+	bool Contains(float x, float y) const { return x >= left && x <= right && y >= top && y <= bottom; }
+
+	// is any corner of the box inside the player's box
+	bool Overlaps(float x, float y, float halfWidth, float halfHeight) const
+	{
+		return Contains(x - halfWidth, y - halfHeight) || Contains(x + halfWidth, y - halfHeight) ||
+			Contains(x - halfWidth, y + halfHeight) || Contains(x + halfWidth, y + halfHeight);
+	}
+};
+
+// an obstacle that hit the player
+struct ObstacleHit
+{
+	Entity entity;
+	EntityKind::Kind kind;
+	int lives; // Lives taken
+	float knockbackY; // How far to push the player down, negative pushes up
+};
+
+class ObstacleSystemsType
+{
+	public:
+		// constructor
+		ObstacleSystemsType();
+
+		// set the job system the kernels are spread across, NULL runs them on the calling thread
+		void SetJobSystem(JobSystemType* inJobs) { jobs = inJobs; }
+
+		// set the narrow phase FindHit uses, NULL tests the collider boxes' corners
+		void SetNarrowPhase(NarrowPhaseType* inNarrowPhase) { narrowPhase = inNarrowPhase; }
+
+		// move every obstacle along its path
+		void Move(EntityWorldType& world);
+
+		// find the obstacles whose boxes overlap the player's, for FindHit
+		void Broadphase(EntityWorldType& world, const PlayerBox& player);
+
+		// find the first Broadphase candidate touching the player, returns false if none are
+		bool FindHit(EntityWorldType& world, const PlayerBox& player, ObstacleHit& hit);
+
+		// find every obstacle that has left its kind's despawn bounds, for Compact
+		void MarkDespawns(EntityWorldType& world);
+
+		// remove the obstacles MarkDespawns found
+		void Compact(EntityWorldType& world);
+
+	private:
+		// one chunk of obstacles, and where its slice of the output lists starts
+		struct ChunkRef
+		{
+			ArchetypeType* archetype;
+			int chunk;
+			int count;
+			int start;
+		};
+
+		JobSystemType* jobs;
+		NarrowPhaseType* narrowPhase;
+
+		std::vector<ChunkRef> chunks; // Every obstacle chunk, in EntityKind order
+		const EntityWorldType* gatheredWorld; // The world and layout chunks was built for
+		unsigned int gatheredVersion;
+		std::vector<int> candidates; // Broadphase rows, a slice per chunk
+		std::vector<int> candidateCounts;
+		std::vector<Entity> despawns; // Entities to remove, a slice per chunk
+		std::vector<int> despawnCounts;
+
+		// build the chunk list and size the output lists, unless nothing has been created or destroyed since the last time
+		void GatherChunks(EntityWorldType& world);
+
+		// run function(chunkIndex) for every chunk, across the job system if there is one
+		template <class Function>
+		void ForEachGatheredChunk(Function function)
+		{
+			if (jobs == NULL)
+			{
+				for (int i = 0; i < int(chunks.size()); i++)
+					function(i);
+				return;
+			}
+
+			jobs->ParallelFor(int(chunks.size()), 1, [&](int begin, int end)
+			{
+				for (int i = begin; i < end; i++)
+					function(i);
+			});
+		}
+};
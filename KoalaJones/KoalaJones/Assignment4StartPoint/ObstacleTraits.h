@@ -0,0 +1,106 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Compile-time description of each obstacle kind. The spawn, move, collide and despawn
+// kernels are templates on the kind that read their rules from this table as constants,
+// so each kind gets its own loop with the rules for other kinds compiled out.
+//
+// Adding an obstacle kind is a new EntityKind, a new row here and its textures.
+//----------------------------------------------------------------------------------------
+
+#include <cfloat>
+#include "ComponentTypes.h"
+
+// kinds up to this one in EntityKind are obstacles
+static const int OBSTACLE_KIND_COUNT = EntityKind::Item;
+
+class ObstacleRule
+{
+	public:
+
+		// where an obstacle appears and where it heads
+		enum SpawnEdge
+		{
+			Top, // On a random vine at the top, falls to the bottom
+			Bottom, // On a random vine at the bottom, rises to the top
+			LeftOrRight, // At a random height on the left or right, crosses to the other side
+			TopOrBottom // On a random vine at the top or bottom, stops at the other end and comes back
+		};
+
+		// how fast a new obstacle moves
+		enum Speed
+		{
+			FixedSpeed, // obstacleSpeed + 1
+			RandomSpeed // Between 1 and obstacleSpeed
+		};
+
+		// how an obstacle turns as it moves
+		enum Rotation
+		{
+			NoRotation,
+			SpinWithSpeed // Turns speed degrees every tick
+		};
+
+		// what happens at the end of the path
+		enum Path
+		{
+			Straight, // Carries on until it leaves the despawn bounds
+			ReverseOnce // Turns round once on reaching the end, then carries on
+		};
+
+		// axis the obstacle moves along
+		enum Axis { Vertical, Horizontal };
+
+		// whether the obstacle steps through a clip from a sprite sheet, see AnimatorType
+		enum Animation { Still, Animated };
+};
+
+// how the obstacle looks when it spawns from one side
+struct ObstacleSide
+{
+	float rotation; // Degrees
+	float scale;
+	float r, g, b;
+	float pivotX, pivotY; // Rotation origin as a fraction of the texture, 0.5 is the centre
+	float dirX, dirY;
+};
+
+// everything that differs between obstacle kinds
+struct ObstacleTraits
+{
+	ObstacleRule::SpawnEdge spawnEdge;
+	ObstacleRule::Speed speed;
+	ObstacleRule::Rotation rotation;
+	ObstacleRule::Path path;
+	ObstacleRule::Axis axis;
+	ObstacleRule::Animation animation;
+
+	float minX, minY, maxX, maxY; // Removed once it goes outside these
+	float knockbackY; // How far the player is pushed down when hit, negative pushes up
+
+	int sideCount; // Spawn edges with two sides pick one at random
+	ObstacleSide sides[2];
+};
+
+// the table, indexed by EntityKind
+static constexpr ObstacleTraits obstacleTraits[OBSTACLE_KIND_COUNT] =
+{
+	// Rocks fall from the top spinning
+	{ ObstacleRule::Top, ObstacleRule::RandomSpeed, ObstacleRule::SpinWithSpeed, ObstacleRule::Straight, ObstacleRule::Vertical, ObstacleRule::Still,
+		-FLT_MAX, -FLT_MAX, FLT_MAX, 768, 20,
+		1, { { 0, 1, 1, 1, 1, 0.5f, 0.5f, 0, 1 }, { 0, 1, 1, 1, 1, 0.5f, 0.5f, 0, 1 } } },
+
+	// Fire rises from the lava and knocks the player up rather than down
+	{ ObstacleRule::Bottom, ObstacleRule::FixedSpeed, ObstacleRule::NoRotation, ObstacleRule::Straight, ObstacleRule::Vertical, ObstacleRule::Still,
+		-FLT_MAX, -100, FLT_MAX, FLT_MAX, -20,
+		1, { { 0, 1, 1, 1, 1, 0.5f, 0.5f, 0, -1 }, { 0, 1, 1, 1, 1, 0.5f, 0.5f, 0, -1 } } },
+
+	// Darts from the left are turned to face right, with the pivot further back so collision with the player feels better
+	{ ObstacleRule::LeftOrRight, ObstacleRule::FixedSpeed, ObstacleRule::NoRotation, ObstacleRule::Straight, ObstacleRule::Horizontal, ObstacleRule::Animated,
+		-100, -FLT_MAX, 1124, FLT_MAX, 20,
+		2, { { 180, 1, 1, 1, 1, 1, 0.5f, 1, 0 }, { 0, 1, 1, 1, 1, 0.5f, 0.5f, -1, 0 } } },
+
+	// Snakes from the top are regular snakes, from the bottom they are smaller orange-red lava snakes facing up
+	{ ObstacleRule::TopOrBottom, ObstacleRule::RandomSpeed, ObstacleRule::NoRotation, ObstacleRule::ReverseOnce, ObstacleRule::Vertical, ObstacleRule::Animated,
+		-FLT_MAX, -100, FLT_MAX, 768, 20,
+		2, { { 0, 1, 1, 1, 1, 0.5f, 0.5f, 0, 1 }, { 180, 0.8f, 1, 0.270588249f, 0, 0.5f, 0.5f, 0, -1 } } }
+};
@@ -0,0 +1,243 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for the particle system
+//----------------------------------------------------------------------------------------
+
+#include "ParticleSystemType.h"
+#include "AllocTrackerType.h"
+
+#include <emmintrin.h>
+#include <cmath>
+
+// how each emitter's particles start off, angles are in degrees with 0 to the right and -90 up
+struct EmitterSettings
+{
+	float speedLow, speedHigh;
+	float angleLow, angleHigh;
+	float gravity;
+	float lifeLow, lifeHigh;
+	float startR, startG, startB, startA;
+	float endR, endG, endB; // Alpha always ends at 0
+	float sizeLow, sizeHigh;
+};
+
+static const EmitterSettings emitterSettings[ParticleSystemType::EMITTER_COUNT] =
+{
+	{ 10, 40, -120, -60, -40, 0.3f, 0.6f, 1, 0.8f, 0.2f, 1, 0.8f, 0.1f, 0, 2, 4 }, // FireTrail, embers drifting up off the fireball
+	{ 80, 220, -150, -30, 400, 0.5f, 0.9f, 1, 0.6f, 0.1f, 1, 0.6f, 0.05f, 0, 2, 5 }, // LavaSplash, thrown up and falling back
+	{ 60, 200, -180, 180, 150, 0.3f, 0.6f, 1, 0.2f, 0.2f, 1, 1, 1, 1, 2, 4 }, // KoalaHit, every way at once
+};
+
+// -----------------------------------------------------------------------------
+// Room for CAPACITY particles up front, so emitting never allocates
+ParticleSystemType::ParticleSystemType()
+{
+	ALLOC_TAG(Rendering);
+
+	jobs = NULL;
+	count = 0;
+	removed = 0;
+	random = 0x9E3779B9;
+
+	std::vector<float>* arrays[] = { &x, &y, &velocityX, &velocityY, &gravity, &life, &r, &g, &b, &a, &fadeR, &fadeG, &fadeB, &fadeA, &size };
+	for (std::vector<float>* values : arrays)
+		values->resize(CAPACITY);
+
+	dead.resize(CAPACITY);
+	deadCounts.resize(CAPACITY / BLOCK);
+}
+
+// -----------------------------------------------------------------------------
+// xorshift, the game's rand() is left alone
+float ParticleSystemType::RandomRange(float low, float high)
+{
+	random ^= random << 13;
+	random ^= random >> 17;
+	random ^= random << 5;
+
+	return low + (high - low) * float(random >> 8) * (1.0f / 16777216.0f);
+}
+
+// -----------------------------------------------------------------------------
+// Add particles on the end with the emitter's spread of speeds, directions and lifetimes.
+// The fade rates take the colour to the end colour, and alpha to 0, as life runs out
+int ParticleSystemType::Emit(Emitter emitter, float atX, float atY, int emitCount)
+{
+	const EmitterSettings& settings = emitterSettings[emitter];
+
+	if (emitCount > CAPACITY - count)
+		emitCount = CAPACITY - count;
+
+	for (int n = 0; n < emitCount; n++)
+	{
+		int i = count++;
+
+		float angle = RandomRange(settings.angleLow, settings.angleHigh) * 3.141592f / 180.0f;
+		float speed = RandomRange(settings.speedLow, settings.speedHigh);
+		float lifetime = RandomRange(settings.lifeLow, settings.lifeHigh);
+
+		x[i] = atX;
+		y[i] = atY;
+		velocityX[i] = cosf(angle) * speed;
+		velocityY[i] = sinf(angle) * speed;
+		gravity[i] = settings.gravity;
+		life[i] = lifetime;
+		r[i] = settings.startR;
+		g[i] = settings.startG;
+		b[i] = settings.startB;
+		a[i] = settings.startA;
+		fadeR[i] = (settings.endR - settings.startR) / lifetime;
+		fadeG[i] = (settings.endG - settings.startG) / lifetime;
+		fadeB[i] = (settings.endB - settings.startB) / lifetime;
+		fadeA[i] = -settings.startA / lifetime;
+		size[i] = RandomRange(settings.sizeLow, settings.sizeHigh);
+	}
+
+	return emitCount;
+}
+
+// -----------------------------------------------------------------------------
+// Update every block, then remove the dead from the highest index down
+void ParticleSystemType::Update(float deltaTime)
+{
+	removed = 0;
+	if (count == 0)
+		return;
+
+	int blockCount = (count + BLOCK - 1) / BLOCK;
+
+	if (jobs == NULL)
+	{
+		for (int block = 0; block < blockCount; block++)
+			UpdateBlock(block, deltaTime);
+	}
+	else
+	{
+		jobs->ParallelFor(blockCount, 1, [&](int begin, int end)
+		{
+			for (int block = begin; block < end; block++)
+				UpdateBlock(block, deltaTime);
+		});
+	}
+
+	for (int block = blockCount - 1; block >= 0; block--)
+	{
+		const int* blockDead = &dead[block * BLOCK];
+
+		for (int d = deadCounts[block] - 1; d >= 0; d--)
+			MoveLast(blockDead[d]);
+
+		removed += deadCounts[block];
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Four particles at a time. The last group can run past count into unused slots, which
+// is harmless as nothing reads them, but only particles below count are reported dead
+void ParticleSystemType::UpdateBlock(int block, float deltaTime)
+{
+	int begin = block * BLOCK;
+	int end = begin + BLOCK < count ? begin + BLOCK : count;
+
+	int* blockDead = &dead[begin];
+	int deadCount = 0;
+
+	__m128 dt = _mm_set1_ps(deltaTime);
+	__m128 zero = _mm_setzero_ps();
+
+	for (int i = begin; i < end; i += 4)
+	{
+		__m128 vy = _mm_add_ps(_mm_loadu_ps(&velocityY[i]), _mm_mul_ps(_mm_loadu_ps(&gravity[i]), dt));
+		_mm_storeu_ps(&velocityY[i], vy);
+		_mm_storeu_ps(&x[i], _mm_add_ps(_mm_loadu_ps(&x[i]), _mm_mul_ps(_mm_loadu_ps(&velocityX[i]), dt)));
+		_mm_storeu_ps(&y[i], _mm_add_ps(_mm_loadu_ps(&y[i]), _mm_mul_ps(vy, dt)));
+
+		_mm_storeu_ps(&r[i], _mm_add_ps(_mm_loadu_ps(&r[i]), _mm_mul_ps(_mm_loadu_ps(&fadeR[i]), dt)));
+		_mm_storeu_ps(&g[i], _mm_add_ps(_mm_loadu_ps(&g[i]), _mm_mul_ps(_mm_loadu_ps(&fadeG[i]), dt)));
+		_mm_storeu_ps(&b[i], _mm_add_ps(_mm_loadu_ps(&b[i]), _mm_mul_ps(_mm_loadu_ps(&fadeB[i]), dt)));
+		_mm_storeu_ps(&a[i], _mm_add_ps(_mm_loadu_ps(&a[i]), _mm_mul_ps(_mm_loadu_ps(&fadeA[i]), dt)));
+
+		__m128 left = _mm_sub_ps(_mm_loadu_ps(&life[i]), dt);
+		_mm_storeu_ps(&life[i], left);
+
+		int died = _mm_movemask_ps(_mm_cmple_ps(left, zero));
+		while (died != 0)
+		{
+			int lane = 0;
+			while (!(died & (1 << lane)))
+				lane++;
+			died &= ~(1 << lane);
+
+			if (i + lane < end)
+				blockDead[deadCount++] = i + lane;
+		}
+	}
+
+	deadCounts[block] = deadCount;
+}
+
+// -----------------------------------------------------------------------------
+// Fill a hole with the last particle
+void ParticleSystemType::MoveLast(int index)
+{
+	int last = --count;
+	if (index == last)
+		return;
+
+	x[index] = x[last];
+	y[index] = y[last];
+	velocityX[index] = velocityX[last];
+	velocityY[index] = velocityY[last];
+	gravity[index] = gravity[last];
+	life[index] = life[last];
+	r[index] = r[last];
+	g[index] = g[last];
+	b[index] = b[last];
+	a[index] = a[last];
+	fadeR[index] = fadeR[last];
+	fadeG[index] = fadeG[last];
+	fadeB[index] = fadeB[last];
+	fadeA[index] = fadeA[last];
+	size[index] = size[last];
+}
+
+// -----------------------------------------------------------------------------
+// Copy the positions and sizes, and pack the colours four at a time. Colours are clamped
+// to [0, 1] first, as the last fade of a particle's life can overshoot
+void ParticleSystemType::CopyTo(float* outX, float* outY, float* outSize, uint32_t* outColors) const
+{
+	__m128 zero = _mm_setzero_ps();
+	__m128 one = _mm_set1_ps(1);
+	__m128 scale = _mm_set1_ps(255);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_ps(&outX[i], _mm_loadu_ps(&x[i]));
+		_mm_storeu_ps(&outY[i], _mm_loadu_ps(&y[i]));
+		_mm_storeu_ps(&outSize[i], _mm_loadu_ps(&size[i]));
+
+		__m128i red = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(&r[i]), zero), one), scale));
+		__m128i green = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(&g[i]), zero), one), scale));
+		__m128i blue = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(&b[i]), zero), one), scale));
+		__m128i alpha = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(&a[i]), zero), one), scale));
+
+		__m128i packed = _mm_or_si128(_mm_or_si128(red, _mm_slli_epi32(green, 8)), _mm_or_si128(_mm_slli_epi32(blue, 16), _mm_slli_epi32(alpha, 24)));
+		_mm_storeu_si128((__m128i*)&outColors[i], packed);
+	}
+
+	for (; i < count; i++)
+	{
+		float channels[4] = { r[i], g[i], b[i], a[i] };
+		uint32_t color = 0;
+		for (int c = 0; c < 4; c++)
+		{
+			float value = channels[c] < 0 ? 0 : (channels[c] > 1 ? 1 : channels[c]);
+			color |= uint32_t(int(value * 255 + 0.5f)) << (c * 8);
+		}
+
+		outX[i] = x[i];
+		outY[i] = y[i];
+		outSize[i] = size[i];
+		outColors[i] = color;
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Cosmetic particles: fireball trails, lava splashes and the burst when the koala is hit.
+// Particles never touch the game, so they have their own random numbers and the game's
+// rand() sequence is the same with or without them.
+//
+// Each per-particle value is its own array. Update works through them four particles an
+// SSE instruction: velocity picks up gravity, position picks up velocity, the colour
+// fades by its per-second rates and life counts down. The particles are split into blocks
+// of BLOCK particles spread across the job system, and each block writes the particles
+// that died into its own slice of the dead list.
+//
+// The dead are then removed in one pass, each by moving the last live particle into its
+// place. Going from the highest dead index down means the particle moved in is never one
+// still waiting to be removed, so the arrays stay packed with no gaps to skip.
+//
+// Particles live in pixels and seconds, unlike obstacles which move by ticks.
+//----------------------------------------------------------------------------------------
+
+#include <vector>
+#include <cstdint>
+#include "JobSystemType.h"
+
+class ParticleSystemType
+{
+	public:
+		static const int CAPACITY = 524288; // Most particles alive at once, emitting past this is dropped
+		static const int BLOCK = 8192; // Particles each job updates, a multiple of 4
+
+		// what made the particles, each has its own speeds, colours and lifetimes
+		enum Emitter { FireTrail, LavaSplash, KoalaHit, EMITTER_COUNT };
+
+		// constructor
+		ParticleSystemType();
+
+		// set the job system the blocks are spread across, NULL runs them on the calling thread
+		void SetJobSystem(JobSystemType* inJobs) { jobs = inJobs; }
+
+		// add count particles at a point, returns how many there was room for
+		int Emit(Emitter emitter, float x, float y, int count);
+
+		// move, fade and age every particle by deltaTime seconds, then remove the ones that died
+		void Update(float deltaTime);
+
+		// remove every particle
+		void Clear() { count = 0; }
+
+		int GetCount() const { return count; }
+		int GetRemovedCount() const { return removed; } // Died in the last Update
+
+		// copy out what the renderer needs, colours packed as R G B A bytes from the low byte up
+		void CopyTo(float* outX, float* outY, float* outSize, uint32_t* outColors) const;
+
+	private:
+		JobSystemType* jobs;
+		int count;
+		int removed;
+		uint32_t random; // xorshift state
+
+		// per particle, CAPACITY long so Update can always load a whole group of 4
+		std::vector<float> x, y;
+		std::vector<float> velocityX, velocityY;
+		std::vector<float> gravity; // Added to velocityY every second
+		std::vector<float> life; // Seconds left
+		std::vector<float> r, g, b, a;
+		std::vector<float> fadeR, fadeG, fadeB, fadeA; // Added to the colour every second
+		std::vector<float> size; // Pixels across, doesn't change
+
+		std::vector<int> dead; // Indices that died in Update, a BLOCK long slice per block
+		std::vector<int> deadCounts; // Per block
+
+		// a float in [low, high)
+		float RandomRange(float low, float high);
+
+		// update one block, writing its dead to its slice
+		void UpdateBlock(int block, float deltaTime);
+
+		// move the last particle into index
+		void MoveLast(int index);
+};
@@ -0,0 +1,96 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for the frame phase profiler
+//----------------------------------------------------------------------------------------
+
+#include "ProfilerType.h"
+
+#ifdef PROFILER_ENABLED
+
+#include <algorithm>
+#include <cstdio>
+
+// -----------------------------------------------------------------------------
+// Initialize member variables
+ProfilerType::ProfilerType()
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	msPerTick = 1000.0 / double(frequency.QuadPart);
+
+	for (int i = 0; i < PHASE_COUNT; i++)
+	{
+		nextSample[i] = 0;
+		sampleCount[i] = 0;
+	}
+
+	renderEndTicks = 0;
+	overlayVisible = false;
+}
+
+// -----------------------------------------------------------------------------
+// Add a sample to the phase's ring buffer, overwriting the oldest once it is full
+void ProfilerType::AddSample(Phase phase, __int64 ticks)
+{
+	samples[phase][nextSample[phase]] = float(ticks * msPerTick);
+
+	nextSample[phase] = (nextSample[phase] + 1) % SAMPLE_COUNT;
+
+	if (sampleCount[phase] < SAMPLE_COUNT)
+		sampleCount[phase]++;
+
+	if (phase == FramePhase::Render)
+		MarkRenderEnd(); // Present starts once Render has returned
+}
+
+// -----------------------------------------------------------------------------
+// Called at the top of Update, closes off the Present sample from the last frame
+void ProfilerType::MarkFrameStart()
+{
+	if (renderEndTicks != 0)
+	{
+		AddSample(FramePhase::Present, GetTicks() - renderEndTicks);
+		renderEndTicks = 0;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Sort a copy of the ring buffer and read the percentiles out of it
+ProfilerType::Stats ProfilerType::GetStats(Phase phase) const
+{
+	Stats stats = { 0, 0, 0, 0, sampleCount[phase] };
+
+	if (stats.sampleCount == 0)
+		return stats;
+
+	float sorted[SAMPLE_COUNT];
+	std::copy(samples[phase], samples[phase] + stats.sampleCount, sorted);
+	std::sort(sorted, sorted + stats.sampleCount);
+
+	int last = stats.sampleCount - 1;
+	stats.p50 = sorted[last * 50 / 100];
+	stats.p95 = sorted[last * 95 / 100];
+	stats.p99 = sorted[last * 99 / 100];
+	stats.max = sorted[last];
+
+	return stats;
+}
+
+// -----------------------------------------------------------------------------
+// Draw one line per phase with its percentiles in milliseconds
+void ProfilerType::DrawOverlay(FontType& font, int posX, int posY)
+{
+	wchar_t line[128];
+
+	swprintf(line, 128, L"%-20ls %7ls %7ls %7ls %7ls", L"Phase (ms)", L"p50", L"p95", L"p99", L"max");
+	font.PrintMessage(posX, posY, line, FC_BLACK);
+
+	for (int i = 0; i < PHASE_COUNT; i++)
+	{
+		Stats stats = GetStats(Phase(i));
+
+		swprintf(line, 128, L"%-20hs %7.3f %7.3f %7.3f %7.3f", FramePhase::GetName(Phase(i)), stats.p50, stats.p95, stats.p99, stats.max);
+		font.PrintMessage(posX, posY + (i + 1) * 18, line, FC_BLACK);
+	}
+}
+
+#endif
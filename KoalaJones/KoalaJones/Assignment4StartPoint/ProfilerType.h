@@ -0,0 +1,95 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Frame phase profiler. Scoped timers record how long each phase of a frame took into a
+// ring buffer per phase, which can be summarised as p50/p95/p99/max and drawn on screen.
+//
+// The profiler only exists in debug builds (_DEBUG). In release builds PROFILE_SCOPE
+// expands to nothing and the class is never compiled.
+//----------------------------------------------------------------------------------------
+
+#ifdef _DEBUG
+#define PROFILER_ENABLED
+#endif
+
+#ifdef PROFILER_ENABLED
+
+#include <windows.h>
+#include "Font.h"
+#include "FramePhase.h"
+
+class ProfilerType
+{
+	public:
+
+		typedef FramePhase::Phase Phase;
+		static const int PHASE_COUNT = FramePhase::COUNT;
+
+		// summary of the samples currently in a phase's ring buffer (milliseconds)
+		struct Stats
+		{
+			float p50;
+			float p95;
+			float p99;
+			float max;
+			int sampleCount;
+		};
+
+		// constructor
+		ProfilerType();
+
+		// read the high resolution counter
+		static __int64 GetTicks() { LARGE_INTEGER t; QueryPerformanceCounter(&t); return t.QuadPart; }
+
+		// add a sample (in counter ticks) to a phase's ring buffer
+		void AddSample(Phase phase, __int64 ticks);
+
+		// Present happens inside DirectXClass::RenderScene, so it is measured as the gap
+		// between the end of Render and the start of the next Update
+		void MarkRenderEnd() { renderEndTicks = GetTicks(); }
+		void MarkFrameStart(); // Call at the top of Update
+
+		// calculate the percentiles for a phase
+		Stats GetStats(Phase phase) const;
+
+		// get and set whether the overlay is drawn
+		bool IsOverlayVisible() const { return overlayVisible; }
+		void ToggleOverlay() { overlayVisible = !overlayVisible; }
+
+		// draw the per-phase breakdown
+		void DrawOverlay(FontType& font, int posX, int posY);
+
+	private:
+		static const int SAMPLE_COUNT = 256; // Frames kept per phase
+
+		float samples[PHASE_COUNT][SAMPLE_COUNT]; // Ring buffer of samples (milliseconds)
+		int nextSample[PHASE_COUNT]; // Index that the next sample is written to
+		int sampleCount[PHASE_COUNT]; // Number of valid samples, up to SAMPLE_COUNT
+
+		double msPerTick; // Converts counter ticks to milliseconds
+		__int64 renderEndTicks; // When the last Render finished, 0 until the first frame is drawn
+		bool overlayVisible;
+};
+
+//----------------------------------------------------------------------------------------
+// Times the enclosing scope and adds it to the profiler when the scope ends
+class ProfileScope
+{
+	public:
+		ProfileScope(ProfilerType& inProfiler, ProfilerType::Phase inPhase) : profiler(inProfiler), phase(inPhase), startTicks(ProfilerType::GetTicks()) {}
+		~ProfileScope() { profiler.AddSample(phase, ProfilerType::GetTicks() - startTicks); }
+
+	private:
+		ProfilerType& profiler;
+		ProfilerType::Phase phase;
+		__int64 startTicks;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(phase) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(profiler, FramePhase::phase)
+
+#else
+
+#define PROFILE_SCOPE(phase)
+
+#endif
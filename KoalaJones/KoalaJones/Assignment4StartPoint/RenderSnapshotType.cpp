@@ -0,0 +1,80 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for render snapshots
+//----------------------------------------------------------------------------------------
+
+#include "RenderSnapshotType.h"
+#include "ObstaclePoolType.h"
+#include "AllocTrackerType.h"
+
+#include <cstring>
+
+// -----------------------------------------------------------------------------
+// An empty snapshot on the start screen, drawn until the sim publishes its first
+RenderSnapshotType::RenderSnapshotType()
+{
+	memset(&hud, 0, sizeof(hud));
+	tick = 0;
+	particleCount = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Drop last time's instances, clear keeps the capacity
+void RenderSnapshotType::Begin(unsigned int inTick)
+{
+	instances.clear();
+	particleCount = 0;
+	tick = inTick;
+}
+
+// -----------------------------------------------------------------------------
+// Copy the sprite's draw settings the same way obstacles get theirs
+void RenderSnapshotType::AddSprite(SpriteType& sprite)
+{
+	ALLOC_TAG(Rendering);
+
+	DrawInstance instance;
+	ColliderComponent collider;
+	ObstaclePoolType::CopySprite(sprite, instance.transform, instance.render, collider);
+
+	instances.push_back(instance);
+}
+
+// -----------------------------------------------------------------------------
+// Grow once for the whole chunk, then copy its two arrays into the instances
+void RenderSnapshotType::AddChunk(ArchetypeType& archetype, int chunk, int count)
+{
+	const TransformComponent* transforms = archetype.GetArray<TransformComponent>(chunk);
+	const RenderComponent* renders = archetype.GetArray<RenderComponent>(chunk);
+
+	size_t first = instances.size();
+	{
+		ALLOC_TAG(Rendering);
+		instances.resize(first + count);
+	}
+
+	DrawInstance* out = &instances[first];
+	for (int i = 0; i < count; i++)
+	{
+		out[i].transform = transforms[i];
+		out[i].render = renders[i];
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Grow the arrays if there are more particles than they have held before, then copy
+void RenderSnapshotType::SetParticles(const ParticleSystemType& particles)
+{
+	particleCount = particles.GetCount();
+
+	if (int(particleX.size()) < particleCount)
+	{
+		ALLOC_TAG(Rendering);
+		particleX.resize(particleCount);
+		particleY.resize(particleCount);
+		particleSizes.resize(particleCount);
+		particleColors.resize(particleCount);
+	}
+
+	if (particleCount > 0)
+		particles.CopyTo(particleX.data(), particleY.data(), particleSizes.data(), particleColors.data());
+}
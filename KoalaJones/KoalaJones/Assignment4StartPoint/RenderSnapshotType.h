@@ -0,0 +1,88 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Everything a frame needs to draw, copied out of the sim at the end of its tick. The
+// renderer draws from the snapshot and never reads the world or the game values, so the
+// sim can move on to its next tick while the last one is drawn.
+//
+// A snapshot is one flat array of draw instances, the particles as flat arrays of their
+// own, plus the values the HUD prints. Once
+// published it isn't changed until it comes round to be refilled, see TripleBufferType.
+// Clearing keeps the array's capacity, so a snapshot only allocates while it grows.
+//----------------------------------------------------------------------------------------
+
+#include <vector>
+#include "SpriteType.h"
+#include "ArchetypeType.h"
+#include "ObstacleTraits.h"
+#include "ParticleSystemType.h"
+
+// one sprite to draw
+struct DrawInstance
+{
+	TransformComponent transform;
+	RenderComponent render;
+};
+
+// the values the HUD and end screens print
+struct RenderHud
+{
+	int state; // MyProject's game state
+	float elapsedTime;
+	int score;
+	int lives;
+	int obstacleLevel;
+	int counts[OBSTACLE_KIND_COUNT]; // Obstacles of each kind, and how many fit in their chunks
+	int capacities[OBSTACLE_KIND_COUNT];
+	float inputLatencyMs, inputMeanLatencyMs, inputMaxLatencyMs;
+	bool autoplay; // The bot is playing, and its last decision
+	int autoplayNodes, autoplayDepth;
+	float autoplayMs;
+	int autoplayDropped; // Obstacles and items the bot couldn't fit in its view
+	bool pacing; // Frame pacer's waiting is on
+	float inputToPresentMs, jitterMs, paceWaitMs;
+	int particleCount; // Particles alive, how long their last update took and how long copying them into the snapshot took
+	float particleMs, particleCopyMs;
+
+	// stress test progress
+	char stressName[64];
+	int stressTarget;
+	int stressStep, stressStepCount;
+	int stressAlive;
+	unsigned int stressMemoryKB;
+};
+
+class RenderSnapshotType
+{
+	public:
+		// constructor
+		RenderSnapshotType();
+
+		// empty the instances for a new tick, the array keeps its capacity
+		void Begin(unsigned int inTick);
+
+		// add a sprite, or every entity in a chunk that has a transform and render component
+		void AddSprite(SpriteType& sprite);
+		void AddChunk(ArchetypeType& archetype, int chunk, int count);
+
+		// copy every live particle, replacing last tick's
+		void SetParticles(const ParticleSystemType& particles);
+
+		const DrawInstance* GetInstances() const { return instances.empty() ? NULL : &instances[0]; }
+		int GetInstanceCount() const { return int(instances.size()); }
+		unsigned int GetTick() const { return tick; }
+
+		int GetParticleCount() const { return particleCount; }
+		const float* GetParticleX() const { return particleX.data(); }
+		const float* GetParticleY() const { return particleY.data(); }
+		const float* GetParticleSizes() const { return particleSizes.data(); }
+		const uint32_t* GetParticleColors() const { return particleColors.data(); } // R G B A bytes from the low byte up
+
+		RenderHud hud;
+
+	private:
+		std::vector<DrawInstance> instances;
+		std::vector<float> particleX, particleY, particleSizes; // Only grow, particleCount of them are this tick's
+		std::vector<uint32_t> particleColors;
+		int particleCount;
+		unsigned int tick; // Sim tick the snapshot was taken on
+};
@@ -0,0 +1,182 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// On-disk layout of a game results store, one row per finished simulated game. Kept free
+// of Windows/DirectX headers so the offline query tool can be built on its own.
+//
+// A store is a ResultsFileHeader followed by blocks, each a ResultsBlockHeader and then
+// the data for each column in turn. Blocks are only ever added to the end, and each has
+// the size of the whole block in its header, so a reader walks the file block by block.
+//
+// Each column of a block has the minimum, maximum and sum of its values in the block
+// header. A query can use these to skip a block without decoding it, or take its count
+// and sums straight from the header when every row in it matches.
+//
+// Column encodings, all built on varints so small values take a byte:
+// - Delta: each value less the one before it, the first less 0, zigzagged so steps back
+//   are small too. For seeds and parameter sets, which count up through a run.
+// - Offset: each value less the block's minimum.
+// - Dictionary: up to MAX_DICTIONARY distinct values as zigzag varints, then a byte per
+//   row indexing them. For enums such as the death cause. A column with more distinct
+//   values than that falls back to Offset.
+//----------------------------------------------------------------------------------------
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+class ResultsFormat
+{
+	public:
+
+		static const uint16_t VERSION = 1;
+		static const int BLOCK_ROWS = 65536; // Rows in a full block, the last block of a run can have fewer
+		static const int MAX_DICTIONARY = 255;
+
+		// one per value kept for each game
+		enum Column { Seed, ParamSet, Ticks, Score, MaxItemCombo, DeathCause, Rocks, FireBalls, Darts, Snakes, COLUMN_COUNT };
+
+		enum Encoding { Delta, Offset, Dictionary };
+
+		// death causes that aren't an obstacle kind
+		enum { StillAlive = -1 }; // The run stopped before the game ended
+
+		static const char* GetColumnName(Column column)
+		{
+			static const char* names[COLUMN_COUNT] = { "seed", "params", "ticks", "score", "maxcombo", "death", "rocks", "fireballs", "darts", "snakes" };
+
+			return (column >= 0 && column < COLUMN_COUNT) ? names[column] : "";
+		}
+
+		// the encoding each column is written with when it fits
+		static Encoding GetPreferredEncoding(Column column)
+		{
+			switch (column)
+			{
+			case Seed:
+			case ParamSet:
+				return Delta;
+			case DeathCause:
+				return Dictionary;
+			default:
+				return Offset;
+			}
+		}
+
+		// write a value 7 bits a byte, low bits first, returns the bytes written, at most 10
+		static int PutVarint(uint8_t* out, uint64_t value)
+		{
+			int bytes = 0;
+			while (value >= 0x80)
+			{
+				out[bytes++] = uint8_t(value | 0x80);
+				value >>= 7;
+			}
+			out[bytes++] = uint8_t(value);
+
+			return bytes;
+		}
+
+		// read a varint, moving in past it
+		static uint64_t GetVarint(const uint8_t*& in)
+		{
+			uint64_t value = 0;
+			int shift = 0;
+
+			while (*in & 0x80)
+			{
+				value |= uint64_t(*in++ & 0x7F) << shift;
+				shift += 7;
+			}
+			value |= uint64_t(*in++) << shift;
+
+			return value;
+		}
+
+		// interleave negative values with positive ones, 0 -1 1 -2 2 becomes 0 1 2 3 4
+		static uint64_t Zigzag(int64_t value) { return (uint64_t(value) << 1) ^ uint64_t(value >> 63); }
+		static int64_t Unzigzag(uint64_t value) { return int64_t(value >> 1) ^ -int64_t(value & 1); }
+};
+
+#pragma pack(push, 1)
+
+struct ResultsFileHeader
+{
+	char magic[4]; // "KJRS"
+	uint16_t version;
+	uint16_t columnCount; // ResultsFormat::COLUMN_COUNT when the store was made
+	uint32_t blockRows; // ResultsFormat::BLOCK_ROWS when the store was made
+};
+
+struct ResultsColumnHeader
+{
+	uint8_t encoding; // ResultsFormat::Encoding
+	uint8_t dictionarySize; // Values in the dictionary, for Dictionary columns
+	uint16_t reserved;
+	uint32_t bytes; // Encoded size of the column
+	int64_t minimum, maximum;
+	int64_t sum;
+};
+
+struct ResultsBlockHeader
+{
+	char magic[4]; // "KJRB"
+	uint32_t rowCount;
+	uint64_t bytes; // The whole block, this header included
+	ResultsColumnHeader columns[ResultsFormat::COLUMN_COUNT];
+};
+
+#pragma pack(pop)
+
+// -----------------------------------------------------------------------------
+// Is the block starting with this header all there, bytesLeft being what the file has from
+// the header on. A torn or damaged header fails: one too short to hold itself would stop a
+// reader moving on or put every block after it out of step, and one whose columns don't add
+// up to the block would decode past them
+inline bool IsResultsBlockWhole(const ResultsBlockHeader& header, uint64_t bytesLeft)
+{
+	if (memcmp(header.magic, "KJRB", 4) != 0 || header.rowCount > uint32_t(ResultsFormat::BLOCK_ROWS) ||
+		header.bytes < sizeof(ResultsBlockHeader) || header.bytes > bytesLeft)
+		return false;
+
+	uint64_t columnBytes = 0;
+	for (int c = 0; c < ResultsFormat::COLUMN_COUNT; c++)
+	{
+		if (header.columns[c].encoding > ResultsFormat::Dictionary)
+			return false;
+		columnBytes += header.columns[c].bytes;
+	}
+
+	return sizeof(ResultsBlockHeader) + columnBytes == header.bytes;
+}
+
+// -----------------------------------------------------------------------------
+// Decode a column of a block into count values
+inline void DecodeResultsColumn(const ResultsColumnHeader& header, const uint8_t* data, int count, int64_t* values)
+{
+	switch (header.encoding)
+	{
+	case ResultsFormat::Delta:
+	{
+		int64_t value = 0;
+		for (int i = 0; i < count; i++)
+		{
+			value += ResultsFormat::Unzigzag(ResultsFormat::GetVarint(data));
+			values[i] = value;
+		}
+		break;
+	}
+	case ResultsFormat::Offset:
+		for (int i = 0; i < count; i++)
+			values[i] = header.minimum + int64_t(ResultsFormat::GetVarint(data));
+		break;
+	case ResultsFormat::Dictionary:
+	{
+		int64_t dictionary[ResultsFormat::MAX_DICTIONARY];
+		for (int entry = 0; entry < header.dictionarySize; entry++)
+			dictionary[entry] = ResultsFormat::Unzigzag(ResultsFormat::GetVarint(data));
+		for (int i = 0; i < count; i++)
+			values[i] = dictionary[data[i]];
+		break;
+	}
+	}
+}
@@ -0,0 +1,263 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for the results store
+//----------------------------------------------------------------------------------------
+
+#include "ResultsStoreType.h"
+#include "AllocTrackerType.h"
+
+#include <cstring>
+#include <filesystem>
+
+static_assert(ResultsFormat::Snakes - ResultsFormat::Rocks + 1 == OBSTACLE_KIND_COUNT, "A column for each obstacle kind");
+
+// -----------------------------------------------------------------------------
+// Seek to a 64-bit offset, files of results pass 2GB
+static bool SeekTo(FILE* file, long long offset)
+{
+#ifdef _WIN32
+	return _fseeki64(file, offset, SEEK_SET) == 0;
+#else
+	return fseeko(file, offset, SEEK_SET) == 0;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Room for a full block of every column
+ResultsStoreType::ResultsStoreType()
+{
+	ALLOC_TAG(Diagnostics);
+
+	file = NULL;
+	rowCount = 0;
+	fileBytes = 0;
+	pending = 0;
+
+	for (int column = 0; column < ResultsFormat::COLUMN_COUNT; column++)
+		columns[column].resize(ResultsFormat::BLOCK_ROWS);
+}
+
+// -----------------------------------------------------------------------------
+// Rows still waiting are written on the way out
+ResultsStoreType::~ResultsStoreType()
+{
+	Close();
+}
+
+// -----------------------------------------------------------------------------
+// Walk the blocks of a store that is already there to count its rows and find where the
+// last whole block ends, cut off anything after it and open the file for adding to. A
+// new store just gets its header
+bool ResultsStoreType::Open(const char* fileName)
+{
+	Close();
+
+	rowCount = 0;
+	fileBytes = 0;
+
+	std::error_code error;
+	long long size = (long long)std::filesystem::file_size(fileName, error);
+
+	if (error || size == 0)
+	{
+		file = fopen(fileName, "wb");
+		if (file == NULL)
+			return false;
+
+		ResultsFileHeader header;
+		memcpy(header.magic, "KJRS", 4);
+		header.version = ResultsFormat::VERSION;
+		header.columnCount = ResultsFormat::COLUMN_COUNT;
+		header.blockRows = ResultsFormat::BLOCK_ROWS;
+
+		fwrite(&header, sizeof(header), 1, file);
+		fileBytes = sizeof(header);
+		return true;
+	}
+
+	FILE* existing = fopen(fileName, "rb");
+	if (existing == NULL)
+		return false;
+
+	ResultsFileHeader header;
+	if (fread(&header, sizeof(header), 1, existing) != 1 || memcmp(header.magic, "KJRS", 4) != 0 ||
+		header.version != ResultsFormat::VERSION || header.columnCount != ResultsFormat::COLUMN_COUNT)
+	{
+		fclose(existing);
+		return false; // Not a store, or one from a different version of the game
+	}
+
+	long long end = sizeof(header);
+	ResultsBlockHeader blockHeader;
+	while (end + (long long)sizeof(blockHeader) <= size && SeekTo(existing, end) &&
+		fread(&blockHeader, sizeof(blockHeader), 1, existing) == 1 && IsResultsBlockWhole(blockHeader, uint64_t(size - end)))
+	{
+		rowCount += blockHeader.rowCount;
+		end += blockHeader.bytes;
+	}
+	fclose(existing);
+
+	if (end < size)
+	{
+		std::filesystem::resize_file(fileName, end, error); // A torn last block
+		if (error)
+			return false;
+	}
+
+	file = fopen(fileName, "ab");
+	if (file == NULL)
+		return false;
+
+	fileBytes = end;
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// The short last block, then the file
+void ResultsStoreType::Close()
+{
+	if (file == NULL)
+		return;
+
+	Flush();
+	fclose(file);
+	file = NULL;
+}
+
+// -----------------------------------------------------------------------------
+// Spread the result over the columns
+void ResultsStoreType::Append(const GameResult& result)
+{
+	if (file == NULL)
+		return;
+
+	columns[ResultsFormat::Seed][pending] = result.seed;
+	columns[ResultsFormat::ParamSet][pending] = result.paramSet;
+	columns[ResultsFormat::Ticks][pending] = result.ticks;
+	columns[ResultsFormat::Score][pending] = result.score;
+	columns[ResultsFormat::MaxItemCombo][pending] = result.maxItemCombo;
+	columns[ResultsFormat::DeathCause][pending] = result.deathCause;
+	for (int kind = 0; kind < OBSTACLE_KIND_COUNT; kind++)
+		columns[ResultsFormat::Rocks + kind][pending] = result.obstacles[kind];
+
+	pending++;
+	rowCount++;
+
+	if (pending == ResultsFormat::BLOCK_ROWS)
+		Flush();
+}
+
+// -----------------------------------------------------------------------------
+// Encode every column after the block header, then write the block in one go
+bool ResultsStoreType::Flush()
+{
+	if (file == NULL || pending == 0)
+		return true;
+
+	ALLOC_TAG(Diagnostics);
+
+	ResultsBlockHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "KJRB", 4);
+	header.rowCount = pending;
+
+	block.resize(sizeof(header));
+	for (int column = 0; column < ResultsFormat::COLUMN_COUNT; column++)
+		EncodeColumn(ResultsFormat::Column(column), header.columns[column]);
+
+	header.bytes = block.size();
+	memcpy(block.data(), &header, sizeof(header));
+
+	bool written = fwrite(block.data(), 1, block.size(), file) == block.size();
+	fflush(file);
+
+	fileBytes += block.size();
+	pending = 0;
+
+	return written;
+}
+
+// -----------------------------------------------------------------------------
+// Work out the statistics, then write the column the way its kind of values compress best
+void ResultsStoreType::EncodeColumn(ResultsFormat::Column column, ResultsColumnHeader& header)
+{
+	const int64_t* values = columns[column].data();
+
+	header.minimum = values[0];
+	header.maximum = values[0];
+	header.sum = 0;
+	for (int i = 0; i < pending; i++)
+	{
+		if (values[i] < header.minimum)
+			header.minimum = values[i];
+		if (values[i] > header.maximum)
+			header.maximum = values[i];
+		header.sum += values[i];
+	}
+
+	ResultsFormat::Encoding encoding = ResultsFormat::GetPreferredEncoding(column);
+
+	// The distinct values, if there are few enough of them for a dictionary
+	int64_t dictionary[ResultsFormat::MAX_DICTIONARY];
+	int dictionarySize = 0;
+	if (encoding == ResultsFormat::Dictionary)
+	{
+		for (int i = 0; i < pending && encoding == ResultsFormat::Dictionary; i++)
+		{
+			int entry = 0;
+			while (entry < dictionarySize && dictionary[entry] != values[i])
+				entry++;
+
+			if (entry < dictionarySize)
+				continue;
+			if (dictionarySize == ResultsFormat::MAX_DICTIONARY)
+			{
+				encoding = ResultsFormat::Offset; // Too many to be an enum
+				dictionarySize = 0;
+			}
+			else
+				dictionary[dictionarySize++] = values[i];
+		}
+	}
+
+	size_t start = block.size();
+	block.resize(start + size_t(pending) * 10 + ResultsFormat::MAX_DICTIONARY * 10); // Longest a varint can be
+	uint8_t* out = block.data() + start;
+	uint8_t* write = out;
+
+	switch (encoding)
+	{
+	case ResultsFormat::Delta:
+	{
+		int64_t previous = 0;
+		for (int i = 0; i < pending; i++)
+		{
+			write += ResultsFormat::PutVarint(write, ResultsFormat::Zigzag(values[i] - previous));
+			previous = values[i];
+		}
+		break;
+	}
+	case ResultsFormat::Offset:
+		for (int i = 0; i < pending; i++)
+			write += ResultsFormat::PutVarint(write, uint64_t(values[i] - header.minimum));
+		break;
+	case ResultsFormat::Dictionary:
+		for (int entry = 0; entry < dictionarySize; entry++)
+			write += ResultsFormat::PutVarint(write, ResultsFormat::Zigzag(dictionary[entry]));
+
+		for (int i = 0; i < pending; i++)
+		{
+			uint8_t entry = 0;
+			while (dictionary[entry] != values[i])
+				entry++;
+			*write++ = entry;
+		}
+		break;
+	}
+
+	header.encoding = uint8_t(encoding);
+	header.dictionarySize = uint8_t(dictionarySize);
+	header.reserved = 0;
+	header.bytes = uint32_t(write - out);
+
+	block.resize(start + header.bytes);
+}
@@ -0,0 +1,66 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Append-only columnar store of finished simulated games, in the layout in ResultsFormat.h.
+// Rows are kept column by column until there are BLOCK_ROWS of them, then each column is
+// encoded and the block is written to the end of the file with its statistics. Stores are
+// read back with the ResultsQuery tool.
+//
+// Opening a store that already exists adds to it. A block that was only partly written,
+// such as by a run that was killed, is cut off first.
+//----------------------------------------------------------------------------------------
+
+#include <cstdio>
+#include <vector>
+#include "ResultsFormat.h"
+#include "ObstacleTraits.h"
+
+// the summary of one finished game
+struct GameResult
+{
+	uint32_t seed;
+	int paramSet; // Which set of parameters the game was played with, up to whoever ran it
+	int ticks; // How long the game lasted
+	int score;
+	int maxItemCombo;
+	int deathCause; // Kind of the obstacle that took the last life, or ResultsFormat::StillAlive
+	int obstacles[OBSTACLE_KIND_COUNT]; // Obstacles of each kind on the screen at the end
+};
+
+class ResultsStoreType
+{
+	public:
+		// constructor
+		ResultsStoreType();
+		~ResultsStoreType();
+
+		// open a store to add to, making it if there isn't one. False if it can't be opened or isn't a store
+		bool Open(const char* fileName);
+
+		// write the rows waiting as a last short block and close the file
+		void Close();
+
+		bool IsOpen() const { return file != NULL; }
+
+		// add a game, which is written once its block fills
+		void Append(const GameResult& result);
+
+		// write the rows waiting as a block now, even if it isn't full
+		bool Flush();
+
+		// rows in the store, those waiting included, and bytes written to the file
+		long long GetRowCount() const { return rowCount; }
+		long long GetFileBytes() const { return fileBytes; }
+
+	private:
+		FILE* file;
+		long long rowCount;
+		long long fileBytes;
+
+		std::vector<int64_t> columns[ResultsFormat::COLUMN_COUNT]; // Rows waiting, BLOCK_ROWS of room in each
+		int pending;
+
+		std::vector<uint8_t> block; // Encoding space for a block, reused
+
+		// encode pending values of a column onto the end of block, and fill in its header
+		void EncodeColumn(ResultsFormat::Column column, ResultsColumnHeader& header);
+};
@@ -0,0 +1,252 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for the spawn script director
+//----------------------------------------------------------------------------------------
+
+#include "SpawnDirectorType.h"
+#include "AllocTrackerType.h"
+
+// -----------------------------------------------------------------------------
+// Coroutine frames count against Sprites, like the obstacles they spawn
+void* SpawnScriptType::promise_type::operator new(size_t size)
+{
+	ALLOC_TAG(Sprites);
+	return ::operator new(size);
+}
+
+// -----------------------------------------------------------------------------
+// Free a coroutine frame
+void SpawnScriptType::promise_type::operator delete(void* frame)
+{
+	::operator delete(frame);
+}
+
+// -----------------------------------------------------------------------------
+// No scripts until Run
+SpawnDirectorType::SpawnDirectorType()
+{
+	scriptCount = 0;
+	current = NONE;
+	timers = NULL;
+	wakeType = 0;
+	world = NULL;
+	area.vineX = NULL;
+	area.vineCount = 0;
+	area.lavaTop = 0;
+	obstacleLevel = 1;
+}
+
+// -----------------------------------------------------------------------------
+// Free any scripts still running
+SpawnDirectorType::~SpawnDirectorType()
+{
+	Clear();
+}
+
+// -----------------------------------------------------------------------------
+// Set what the director needs from the game
+void SpawnDirectorType::Initialize(TimerWheelType* inTimers, int inWakeType, EntityWorldType* inWorld)
+{
+	timers = inTimers;
+	wakeType = inWakeType;
+	world = inWorld;
+}
+
+// -----------------------------------------------------------------------------
+// Give the script a slot and run it to its first wait
+void SpawnDirectorType::Run(SpawnScriptType script)
+{
+	int slot;
+
+	if (!freeScripts.empty())
+	{
+		slot = freeScripts.back();
+		freeScripts.pop_back();
+	}
+	else
+	{
+		ALLOC_TAG(Sprites);
+
+		Script empty = {};
+		scripts.push_back(empty);
+		slot = int(scripts.size()) - 1;
+	}
+
+	Script& entry = scripts[slot];
+	entry.handle = script.Release();
+	entry.generation++;
+	entry.wake.index = entry.wake.generation = 0;
+	entry.condition = NULL;
+	scriptCount++;
+
+	Resume(slot);
+}
+
+// -----------------------------------------------------------------------------
+// Resume the script the timer belongs to, if it is still the same script
+void SpawnDirectorType::Wake(const TimerEvent& event)
+{
+	if (event.index >= scripts.size())
+		return;
+
+	Script& entry = scripts[event.index];
+	if (!entry.handle || entry.generation != event.generation)
+		return; // Cleared since it went to sleep
+
+	entry.wake.generation = 0;
+	Resume(int(event.index));
+}
+
+// -----------------------------------------------------------------------------
+// Find every condition that holds first, then resume them, so a script that waits again
+// on something that still holds isn't resumed twice in one tick
+void SpawnDirectorType::Update()
+{
+	ALLOC_TAG(Sprites);
+
+	ready.clear();
+
+	for (size_t i = 0; i < waiting.size(); )
+	{
+		Script& entry = scripts[waiting[i]];
+
+		if (entry.condition(*this, entry.conditionValue))
+		{
+			entry.condition = NULL;
+			ready.push_back(waiting[i]);
+			waiting[i] = waiting.back(); // Order doesn't matter, ready keeps the order they were found in
+			waiting.pop_back();
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	for (size_t i = 0; i < ready.size(); i++)
+		Resume(ready[i]);
+}
+
+// -----------------------------------------------------------------------------
+// Random obstacles first in the order emitted, so their rand() calls come in the same order
+// as before scripts, then the placed ones as one burst
+void SpawnDirectorType::Flush(const ObstaclePoolType& pool, float obstacleSpeed)
+{
+	ALLOC_TAG(Sprites);
+
+	spawned.clear();
+
+	for (size_t i = 0; i < randomKinds.size(); i++)
+		spawned.push_back(pool.Spawn(*world, randomKinds[i], area, obstacleSpeed));
+
+	if (!orders.empty())
+	{
+		size_t first = spawned.size();
+		spawned.resize(first + orders.size());
+		pool.SpawnBurst(*world, &orders[0], int(orders.size()), area, obstacleSpeed, &spawned[first]);
+	}
+
+	randomKinds.clear();
+	orders.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Destroy every coroutine and cancel its wake timer
+void SpawnDirectorType::Clear()
+{
+	for (size_t slot = 0; slot < scripts.size(); slot++)
+	{
+		Script& entry = scripts[slot];
+		if (!entry.handle)
+			continue;
+
+		if (timers != NULL)
+			timers->Cancel(entry.wake);
+
+		entry.handle.destroy();
+		entry.handle = NULL;
+		entry.condition = NULL;
+		entry.generation++; // Any wake event already out for it is ignored
+		freeScripts.push_back(int(slot));
+	}
+
+	scriptCount = 0;
+	waiting.clear();
+	ready.clear();
+	orders.clear();
+	randomKinds.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Queue an obstacle for the next burst
+void SpawnDirectorType::Emit(EntityKind::Kind kind, int side, float across)
+{
+	ALLOC_TAG(Sprites);
+
+	SpawnOrder order = { kind, side, across };
+	orders.push_back(order);
+}
+
+// -----------------------------------------------------------------------------
+// Queue an obstacle the pool places at random
+void SpawnDirectorType::EmitRandom(EntityKind::Kind kind)
+{
+	ALLOC_TAG(Sprites);
+
+	randomKinds.push_back(kind);
+}
+
+// -----------------------------------------------------------------------------
+// Count the obstacles of every kind
+int SpawnDirectorType::GetObstacleCount() const
+{
+	int count = 0;
+	for (int kind = 0; kind < OBSTACLE_KIND_COUNT; kind++)
+		count += world->GetCount(EntityKind::Kind(kind));
+
+	return count;
+}
+
+// -----------------------------------------------------------------------------
+// Start the running script's wake timer, it gets the script's slot and generation back
+void SpawnDirectorType::Sleep(float seconds)
+{
+	Script& entry = scripts[current];
+	entry.wake = timers->Start(seconds, wakeType, uint32_t(current), entry.generation);
+}
+
+// -----------------------------------------------------------------------------
+// Put the running script on the list Update checks
+void SpawnDirectorType::WaitOn(Condition condition, int value)
+{
+	ALLOC_TAG(Sprites);
+
+	Script& entry = scripts[current];
+	entry.condition = condition;
+	entry.conditionValue = value;
+	waiting.push_back(current);
+}
+
+// -----------------------------------------------------------------------------
+// Run the script to its next wait. A script can Run another, so the one that was running is put back after
+void SpawnDirectorType::Resume(int slot)
+{
+	int previous = current;
+	current = slot;
+
+	std::coroutine_handle<> handle = scripts[slot].handle;
+	handle.resume();
+
+	current = previous;
+
+	if (handle.done())
+	{
+		Script& entry = scripts[slot];
+		entry.handle.destroy();
+		entry.handle = NULL;
+		entry.generation++;
+		scriptCount--;
+
+		ALLOC_TAG(Sprites);
+		freeScripts.push_back(slot);
+	}
+}
@@ -0,0 +1,126 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Runs the spawn scripts. A script waiting a number of seconds has a timer in the game's
+// timer wheel and costs nothing until the timer fires, when the game hands the event to
+// Wake. Only scripts waiting on a condition are looked at each tick, by Update.
+//
+// Scripts don't create entities themselves. What they emit while they run is queued, and
+// Flush spawns the queue after the tick's scripts have run. The obstacles placed with Emit
+// go in as one burst, so each kind's archetype grows once however many a script emits.
+//----------------------------------------------------------------------------------------
+
+#include <vector>
+#include "SpawnScriptType.h"
+#include "TimerWheelType.h"
+#include "ObstaclePoolType.h"
+
+class SpawnDirectorType
+{
+	public:
+		// a condition a script can wait on, value is whatever the script passed with it
+		typedef bool (*Condition)(const SpawnDirectorType& director, int value);
+
+		// co_await one of these to sleep for a while
+		struct WaitAwaiter
+		{
+			SpawnDirectorType* director;
+			float seconds;
+
+			bool await_ready() const noexcept { return false; }
+			void await_suspend(std::coroutine_handle<>) { director->Sleep(seconds); }
+			void await_resume() const noexcept {}
+		};
+
+		// co_await one of these to sleep until the condition holds, checked once a tick
+		struct ConditionAwaiter
+		{
+			SpawnDirectorType* director;
+			Condition condition;
+			int value;
+
+			bool await_ready() const { return condition(*director, value); }
+			void await_suspend(std::coroutine_handle<>) { director->WaitOn(condition, value); }
+			void await_resume() const noexcept {}
+		};
+
+		// constructor and destructor
+		SpawnDirectorType();
+		~SpawnDirectorType();
+
+		// set the wheel that wakes sleeping scripts, the timer type its wake events have and the world to spawn into
+		void Initialize(TimerWheelType* inTimers, int inWakeType, EntityWorldType* inWorld);
+
+		// set where obstacles spawn, scripts read the vines and lava from it
+		void SetArea(const SpawnArea& inArea) { area = inArea; }
+
+		// start a script, it runs up to its first wait before this returns
+		void Run(SpawnScriptType script);
+
+		// resume the script a wake timer was started for
+		void Wake(const TimerEvent& event);
+
+		// resume the scripts whose condition now holds
+		void Update();
+
+		// spawn everything emitted since the last Flush. The entities are kept until the next Flush
+		void Flush(const ObstaclePoolType& pool, float obstacleSpeed);
+		const std::vector<Entity>& GetSpawned() const { return spawned; }
+
+		// stop and free every script and drop anything emitted
+		void Clear();
+
+		// awaitables for scripts
+		WaitAwaiter Wait(float seconds) { WaitAwaiter awaiter = { this, seconds }; return awaiter; }
+		ConditionAwaiter WaitUntil(Condition condition, int value = 0) { ConditionAwaiter awaiter = { this, condition, value }; return awaiter; }
+
+		// queue an obstacle at an exact place, see SpawnOrder, or one placed at random the way ObstaclePoolType::Spawn does
+		void Emit(EntityKind::Kind kind, int side, float across);
+		void EmitRandom(EntityKind::Kind kind);
+
+		// what scripts can read
+		void SetObstacleLevel(int level) { obstacleLevel = level; }
+		int GetObstacleLevel() const { return obstacleLevel; }
+		int GetObstacleCount() const;
+		int GetVineCount() const { return area.vineCount; }
+		int GetVineX(int vine) const { return area.vineX[vine]; }
+		int GetLavaTop() const { return area.lavaTop; }
+		int GetScriptCount() const { return scriptCount; }
+
+	private:
+		static const int NONE = -1;
+
+		// a running script
+		struct Script
+		{
+			std::coroutine_handle<> handle; // NULL for a free slot
+			uint32_t generation; // Goes in the wake timer, so a wake for a script that was cleared is ignored
+			TimerHandle wake;
+			Condition condition; // NULL unless it is waiting on one
+			int conditionValue;
+		};
+
+		std::vector<Script> scripts;
+		std::vector<int> freeScripts;
+		int scriptCount;
+		int current; // Slot of the script being resumed, NONE between resumes
+
+		std::vector<int> waiting; // Slots of the scripts waiting on a condition
+		std::vector<int> ready; // Conditions that held this Update, resumed once they are all found
+
+		std::vector<SpawnOrder> orders;
+		std::vector<EntityKind::Kind> randomKinds;
+		std::vector<Entity> spawned;
+
+		TimerWheelType* timers;
+		int wakeType;
+		EntityWorldType* world; // Where scripts spawn, and what they count
+		SpawnArea area;
+		int obstacleLevel;
+
+		// called by the awaiters from inside the running script
+		void Sleep(float seconds);
+		void WaitOn(Condition condition, int value);
+
+		// resume a script, and free it once it has finished
+		void Resume(int slot);
+};
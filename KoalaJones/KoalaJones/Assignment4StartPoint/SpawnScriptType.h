@@ -0,0 +1,57 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// A spawn script is a C++20 coroutine that places obstacles. It is written as plain
+// sequential code: emit some obstacles, co_await a wait or a condition, emit some more.
+// The script doesn't run when it is created. SpawnDirectorType takes it with Run, resumes
+// it straight away and then again whenever what it is waiting on comes round.
+//
+//   SpawnScriptType Columns(SpawnDirectorType& director)
+//   {
+//       for (int row = 0; row < 4; row++)
+//       {
+//           director.Emit(EntityKind::Rock, 0, float(director.GetVineX(row)));
+//           co_await director.Wait(0.5f);
+//       }
+//   }
+//
+// Parameters are copied into the coroutine frame, so anything passed by reference, such
+// as the director, must outlive the script.
+//----------------------------------------------------------------------------------------
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+
+class SpawnScriptType
+{
+	public:
+		// what the compiler needs to build the coroutine, the frame comes from the tracked heap under Sprites
+		struct promise_type
+		{
+			SpawnScriptType get_return_object() { return SpawnScriptType(std::coroutine_handle<promise_type>::from_promise(*this)); }
+			std::suspend_always initial_suspend() noexcept { return std::suspend_always(); } // Waits for the director to start it
+			std::suspend_always final_suspend() noexcept { return std::suspend_always(); } // Kept so the director sees it is done and frees it
+			void return_void() {}
+			void unhandled_exception() { std::terminate(); }
+
+			static void* operator new(size_t size);
+			static void operator delete(void* frame);
+		};
+
+		// constructors and destructor, a script owns its coroutine until Release hands it on
+		SpawnScriptType() : handle(NULL) {}
+		SpawnScriptType(SpawnScriptType&& other) noexcept : handle(other.handle) { other.handle = NULL; }
+		~SpawnScriptType() { if (handle) handle.destroy(); }
+
+		// take the coroutine, the script no longer destroys it
+		std::coroutine_handle<> Release() { std::coroutine_handle<> released = handle; handle = NULL; return released; }
+
+	private:
+		std::coroutine_handle<promise_type> handle;
+
+		explicit SpawnScriptType(std::coroutine_handle<promise_type> inHandle) : handle(inHandle) {}
+
+		// scripts can be moved but not copied
+		SpawnScriptType(const SpawnScriptType&);
+		SpawnScriptType& operator=(const SpawnScriptType&);
+};
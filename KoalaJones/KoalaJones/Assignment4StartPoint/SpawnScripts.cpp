@@ -0,0 +1,94 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for the spawn scripts
+//----------------------------------------------------------------------------------------
+
+#include "SpawnScripts.h"
+
+#include <cstdlib>
+
+static const int WAVE_MAX_OBSTACLES = 6; // A wave waits until there are fewer obstacles than this
+
+// is the screen quiet enough for a wave
+static bool FewerObstaclesThan(const SpawnDirectorType& director, int count)
+{
+	return director.GetObstacleCount() < count;
+}
+
+// -----------------------------------------------------------------------------
+// Pick the kind and the next wait before spawning, the same rand() calls in the same order as the old countdown
+SpawnScriptType RandomSpawns(SpawnDirectorType& director, float firstWait, int maxWait)
+{
+	co_await director.Wait(firstWait);
+
+	for (;;)
+	{
+		int toSpawn = rand() % director.GetObstacleLevel(); // Choose a random obstacle to spawn in
+		float wait = rand() % maxWait + 0.5f;
+
+		if (toSpawn < OBSTACLE_KIND_COUNT)
+			director.EmitRandom(EntityKind::Kind(toSpawn));
+
+		co_await director.Wait(wait);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Each row is one burst, on the even vines then the odd ones
+SpawnScriptType StaggeredRockColumns(SpawnDirectorType& director, int rows, float rowGap)
+{
+	co_await director.WaitUntil(FewerObstaclesThan, WAVE_MAX_OBSTACLES);
+
+	for (int row = 0; row < rows; row++)
+	{
+		for (int vine = row % 2; vine < director.GetVineCount(); vine += 2)
+			director.Emit(EntityKind::Rock, 0, float(director.GetVineX(vine)));
+
+		co_await director.Wait(rowGap);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Step down the screen from just under the top, switching side each dart
+SpawnScriptType AlternatingDarts(SpawnDirectorType& director, int count, float gap)
+{
+	co_await director.WaitUntil(FewerObstaclesThan, WAVE_MAX_OBSTACLES);
+
+	float top = 60;
+	float step = (director.GetLavaTop() - 40 - top) / (count > 1 ? count - 1 : 1);
+
+	for (int i = 0; i < count; i++)
+	{
+		director.Emit(EntityKind::Dart, i % 2, top + step * i);
+		co_await director.Wait(gap);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Both ends of a vine at once, so the pair meet in the middle
+SpawnScriptType SnakeSweep(SpawnDirectorType& director, float gap)
+{
+	co_await director.WaitUntil(FewerObstaclesThan, WAVE_MAX_OBSTACLES);
+
+	for (int vine = 0; vine < director.GetVineCount(); vine++)
+	{
+		float x = float(director.GetVineX(vine));
+		director.Emit(EntityKind::Snake, 0, x);
+		director.Emit(EntityKind::Snake, 1, x);
+
+		co_await director.Wait(gap);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Work through the waves in turn, harder ones once the level allows their kind
+SpawnScriptType StartWave(SpawnDirectorType& director, int wave)
+{
+	int level = director.GetObstacleLevel();
+
+	if (wave % 3 == 2 && level > EntityKind::Snake)
+		return SnakeSweep(director, 0.8f);
+	if (wave % 3 == 1 && level > EntityKind::Dart)
+		return AlternatingDarts(director, 6, 0.5f);
+
+	return StaggeredRockColumns(director, 4, 0.7f);
+}
@@ -0,0 +1,23 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// The game's spawn scripts. RandomSpawns is the steady trickle of obstacles the game has
+// always had. The waves are set pieces started on level changes, each waits for the
+// screen to thin out before it starts so waves don't pile up on top of each other.
+//----------------------------------------------------------------------------------------
+
+#include "SpawnDirectorType.h"
+
+// one random obstacle from the kinds the level allows, then a random wait of up to maxWait seconds, forever
+SpawnScriptType RandomSpawns(SpawnDirectorType& director, float firstWait, int maxWait);
+
+// rows of rocks down every other vine, each row on the vines the last one missed
+SpawnScriptType StaggeredRockColumns(SpawnDirectorType& director, int rows, float rowGap);
+
+// darts from the left and right in turn, each lower down than the last
+SpawnScriptType AlternatingDarts(SpawnDirectorType& director, int count, float gap);
+
+// a snake from the top and one from the bottom on each vine in turn, working across the screen
+SpawnScriptType SnakeSweep(SpawnDirectorType& director, float gap);
+
+// pick the wave for a level change
+SpawnScriptType StartWave(SpawnDirectorType& director, int wave);
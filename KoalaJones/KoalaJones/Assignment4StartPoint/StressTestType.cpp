@@ -0,0 +1,378 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for the stress test driver
+//----------------------------------------------------------------------------------------
+
+#include "StressTestType.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+static const double FRAME_BUDGET_MS = 1000.0 / 60.0;
+static const double KNEE_GROWTH = 1.5; // Cost per obstacle growing by more than this between counts is a knee
+static const double KNEE_MIN_MS = 0.05; // Below this the timings are mostly noise
+
+// case-insensitive string compare, for the scenario file
+static bool SameName(const char* a, const char* b)
+{
+	while (*a && *b && tolower((unsigned char)*a) == tolower((unsigned char)*b))
+	{
+		a++;
+		b++;
+	}
+	return *a == 0 && *b == 0;
+}
+
+// -----------------------------------------------------------------------------
+// Pick a kind with a chance proportional to its spawn rate
+EntityKind::Kind StressScenario::PickKind(float r) const
+{
+	float total = 0;
+	for (int kind = 0; kind < OBSTACLE_KIND_COUNT; kind++)
+		total += spawnRates[kind];
+
+	float pick = r * total;
+	for (int kind = 0; kind < OBSTACLE_KIND_COUNT; kind++)
+	{
+		if (pick < spawnRates[kind])
+			return EntityKind::Kind(kind);
+		pick -= spawnRates[kind];
+	}
+
+	return EntityKind::Rock; // Only if every rate is 0
+}
+
+// -----------------------------------------------------------------------------
+// Initialize member variables
+StressTestType::StressTestType()
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	msPerTick = 1000.0 / double(frequency.QuadPart);
+
+	SetDefaults(scenario);
+	running = false;
+	step = 0;
+	frame = 0;
+	framesPerStep = 0;
+	memset(&current, 0, sizeof(current));
+}
+
+// -----------------------------------------------------------------------------
+// Every kind equally often, ramping from 10 to a million obstacles
+void StressTestType::SetDefaults(StressScenario& scenario)
+{
+	strcpy(scenario.name, "default");
+	scenario.seed = 1;
+	scenario.obstacleSpeed = 3;
+	scenario.secondsPerStep = 2;
+	scenario.koalaPolicy = StressScenario::Wander;
+
+	for (int kind = 0; kind < OBSTACLE_KIND_COUNT; kind++)
+		scenario.spawnRates[kind] = 1;
+
+	scenario.stepCount = 0;
+	for (int count = 10; count <= 1000000; count *= 10)
+		scenario.counts[scenario.stepCount++] = count;
+}
+
+// -----------------------------------------------------------------------------
+// Read "key value" lines, anything not in the file keeps its current value
+bool StressTestType::LoadScenario(const char* fileName, StressScenario& scenario)
+{
+	FILE* file = fopen(fileName, "r");
+	if (!file)
+		return false;
+
+	char line[256];
+	while (fgets(line, sizeof(line), file))
+	{
+		char* comment = strchr(line, '#');
+		if (comment)
+			*comment = 0;
+
+		char key[32];
+		int used = 0;
+		if (sscanf(line, "%31s%n", key, &used) != 1)
+			continue; // Blank line
+		const char* values = line + used;
+
+		if (SameName(key, "name"))
+		{
+			sscanf(values, "%63s", scenario.name);
+		}
+		else if (SameName(key, "seed"))
+		{
+			sscanf(values, "%u", &scenario.seed);
+		}
+		else if (SameName(key, "speed"))
+		{
+			sscanf(values, "%f", &scenario.obstacleSpeed);
+		}
+		else if (SameName(key, "seconds"))
+		{
+			sscanf(values, "%f", &scenario.secondsPerStep);
+		}
+		else if (SameName(key, "koala"))
+		{
+			char policy[32];
+			if (sscanf(values, "%31s", policy) == 1)
+				scenario.koalaPolicy = SameName(policy, "stay") ? StressScenario::Stay : StressScenario::Wander;
+		}
+		else if (SameName(key, "rate"))
+		{
+			char kindName[32];
+			float rate;
+			if (sscanf(values, "%31s %f", kindName, &rate) == 2)
+			{
+				for (int kind = 0; kind < OBSTACLE_KIND_COUNT; kind++)
+				{
+					if (SameName(kindName, EntityKind::GetName(EntityKind::Kind(kind))))
+						scenario.spawnRates[kind] = rate > 0 ? rate : 0;
+				}
+			}
+		}
+		else if (SameName(key, "counts"))
+		{
+			scenario.stepCount = 0;
+
+			int count;
+			while (scenario.stepCount < StressScenario::MAX_STEPS && sscanf(values, "%d%n", &count, &used) == 1)
+			{
+				if (count > 0)
+					scenario.counts[scenario.stepCount++] = count;
+				values += used;
+			}
+		}
+	}
+
+	fclose(file);
+
+	if (scenario.obstacleSpeed < 1)
+		scenario.obstacleSpeed = 1; // Spawning takes rand() % int(obstacleSpeed)
+	if (scenario.stepCount == 0)
+		scenario.counts[scenario.stepCount++] = 10;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Start at the first count with no results
+void StressTestType::Start(const StressScenario& inScenario)
+{
+	scenario = inScenario;
+	running = scenario.stepCount > 0;
+	step = 0;
+	frame = 0;
+
+	framesPerStep = int(scenario.secondsPerStep * TICKS_PER_SECOND);
+	if (framesPerStep < 1)
+		framesPerStep = 1;
+
+	simSamples.clear();
+	simSamples.reserve(framesPerStep);
+	renderSamples.clear();
+	renderSamples.reserve(framesPerStep);
+	results.clear();
+
+	memset(&current, 0, sizeof(current));
+}
+
+// -----------------------------------------------------------------------------
+// Move to the next count once this one has had all its frames
+bool StressTestType::BeginFrame()
+{
+	if (!running)
+		return false;
+
+	if (frame < framesPerStep)
+		return true;
+
+	FinishStep();
+
+	step++;
+	frame = 0;
+
+	if (step >= scenario.stepCount)
+	{
+		running = false;
+
+		char csvFileName[96], summaryFileName[96];
+		snprintf(csvFileName, sizeof(csvFileName), "koala_scaling_%s.csv", scenario.name);
+		snprintf(summaryFileName, sizeof(summaryFileName), "koala_scaling_%s.txt", scenario.name);
+		WriteReport(csvFileName, summaryFileName);
+		return false;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Add a frame to the current count
+void StressTestType::AddSimTime(__int64 ticks, int obstacleCount, size_t memoryBytes, int hits)
+{
+	if (!running)
+		return;
+
+	if (frame == 0)
+	{
+		memset(&current, 0, sizeof(current));
+		current.targetCount = GetTargetCount();
+		current.minCount = obstacleCount;
+		simSamples.clear();
+		renderSamples.clear();
+	}
+
+	simSamples.push_back(float(double(ticks) * msPerTick));
+
+	if (obstacleCount < current.minCount)
+		current.minCount = obstacleCount;
+	if (obstacleCount > current.maxCount)
+		current.maxCount = obstacleCount;
+	if (memoryBytes > current.peakMemoryBytes)
+		current.peakMemoryBytes = memoryBytes;
+	current.hits += hits;
+
+	frame++;
+}
+
+// -----------------------------------------------------------------------------
+// Add this frame's draw time, Render runs after Update so it goes with the last sim frame
+void StressTestType::AddRenderTime(__int64 ticks)
+{
+	if (running && int(renderSamples.size()) < frame)
+		renderSamples.push_back(float(double(ticks) * msPerTick));
+}
+
+// -----------------------------------------------------------------------------
+// Work out the statistics for the count that just finished
+void StressTestType::FinishStep()
+{
+	current.frames = int(simSamples.size());
+
+	double simTotal = 0, renderTotal = 0;
+	for (size_t i = 0; i < simSamples.size(); i++)
+	{
+		simTotal += simSamples[i];
+		if (simSamples[i] > current.simMaxMs)
+			current.simMaxMs = simSamples[i];
+	}
+	for (size_t i = 0; i < renderSamples.size(); i++)
+	{
+		renderTotal += renderSamples[i];
+		if (renderSamples[i] > current.renderMaxMs)
+			current.renderMaxMs = renderSamples[i];
+	}
+
+	current.simMeanMs = simSamples.empty() ? 0 : simTotal / simSamples.size();
+	current.renderMeanMs = renderSamples.empty() ? 0 : renderTotal / renderSamples.size();
+	current.simP95Ms = Percentile95(simSamples);
+	current.renderP95Ms = Percentile95(renderSamples);
+
+	results.push_back(current);
+}
+
+// -----------------------------------------------------------------------------
+// Partially sort the samples to find the 95th percentile
+double StressTestType::Percentile95(std::vector<float>& samples)
+{
+	if (samples.empty())
+		return 0;
+
+	size_t index = (samples.size() * 95) / 100;
+	if (index >= samples.size())
+		index = samples.size() - 1;
+
+	std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+	return samples[index];
+}
+
+// -----------------------------------------------------------------------------
+// Write one CSV row per count, then a summary that points out where things fall over
+bool StressTestType::WriteReport(const char* csvFileName, const char* summaryFileName) const
+{
+	FILE* csv = fopen(csvFileName, "w");
+	if (csv)
+	{
+		fprintf(csv, "obstacles,frames,min_alive,max_alive,sim_mean_ms,sim_p95_ms,sim_max_ms,sim_ns_per_obstacle,"
+			"render_mean_ms,render_p95_ms,render_max_ms,render_ns_per_obstacle,memory_bytes,bytes_per_obstacle,hits\n");
+
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			const StepResult& r = results[i];
+			fprintf(csv, "%d,%d,%d,%d,%.4f,%.4f,%.4f,%.2f,%.4f,%.4f,%.4f,%.2f,%llu,%.1f,%d\n",
+				r.targetCount, r.frames, r.minCount, r.maxCount,
+				r.simMeanMs, r.simP95Ms, r.simMaxMs, r.simMeanMs * 1e6 / r.targetCount,
+				r.renderMeanMs, r.renderP95Ms, r.renderMaxMs, r.renderMeanMs * 1e6 / r.targetCount,
+				(unsigned long long)r.peakMemoryBytes, double(r.peakMemoryBytes) / r.targetCount, r.hits);
+		}
+
+		fclose(csv);
+	}
+
+	FILE* file = fopen(summaryFileName, "w");
+	char line[200];
+
+	snprintf(line, sizeof(line), "Stress scenario '%s': seed %u, speed %.1f, %.1f s per count, koala %s\n", scenario.name, scenario.seed,
+		scenario.obstacleSpeed, scenario.secondsPerStep, scenario.koalaPolicy == StressScenario::Stay ? "stays" : "wanders");
+	OutputDebugStringA(line);
+	if (file)
+		fputs(line, file);
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const StepResult& r = results[i];
+		snprintf(line, sizeof(line), "  %8d obstacles: sim %8.3f ms (p95 %8.3f)  render %8.3f ms (p95 %8.3f)  %10llu bytes\n",
+			r.targetCount, r.simMeanMs, r.simP95Ms, r.renderMeanMs, r.renderP95Ms, (unsigned long long)r.peakMemoryBytes);
+		OutputDebugStringA(line);
+		if (file)
+			fputs(line, file);
+	}
+
+	// Knees, where the cost of each obstacle grows faster than the count does
+	for (size_t i = 1; i < results.size(); i++)
+	{
+		const StepResult& before = results[i - 1];
+		const StepResult& after = results[i];
+
+		struct { const char* name; double beforeMs, afterMs; } costs[2] =
+		{
+			{ "sim", before.simMeanMs, after.simMeanMs },
+			{ "render", before.renderMeanMs, after.renderMeanMs },
+		};
+
+		for (int c = 0; c < 2; c++)
+		{
+			if (costs[c].beforeMs < KNEE_MIN_MS || costs[c].afterMs < KNEE_MIN_MS)
+				continue;
+
+			double growth = (costs[c].afterMs / after.targetCount) / (costs[c].beforeMs / before.targetCount);
+			if (growth > KNEE_GROWTH)
+			{
+				snprintf(line, sizeof(line), "  knee: %s cost per obstacle grows %.1fx from %d to %d obstacles\n",
+					costs[c].name, growth, before.targetCount, after.targetCount);
+				OutputDebugStringA(line);
+				if (file)
+					fputs(line, file);
+			}
+		}
+	}
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		if (results[i].simP95Ms + results[i].renderP95Ms > FRAME_BUDGET_MS)
+		{
+			snprintf(line, sizeof(line), "  sim and render first go over the %.1f ms frame budget at %d obstacles\n", FRAME_BUDGET_MS, results[i].targetCount);
+			OutputDebugStringA(line);
+			if (file)
+				fputs(line, file);
+			break;
+		}
+	}
+
+	if (file)
+		fclose(file);
+
+	return csv != NULL && file != NULL;
+}
@@ -0,0 +1,122 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Stress test driver. Runs a scenario that ramps the number of obstacles up through a list
+// of counts (10 up to 1,000,000 by default), holding each count for a few seconds of sim
+// time. Each frame it records the sim time, the time spent submitting sprites to the
+// sprite batch and the memory held by the entity world. Once the last count is done it
+// writes a scaling report: a CSV of the curve and a text summary of the knee points, where
+// the cost per obstacle jumps or the frame budget is first blown.
+//
+// Scenarios are text files of "key value" lines, # starts a comment:
+//
+//   name       default
+//   seed       1
+//   speed      3                       obstacleSpeed for every spawn
+//   seconds    2                       sim time held at each count
+//   koala      wander                  stay, or wander to a random vine about every half second
+//   rate       rock 1                  relative spawn rate of a kind, sets the mix of kinds
+//   counts     10 100 1000 10000 100000 1000000
+//----------------------------------------------------------------------------------------
+
+#include <windows.h>
+#include <vector>
+#include "ComponentTypes.h"
+#include "ObstacleTraits.h"
+
+// one stress run
+struct StressScenario
+{
+	enum KoalaPolicy { Stay, Wander };
+
+	static const int MAX_STEPS = 16;
+
+	char name[64];
+	unsigned int seed; // srand seed, each step reseeds with seed + step so steps can be rerun on their own
+	float obstacleSpeed;
+	float secondsPerStep; // Sim time held at each count, at 60 ticks a second
+	KoalaPolicy koalaPolicy;
+	float spawnRates[OBSTACLE_KIND_COUNT];
+	int counts[MAX_STEPS]; // Obstacle counts to ramp through
+	int stepCount;
+
+	// pick a kind from the spawn rates, r is in [0, 1)
+	EntityKind::Kind PickKind(float r) const;
+};
+
+class StressTestType
+{
+	public:
+		static const int TICKS_PER_SECOND = 60; // The stress test always steps the sim at a fixed rate
+
+		// constructor
+		StressTestType();
+
+		// fill in the default scenario
+		static void SetDefaults(StressScenario& scenario);
+
+		// read a scenario file over the defaults, returns false if the file couldn't be opened
+		static bool LoadScenario(const char* fileName, StressScenario& scenario);
+
+		// start a run from the first count
+		void Start(const StressScenario& inScenario);
+
+		// stop the run early, nothing is written
+		void Stop() { running = false; }
+
+		bool IsRunning() const { return running; }
+		const StressScenario& GetScenario() const { return scenario; }
+
+		// called before each sim tick. Moves to the next count once this one has had its
+		// frames, and writes the report after the last. Returns false once the run is over
+		bool BeginFrame();
+
+		// is this the first frame of a count, the caller refills the world when it is
+		bool IsStepStarting() const { return frame == 0; }
+
+		int GetStep() const { return step; }
+		int GetTargetCount() const { return scenario.counts[step]; }
+
+		// record this frame's sim time, obstacle count, world memory and hits on the koala
+		void AddSimTime(__int64 ticks, int obstacleCount, size_t memoryBytes, int hits);
+
+		// record the time spent drawing this frame's obstacles
+		void AddRenderTime(__int64 ticks);
+
+		// write the curve as CSV and the knee points as text, returns false if either file couldn't be written
+		bool WriteReport(const char* csvFileName, const char* summaryFileName) const;
+
+		// read the high resolution counter
+		static __int64 GetTicks() { LARGE_INTEGER t; QueryPerformanceCounter(&t); return t.QuadPart; }
+
+	private:
+		// what one count measured
+		struct StepResult
+		{
+			int targetCount;
+			int frames;
+			int minCount, maxCount; // Obstacles alive, dips below the target while despawned ones are refilled
+			double simMeanMs, simP95Ms, simMaxMs;
+			double renderMeanMs, renderP95Ms, renderMaxMs;
+			size_t peakMemoryBytes;
+			int hits;
+		};
+
+		StressScenario scenario;
+		bool running;
+		int step; // Index into scenario.counts
+		int frame; // Frames run at this count
+		int framesPerStep;
+
+		std::vector<float> simSamples; // This count's per-frame times in milliseconds
+		std::vector<float> renderSamples;
+		StepResult current;
+		std::vector<StepResult> results;
+
+		double msPerTick; // Converts counter ticks to milliseconds
+
+		// work out the means and percentiles of the finished count and store it
+		void FinishStep();
+
+		// get the value 95% of the samples are at or under
+		static double Percentile95(std::vector<float>& samples);
+};
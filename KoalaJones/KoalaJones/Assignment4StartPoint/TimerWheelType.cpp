@@ -0,0 +1,291 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for the hierarchical timer wheel
+//----------------------------------------------------------------------------------------
+
+#include "TimerWheelType.h"
+#include "AllocTrackerType.h"
+
+#include <cmath>
+
+// -----------------------------------------------------------------------------
+// Start with every slot empty at tick 0
+TimerWheelType::TimerWheelType()
+{
+	freeList = NONE;
+	pendingCount = 0;
+
+	for (int i = 0; i < LEVELS * SLOTS; i++)
+		heads[i] = tails[i] = NONE;
+
+	now = 0;
+	leftover = 0;
+	nextExpired = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Round up, so a timer never fires before its time, and never in the tick it was started.
+// A float of whole milliseconds such as 5.822 can come out a hair over, which isn't rounded up
+uint32_t TimerWheelType::ToTicks(float seconds)
+{
+	double ticks = ceil(double(seconds) * TICKS_PER_SECOND - 1e-3);
+
+	if (ticks < 1)
+		return 1;
+	if (ticks > 4e9)
+		return 4000000000u;
+	return uint32_t(ticks);
+}
+
+// -----------------------------------------------------------------------------
+// Start a one shot timer
+TimerHandle TimerWheelType::Start(float seconds, int type, uint32_t index, uint32_t generation)
+{
+	return Add(ToTicks(seconds), 0, type, index, generation);
+}
+
+// -----------------------------------------------------------------------------
+// Start a repeating timer
+TimerHandle TimerWheelType::StartRepeating(float seconds, float period, int type, uint32_t index, uint32_t generation)
+{
+	return Add(ToTicks(seconds), ToTicks(period), type, index, generation);
+}
+
+// -----------------------------------------------------------------------------
+// Take a node from the free list, or grow the pool, and put it in the wheel
+TimerHandle TimerWheelType::Add(uint32_t delay, uint32_t period, int type, uint32_t index, uint32_t generation)
+{
+	int timer = freeList;
+
+	if (timer != NONE)
+	{
+		freeList = timers[timer].next;
+	}
+	else
+	{
+		ALLOC_TAG(General);
+
+		Timer node = {};
+		timers.push_back(node);
+		timer = int(timers.size()) - 1;
+	}
+
+	Timer& node = timers[timer];
+	node.generation++;
+	if (node.generation == 0)
+		node.generation = 1; // 0 is kept for handles that were never started
+
+	node.expiry = now + delay;
+	node.period = period;
+	node.type = type;
+	node.index = index;
+	node.dataGeneration = generation;
+
+	Insert(timer);
+	pendingCount++;
+
+	TimerHandle handle = { uint32_t(timer), node.generation };
+	return handle;
+}
+
+// -----------------------------------------------------------------------------
+// Link the timer into the lowest level whose slots reach its expiry
+void TimerWheelType::Insert(int timer)
+{
+	Timer& node = timers[timer];
+	uint64_t delay = node.expiry > now ? node.expiry - now : 0;
+
+	int level = 0;
+	while (level < LEVELS - 1 && delay >= (uint64_t(1) << (SLOT_BITS * (level + 1))))
+		level++;
+
+	uint64_t expiry = node.expiry;
+	if (level == LEVELS - 1 && delay >= (uint64_t(1) << (SLOT_BITS * LEVELS)))
+		expiry = now + (uint64_t(1) << (SLOT_BITS * LEVELS)) - 1; // Too far off, park it in the furthest slot and insert it again when it cascades
+
+	int slot = level * SLOTS + int((expiry >> (SLOT_BITS * level)) & (SLOTS - 1));
+
+	node.slot = slot;
+	node.next = NONE;
+	node.prev = tails[slot];
+
+	if (tails[slot] != NONE)
+		timers[tails[slot]].next = timer;
+	else
+		heads[slot] = timer;
+	tails[slot] = timer;
+}
+
+// -----------------------------------------------------------------------------
+// Take the timer out of its slot's list
+void TimerWheelType::Unlink(int timer)
+{
+	Timer& node = timers[timer];
+
+	if (node.prev != NONE)
+		timers[node.prev].next = node.next;
+	else
+		heads[node.slot] = node.next;
+
+	if (node.next != NONE)
+		timers[node.next].prev = node.prev;
+	else
+		tails[node.slot] = node.prev;
+
+	node.slot = NONE;
+}
+
+// -----------------------------------------------------------------------------
+// Bump the generation so handles to it go stale, and reuse the node
+void TimerWheelType::Free(int timer)
+{
+	Timer& node = timers[timer];
+
+	node.generation++;
+	node.slot = NONE;
+	node.next = freeList;
+	freeList = timer;
+
+	pendingCount--;
+}
+
+// -----------------------------------------------------------------------------
+// Cancel a pending timer and clear the handle
+void TimerWheelType::Cancel(TimerHandle& handle)
+{
+	if (IsPending(handle))
+	{
+		Unlink(int(handle.index));
+		Free(int(handle.index));
+	}
+
+	handle.generation = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Check the handle still matches a timer in the wheel
+bool TimerWheelType::IsPending(TimerHandle handle) const
+{
+	return handle.generation != 0 && handle.index < timers.size() && timers[handle.index].generation == handle.generation && timers[handle.index].slot != NONE;
+}
+
+// -----------------------------------------------------------------------------
+// Work out the seconds left from the timer's expiry
+float TimerWheelType::GetTimeLeft(TimerHandle handle) const
+{
+	if (!IsPending(handle))
+		return 0;
+
+	uint64_t expiry = timers[handle.index].expiry;
+	return expiry > now ? float(double(expiry - now) / TICKS_PER_SECOND - leftover) : 0;
+}
+
+// -----------------------------------------------------------------------------
+// Run whole ticks for the time passed, keeping what is left over for next time
+void TimerWheelType::Advance(float seconds)
+{
+	if (seconds <= 0)
+		return;
+
+	leftover += seconds;
+
+	while (leftover * TICKS_PER_SECOND >= 1)
+	{
+		leftover -= 1.0 / TICKS_PER_SECOND;
+		Tick();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Cascade each level down when the one below it wraps, then fire what is in level 0's slot
+void TimerWheelType::Tick()
+{
+	now++;
+
+	for (int level = 1; level < LEVELS; level++)
+	{
+		int shift = SLOT_BITS * level;
+		if ((now & ((uint64_t(1) << shift) - 1)) != 0)
+			break; // Level below hasn't wrapped
+
+		int slot = level * SLOTS + int((now >> shift) & (SLOTS - 1));
+		int timer = heads[slot];
+		heads[slot] = tails[slot] = NONE;
+
+		while (timer != NONE)
+		{
+			int next = timers[timer].next;
+			Insert(timer); // Lands in a lower level now it is closer
+			timer = next;
+		}
+	}
+
+	int slot = int(now & (SLOTS - 1));
+	int timer = heads[slot];
+	heads[slot] = tails[slot] = NONE;
+
+	while (timer != NONE)
+	{
+		Timer& node = timers[timer];
+		int next = node.next;
+
+		TimerEvent event = { node.type, node.index, node.dataGeneration };
+		{
+			ALLOC_TAG(General);
+			expired.push_back(event);
+		}
+
+		if (node.period > 0)
+		{
+			node.expiry += node.period; // From when it was due, so repeats don't drift
+			Insert(timer);
+		}
+		else
+		{
+			Free(timer);
+		}
+
+		timer = next;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Hand out the expired timers in order, the list is emptied once they have all been taken
+bool TimerWheelType::PopExpired(TimerEvent& event)
+{
+	if (nextExpired >= expired.size())
+	{
+		expired.clear();
+		nextExpired = 0;
+		return false;
+	}
+
+	event = expired[nextExpired++];
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Free every timer in the wheel, and start time again if asked
+void TimerWheelType::Clear(bool restartTime)
+{
+	for (int slot = 0; slot < LEVELS * SLOTS; slot++)
+	{
+		int timer = heads[slot];
+		heads[slot] = tails[slot] = NONE;
+
+		while (timer != NONE)
+		{
+			int next = timers[timer].next;
+			Free(timer);
+			timer = next;
+		}
+	}
+
+	expired.clear();
+	nextExpired = 0;
+
+	if (restartTime)
+	{
+		now = 0;
+		leftover = 0;
+	}
+}
@@ -0,0 +1,113 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Hierarchical timer wheel. Time moves in 1 ms ticks. Level 0 has a slot for each of the
+// next 64 ticks, level 1 a slot for each of the next 64 blocks of 64 ticks, and so on up
+// through LEVELS levels. A timer goes in the slot for its expiry at the lowest level that
+// reaches it. Whenever a lower level wraps round, the next slot up is cascaded down.
+//
+// Starting and cancelling a timer are O(1). Timers are nodes in a pool linked into their
+// slot, and a handle's generation stops a stale handle from touching a reused node. A
+// timer costs nothing until its slot comes up, so thousands of per-entity timers are fine.
+//
+// Expired timers come out as events, in the order they expired, from PopExpired. The game
+// reads them on the sim tick rather than being called back from inside Advance.
+//----------------------------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// a timer, or nothing if it has fired or been cancelled
+struct TimerHandle
+{
+	uint32_t index;
+	uint32_t generation; // 0 is never used, so a zeroed handle is never pending
+};
+
+// a timer that has fired. index and generation are whatever the timer was started with, such as an entity
+struct TimerEvent
+{
+	int type;
+	uint32_t index;
+	uint32_t generation;
+};
+
+class TimerWheelType
+{
+	public:
+		static const int TICKS_PER_SECOND = 1000;
+
+		// constructor
+		TimerWheelType();
+
+		// start a timer that fires once after seconds
+		TimerHandle Start(float seconds, int type, uint32_t index = 0, uint32_t generation = 0);
+
+		// start a timer that fires after seconds, then every period seconds until cancelled
+		TimerHandle StartRepeating(float seconds, float period, int type, uint32_t index = 0, uint32_t generation = 0);
+
+		// stop a timer, does nothing if it has already fired or been cancelled
+		void Cancel(TimerHandle& handle);
+
+		// has the timer still to fire
+		bool IsPending(TimerHandle handle) const;
+
+		// get the seconds until the timer fires, 0 if it isn't pending
+		float GetTimeLeft(TimerHandle handle) const;
+
+		// move time on, every timer that expires goes on the expired list
+		void Advance(float seconds);
+
+		// take the next expired timer, returns false once there are none
+		bool PopExpired(TimerEvent& event);
+
+		// cancel every timer and drop the expired list. Time carries on from where it is, or with
+		// restartTime goes back to tick 0 with no part tick left over, so a replay fires on the same frames
+		void Clear(bool restartTime = false);
+
+		int GetPendingCount() const { return pendingCount; }
+
+	private:
+		static const int SLOT_BITS = 6;
+		static const int SLOTS = 1 << SLOT_BITS;
+		static const int LEVELS = 4; // 64^4 ticks, about 4.6 hours. Longer timers wait in the top level and cascade again
+		static const int NONE = -1;
+
+		struct Timer
+		{
+			uint64_t expiry; // Tick it fires on
+			uint32_t period; // Ticks between repeats, 0 for a one shot
+			uint32_t generation;
+			int type;
+			uint32_t index, dataGeneration; // Handed back in the event
+			int prev, next; // Links in the slot's list, or the free list
+			int slot; // Index into slots, NONE when the timer isn't in the wheel
+		};
+
+		std::vector<Timer> timers;
+		int freeList;
+		int pendingCount;
+
+		int heads[LEVELS * SLOTS]; // First timer in each slot
+		int tails[LEVELS * SLOTS]; // Last timer in each slot, timers are added at the back so equal expiries fire in start order
+
+		uint64_t now; // Ticks so far
+		double leftover; // Seconds not yet making up a whole tick
+
+		std::vector<TimerEvent> expired;
+		size_t nextExpired; // Index of the next event PopExpired returns
+
+		TimerHandle Add(uint32_t delay, uint32_t period, int type, uint32_t index, uint32_t generation);
+
+		// link a timer into the slot for its expiry, or unlink it from its slot
+		void Insert(int timer);
+		void Unlink(int timer);
+
+		// put a timer node back on the free list
+		void Free(int timer);
+
+		// move one tick on, cascading the higher levels and firing level 0's slot
+		void Tick();
+
+		static uint32_t ToTicks(float seconds);
+};
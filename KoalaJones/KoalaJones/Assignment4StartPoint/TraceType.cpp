@@ -0,0 +1,356 @@
+//----------------------------------------------------------------------------------------
+// Implementation file for the trace event recorder
+//----------------------------------------------------------------------------------------
+
+#include "TraceType.h"
+#include "AllocTrackerType.h"
+
+#include <chrono>
+#include <cstring>
+
+std::atomic<bool> TraceType::enabled(false);
+std::mutex TraceType::buffersLock;
+std::vector<TraceType::ThreadBuffer*> TraceType::buffers;
+std::vector<TraceType::ThreadBuffer*> TraceType::drainList;
+std::thread TraceType::flushThread;
+std::atomic<bool> TraceType::flushRunning(false);
+FILE* TraceType::file = NULL;
+TraceType::Format TraceType::fileFormat = TraceType::ChromeJson;
+bool TraceType::firstJsonEvent = true;
+__int64 TraceType::startTicks = 0;
+double TraceType::nsPerTick = 0;
+
+namespace
+{
+	//------------------------------------------------------------------------------------
+	// Minimal protobuf writer for the handful of Perfetto messages we emit
+	struct ProtoWriter
+	{
+		unsigned char data[512];
+		int size = 0;
+
+		void Varint(unsigned __int64 value)
+		{
+			while (value >= 0x80 && size < (int)sizeof(data))
+			{
+				data[size++] = (unsigned char)(value | 0x80);
+				value >>= 7;
+			}
+			if (size < (int)sizeof(data))
+				data[size++] = (unsigned char)value;
+		}
+
+		void Tag(int field, int wireType) { Varint((unsigned __int64)((field << 3) | wireType)); }
+
+		void VarintField(int field, unsigned __int64 value) { Tag(field, 0); Varint(value); }
+
+		void Bytes(int field, const void* bytes, int length)
+		{
+			Tag(field, 2);
+			Varint((unsigned __int64)length);
+			if (size + length > (int)sizeof(data))
+				length = (int)sizeof(data) - size;
+			memcpy(data + size, bytes, length);
+			size += length;
+		}
+
+		void String(int field, const char* text) { Bytes(field, text, (int)strlen(text)); }
+		void Message(int field, const ProtoWriter& message) { Bytes(field, message.data, message.size); }
+	};
+
+	// Perfetto field numbers (protos/perfetto/trace/...)
+	const int TRACE_PACKET = 1;
+	const int PACKET_TIMESTAMP = 8;
+	const int PACKET_SEQUENCE_ID = 10;
+	const int PACKET_TRACK_EVENT = 11;
+	const int PACKET_TRACK_DESCRIPTOR = 60;
+	const int EVENT_DEBUG_ANNOTATIONS = 4;
+	const int EVENT_TYPE = 9;
+	const int EVENT_TRACK_UUID = 11;
+	const int EVENT_CATEGORIES = 22;
+	const int EVENT_NAME = 23;
+	const int ANNOTATION_INT_VALUE = 4;
+	const int ANNOTATION_NAME = 10;
+	const int DESCRIPTOR_UUID = 1;
+	const int DESCRIPTOR_THREAD = 4;
+	const int THREAD_PID = 1;
+	const int THREAD_TID = 2;
+	const int THREAD_NAME = 5;
+
+	const int SLICE_BEGIN = 1;
+	const int SLICE_END = 2;
+	const int INSTANT = 3;
+}
+
+// -----------------------------------------------------------------------------
+// Open the trace file and start the flush thread
+bool TraceType::Start(const char* fileName, Format format)
+{
+	if (IsRecording())
+		Stop();
+
+	file = fopen(fileName, "wb");
+	if (file == NULL)
+		return false;
+
+	fileFormat = format;
+	firstJsonEvent = true;
+
+	if (fileFormat == ChromeJson)
+		fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+
+	LARGE_INTEGER frequency, now;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&now);
+	nsPerTick = 1000000000.0 / double(frequency.QuadPart);
+	startTicks = now.QuadPart;
+
+	{
+		// anything left over from an earlier trace is thrown away
+		std::lock_guard<std::mutex> lock(buffersLock);
+		for (ThreadBuffer* buffer : buffers)
+		{
+			buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_release);
+			buffer->described = false;
+			buffer->dropped = 0;
+		}
+	}
+
+	flushRunning = true;
+	{
+		ALLOC_TAG(Diagnostics);
+		flushThread = std::thread(FlushThread);
+	}
+
+	enabled = true;
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Stop recording, drain the buffers one last time and close the file
+void TraceType::Stop()
+{
+	if (!IsRecording())
+		return;
+
+	enabled = false;
+
+	flushRunning = false;
+	if (flushThread.joinable())
+		flushThread.join();
+
+	Drain();
+
+	if (fileFormat == ChromeJson)
+		fputs("\n]}\n", file);
+
+	fclose(file);
+	file = NULL;
+}
+
+// -----------------------------------------------------------------------------
+// Push an event onto this thread's ring buffer. Never blocks, if the flush thread
+// has fallen behind the event is dropped and counted instead.
+void TraceType::Record(EventType type, const char* category, const char* name, int value)
+{
+	ThreadBuffer* buffer = GetThreadBuffer();
+
+	unsigned int head = buffer->head.load(std::memory_order_relaxed);
+	if (head - buffer->tail.load(std::memory_order_acquire) >= (unsigned int)BUFFER_SIZE)
+	{
+		buffer->dropped++;
+		return;
+	}
+
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+
+	Event& e = buffer->events[head & (BUFFER_SIZE - 1)];
+	e.ticks = now.QuadPart;
+	e.category = category;
+	e.name = name;
+	e.value = value;
+	e.type = type;
+
+	buffer->head.store(head + 1, std::memory_order_release);
+}
+
+// -----------------------------------------------------------------------------
+// Each thread gets a buffer the first time it records, taking over one an exited thread
+// handed back once everything in it has been written, or else registering a new one
+TraceType::ThreadBuffer* TraceType::GetThreadBuffer()
+{
+	thread_local BufferOwner owner;
+
+	if (owner.buffer == NULL)
+	{
+		std::lock_guard<std::mutex> lock(buffersLock);
+
+		for (ThreadBuffer* buffer : buffers)
+		{
+			if (buffer->released && buffer->tail.load(std::memory_order_acquire) == buffer->head.load(std::memory_order_relaxed))
+			{
+				owner.buffer = buffer;
+				break;
+			}
+		}
+
+		if (owner.buffer == NULL)
+		{
+			ALLOC_TAG(Diagnostics);
+
+			owner.buffer = new ThreadBuffer;
+			owner.buffer->head = 0;
+			owner.buffer->tail = 0;
+			owner.buffer->trackId = (int)buffers.size() + 1;
+			buffers.push_back(owner.buffer);
+		}
+
+		owner.buffer->threadId = (unsigned int)GetCurrentThreadId();
+		owner.buffer->described = false;
+		owner.buffer->dropped = 0;
+		owner.buffer->released = false;
+	}
+
+	return owner.buffer;
+}
+
+// -----------------------------------------------------------------------------
+// The thread is exiting, its buffer stays registered until it is taken over
+TraceType::BufferOwner::~BufferOwner()
+{
+	if (buffer == NULL)
+		return;
+
+	std::lock_guard<std::mutex> lock(buffersLock);
+	buffer->released = true;
+}
+
+// -----------------------------------------------------------------------------
+// Background thread, drains the buffers every few milliseconds while recording
+void TraceType::FlushThread()
+{
+	while (flushRunning)
+	{
+		Drain();
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Write every event currently in the buffers to the file. The lock is only held to copy
+// the list, so a thread registering its first buffer never waits on the disk. Buffers
+// are never freed, so the copied pointers stay good
+void TraceType::Drain()
+{
+	{
+		std::lock_guard<std::mutex> lock(buffersLock);
+		ALLOC_TAG(Diagnostics);
+		drainList.assign(buffers.begin(), buffers.end());
+	}
+
+	for (ThreadBuffer* buffer : drainList)
+	{
+		unsigned int tail = buffer->tail.load(std::memory_order_relaxed);
+		unsigned int head = buffer->head.load(std::memory_order_acquire);
+
+		for (; tail != head; tail++)
+		{
+			WriteEvent(*buffer, buffer->events[tail & (BUFFER_SIZE - 1)]);
+		}
+
+		buffer->tail.store(tail, std::memory_order_release);
+	}
+
+	fflush(file);
+}
+
+// -----------------------------------------------------------------------------
+// Write a single event in the format the trace was started with
+void TraceType::WriteEvent(ThreadBuffer& buffer, const Event& e)
+{
+	if (fileFormat == ChromeJson)
+		WriteJsonEvent(buffer, e);
+	else
+		WritePerfettoEvent(buffer, e);
+}
+
+// -----------------------------------------------------------------------------
+// Chrome trace event format, timestamps are in microseconds
+void TraceType::WriteJsonEvent(ThreadBuffer& buffer, const Event& e)
+{
+	static const char phases[] = { 'B', 'E', 'i' };
+
+	double microseconds = double(e.ticks - startTicks) * nsPerTick / 1000.0;
+
+	fprintf(file, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u",
+		firstJsonEvent ? "" : ",\n", e.name, e.category, phases[e.type], microseconds, buffer.threadId);
+
+	if (e.type == Instant)
+		fprintf(file, ",\"s\":\"t\",\"args\":{\"value\":%d}", e.value);
+
+	fputs("}", file);
+	firstJsonEvent = false;
+}
+
+// -----------------------------------------------------------------------------
+// Perfetto TracePacket containing a TrackEvent on the thread's track
+void TraceType::WritePerfettoEvent(ThreadBuffer& buffer, const Event& e)
+{
+	if (!buffer.described)
+		WritePerfettoDescriptor(buffer);
+
+	ProtoWriter trackEvent;
+	trackEvent.VarintField(EVENT_TYPE, e.type == Begin ? SLICE_BEGIN : (e.type == End ? SLICE_END : INSTANT));
+	trackEvent.VarintField(EVENT_TRACK_UUID, (unsigned __int64)buffer.trackId);
+
+	if (e.type != End)
+	{
+		trackEvent.String(EVENT_CATEGORIES, e.category);
+		trackEvent.String(EVENT_NAME, e.name);
+	}
+
+	if (e.type == Instant)
+	{
+		ProtoWriter annotation;
+		annotation.String(ANNOTATION_NAME, "value");
+		annotation.VarintField(ANNOTATION_INT_VALUE, (unsigned __int64)(__int64)e.value);
+		trackEvent.Message(EVENT_DEBUG_ANNOTATIONS, annotation);
+	}
+
+	ProtoWriter packet;
+	packet.VarintField(PACKET_TIMESTAMP, (unsigned __int64)(double(e.ticks - startTicks) * nsPerTick));
+	packet.VarintField(PACKET_SEQUENCE_ID, 1);
+	packet.Message(PACKET_TRACK_EVENT, trackEvent);
+
+	ProtoWriter trace;
+	trace.Message(TRACE_PACKET, packet);
+	fwrite(trace.data, 1, trace.size, file);
+}
+
+// -----------------------------------------------------------------------------
+// Perfetto TrackDescriptor naming the thread, written before its first event
+void TraceType::WritePerfettoDescriptor(ThreadBuffer& buffer)
+{
+	char threadName[32];
+	snprintf(threadName, sizeof(threadName), buffer.trackId == 1 ? "Main" : "Thread %d", buffer.trackId);
+
+	ProtoWriter thread;
+	thread.VarintField(THREAD_PID, (unsigned __int64)GetCurrentProcessId());
+	thread.VarintField(THREAD_TID, buffer.threadId);
+	thread.String(THREAD_NAME, threadName);
+
+	ProtoWriter descriptor;
+	descriptor.VarintField(DESCRIPTOR_UUID, (unsigned __int64)buffer.trackId);
+	descriptor.Message(DESCRIPTOR_THREAD, thread);
+
+	ProtoWriter packet;
+	packet.VarintField(PACKET_SEQUENCE_ID, 1);
+	packet.Message(PACKET_TRACK_DESCRIPTOR, descriptor);
+
+	ProtoWriter trace;
+	trace.Message(TRACE_PACKET, packet);
+	fwrite(trace.data, 1, trace.size, file);
+
+	buffer.described = true;
+}
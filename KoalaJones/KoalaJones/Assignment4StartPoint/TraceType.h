@@ -0,0 +1,130 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Trace event recorder. Begin/end/instant events are written by each thread into its own
+// lock-free ring buffer and a background thread drains the buffers into a trace file that
+// can be opened in chrome://tracing or ui.perfetto.dev.
+//
+// Event names and categories are stored as pointers, so they must be string literals.
+// When tracing is stopped every TRACE_ macro costs a single branch on TraceType::enabled.
+//
+// Buffers are kept for the life of the process and reused rather than freed: Stop leaves
+// them in place for the next trace, since a thread may still be inside Record, and a
+// thread that exits hands its buffer back for the next new thread to take over once it
+// has been drained.
+//----------------------------------------------------------------------------------------
+
+#include <windows.h>
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TraceType
+{
+	public:
+
+		// file formats that the recorder can write
+		enum Format { ChromeJson, PerfettoProtobuf };
+
+		// the kind of event being recorded
+		enum EventType { Begin, End, Instant };
+
+		// is a trace currently being recorded, checked by every TRACE_ macro
+		static std::atomic<bool> enabled;
+
+		// start recording to a file, returns false if the file couldn't be opened
+		static bool Start(const char* fileName, Format format);
+
+		// stop recording, flush everything left in the buffers and close the file
+		static void Stop();
+
+		static bool IsRecording() { return enabled.load(std::memory_order_relaxed); }
+
+		// record an event on the calling thread's buffer
+		static void Record(EventType type, const char* category, const char* name, int value = 0);
+
+	private:
+		static const int BUFFER_SIZE = 1 << 16; // Events per thread, must be a power of two
+
+		struct Event
+		{
+			__int64 ticks; // QueryPerformanceCounter time of the event
+			const char* category;
+			const char* name;
+			int value; // Shown as an argument on the event
+			EventType type;
+		};
+
+		// single producer (the owning thread), single consumer (the flush thread) ring buffer
+		struct ThreadBuffer
+		{
+			Event events[BUFFER_SIZE];
+			std::atomic<unsigned int> head; // Next slot the owning thread writes
+			std::atomic<unsigned int> tail; // Next slot the flush thread reads
+			unsigned int threadId;
+			int trackId; // Index of the buffer, used as the track for the thread
+			bool described; // Has the thread's track descriptor been written yet
+			int dropped; // Events lost because the buffer was full
+			bool released; // Its thread has exited, guarded by buffersLock
+		};
+
+		// hands the thread's buffer back when the thread exits
+		struct BufferOwner
+		{
+			ThreadBuffer* buffer = NULL;
+			~BufferOwner();
+		};
+
+		static ThreadBuffer* GetThreadBuffer();
+
+		static void FlushThread();
+		static void Drain();
+
+		static void WriteEvent(ThreadBuffer& buffer, const Event& e);
+		static void WriteJsonEvent(ThreadBuffer& buffer, const Event& e);
+		static void WritePerfettoEvent(ThreadBuffer& buffer, const Event& e);
+		static void WritePerfettoDescriptor(ThreadBuffer& buffer);
+
+		static std::mutex buffersLock; // Guards the list of buffers, not the buffers themselves
+		static std::vector<ThreadBuffer*> buffers;
+		static std::vector<ThreadBuffer*> drainList; // Copy of buffers Drain writes from, only used by whichever thread is draining
+
+		static std::thread flushThread;
+		static std::atomic<bool> flushRunning;
+
+		static FILE* file;
+		static Format fileFormat;
+		static bool firstJsonEvent;
+		static __int64 startTicks;
+		static double nsPerTick;
+};
+
+//----------------------------------------------------------------------------------------
+// Records a begin event now and the matching end event when the scope closes
+class TraceScope
+{
+	public:
+		TraceScope(const char* inCategory, const char* inName) : category(inCategory), name(inName), active(TraceType::enabled.load(std::memory_order_relaxed))
+		{
+			if (active)
+				TraceType::Record(TraceType::Begin, category, name);
+		}
+
+		~TraceScope()
+		{
+			if (active)
+				TraceType::Record(TraceType::End, category, name);
+		}
+
+	private:
+		const char* category;
+		const char* name;
+		bool active;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#define TRACE_SCOPE(category, name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(category, name)
+#define TRACE_INSTANT(category, name, value) do { if (TraceType::enabled.load(std::memory_order_relaxed)) TraceType::Record(TraceType::Instant, category, name, value); } while (0)
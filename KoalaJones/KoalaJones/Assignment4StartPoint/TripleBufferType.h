@@ -0,0 +1,53 @@
+#pragma once
+//----------------------------------------------------------------------------------------
+// Lock-free triple buffer between one producer and one consumer. The producer fills the
+// back buffer and publishes it, which swaps it with the middle buffer. The consumer takes
+// the middle buffer when a new one has been published, swapping its old front buffer in.
+// Neither side ever waits for the other. The producer can publish faster than the
+// consumer reads, in which case the consumer only ever sees the newest.
+//
+// The three buffers are made once and reused, so whatever they hold keeps its capacity
+// from one publish to the next.
+//----------------------------------------------------------------------------------------
+
+#include <atomic>
+
+template <class T>
+class TripleBufferType
+{
+	public:
+		// constructor, the consumer starts with buffer 2, which is default constructed until the first publish
+		TripleBufferType() : back(0), front(2) { middle.store(1, std::memory_order_relaxed); }
+
+		// the buffer the producer is filling
+		T& GetBack() { return buffers[back]; }
+
+		// hand the back buffer to the consumer and take the middle one to fill next, producer only
+		void Publish() { back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX_MASK; }
+
+		// take the newest published buffer if there is one, consumer only. Returns false if the front buffer is still the newest
+		bool Acquire()
+		{
+			if ((middle.load(std::memory_order_relaxed) & FRESH) == 0)
+				return false;
+
+			front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+			return true;
+		}
+
+		// the buffer the consumer is reading
+		const T& GetFront() const { return buffers[front]; }
+
+	private:
+		static const int INDEX_MASK = 3;
+		static const int FRESH = 4; // Set in middle when the producer has published since the consumer last took it
+
+		T buffers[3];
+		int back; // Only touched by the producer
+		alignas(64) int front; // Only touched by the consumer
+		alignas(64) std::atomic<int> middle; // Index of the buffer between them, plus FRESH
+
+		// the buffers can't be copied
+		TripleBufferType(const TripleBufferType&);
+		TripleBufferType& operator=(const TripleBufferType&);
+};
@@ -0,0 +1,174 @@
+/*
+
+Flight recorder decoder
+Reads a hitch_<frame>.kjfr dump written by FlightRecorderType and prints the recorded
+timeline, one row per frame with the change from the previous frame, followed by a
+comparison of the hitch frame against the median of the frames before it.
+
+Usage: FlightDecoder <dump file> [frames to show, default all]
+
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "FlightRecordFormat.h"
+
+using namespace std;
+
+// -----------------------------------------------------------------------------
+// Print the value and how much it changed since the previous frame
+void PrintWithDelta(float value, float previous, bool first)
+{
+	if (first)
+		printf(" %8.3f        ", value);
+	else
+		printf(" %8.3f(%+6.2f)", value, value - previous);
+}
+
+// -----------------------------------------------------------------------------
+// Print the recorded input events for a frame
+void PrintInputs(const FlightFrameRecord& frame)
+{
+	int stored = (frame.inputCount < FlightRecord::MAX_INPUTS) ? frame.inputCount : FlightRecord::MAX_INPUTS;
+
+	for (int i = 0; i < stored; i++)
+	{
+		const FlightInputEvent& input = frame.inputs[i];
+
+		switch (input.type)
+		{
+		case FlightRecord::MouseDown:
+			printf(" down(%d,%d)", input.x, input.y);
+			break;
+		case FlightRecord::MouseUp:
+			printf(" up(%d,%d)", input.x, input.y);
+			break;
+		case FlightRecord::KeyUp:
+			printf(" key(%c)", input.key);
+			break;
+		}
+	}
+
+	if (frame.inputCount > stored)
+		printf(" +%d more", frame.inputCount - stored);
+}
+
+// -----------------------------------------------------------------------------
+// Median of a list of values
+float Median(vector<float> values)
+{
+	if (values.empty())
+		return 0;
+
+	nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+	return values[values.size() / 2];
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		printf("Usage: FlightDecoder <dump file> [frames to show]\n");
+		return 1;
+	}
+
+	FILE* file = fopen(argv[1], "rb");
+	if (file == NULL)
+	{
+		printf("Could not open %s\n", argv[1]);
+		return 1;
+	}
+
+	FlightFileHeader header;
+	if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, "KJFR", 4) != 0)
+	{
+		printf("%s is not a flight recorder dump\n", argv[1]);
+		fclose(file);
+		return 1;
+	}
+
+	if (header.version != FlightRecord::VERSION || header.phaseCount != FramePhase::COUNT ||
+		header.listCount != FlightRecord::LIST_COUNT || header.maxInputs != FlightRecord::MAX_INPUTS)
+	{
+		printf("%s was written by a different version of the game (version %d, %d phases, %d lists)\n",
+			argv[1], header.version, header.phaseCount, header.listCount);
+		fclose(file);
+		return 1;
+	}
+
+	vector<FlightFrameRecord> frames(header.frameCount);
+	size_t read = fread(frames.data(), sizeof(FlightFrameRecord), header.frameCount, file);
+	fclose(file);
+
+	frames.resize(read);
+	if (frames.empty())
+	{
+		printf("%s has no frames\n", argv[1]);
+		return 1;
+	}
+
+	int first = 0;
+	if (argc >= 3)
+		first = max(0, (int)frames.size() - atoi(argv[2]));
+
+	printf("Hitch at frame %u, budget %.2f ms, %d frames recorded\n\n", header.hitchFrame, header.budgetMs, (int)frames.size());
+
+	// Timeline header
+	printf("%8s %17s", "frame", "delta ms");
+	for (int p = 0; p < FramePhase::COUNT; p++)
+		printf(" %17.17s", FramePhase::GetName(FramePhase::Phase(p)));
+	for (int l = 0; l < FlightRecord::LIST_COUNT; l++)
+		printf(" %14s", FlightRecord::GetListName(FlightRecord::List(l)));
+	printf(" %7s %5s %5s  input\n", "score", "lives", "level");
+
+	// Timeline, one row per frame with the change from the frame before
+	for (int i = first; i < (int)frames.size(); i++)
+	{
+		const FlightFrameRecord& frame = frames[i];
+		const FlightFrameRecord& previous = frames[max(i - 1, 0)];
+		bool noPrevious = (i == 0);
+
+		printf("%8u", frame.frame);
+		PrintWithDelta(frame.deltaMs, previous.deltaMs, noPrevious);
+
+		for (int p = 0; p < FramePhase::COUNT; p++)
+			PrintWithDelta(frame.phaseMs[p], previous.phaseMs[p], noPrevious);
+
+		for (int l = 0; l < FlightRecord::LIST_COUNT; l++)
+			printf(" %6u/%-4u%+4d", frame.spriteCount[l], frame.listCapacity[l], noPrevious ? 0 : (int)frame.spriteCount[l] - (int)previous.spriteCount[l]);
+
+		printf(" %7d %5d %5d ", frame.score, frame.lives, frame.obstacleLevel);
+		PrintInputs(frame);
+
+		if (frame.deltaMs > header.budgetMs)
+			printf("  <-- over budget");
+
+		printf("\n");
+	}
+
+	// Compare the hitch frame (the newest) against the typical frame before it
+	const FlightFrameRecord& hitch = frames.back();
+	int before = (int)frames.size() - 1;
+
+	printf("\nHitch frame %u against the median of the %d frames before it:\n", hitch.frame, before);
+	vector<float> deltas;
+	for (int i = 0; i < before; i++)
+		deltas.push_back(frames[i].deltaMs);
+
+	printf("  %-20s %10.3f ms  median %8.3f ms\n", "frame", hitch.deltaMs, Median(deltas));
+
+	for (int p = 0; p < FramePhase::COUNT; p++)
+	{
+		vector<float> values;
+		for (int i = 0; i < before; i++)
+			values.push_back(frames[i].phaseMs[p]);
+
+		float median = Median(values);
+		printf("  %-20s %10.3f ms  median %8.3f ms  %+9.3f ms\n", FramePhase::GetName(FramePhase::Phase(p)), hitch.phaseMs[p], median, hitch.phaseMs[p] - median);
+	}
+
+	return 0;
+}
@@ -0,0 +1,853 @@
+/*
+
+Checks
+Runs the parts of the game that don't need a window or a device against known answers, and
+prints each check that fails. The exit code is the number of failures, so a build step can
+run it after the game builds.
+
+Usage: KoalaChecks
+
+Timing is checked on a ManualClockType, so the results are the same on every machine. The
+narrow phase is given its masks straight from texels made up here, so no device is needed.
+The steady-state checks need the allocation tracker, so they only run in a debug build.
+Fixed point games are played from set seeds and clicks and their hashes compared with ones
+pinned here, which every compiler, platform and build has to match. Batched games are
+played next to HeadlessGameTypes and compared tick by tick. The results
+store writes a scratch file in the working directory and deletes it when it is done.
+
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "AllocTrackerType.h"
+#include "AutoplayerType.h"
+#include "BatchEnvironmentType.h"
+#include "ClockType.h"
+#include "FramePacerType.h"
+#include "JobSystemType.h"
+#include "NarrowPhaseType.h"
+#include "ResultsStoreType.h"
+#include "TextureType.h"
+
+static int failures = 0;
+
+#define CHECK(condition) Check(condition, #condition, __FILE__, __LINE__)
+
+// -----------------------------------------------------------------------------
+// Count and print a check that didn't hold
+static void Check(bool passed, const char* text, const char* file, int line)
+{
+	if (!passed)
+	{
+		printf("%s(%d): check failed: %s\n", file, line, text);
+		failures++;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// How a frame gets to the screen once it is drawn
+enum class PresentMode
+{
+	Immediate, // Present returns straight away, presentInterval 0
+	Vsync, // Present blocks until the next flip
+	Limited // Present returns straight away, then the frame sleeps blindly until a period after it started
+};
+
+struct PacerRun
+{
+	double inputToPresentMs; // Mean time from an input arriving to the frame that applied it reaching the screen
+	double frameMs; // Mean time between frames reaching the screen
+	int missed; // Frames the pacer said missed their deadline
+};
+
+static const int64_t MILLISECOND = ClockType::NANOSECONDS_PER_MILLISECOND;
+static const int64_t PERIOD = ClockType::NANOSECONDS_PER_SECOND / 60;
+
+// -----------------------------------------------------------------------------
+// Run frames of sim then render against a manual clock with inputs arriving every millisecond. The
+// sim cost wobbles a little from frame to frame and one frame can have a spike. The first frames
+// fill the pacer's history and aren't measured. Latency is measured here rather than by the pacer,
+// as with the blind limiter the frame is on screen before the sleep
+static PacerRun RunPacer(bool pacing, PresentMode mode, int frames, int spikeFrame = -1)
+{
+	const int WARM_UP = FramePacerType::HISTORY * 2;
+
+	ManualClockType clock;
+	clock.SetSleepSlack(2 * MILLISECOND);
+
+	FramePacerType pacer(clock);
+	pacer.SetEnabled(pacing);
+
+	int64_t nextInput = 0;
+	int64_t latencyTotal = 0;
+	int64_t inputs = 0;
+	int64_t firstShown = 0, lastShown = 0;
+	int missedBefore = 0;
+
+	for (int i = 0; i < WARM_UP + frames; i++)
+	{
+		pacer.BeginFrame();
+		int64_t start = clock.Now();
+		if (i == WARM_UP)
+			missedBefore = pacer.GetMissedCount();
+
+		// The frame reads every input that has arrived by now
+		int64_t firstInput = nextInput;
+		int count = 0;
+		for (; nextInput <= start; nextInput += MILLISECOND, count++)
+			pacer.AddInput(nextInput);
+
+		clock.Advance(3 * MILLISECOND + (i * 7 % 5) * MILLISECOND / 5);
+		if (i == spikeFrame)
+			clock.Advance(10 * MILLISECOND);
+		pacer.EndSim();
+
+		clock.Advance(4 * MILLISECOND);
+		pacer.EndRender();
+
+		// When the frame reaches the screen, the next flip with vsync or straight away without
+		if (mode == PresentMode::Vsync)
+			clock.SpinUntil((clock.Now() / PERIOD + 1) * PERIOD);
+		int64_t shown = clock.Now();
+		if (mode == PresentMode::Limited)
+			clock.SpinUntil(start + PERIOD);
+
+		if (i >= WARM_UP)
+		{
+			// The inputs were a millisecond apart, so their mean arrival is halfway between the first and last
+			latencyTotal += count * (shown - firstInput) - int64_t(count) * (count - 1) / 2 * MILLISECOND;
+			inputs += count;
+
+			if (i == WARM_UP)
+				firstShown = shown;
+			lastShown = shown;
+		}
+	}
+
+	PacerRun run;
+	run.inputToPresentMs = double(latencyTotal) / double(inputs) / double(MILLISECOND);
+	run.frameMs = double(lastShown - firstShown) / (frames - 1) / double(MILLISECOND);
+	run.missed = pacer.GetMissedCount() - missedBefore;
+	return run;
+}
+
+// -----------------------------------------------------------------------------
+// The pacer holds the rate, meets its deadlines and waits on a clock that only moves when it
+// is slept or spun on, and starts frames late enough to cut the latency vsync adds
+static void CheckFramePacer()
+{
+	// 4 ms of sim and 4 ms of render with 2 ms of sleep slack, where the wait ends in a spin
+	{
+		ManualClockType clock;
+		clock.SetSleepSlack(2 * MILLISECOND);
+		FramePacerType pacer(clock);
+
+		for (int i = 0; i < 120; i++)
+		{
+			pacer.BeginFrame();
+			clock.Advance(4 * MILLISECOND);
+			pacer.EndSim();
+			clock.Advance(4 * MILLISECOND);
+			pacer.EndRender();
+		}
+
+		CHECK(pacer.GetMissedCount() == 0);
+		CHECK(pacer.GetPredictedSimMs() == 4 && pacer.GetPredictedRenderMs() == 4);
+		CHECK(pacer.GetLastWaitMs() > 8.66 && pacer.GetLastWaitMs() < 8.67); // A period less the 8 ms of work
+		CHECK(pacer.GetMeanFrameMs() > 16.66 && pacer.GetMeanFrameMs() < 16.67);
+		CHECK(pacer.GetJitterMs() < 0.001);
+	}
+
+	PacerRun vsyncOff = RunPacer(false, PresentMode::Vsync, 600);
+	PacerRun vsyncOn = RunPacer(true, PresentMode::Vsync, 600);
+	PacerRun immediateOff = RunPacer(false, PresentMode::Immediate, 600);
+	PacerRun immediateOn = RunPacer(true, PresentMode::Immediate, 600);
+	PacerRun limited = RunPacer(false, PresentMode::Limited, 600);
+
+	printf("Input to present, pacer off and on: vsync %.2f and %.2f ms, presentInterval 0 %.2f and %.2f ms, blind limiter %.2f ms\n",
+		vsyncOff.inputToPresentMs, vsyncOn.inputToPresentMs, immediateOff.inputToPresentMs, immediateOn.inputToPresentMs, limited.inputToPresentMs);
+	printf("Frame time, pacer off and on: vsync %.2f and %.2f ms, presentInterval 0 %.2f and %.2f ms, blind limiter %.2f ms\n",
+		vsyncOff.frameMs, vsyncOn.frameMs, immediateOff.frameMs, immediateOn.frameMs, limited.frameMs);
+
+	// With vsync the pacer keeps the rate and starts each frame as late as it can still make the flip
+	CHECK(vsyncOn.missed == 0);
+	CHECK(vsyncOn.frameMs > 16.66 && vsyncOn.frameMs < 16.67);
+	CHECK(vsyncOn.inputToPresentMs < vsyncOff.inputToPresentMs - 5);
+
+	// Without vsync it holds 60 fps, and is no slower to show input than a blind limiter at that rate
+	CHECK(immediateOn.missed == 0);
+	CHECK(immediateOn.frameMs > 16.66 && immediateOn.frameMs < 16.67);
+	CHECK(immediateOn.inputToPresentMs <= limited.inputToPresentMs + 0.01);
+
+	// A single spike misses one flip, doesn't raise the prediction, and the pacer finds the flips again
+	PacerRun spiked = RunPacer(true, PresentMode::Vsync, 600, FramePacerType::HISTORY * 2 + 100);
+	CHECK(spiked.missed == 1);
+	CHECK(spiked.inputToPresentMs < vsyncOn.inputToPresentMs + 0.1);
+}
+
+// a texture for the narrow phase, its texels only ever on the CPU
+struct TestSheet
+{
+	TextureType texture; // Never loaded, the narrow phase only keys its masks on it
+	int width, height;
+	std::vector<uint8_t> texels; // RGBA, only alpha is read
+
+	bool IsSolid(int x, int y) const { return texels[(size_t(y) * width + x) * 4 + 3] >= NarrowPhaseType::ALPHA_THRESHOLD; }
+};
+
+// -----------------------------------------------------------------------------
+// Fill a sheet's alpha with a ring and some noise, so masks have holes and ragged edges
+static void FillSheet(TestSheet& sheet, int width, int height)
+{
+	sheet.width = width;
+	sheet.height = height;
+	sheet.texels.assign(size_t(width) * height * 4, 0);
+
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			float dx = (x - width * 0.5f) / (width * 0.5f);
+			float dy = (y - height * 0.5f) / (height * 0.5f);
+			float distance = dx * dx + dy * dy;
+
+			bool solid = distance < 1 && distance > 0.2f && rand() % 6 != 0;
+			sheet.texels[(size_t(y) * width + x) * 4 + 3] = solid ? 255 : uint8_t(rand() % NarrowPhaseType::ALPHA_THRESHOLD);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// A sprite drawing the whole of a sheet
+static RenderComponent SheetSprite(TestSheet& sheet, float originX, float originY)
+{
+	RenderComponent render = {};
+	render.texture = &sheet.texture;
+	render.regionRight = sheet.width;
+	render.regionBottom = sheet.height;
+	render.originX = originX;
+	render.originY = originY;
+	return render;
+}
+
+// -----------------------------------------------------------------------------
+// Is a screen pixel solid where a sprite is drawn, worked out one pixel at a time: the
+// position rounded to a whole pixel and the rotation to the nearest of ANGLE_STEPS, the
+// pixel's centre turned back into the region and the texel under it read
+static bool SolidAt(const TestSheet& sheet, const TransformComponent& transform, const RenderComponent& render, int pixelX, int pixelY)
+{
+	int steps = int(floorf(transform.rotation * NarrowPhaseType::ANGLE_STEPS / 360.0f + 0.5f)) % NarrowPhaseType::ANGLE_STEPS;
+	float angle = float(steps < 0 ? steps + NarrowPhaseType::ANGLE_STEPS : steps) * 360.0f / NarrowPhaseType::ANGLE_STEPS * (3.141592f / 180.0f);
+	float cosine = cosf(angle);
+	float sine = sinf(angle);
+	float inverseScale = 1.0f / transform.scale;
+
+	float x = float(pixelX - int(floorf(transform.x + 0.5f))) + 0.5f;
+	float y = float(pixelY - int(floorf(transform.y + 0.5f))) + 0.5f;
+	float regionX = (x * cosine + y * sine) * inverseScale + render.originX;
+	float regionY = (y * cosine - x * sine) * inverseScale + render.originY;
+
+	int width = render.regionRight - render.regionLeft;
+	int height = render.regionBottom - render.regionTop;
+	if (regionX < 0 || regionY < 0 || regionX >= width || regionY >= height)
+		return false;
+
+	return sheet.IsSolid(render.regionLeft + int(regionX), render.regionTop + int(regionY));
+}
+
+// -----------------------------------------------------------------------------
+// Is a point inside a box grown by grow on every side
+static bool Contains(const OrientedBox& box, float x, float y, float grow)
+{
+	float gapX = x - box.centerX;
+	float gapY = y - box.centerY;
+
+	return fabsf(gapX * box.axisX + gapY * box.axisY) <= box.halfWidth + grow && fabsf(gapY * box.axisX - gapX * box.axisY) <= box.halfHeight + grow;
+}
+
+// -----------------------------------------------------------------------------
+// The four corners in order round the box
+static void GetCorners(const OrientedBox& box, float* xs, float* ys)
+{
+	static const float signs[4][2] = { { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 } };
+
+	for (int i = 0; i < 4; i++)
+	{
+		float along = signs[i][0] * box.halfWidth;
+		float across = signs[i][1] * box.halfHeight;
+		xs[i] = box.centerX + along * box.axisX - across * box.axisY;
+		ys[i] = box.centerY + along * box.axisY + across * box.axisX;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Do two segments cross, by which side of each the other's ends are on
+static bool SegmentsCross(float ax, float ay, float bx, float by, float cx, float cy, float dx, float dy)
+{
+	float d1 = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+	float d2 = (bx - ax) * (dy - ay) - (by - ay) * (dx - ax);
+	float d3 = (dx - cx) * (ay - cy) - (dy - cy) * (ax - cx);
+	float d4 = (dx - cx) * (by - cy) - (dy - cy) * (bx - cx);
+
+	return ((d1 > 0) != (d2 > 0)) && ((d3 > 0) != (d4 > 0));
+}
+
+// -----------------------------------------------------------------------------
+// Two convex quads overlap if a corner of one is inside the other or two of their edges cross
+static bool QuadsOverlap(const OrientedBox& a, const OrientedBox& b)
+{
+	float ax[4], ay[4], bx[4], by[4];
+	GetCorners(a, ax, ay);
+	GetCorners(b, bx, by);
+
+	for (int i = 0; i < 4; i++)
+	{
+		if (Contains(b, ax[i], ay[i], 0) || Contains(a, bx[i], by[i], 0))
+			return true;
+	}
+
+	for (int i = 0; i < 4; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			if (SegmentsCross(ax[i], ay[i], ax[(i + 1) % 4], ay[(i + 1) % 4], bx[j], by[j], bx[(j + 1) % 4], by[(j + 1) % 4]))
+				return true;
+		}
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// The box a little bigger or smaller, to spot pairs too close to touching to call
+static OrientedBox Grown(OrientedBox box, float grow)
+{
+	box.halfWidth += grow;
+	box.halfHeight += grow;
+	return box;
+}
+
+// -----------------------------------------------------------------------------
+// Oriented boxes against a corner and edge test, rotated masks against the texels under
+// each pixel, and pixel masks against both masks tested one pixel at a time
+static void CheckNarrowPhase()
+{
+	srand(50);
+
+	// Overlaps, skipping pairs within a hundredth of a pixel of touching
+	{
+		int tested = 0, overlapping = 0, wrong = 0;
+		for (int i = 0; i < 20000; i++)
+		{
+			TransformComponent transforms[2] = {};
+			RenderComponent renders[2] = {};
+			for (int s = 0; s < 2; s++)
+			{
+				transforms[s].x = float(rand() % 2000) / 10;
+				transforms[s].y = float(rand() % 2000) / 10;
+				transforms[s].rotation = float(rand() % 3600) / 10;
+				transforms[s].scale = 0.5f + float(rand() % 100) / 100;
+				renders[s].regionRight = 1 + rand() % 100;
+				renders[s].regionBottom = 1 + rand() % 100;
+				renders[s].originX = float(rand() % renders[s].regionRight);
+				renders[s].originY = float(rand() % renders[s].regionBottom);
+			}
+
+			OrientedBox a = OrientedBox::FromSprite(transforms[0], renders[0]);
+			OrientedBox b = OrientedBox::FromSprite(transforms[1], renders[1]);
+			if (Grown(a, 0.01f).Overlaps(Grown(b, 0.01f)) != Grown(a, -0.01f).Overlaps(Grown(b, -0.01f)))
+				continue;
+
+			bool overlaps = a.Overlaps(b);
+			tested++;
+			overlapping += overlaps;
+			wrong += overlaps != QuadsOverlap(a, b) || overlaps != b.Overlaps(a);
+		}
+
+		CHECK(wrong == 0);
+		CHECK(overlapping > tested / 10 && overlapping < tested * 9 / 10); // Both answers were tried
+	}
+
+	// A sheet wider than 64 texels, so its rows cross words, and a one texel solid probe
+	static TestSheet sheet, probe;
+	FillSheet(sheet, 70, 20);
+	probe.width = probe.height = 1;
+	probe.texels.assign(4, 255);
+
+	NarrowPhaseType narrowPhase;
+	narrowPhase.SetMode(NarrowPhaseType::PixelMasks);
+	CHECK(narrowPhase.AddMask(&sheet.texture, sheet.width, sheet.height, &sheet.texels[0], size_t(sheet.width) * 4));
+	CHECK(narrowPhase.AddMask(&probe.texture, 1, 1, &probe.texels[0], 4));
+	CHECK(!narrowPhase.AddMask(&probe.texture, 1, 1, &probe.texels[0], 4)); // Already has one
+
+	// The probe touches a sheet sprite exactly where the sprite's rotated mask has a solid pixel, so
+	// walking it over the screen reads the mask back. Unturned the mask is the sheet, a quarter turn
+	// takes texel u, v to the pixel v + 1 left of the position and u down from it
+	for (int quarter = 0; quarter < 2; quarter++)
+	{
+		TransformComponent transform = { 100, 100, quarter * 90.0f, 1 };
+		narrowPhase.SetPlayer(transform, SheetSprite(sheet, 0, 0));
+
+		int wrong = 0, solid = 0, touched = 0;
+		for (int v = 0; v < sheet.height; v++)
+		{
+			for (int u = 0; u < sheet.width; u++)
+			{
+				TransformComponent at = { float(quarter == 0 ? 100 + u : 100 - v - 1), float(quarter == 0 ? 100 + v : 100 + u), 0, 1 };
+				wrong += narrowPhase.Touches(at, SheetSprite(probe, 0, 0)) != sheet.IsSolid(u, v);
+				solid += sheet.IsSolid(u, v);
+			}
+		}
+
+		for (int y = 0; y < 200; y++)
+		{
+			for (int x = 0; x < 200; x++)
+			{
+				TransformComponent at = { float(x), float(y), 0, 1 };
+				touched += narrowPhase.Touches(at, SheetSprite(probe, 0, 0));
+			}
+		}
+
+		CHECK(wrong == 0);
+		CHECK(touched == solid); // And nowhere else
+	}
+
+	// Turned and scaled sprites against each other, both masks read one pixel at a time. The
+	// narrow phase only looks at the masks of boxes that touch
+	{
+		int touching = 0, wrong = 0;
+		for (int i = 0; i < 3000; i++)
+		{
+			TransformComponent a = { float(100 + rand() % 60), float(100 + rand() % 60), float(rand() % 720 - 360), 0.5f + float(rand() % 100) / 100 };
+			TransformComponent b = { float(80 + rand() % 100) + 0.25f, float(80 + rand() % 100) + 0.75f, float(rand() % 360), 0.5f + float(rand() % 100) / 100 };
+			RenderComponent aRender = SheetSprite(sheet, float(rand() % 70), 10);
+			RenderComponent bRender = SheetSprite(sheet, 35, float(rand() % 20));
+
+			narrowPhase.SetPlayer(a, aRender);
+			bool touches = narrowPhase.Touches(b, bRender);
+
+			bool expected = OrientedBox::FromSprite(a, aRender).Overlaps(OrientedBox::FromSprite(b, bRender));
+			if (expected)
+			{
+				expected = false;
+				for (int y = 0; y < 300 && !expected; y++)
+				{
+					for (int x = 0; x < 300 && !expected; x++)
+						expected = SolidAt(sheet, a, aRender, x, y) && SolidAt(sheet, b, bRender, x, y);
+				}
+			}
+
+			touching += touches;
+			wrong += touches != expected;
+		}
+
+		CHECK(wrong == 0);
+		CHECK(touching > 100);
+		CHECK(narrowPhase.GetCachedMaskCount() < 3000 * 2); // Masks were found in the cache as well as built
+	}
+}
+
+// -----------------------------------------------------------------------------
+// FNV-1a over some bytes, carrying on from hash
+static uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+{
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= ((const uint8_t*)data)[i];
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+// -----------------------------------------------------------------------------
+// Play a fixed point game from a seed with a set script of clicks, hashing the player, the
+// game values and every obstacle and item after each tick
+static uint64_t PlayFixedGame(const HeadlessConfig& config, uint32_t seed, int ticks, int& endTick, int& endScore)
+{
+	FixedHeadlessGameType game;
+	game.Start(&config, seed);
+
+	uint64_t hash = 14695981039346656037ull;
+	uint32_t random = seed * 2654435761u + 1; // xorshift for the clicks, none of the pinned seeds start it at 0
+
+	for (int tick = 0; tick < ticks && !game.IsOver(); tick++)
+	{
+		random ^= random << 13;
+		random ^= random >> 17;
+		random ^= random << 5;
+		game.Step(FixedHeadlessGameType::Action(random % 6 == 0 ? (random >> 3) % FixedHeadlessGameType::ACTION_COUNT : FixedHeadlessGameType::Wait));
+
+		int values[] = { game.GetTick(), game.GetScore(), game.GetLives(), game.GetVine(), game.GetItemCombo(), game.GetItemLevel(),
+			game.GetObstacleLevel(), game.GetObstacleCount(), game.GetItemCount(), game.GetDeathCause() };
+		float positions[] = { game.GetKoalaX(), game.GetKoalaY(), game.GetObstacleSpeed() };
+		hash = HashBytes(hash, values, sizeof(values));
+		hash = HashBytes(hash, positions, sizeof(positions));
+
+		for (int i = 0; i < game.GetObstacleCount(); i++)
+		{
+			float box[6];
+			int kind = game.GetObstacle(i, box[0], box[1], box[2], box[3], box[4], box[5]);
+			hash = HashBytes(hash, &kind, sizeof(kind));
+			hash = HashBytes(hash, box, sizeof(box));
+		}
+
+		for (int i = 0; i < game.GetItemCount(); i++)
+		{
+			float box[4];
+			int ticksLeft;
+			game.GetItem(i, box[0], box[1], box[2], box[3], ticksLeft);
+			hash = HashBytes(hash, box, sizeof(box));
+			hash = HashBytes(hash, &ticksLeft, sizeof(ticksLeft));
+		}
+	}
+
+	endTick = game.GetTick();
+	endScore = game.GetScore();
+
+	return hash;
+}
+
+// -----------------------------------------------------------------------------
+// Fixed point games play out to the same bits everywhere, so their hashes are pinned. A
+// change to the rules changes them too, and then they are pinned again from this output
+static void CheckFixedHeadlessGame()
+{
+	struct PinnedGame
+	{
+		uint32_t seed;
+		int endTick, endScore;
+		uint64_t hash;
+	};
+
+	static const PinnedGame pinned[] =
+	{
+		{ 1, 933, 1160, 0xfe2b56890325a38cull },
+		{ 42, 664, 720, 0x47284e3e2bacc14cull },
+		{ 2024, 759, 1260, 0x326e360abc9ec8b2ull },
+	};
+
+	HeadlessConfig config;
+	FixedHeadlessGameType::SetDefaults(config);
+
+	for (const PinnedGame& game : pinned)
+	{
+		int endTick, endScore;
+		uint64_t hash = PlayFixedGame(config, game.seed, 60 * 60 * 5, endTick, endScore);
+
+		bool same = hash == game.hash && endTick == game.endTick && endScore == game.endScore;
+		CHECK(same);
+		if (!same)
+			printf("Fixed point game seed %u: { %u, %d, %d, 0x%016llxull }\n", game.seed, game.seed, endTick, endScore, (unsigned long long)hash);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Batched games play the same as HeadlessGameTypes with the same seeds and actions,
+// including the games they start again once one ends
+static void CheckBatchEnvironment()
+{
+	const int GAMES = BatchEnvironmentType::LANES * 2; // Whole groups, so no filler game ends and takes a seed
+	const uint32_t FIRST_SEED = 100;
+	const int TICKS = 60 * 60; // Every game has ended and started again well before this
+
+	HeadlessConfig config;
+	HeadlessGameType::SetDefaults(config);
+
+	BatchEnvironmentType batch;
+	batch.Initialize(&config, GAMES, FIRST_SEED);
+
+	HeadlessGameType games[GAMES];
+	for (int game = 0; game < GAMES; game++)
+		games[game].Start(&config, FIRST_SEED + game);
+	uint32_t nextSeed = FIRST_SEED + GAMES;
+
+	uint8_t actions[GAMES];
+	uint32_t random = 12345; // xorshift, clicks on about one tick in eight
+	int restarts[GAMES] = {};
+	int mismatches = 0;
+	int firstMismatch = -1;
+
+	for (int tick = 0; tick < TICKS && mismatches == 0; tick++)
+	{
+		for (int game = 0; game < GAMES; game++)
+		{
+			random ^= random << 13;
+			random ^= random >> 17;
+			random ^= random << 5;
+			actions[game] = uint8_t(random % 8 == 0 ? (random >> 3) % HeadlessGameType::ACTION_COUNT : HeadlessGameType::Wait);
+		}
+
+		batch.Step(actions);
+
+		for (int game = 0; game < GAMES; game++)
+		{
+			games[game].Step(HeadlessGameType::Action(actions[game]));
+
+			bool ended = games[game].IsOver();
+			if (ended)
+			{
+				games[game].Start(&config, nextSeed++); // The batch hands out seeds in game order
+				restarts[game]++;
+			}
+
+			bool same = ended == (batch.GetDone()[game] != 0) &&
+				games[game].GetScore() == batch.GetScores()[game] &&
+				games[game].GetLives() == batch.GetLives()[game] &&
+				games[game].GetTick() == batch.GetTicks()[game] &&
+				games[game].GetObstacleCount() == batch.GetObstacleCounts()[game] &&
+				games[game].GetVine() == batch.GetVines()[game] &&
+				games[game].GetKoalaY() == batch.GetKoalaY()[game];
+			if (!same && mismatches++ == 0)
+				firstMismatch = tick;
+		}
+	}
+
+	CHECK(mismatches == 0);
+	if (mismatches != 0)
+		printf("Batch and headless games first differ on tick %d\n", firstMismatch);
+
+	for (int game = 0; game < GAMES; game++)
+		CHECK(restarts[game] > 0); // Every game went through at least one start again
+}
+
+// -----------------------------------------------------------------------------
+// A made up game for row i of a results store
+static GameResult MakeResult(int i)
+{
+	GameResult result;
+	result.seed = uint32_t(1000 + i);
+	result.paramSet = i / 5000;
+	result.ticks = 600 + (i * 37) % 5000;
+	result.score = (i * 7919) % 20000;
+	result.maxItemCombo = 100 + i % 400;
+	result.deathCause = i % 7 == 0 ? ResultsFormat::StillAlive : i % OBSTACLE_KIND_COUNT;
+	for (int kind = 0; kind < OBSTACLE_KIND_COUNT; kind++)
+		result.obstacles[kind] = (i + kind) % 9;
+
+	return result;
+}
+
+// -----------------------------------------------------------------------------
+// Read a whole file, empty if it isn't there
+static std::vector<uint8_t> ReadFile(const char* fileName)
+{
+	std::vector<uint8_t> bytes;
+	FILE* file = fopen(fileName, "rb");
+	if (file == NULL)
+		return bytes;
+
+	uint8_t buffer[4096];
+	size_t read;
+	while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		bytes.insert(bytes.end(), buffer, buffer + read);
+	fclose(file);
+
+	return bytes;
+}
+
+// -----------------------------------------------------------------------------
+// Write bytes over a file
+static void WriteFile(const char* fileName, const std::vector<uint8_t>& bytes)
+{
+	FILE* file = fopen(fileName, "wb");
+	if (file == NULL)
+		return;
+
+	fwrite(bytes.data(), 1, bytes.size(), file);
+	fclose(file);
+}
+
+// -----------------------------------------------------------------------------
+// Walk a store's blocks the way ResultsQuery does, decode every row and check it is the
+// made up game for its row. Returns the rows in whole blocks
+static long long CheckStoreRows(const std::vector<uint8_t>& bytes)
+{
+	long long rows = 0;
+	int wrong = 0;
+	std::vector<int64_t> values[ResultsFormat::COLUMN_COUNT];
+	for (int c = 0; c < ResultsFormat::COLUMN_COUNT; c++)
+		values[c].resize(ResultsFormat::BLOCK_ROWS);
+
+	size_t offset = sizeof(ResultsFileHeader);
+	while (offset + sizeof(ResultsBlockHeader) <= bytes.size())
+	{
+		const ResultsBlockHeader& block = *(const ResultsBlockHeader*)(bytes.data() + offset);
+		if (!IsResultsBlockWhole(block, bytes.size() - offset))
+			break;
+
+		const uint8_t* data = bytes.data() + offset + sizeof(ResultsBlockHeader);
+		for (int c = 0; c < ResultsFormat::COLUMN_COUNT; c++)
+		{
+			DecodeResultsColumn(block.columns[c], data, int(block.rowCount), values[c].data());
+			data += block.columns[c].bytes;
+		}
+
+		for (int i = 0; i < int(block.rowCount); i++)
+		{
+			GameResult expected = MakeResult(int(rows + i));
+			int64_t row[ResultsFormat::COLUMN_COUNT] = { expected.seed, expected.paramSet, expected.ticks, expected.score, expected.maxItemCombo, expected.deathCause,
+				expected.obstacles[0], expected.obstacles[1], expected.obstacles[2], expected.obstacles[3] };
+			for (int c = 0; c < ResultsFormat::COLUMN_COUNT; c++)
+				wrong += values[c][i] != row[c];
+		}
+
+		rows += block.rowCount;
+		offset += size_t(block.bytes);
+	}
+
+	CHECK(wrong == 0);
+	return rows;
+}
+
+// -----------------------------------------------------------------------------
+// Rows written to a results store come back the same, and reopening a store cuts off a
+// torn or damaged last block whatever its header says
+static void CheckResultsStore()
+{
+	const char* FILE_NAME = "KoalaChecksResults.tmp";
+	const int ROWS = ResultsFormat::BLOCK_ROWS + 1000; // A full block and a short one
+
+	remove(FILE_NAME);
+
+	ResultsStoreType* store = new ResultsStoreType();
+	CHECK(store->Open(FILE_NAME));
+	for (int i = 0; i < ROWS; i++)
+		store->Append(MakeResult(i));
+	store->Close();
+
+	std::vector<uint8_t> whole = ReadFile(FILE_NAME);
+	CHECK(CheckStoreRows(whole) == ROWS);
+
+	CHECK(store->Open(FILE_NAME));
+	CHECK(store->GetRowCount() == ROWS);
+	CHECK(store->GetFileBytes() == (long long)whole.size());
+	store->Close();
+
+	// Where the short block starts, everything after it is the block to tear
+	size_t lastBlock = sizeof(ResultsFileHeader) + size_t(((const ResultsBlockHeader*)(whole.data() + sizeof(ResultsFileHeader)))->bytes);
+
+	// The last block cut short, as a killed run leaves it
+	std::vector<uint8_t> torn(whole.begin(), whole.end() - 10);
+	// A header that claims no bytes, which would never move a reader on
+	std::vector<uint8_t> zero = whole;
+	((ResultsBlockHeader*)(zero.data() + lastBlock))->bytes = 0;
+	// A header shorter than itself, which would put the walk out of step
+	std::vector<uint8_t> shortBlock = whole;
+	((ResultsBlockHeader*)(shortBlock.data() + lastBlock))->bytes = sizeof(ResultsBlockHeader) - 8;
+	// Columns that add up to more than the block
+	std::vector<uint8_t> columns = whole;
+	((ResultsBlockHeader*)(columns.data() + lastBlock))->columns[ResultsFormat::Score].bytes += 1;
+
+	const std::vector<uint8_t>* damaged[] = { &torn, &zero, &shortBlock, &columns };
+	for (const std::vector<uint8_t>* bytes : damaged)
+	{
+		CHECK(CheckStoreRows(*bytes) == ResultsFormat::BLOCK_ROWS);
+
+		WriteFile(FILE_NAME, *bytes);
+		CHECK(store->Open(FILE_NAME));
+		CHECK(store->GetRowCount() == ResultsFormat::BLOCK_ROWS);
+		CHECK(store->GetFileBytes() == (long long)lastBlock);
+
+		// Adding to it again carries on from the whole block
+		for (int i = ResultsFormat::BLOCK_ROWS; i < ROWS; i++)
+			store->Append(MakeResult(i));
+		store->Close();
+
+		CHECK(ReadFile(FILE_NAME) == whole);
+	}
+
+	delete store;
+	remove(FILE_NAME);
+}
+
+// -----------------------------------------------------------------------------
+// Play a game with the autoplayer for a number of ticks, deciding every SEGMENT_TICKS
+static void PlayAutoplayer(AutoplayerType& autoplayer, const HeadlessConfig& config, uint32_t seed, int ticks)
+{
+	ManualClockType clock; // Never moves, so no decision runs out of time and every pass decides the same
+	HeadlessGameType game;
+	game.Start(&config, seed);
+
+	HeadlessGameType::Action action = HeadlessGameType::Wait;
+	for (int tick = 0; tick < ticks && !game.IsOver(); tick++)
+	{
+		if (tick % AutoplayerType::SEGMENT_TICKS == 0)
+			action = autoplayer.Decide(game, clock);
+		game.Step(action);
+		action = HeadlessGameType::Wait;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Steady-state mode counts what job workers allocate, and a warmed up loop allocates nothing
+static void CheckSteadyState()
+{
+#ifdef ALLOC_TRACKING_ENABLED
+	// Allocations in a ParallelFor count whichever thread runs the piece
+	{
+		JobSystemType jobs;
+		jobs.Start(3);
+
+		const int COUNT = 64;
+		std::vector<int*> blocks(COUNT); // Kept until the section ends, so none of the allocations can be left out
+		AllocTrackerType::ExpectNoAllocations(true, false);
+		jobs.ParallelFor(COUNT, 1, [&](int begin, int end)
+		{
+			for (int i = begin; i < end; i++)
+			{
+				blocks[i] = new int(i);
+				std::this_thread::sleep_for(std::chrono::milliseconds(1)); // Long enough that the workers take pieces
+			}
+		});
+		AllocTrackerType::ExpectNoAllocations(false);
+
+		CHECK(AllocTrackerType::GetUnexpectedAllocations() == COUNT);
+		for (int i = 0; i < COUNT; i++)
+			delete blocks[i];
+		jobs.Stop();
+	}
+
+	// The second pass over the same game finds the arenas already big enough, so it asserts on any allocation
+	{
+		HeadlessConfig config;
+		HeadlessGameType::SetDefaults(config);
+
+		AutoplayerType* autoplayer = new AutoplayerType();
+		PlayAutoplayer(*autoplayer, config, 7, 600);
+
+		AllocTrackerType::ExpectNoAllocations(true);
+		PlayAutoplayer(*autoplayer, config, 7, 600);
+		AllocTrackerType::ExpectNoAllocations(false);
+
+		CHECK(AllocTrackerType::GetUnexpectedAllocations() == 0);
+		CHECK(autoplayer->GetDecisionCount() > 0);
+		delete autoplayer;
+	}
+#else
+	printf("Steady-state checks skipped, the allocation tracker is only in debug builds\n");
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Run every check, the exit code is how many failed
+int main()
+{
+	CheckFramePacer();
+	CheckNarrowPhase();
+	CheckSteadyState();
+	CheckFixedHeadlessGame();
+	CheckBatchEnvironment();
+	CheckResultsStore();
+
+	if (failures == 0)
+		printf("All checks passed\n");
+	else
+		printf("%d checks failed\n", failures);
+
+	return failures;
+}
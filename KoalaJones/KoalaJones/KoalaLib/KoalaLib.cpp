@@ -0,0 +1,318 @@
+/*
+
+libkoala
+The C interface in KoalaLib.h over HeadlessGameType. Everything a game uses is in its
+KoalaGame, including the config its HeadlessGameType points at, so games share nothing.
+A game in fixed point plays FixedHeadlessGameType instead, the rest is the same.
+
+The KoalaLib project defines KOALA_BUILDING_LIBRARY, so KoalaLib.h exports rather than
+imports. Other platforms export by visibility and don't need it.
+
+*/
+
+#include "KoalaLib.h"
+
+#include <new>
+#include <cstring>
+#include "HeadlessGameType.h"
+
+static const int DEFAULT_ROWS = 24; // 32 pixel bands
+static const float SCREEN_HEIGHT = 768;
+
+static_assert(KOALA_MAX_OBSTACLES == HeadlessGameType::MAX_OBSTACLES, "KoalaObstacleArrays must hold every obstacle");
+static_assert(KOALA_MAX_ITEMS == HeadlessGameType::MAX_ITEMS, "KoalaObstacleArrays must hold every item");
+static_assert(KOALA_MAX_VINES == HeadlessConfig::MAX_VINES, "KoalaGrid must have a lane for every vine");
+static_assert(KOALA_KIND_COUNT == OBSTACLE_KIND_COUNT, "KoalaKind must match EntityKind");
+
+struct KoalaGame
+{
+	HeadlessConfig headlessConfig;
+	KoalaConfig config;
+	HeadlessGameType game;
+	FixedHeadlessGameType fixedGame; // Played instead when config.fixedPoint is set
+
+	int done; // KoalaDone, kept until reset
+
+	void* observation; // Where observations are written, ownObservation or the caller's
+	void* ownObservation;
+};
+
+// -----------------------------------------------------------------------------
+// Band of the screen a y is in, clamped to the grid
+static int GetRow(float y, int rows)
+{
+	int row = int(y * rows / SCREEN_HEIGHT);
+	return row < 0 ? 0 : (row >= rows ? rows - 1 : row);
+}
+
+// -----------------------------------------------------------------------------
+// Set a bit in the rows a box covers in every lane whose koala column it overlaps
+static void MarkBox(KoalaGrid& grid, const HeadlessConfig& config, float x, float y, float halfWidth, float halfHeight, uint8_t bit)
+{
+	if (y + halfHeight < 0 || y - halfHeight > SCREEN_HEIGHT)
+		return; // Off the screen
+
+	int firstRow = GetRow(y - halfHeight, grid.rows);
+	int lastRow = GetRow(y + halfHeight, grid.rows);
+
+	for (int lane = 0; lane < grid.lanes; lane++)
+	{
+		// The koala's box on that vine, worked out as HeadlessGameType does
+		float left = float(int(config.vineX[lane] - (config.koalaWidth >> 1)));
+		float right = left + config.koalaWidth;
+
+		if (x + halfWidth < left || x - halfWidth > right)
+			continue;
+
+		uint8_t* cells = &grid.cells[lane * grid.rows];
+		for (int row = firstRow; row <= lastRow; row++)
+			cells[row] |= bit;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Write the game as it is now into the observation buffer
+template <typename Game>
+static void Observe(KoalaGame& koala, const Game& game)
+{
+	if (koala.config.observation == KOALA_OBSERVE_GRID)
+	{
+		KoalaGrid& grid = *(KoalaGrid*)koala.observation;
+		grid.lanes = koala.headlessConfig.vineCount;
+		grid.rows = koala.config.gridRows;
+		memset(grid.cells, 0, sizeof(grid.cells));
+
+		for (int i = 0; i < game.GetObstacleCount(); i++)
+		{
+			float x, y, stepX, stepY, halfWidth, halfHeight;
+			EntityKind::Kind kind = game.GetObstacle(i, x, y, stepX, stepY, halfWidth, halfHeight);
+			MarkBox(grid, koala.headlessConfig, x, y, halfWidth, halfHeight, uint8_t(1 << kind));
+		}
+
+		for (int i = 0; i < game.GetItemCount(); i++)
+		{
+			float x, y, halfWidth, halfHeight;
+			int ticksLeft;
+			game.GetItem(i, x, y, halfWidth, halfHeight, ticksLeft);
+			MarkBox(grid, koala.headlessConfig, x, y, halfWidth, halfHeight, KOALA_CELL_ITEM);
+		}
+
+		int halfHeight = koala.headlessConfig.koalaHeight >> 1;
+		uint8_t* cells = &grid.cells[game.GetVine() * grid.rows];
+		for (int row = GetRow(game.GetKoalaY() - halfHeight, grid.rows); row <= GetRow(game.GetKoalaY() + halfHeight, grid.rows); row++)
+			cells[row] |= KOALA_CELL_KOALA;
+	}
+	else if (koala.config.observation == KOALA_OBSERVE_ARRAYS)
+	{
+		KoalaObstacleArrays& arrays = *(KoalaObstacleArrays*)koala.observation;
+
+		arrays.obstacleCount = game.GetObstacleCount();
+		for (int i = 0; i < arrays.obstacleCount; i++)
+			arrays.kind[i] = game.GetObstacle(i, arrays.x[i], arrays.y[i], arrays.stepX[i], arrays.stepY[i], arrays.halfWidth[i], arrays.halfHeight[i]);
+
+		arrays.itemCount = game.GetItemCount();
+		for (int i = 0; i < arrays.itemCount; i++)
+			game.GetItem(i, arrays.itemX[i], arrays.itemY[i], arrays.itemHalfWidth[i], arrays.itemHalfHeight[i], arrays.itemTicksLeft[i]);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Observe whichever game is being played
+static void Observe(KoalaGame& koala)
+{
+	if (koala.config.fixedPoint)
+		Observe(koala, koala.fixedGame);
+	else
+		Observe(koala, koala.game);
+}
+
+// -----------------------------------------------------------------------------
+// Copy out a game's state
+template <typename Game>
+static void GetInfo(const Game& headless, KoalaInfo* info)
+{
+	info->tick = headless.GetTick();
+	info->score = headless.GetScore();
+	info->lives = headless.GetLives();
+	info->vine = headless.GetVine();
+	info->koalaX = headless.GetKoalaX();
+	info->koalaY = headless.GetKoalaY();
+	info->graceTicks = headless.GetGraceTicks();
+	info->itemCombo = headless.GetItemCombo();
+	info->itemLevel = headless.GetItemLevel();
+	info->obstacleLevel = headless.GetObstacleLevel();
+	info->obstacleSpeed = headless.GetObstacleSpeed();
+	info->obstacleCount = headless.GetObstacleCount();
+	info->itemCount = headless.GetItemCount();
+	info->deathCause = headless.GetDeathCause();
+}
+
+// -----------------------------------------------------------------------------
+// For callers that load the library at run time and can't see the header's KOALA_VERSION
+int koala_version(void)
+{
+	return KOALA_VERSION;
+}
+
+// -----------------------------------------------------------------------------
+// The grid, which is the smaller observation
+void koala_default_config(KoalaConfig* config)
+{
+	config->size = sizeof(KoalaConfig);
+	config->observation = KOALA_OBSERVE_GRID;
+	config->gridRows = DEFAULT_ROWS;
+	config->spawning = 1;
+	config->maxTicks = 0;
+	config->fixedPoint = 0;
+}
+
+// -----------------------------------------------------------------------------
+// The whole struct for either observation, so a buffer never depends on the row count
+size_t koala_observation_size(const KoalaConfig* config)
+{
+	int observation = config != NULL ? config->observation : KOALA_OBSERVE_GRID;
+
+	switch (observation)
+	{
+	case KOALA_OBSERVE_GRID:
+		return sizeof(KoalaGrid);
+	case KOALA_OBSERVE_ARRAYS:
+		return sizeof(KoalaObstacleArrays);
+	default:
+		return 0;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// The only allocations a game makes, itself and its own observation buffer
+KoalaGame* koala_create(uint32_t seed, const KoalaConfig* config)
+{
+	if (config != NULL && config->size != sizeof(KoalaConfig))
+		return NULL; // Built against another version, its fields aren't where this library expects them
+
+	KoalaGame* koala = new (std::nothrow) KoalaGame;
+	if (koala == NULL)
+		return NULL;
+
+	if (config != NULL)
+		koala->config = *config;
+	else
+		koala_default_config(&koala->config);
+
+	if (koala->config.gridRows < 1 || koala->config.gridRows > KOALA_MAX_ROWS)
+		koala->config.gridRows = DEFAULT_ROWS;
+
+	HeadlessGameType::SetDefaults(koala->headlessConfig);
+	koala->headlessConfig.spawning = koala->config.spawning != 0;
+
+	size_t bytes = koala_observation_size(&koala->config);
+	koala->ownObservation = bytes > 0 ? new (std::nothrow) uint32_t[(bytes + 3) / 4] : NULL;
+	if (bytes > 0 && koala->ownObservation == NULL)
+	{
+		delete koala;
+		return NULL;
+	}
+	koala->observation = koala->ownObservation;
+
+	koala_reset(koala, seed);
+
+	return koala;
+}
+
+// -----------------------------------------------------------------------------
+// Free the game and its own buffer, never the caller's
+void koala_destroy(KoalaGame* game)
+{
+	if (game == NULL)
+		return;
+
+	delete[] (uint32_t*)game->ownObservation;
+	delete game;
+}
+
+// -----------------------------------------------------------------------------
+// A new game from the starting values
+void koala_reset(KoalaGame* game, uint32_t seed)
+{
+	if (game == NULL)
+		return;
+
+	if (game->config.fixedPoint)
+		game->fixedGame.Start(&game->headlessConfig, seed);
+	else
+		game->game.Start(&game->headlessConfig, seed);
+	game->done = KOALA_RUNNING;
+
+	if (game->observation != NULL)
+		Observe(*game);
+}
+
+// -----------------------------------------------------------------------------
+// Step, then write the observation. A game that is already done isn't stepped
+int koala_step(KoalaGame* game, int action, float* reward, KoalaInfo* info)
+{
+	if (game == NULL || action < 0 || action >= KOALA_ACTION_COUNT)
+		return KOALA_ERROR;
+
+	bool fixedPoint = game->config.fixedPoint != 0;
+	int scoreBefore = fixedPoint ? game->fixedGame.GetScore() : game->game.GetScore();
+
+	if (game->done == KOALA_RUNNING)
+	{
+		if (fixedPoint)
+			game->fixedGame.Step(FixedHeadlessGameType::Action(action));
+		else
+			game->game.Step(HeadlessGameType::Action(action));
+
+		bool over = fixedPoint ? game->fixedGame.IsOver() : game->game.IsOver();
+		int tick = fixedPoint ? game->fixedGame.GetTick() : game->game.GetTick();
+
+		if (over)
+			game->done = KOALA_GAME_OVER;
+		else if (game->config.maxTicks > 0 && tick >= game->config.maxTicks)
+			game->done = KOALA_TIME_UP;
+
+		if (game->observation != NULL)
+			Observe(*game);
+	}
+
+	if (reward != NULL)
+		*reward = float((fixedPoint ? game->fixedGame.GetScore() : game->game.GetScore()) - scoreBefore);
+	if (info != NULL)
+		koala_get_info(game, info);
+
+	return game->done;
+}
+
+// -----------------------------------------------------------------------------
+// Copy out the game's state
+void koala_get_info(const KoalaGame* game, KoalaInfo* info)
+{
+	if (game == NULL || info == NULL)
+		return;
+
+	if (game->config.fixedPoint)
+		GetInfo(game->fixedGame, info);
+	else
+		GetInfo(game->game, info);
+}
+
+// -----------------------------------------------------------------------------
+// Swap buffers and fill the new one in, so it is ready to read without a step
+void koala_set_observation(KoalaGame* game, void* buffer)
+{
+	if (game == NULL)
+		return;
+
+	game->observation = buffer != NULL ? buffer : game->ownObservation;
+
+	if (game->observation != NULL)
+		Observe(*game);
+}
+
+// -----------------------------------------------------------------------------
+// The buffer in use
+const void* koala_get_observation(const KoalaGame* game)
+{
+	return game != NULL ? game->observation : NULL;
+}
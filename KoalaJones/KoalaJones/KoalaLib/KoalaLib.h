@@ -0,0 +1,159 @@
+#pragma once
+/*
+
+libkoala
+The headless game behind a plain C interface, for training and analysis tools that drive
+the game from outside: Python through ctypes or cffi, or anything else that can call C.
+
+Each KoalaGame is independent and owns all of its state, so different games can be used
+from different threads at the same time. One game must not be used from two threads at
+once.
+
+The observation is written in place on reset and after every step, into a buffer the
+library allocates when the game is created or one the caller hands over with
+koala_set_observation. Stepping never allocates and nothing is copied out: read the
+buffer after each step.
+
+Observations (see KoalaObservation):
+- KOALA_OBSERVE_GRID: a lane by row grid of bytes, one lane per vine. A cell's bits say
+  which kinds of obstacle, or an item, overlap the koala's column on that vine in that band
+  of the screen, so a set bit is somewhere the koala would be hit.
+- KOALA_OBSERVE_ARRAYS: the obstacles and items as they are, one array per field.
+
+KoalaConfig grows as the library does. It starts with its size, which koala_default_config
+fills in, and koala_create turns down a config whose size isn't this library's, rather than
+read past the end of an older one. koala_version says which KOALA_VERSION a loaded library
+is, so a caller can check before it builds a config.
+
+Building on Linux, from this directory:
+	g++ -std=c++17 -O2 -shared -fPIC -fvisibility=hidden -I../Assignment4StartPoint KoalaLib.cpp
+		../Assignment4StartPoint/HeadlessGameType.cpp ../Assignment4StartPoint/FrameArenaType.cpp -o libkoala.so
+On Windows build the KoalaLib project, which makes koala.dll.
+
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#ifdef KOALA_BUILDING_LIBRARY
+#define KOALA_API __declspec(dllexport)
+#else
+#define KOALA_API __declspec(dllimport)
+#endif
+#else
+#define KOALA_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KOALA_VERSION 3
+
+#define KOALA_MAX_VINES 8
+#define KOALA_MAX_ROWS 64
+#define KOALA_MAX_OBSTACLES 128 // HeadlessGameType::MAX_OBSTACLES
+#define KOALA_MAX_ITEMS 4 // HeadlessGameType::MAX_ITEMS
+
+typedef struct KoalaGame KoalaGame;
+
+// what the koala can do on a tick, each is one click in the game
+typedef enum KoalaAction { KOALA_WAIT, KOALA_UP, KOALA_DOWN, KOALA_LEFT, KOALA_RIGHT, KOALA_ACTION_COUNT } KoalaAction;
+
+// obstacle kinds, as EntityKind
+typedef enum KoalaKind { KOALA_ROCK, KOALA_FIREBALL, KOALA_DART, KOALA_SNAKE, KOALA_KIND_COUNT } KoalaKind;
+
+typedef enum KoalaObservationType { KOALA_OBSERVE_NONE, KOALA_OBSERVE_GRID, KOALA_OBSERVE_ARRAYS } KoalaObservationType;
+
+// bits of a grid cell, one for each obstacle kind (1 << kind), and these
+#define KOALA_CELL_ITEM 0x10
+#define KOALA_CELL_KOALA 0x20
+
+// what koala_step returns
+typedef enum KoalaDone { KOALA_RUNNING, KOALA_GAME_OVER, KOALA_TIME_UP, KOALA_ERROR = -1 } KoalaDone;
+
+typedef struct KoalaConfig
+{
+	uint32_t size; // sizeof(KoalaConfig), set by koala_default_config
+	int observation; // KoalaObservationType
+	int gridRows; // Bands the screen is split into for the grid, up to KOALA_MAX_ROWS
+	int spawning; // 0 for no random spawns or level changes, only what is already there moves
+	int maxTicks; // Steps before an episode stops with KOALA_TIME_UP, 0 for no limit
+	int fixedPoint; // 1 to play in 16.16 fixed point, which plays a seed out to the same bits on every platform and build
+} KoalaConfig;
+
+// how the game is going, filled in by koala_step and koala_get_info
+typedef struct KoalaInfo
+{
+	int tick;
+	int score;
+	int lives;
+	int vine;
+	float koalaX, koalaY;
+	int graceTicks; // Ticks left of invulnerability after a hit
+	int itemCombo;
+	int itemLevel;
+	int obstacleLevel;
+	float obstacleSpeed;
+	int obstacleCount;
+	int itemCount;
+	int deathCause; // KoalaKind that took the last life, -1 while the game is going
+} KoalaInfo;
+
+// KOALA_OBSERVE_ARRAYS, the first count entries of each array are in use
+typedef struct KoalaObstacleArrays
+{
+	int32_t obstacleCount;
+	int32_t kind[KOALA_MAX_OBSTACLES];
+	float x[KOALA_MAX_OBSTACLES], y[KOALA_MAX_OBSTACLES];
+	float stepX[KOALA_MAX_OBSTACLES], stepY[KOALA_MAX_OBSTACLES]; // Pixels each tick
+	float halfWidth[KOALA_MAX_OBSTACLES], halfHeight[KOALA_MAX_OBSTACLES];
+
+	int32_t itemCount;
+	float itemX[KOALA_MAX_ITEMS], itemY[KOALA_MAX_ITEMS];
+	float itemHalfWidth[KOALA_MAX_ITEMS], itemHalfHeight[KOALA_MAX_ITEMS];
+	int32_t itemTicksLeft[KOALA_MAX_ITEMS];
+} KoalaObstacleArrays;
+
+// KOALA_OBSERVE_GRID, cells[lane * rows + row] for lanes 0 to lanes - 1 left to right and rows top to bottom
+typedef struct KoalaGrid
+{
+	int32_t lanes, rows;
+	uint8_t cells[KOALA_MAX_VINES * KOALA_MAX_ROWS];
+} KoalaGrid;
+
+// the KOALA_VERSION the library was built with
+KOALA_API int koala_version(void);
+
+// fill in the size and the defaults: the grid with 24 rows, spawning on, no tick limit, floats
+KOALA_API void koala_default_config(KoalaConfig* config);
+
+// bytes an observation buffer needs for a config, 0 for KOALA_OBSERVE_NONE
+KOALA_API size_t koala_observation_size(const KoalaConfig* config);
+
+// make a game and start it, NULL config for the defaults. Returns NULL if it couldn't be made,
+// or if the config's size isn't sizeof(KoalaConfig)
+KOALA_API KoalaGame* koala_create(uint32_t seed, const KoalaConfig* config);
+KOALA_API void koala_destroy(KoalaGame* game);
+
+// start again with a seed, the same seed plays out the same for the same actions
+KOALA_API void koala_reset(KoalaGame* game, uint32_t seed);
+
+// one tick with the action taken at the start of it. Returns a KoalaDone, reward (score
+// gained) and info are filled in when they aren't NULL. A game that is done stays done until reset
+KOALA_API int koala_step(KoalaGame* game, int action, float* reward, KoalaInfo* info);
+
+KOALA_API void koala_get_info(const KoalaGame* game, KoalaInfo* info);
+
+// write observations into the caller's buffer from now on, at least koala_observation_size
+// bytes and aligned to 4. NULL goes back to the library's own buffer. The current state is
+// written into it straight away
+KOALA_API void koala_set_observation(KoalaGame* game, void* buffer);
+
+// the buffer observations are written into, a KoalaGrid or KoalaObstacleArrays
+KOALA_API const void* koala_get_observation(const KoalaGame* game);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,425 @@
+/*
+
+Results store query tool
+Reads a store of finished games written by ResultsStoreType and prints the count, minimum,
+maximum and mean of each column over the games that pass the filters, how the games
+ended, and the top scores.
+
+Usage: ResultsQuery <store> [filter ...] [top=K]
+A filter is a column, an operator (= != < <= > >=) and a whole number, such as score>=5000,
+death=3 or params=2. Columns: seed params ticks score maxcombo death rocks fireballs darts snakes
+
+The file is memory mapped and read a block at a time. A block whose minimum and maximum
+show that no game in it can pass the filters is skipped without being decoded. One where
+every game passes is counted from its statistics, and only the columns still needed (death
+causes, and the scores if the block could have a top score) are decoded.
+
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "ResultsFormat.h"
+#include "ComponentTypes.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+enum Operator { Equal, NotEqual, Less, LessOrEqual, Greater, GreaterOrEqual };
+
+// one column compared against a value
+struct Filter
+{
+	ResultsFormat::Column column;
+	Operator op;
+	int64_t value;
+};
+
+// which of a block's rows can pass a filter, from the block's statistics
+enum Coverage { NoRows, SomeRows, AllRows };
+
+// running totals for one column
+struct Aggregate
+{
+	long long count = 0;
+	int64_t minimum = 0, maximum = 0;
+	double sum = 0;
+
+	void Add(int64_t low, int64_t high, double total, long long rows)
+	{
+		if (count == 0 || low < minimum)
+			minimum = low;
+		if (count == 0 || high > maximum)
+			maximum = high;
+		sum += total;
+		count += rows;
+	}
+};
+
+// one of the best games
+struct TopScore
+{
+	int64_t score, seed, params, ticks;
+};
+
+// -----------------------------------------------------------------------------
+// A read only view of a whole file
+class MappedFile
+{
+	public:
+		const uint8_t* data = NULL;
+		long long size = 0;
+
+		bool Open(const char* fileName)
+		{
+#ifdef _WIN32
+			file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+			if (file == INVALID_HANDLE_VALUE)
+				return false;
+
+			LARGE_INTEGER fileSize;
+			GetFileSizeEx(file, &fileSize);
+			size = fileSize.QuadPart;
+
+			mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (mapping == NULL)
+				return false;
+
+			data = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0); // A 32-bit build can only map stores up to about 1GB
+#else
+			descriptor = open(fileName, O_RDONLY);
+			if (descriptor < 0)
+				return false;
+
+			struct stat status;
+			fstat(descriptor, &status);
+			size = status.st_size;
+
+			void* view = mmap(NULL, size_t(size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+			data = view != MAP_FAILED ? (const uint8_t*)view : NULL;
+			if (data != NULL)
+				madvise(view, size_t(size), MADV_SEQUENTIAL);
+#endif
+			return data != NULL;
+		}
+
+		~MappedFile()
+		{
+#ifdef _WIN32
+			if (data != NULL)
+				UnmapViewOfFile(data);
+			if (mapping != NULL)
+				CloseHandle(mapping);
+			if (file != INVALID_HANDLE_VALUE)
+				CloseHandle(file);
+#else
+			if (data != NULL)
+				munmap((void*)data, size_t(size));
+			if (descriptor >= 0)
+				close(descriptor);
+#endif
+		}
+
+	private:
+#ifdef _WIN32
+		HANDLE file = INVALID_HANDLE_VALUE;
+		HANDLE mapping = NULL;
+#else
+		int descriptor = -1;
+#endif
+};
+
+// -----------------------------------------------------------------------------
+// Read a filter such as score>=5000, false if it isn't one
+bool ParseFilter(const char* text, Filter& filter)
+{
+	static const char* operators[] = { "!=", "<=", ">=", "=", "<", ">" }; // Two character operators first
+	static const Operator ops[] = { NotEqual, LessOrEqual, GreaterOrEqual, Equal, Less, Greater };
+
+	for (int c = 0; c < ResultsFormat::COLUMN_COUNT; c++)
+	{
+		const char* name = ResultsFormat::GetColumnName(ResultsFormat::Column(c));
+		size_t length = strlen(name);
+		if (strncmp(text, name, length) != 0)
+			continue;
+
+		for (int o = 0; o < 6; o++)
+		{
+			size_t opLength = strlen(operators[o]);
+			if (strncmp(text + length, operators[o], opLength) == 0)
+			{
+				char* end;
+				filter.column = ResultsFormat::Column(c);
+				filter.op = ops[o];
+				filter.value = strtoll(text + length + opLength, &end, 10);
+				return *end == 0 && end != text + length + opLength;
+			}
+		}
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Does a value pass a filter
+bool Passes(const Filter& filter, int64_t value)
+{
+	switch (filter.op)
+	{
+	case Equal: return value == filter.value;
+	case NotEqual: return value != filter.value;
+	case Less: return value < filter.value;
+	case LessOrEqual: return value <= filter.value;
+	case Greater: return value > filter.value;
+	default: return value >= filter.value;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Which rows of a block with values from minimum to maximum can pass a filter
+Coverage GetCoverage(const Filter& filter, int64_t minimum, int64_t maximum)
+{
+	bool all, any;
+	switch (filter.op)
+	{
+	case Equal:
+		all = minimum == filter.value && maximum == filter.value;
+		any = minimum <= filter.value && maximum >= filter.value;
+		break;
+	case NotEqual:
+		all = minimum > filter.value || maximum < filter.value;
+		any = !(minimum == filter.value && maximum == filter.value);
+		break;
+	default:
+		all = Passes(filter, minimum) && Passes(filter, maximum); // Ranges, so both ends pass only if everything between does
+		any = Passes(filter, minimum) || Passes(filter, maximum);
+		break;
+	}
+
+	return all ? AllRows : (any ? SomeRows : NoRows);
+}
+
+// -----------------------------------------------------------------------------
+// Name of a death cause
+const char* GetDeathName(int64_t cause)
+{
+	if (cause == ResultsFormat::StillAlive)
+		return "still alive";
+
+	return EntityKind::GetName(EntityKind::Kind(cause));
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		printf("Usage: ResultsQuery <store> [filter ...] [top=K]\n");
+		printf("Filters are a column, = != < <= > >= and a number, such as score>=5000 or death=3\n");
+		return 1;
+	}
+
+	vector<Filter> filters;
+	int topCount = 10;
+	for (int i = 2; i < argc; i++)
+	{
+		Filter filter;
+		if (strncmp(argv[i], "top=", 4) == 0)
+			topCount = max(0, atoi(argv[i] + 4));
+		else if (ParseFilter(argv[i], filter))
+			filters.push_back(filter);
+		else
+		{
+			printf("Don't understand %s\n", argv[i]);
+			return 1;
+		}
+	}
+
+	MappedFile store;
+	if (!store.Open(argv[1]))
+	{
+		printf("Could not open %s\n", argv[1]);
+		return 1;
+	}
+
+	const ResultsFileHeader* header = (const ResultsFileHeader*)store.data;
+	if (store.size < (long long)sizeof(ResultsFileHeader) || memcmp(header->magic, "KJRS", 4) != 0)
+	{
+		printf("%s is not a results store\n", argv[1]);
+		return 1;
+	}
+
+	if (header->version != ResultsFormat::VERSION || header->columnCount != ResultsFormat::COLUMN_COUNT)
+	{
+		printf("%s was written by a different version of the game (version %d, %d columns)\n", argv[1], header->version, header->columnCount);
+		return 1;
+	}
+
+	Aggregate aggregates[ResultsFormat::COLUMN_COUNT];
+	long long deaths[EntityKind::COUNT + 1] = {}; // Still alive, then each kind
+	long long totalRows = 0, matched = 0;
+	int blocks = 0, skipped = 0, fromStatistics = 0;
+
+	vector<TopScore> top; // A min heap on score of the best topCount games
+	auto worseTop = [](const TopScore& a, const TopScore& b) { return a.score > b.score; };
+
+	vector<int64_t> values[ResultsFormat::COLUMN_COUNT];
+	for (int c = 0; c < ResultsFormat::COLUMN_COUNT; c++)
+		values[c].resize(ResultsFormat::BLOCK_ROWS);
+	vector<uint8_t> passes(ResultsFormat::BLOCK_ROWS);
+
+	long long offset = sizeof(ResultsFileHeader);
+	while (offset + (long long)sizeof(ResultsBlockHeader) <= store.size)
+	{
+		const ResultsBlockHeader& block = *(const ResultsBlockHeader*)(store.data + offset);
+		if (!IsResultsBlockWhole(block, uint64_t(store.size - offset)))
+			break; // A torn last block
+
+		const uint8_t* columnData[ResultsFormat::COLUMN_COUNT];
+		const uint8_t* data = store.data + offset + sizeof(ResultsBlockHeader);
+		for (int c = 0; c < ResultsFormat::COLUMN_COUNT; c++)
+		{
+			columnData[c] = data;
+			data += block.columns[c].bytes;
+		}
+
+		offset += block.bytes;
+		blocks++;
+		totalRows += block.rowCount;
+
+		int rows = int(block.rowCount);
+		bool decoded[ResultsFormat::COLUMN_COUNT] = {};
+		auto decode = [&](int c)
+		{
+			if (!decoded[c])
+				DecodeResultsColumn(block.columns[c], columnData[c], rows, values[c].data());
+			decoded[c] = true;
+		};
+
+		// What the statistics say about the filters
+		Coverage coverage = AllRows;
+		for (const Filter& filter : filters)
+		{
+			Coverage column = GetCoverage(filter, block.columns[filter.column].minimum, block.columns[filter.column].maximum);
+			if (column < coverage)
+				coverage = column;
+		}
+
+		if (coverage == NoRows)
+		{
+			skipped++;
+			continue;
+		}
+
+		bool topWanted = topCount > 0 && ((int)top.size() < topCount || block.columns[ResultsFormat::Score].maximum > top.front().score);
+
+		if (coverage == AllRows)
+		{
+			fromStatistics++;
+			matched += rows;
+			for (int c = 0; c < ResultsFormat::COLUMN_COUNT; c++)
+				aggregates[c].Add(block.columns[c].minimum, block.columns[c].maximum, double(block.columns[c].sum), rows);
+
+			fill(passes.begin(), passes.begin() + rows, 1);
+		}
+		else
+		{
+			fill(passes.begin(), passes.begin() + rows, 1);
+			for (const Filter& filter : filters)
+			{
+				decode(filter.column);
+				const int64_t* column = values[filter.column].data();
+				for (int i = 0; i < rows; i++)
+					passes[i] &= Passes(filter, column[i]);
+			}
+
+			for (int c = ResultsFormat::Ticks; c < ResultsFormat::COLUMN_COUNT; c++)
+			{
+				if (c == ResultsFormat::DeathCause)
+					continue; // Counted by cause instead
+
+				decode(c);
+				const int64_t* column = values[c].data();
+				for (int i = 0; i < rows; i++)
+				{
+					if (passes[i])
+						aggregates[c].Add(column[i], column[i], double(column[i]), 1);
+				}
+			}
+
+			for (int i = 0; i < rows; i++)
+				matched += passes[i];
+		}
+
+		decode(ResultsFormat::DeathCause);
+		const int64_t* causes = values[ResultsFormat::DeathCause].data();
+		for (int i = 0; i < rows; i++)
+		{
+			if (passes[i] && causes[i] >= ResultsFormat::StillAlive && causes[i] < EntityKind::COUNT)
+				deaths[causes[i] + 1]++;
+		}
+
+		if (!topWanted)
+			continue;
+
+		decode(ResultsFormat::Score);
+		const int64_t* scores = values[ResultsFormat::Score].data();
+		for (int i = 0; i < rows; i++)
+		{
+			if (!passes[i] || ((int)top.size() == topCount && scores[i] <= top.front().score))
+				continue;
+
+			decode(ResultsFormat::Seed);
+			decode(ResultsFormat::ParamSet);
+			decode(ResultsFormat::Ticks);
+
+			TopScore entry = { scores[i], values[ResultsFormat::Seed][i], values[ResultsFormat::ParamSet][i], values[ResultsFormat::Ticks][i] };
+			if ((int)top.size() == topCount)
+			{
+				pop_heap(top.begin(), top.end(), worseTop);
+				top.pop_back();
+			}
+			top.push_back(entry);
+			push_heap(top.begin(), top.end(), worseTop);
+		}
+	}
+
+	printf("%lld games in %d blocks, %lld pass the filters\n", totalRows, blocks, matched);
+	printf("%d blocks skipped and %d counted from their statistics\n\n", skipped, fromStatistics);
+
+	printf("%-10s %12s %12s %14s\n", "column", "min", "max", "mean");
+	for (int c = ResultsFormat::Ticks; c < ResultsFormat::COLUMN_COUNT; c++)
+	{
+		if (c == ResultsFormat::DeathCause)
+			continue;
+
+		const Aggregate& aggregate = aggregates[c];
+		printf("%-10s %12lld %12lld %14.2f\n", ResultsFormat::GetColumnName(ResultsFormat::Column(c)),
+			(long long)aggregate.minimum, (long long)aggregate.maximum, aggregate.count > 0 ? aggregate.sum / double(aggregate.count) : 0.0);
+	}
+
+	printf("\nEnded by:\n");
+	for (int cause = ResultsFormat::StillAlive; cause < EntityKind::Item; cause++)
+		printf("  %-12s %12lld %6.2f%%\n", GetDeathName(cause), deaths[cause + 1], matched > 0 ? 100.0 * double(deaths[cause + 1]) / double(matched) : 0.0);
+
+	if (!top.empty())
+	{
+		sort_heap(top.begin(), top.end(), worseTop);
+
+		printf("\nTop %d scores:\n%12s %12s %8s %8s\n", (int)top.size(), "score", "seed", "params", "ticks");
+		for (const TopScore& entry : top)
+			printf("%12lld %12lld %8lld %8lld\n", (long long)entry.score, (long long)entry.seed, (long long)entry.params, (long long)entry.ticks);
+	}
+
+	return 0;
+}